@@ -273,7 +273,26 @@ namespace uiview
 
 	inline FlexContainer::FlexContainer()
 	{
-		style()->set("min-height: 300px; max-height: 450px; background-color: #dce7f2; border: 1px solid #2a4f73; width: 750px; margin: 15px auto");
+		style()->set_value("min-height", StyleSetValue::from_length(300.0f, StyleDimension::px));
+		style()->set_value("max-height", StyleSetValue::from_length(450.0f, StyleDimension::px));
+		style()->set_value("background-color", StyleSetValue::from_color(Colorf(0.862745106f, 0.905882359f, 0.949019611f, 1.0f)));
+		style()->set_value("border-left-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-top-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-right-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-bottom-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-left-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-top-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-right-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-bottom-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-left-color", StyleSetValue::from_color(Colorf(0.164705887f, 0.309803933f, 0.450980395f, 1.0f)));
+		style()->set_value("border-top-color", StyleSetValue::from_color(Colorf(0.164705887f, 0.309803933f, 0.450980395f, 1.0f)));
+		style()->set_value("border-right-color", StyleSetValue::from_color(Colorf(0.164705887f, 0.309803933f, 0.450980395f, 1.0f)));
+		style()->set_value("border-bottom-color", StyleSetValue::from_color(Colorf(0.164705887f, 0.309803933f, 0.450980395f, 1.0f)));
+		style()->set_value("width", StyleSetValue::from_length(750.0f, StyleDimension::px));
+		style()->set_value("margin-top", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		style()->set_value("margin-bottom", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		style()->set_value("margin-left", StyleSetValue::from_keyword("auto"));
+		style()->set_value("margin-right", StyleSetValue::from_keyword("auto"));
 	}
 
 	inline FlexExample::FlexExample()
@@ -289,7 +308,7 @@ namespace uiview
 		box2 = container->add_child<FlexRedBox>();
 		box3 = container->add_child<FlexRedBox>();
 		box4 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-direction: row");
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
 		headline->set_properties(
 		{
 			{ "text", "Put flex items into a row" }
@@ -315,7 +334,11 @@ namespace uiview
 		box8 = container->add_child<FlexRedBox>();
 		box9 = container->add_child<FlexRedBox>();
 		box10 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-direction: column; align-items: center; justify-content: center; flex-flow: column wrap; align-content: center");
+		container->style()->set_value("align-items", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("justify-content", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container->style()->set_value("flex-wrap", StyleSetValue::from_keyword("wrap"));
+		container->style()->set_value("align-content", StyleSetValue::from_keyword("center"));
 		headline->set_properties(
 		{
 			{ "text", "Remove the space from wrapped rows or columns" }
@@ -335,8 +358,8 @@ namespace uiview
 		box2 = container->add_child<FlexRedBox>();
 		box3 = container->add_child<FlexRedBox>();
 		box4 = container->add_child<FlexRedBox>();
-		box2->style()->set("align-self: flex-start");
-		box3->style()->set("margin-left: auto");
+		box2->style()->set_value("align-self", StyleSetValue::from_keyword("flex-start"));
+		box3->style()->set_value("margin-left", StyleSetValue::from_keyword("auto"));
 		headline->set_properties(
 		{
 			{ "text", "Pin an element to one side of the flex container" }
@@ -356,7 +379,7 @@ namespace uiview
 		box2 = container->add_child<FlexRedBox>();
 		box3 = container->add_child<FlexRedBox>();
 		box4 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-direction: column");
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
 		headline->set_properties(
 		{
 			{ "text", "Put flex items into a column" }
@@ -381,8 +404,11 @@ namespace uiview
 		box6 = container2->add_child<FlexRedBox>();
 		box7 = container2->add_child<FlexRedBox>();
 		box8 = container2->add_child<FlexRedBox>();
-		container1->style()->set("flex-direction: column; justify-content: flex-start; height: 500px");
-		container2->style()->set("flex-direction: row; align-items: flex-start");
+		container1->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container1->style()->set_value("justify-content", StyleSetValue::from_keyword("flex-start"));
+		container1->style()->set_value("height", StyleSetValue::from_length(500.0f, StyleDimension::px));
+		container2->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		container2->style()->set_value("align-items", StyleSetValue::from_keyword("flex-start"));
 		headline->set_properties(
 		{
 			{ "text", "Move flex items to the top" }
@@ -407,8 +433,10 @@ namespace uiview
 		box6 = container2->add_child<FlexRedBox>();
 		box7 = container2->add_child<FlexRedBox>();
 		box8 = container2->add_child<FlexRedBox>();
-		container1->style()->set("flex-direction: row; justify-content: flex-start");
-		container2->style()->set("flex-direction: column; align-items: flex-start");
+		container1->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		container1->style()->set_value("justify-content", StyleSetValue::from_keyword("flex-start"));
+		container2->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container2->style()->set_value("align-items", StyleSetValue::from_keyword("flex-start"));
 		headline->set_properties(
 		{
 			{ "text", "Move flex items to the left" }
@@ -433,8 +461,10 @@ namespace uiview
 		box6 = container2->add_child<FlexRedBox>();
 		box7 = container2->add_child<FlexRedBox>();
 		box8 = container2->add_child<FlexRedBox>();
-		container1->style()->set("flex-direction: row; justify-content: flex-end");
-		container2->style()->set("flex-direction: column; align-items: flex-end");
+		container1->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		container1->style()->set_value("justify-content", StyleSetValue::from_keyword("flex-end"));
+		container2->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container2->style()->set_value("align-items", StyleSetValue::from_keyword("flex-end"));
 		headline->set_properties(
 		{
 			{ "text", "Move flex items to the right" }
@@ -459,8 +489,12 @@ namespace uiview
 		box6 = container2->add_child<FlexRedBox>();
 		box7 = container2->add_child<FlexRedBox>();
 		box8 = container2->add_child<FlexRedBox>();
-		container1->style()->set("flex-direction: column; justify-content: center; align-items: center");
-		container2->style()->set("flex-direction: row; justify-content: center; align-items: center");
+		container1->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container1->style()->set_value("justify-content", StyleSetValue::from_keyword("center"));
+		container1->style()->set_value("align-items", StyleSetValue::from_keyword("center"));
+		container2->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		container2->style()->set_value("justify-content", StyleSetValue::from_keyword("center"));
+		container2->style()->set_value("align-items", StyleSetValue::from_keyword("center"));
 		headline->set_properties(
 		{
 			{ "text", "Center everything" }
@@ -478,9 +512,13 @@ namespace uiview
 		container = add_child<FlexContainer>();
 		box1 = container->add_child<FlexRedBox>();
 		box2 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-direction: row");
-		box1->style()->set("flex: 2 0 0");
-		box2->style()->set("flex: 1 0 0");
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		box1->style()->set_value("flex-grow", StyleSetValue::from_number(2.0f));
+		box1->style()->set_value("flex-shrink", StyleSetValue::from_number(0.0f));
+		box1->style()->set_value("flex-basis", StyleSetValue::from_length(0.0f, StyleDimension::px));
+		box2->style()->set_value("flex-grow", StyleSetValue::from_number(1.0f));
+		box2->style()->set_value("flex-shrink", StyleSetValue::from_number(0.0f));
+		box2->style()->set_value("flex-basis", StyleSetValue::from_length(0.0f, StyleDimension::px));
 		headline->set_properties(
 		{
 			{ "text", "Grow a flex item X times as big as other flex items" }
@@ -507,7 +545,11 @@ namespace uiview
 		box10 = container->add_child<FlexRedBox>();
 		box11 = container->add_child<FlexRedBox>();
 		box12 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-flow: row wrap; align-items: center; justify-content: center; align-content: flex-end");
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("row"));
+		container->style()->set_value("flex-wrap", StyleSetValue::from_keyword("wrap"));
+		container->style()->set_value("align-items", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("justify-content", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("align-content", StyleSetValue::from_keyword("flex-end"));
 		headline->set_properties(
 		{
 			{ "text", "Wrap flex items into multiple rows" }
@@ -526,7 +568,11 @@ namespace uiview
 		box6 = container->add_child<FlexRedBox>();
 		box7 = container->add_child<FlexRedBox>();
 		box8 = container->add_child<FlexRedBox>();
-		container->style()->set("flex-flow: column wrap; align-items: center; justify-content: center; align-content: stretch");
+		container->style()->set_value("flex-direction", StyleSetValue::from_keyword("column"));
+		container->style()->set_value("flex-wrap", StyleSetValue::from_keyword("wrap"));
+		container->style()->set_value("align-items", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("justify-content", StyleSetValue::from_keyword("center"));
+		container->style()->set_value("align-content", StyleSetValue::from_keyword("stretch"));
 		headline->set_properties(
 		{
 			{ "text", "Wrap flex items into multiple columns" }
@@ -535,22 +581,65 @@ namespace uiview
 
 	inline FlexHeadline::FlexHeadline()
 	{
-		style()->set("font-weight: 400; font-style: italic; font-size: 24px; line-height: 32px; width: 750px; margin: 15px auto; flex: none");
+		style()->set_value("font-weight", StyleSetValue::from_number(400.0f));
+		style()->set_value("font-style", StyleSetValue::from_keyword("italic"));
+		style()->set_value("font-size", StyleSetValue::from_length(24.0f, StyleDimension::px));
+		style()->set_value("line-height", StyleSetValue::from_length(32.0f, StyleDimension::px));
+		style()->set_value("width", StyleSetValue::from_length(750.0f, StyleDimension::px));
+		style()->set_value("margin-top", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		style()->set_value("margin-bottom", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		style()->set_value("margin-left", StyleSetValue::from_keyword("auto"));
+		style()->set_value("margin-right", StyleSetValue::from_keyword("auto"));
+		style()->set_value("flex-grow", StyleSetValue::from_number(0.0f));
+		style()->set_value("flex-shrink", StyleSetValue::from_number(0.0f));
+		style()->set_value("flex-basis", StyleSetValue::from_keyword("auto"));
 	}
 
 	inline FlexPanelButton::FlexPanelButton()
 	{
-		style()->set("margin: 5px 0; padding: 2px 5px");
+		style()->set_value("margin-top", StyleSetValue::from_length(5.0f, StyleDimension::px));
+		style()->set_value("margin-bottom", StyleSetValue::from_length(5.0f, StyleDimension::px));
+		style()->set_value("margin-left", StyleSetValue::from_length(0.0f, StyleDimension::px));
+		style()->set_value("margin-right", StyleSetValue::from_length(0.0f, StyleDimension::px));
+		style()->set_value("padding-top", StyleSetValue::from_length(2.0f, StyleDimension::px));
+		style()->set_value("padding-bottom", StyleSetValue::from_length(2.0f, StyleDimension::px));
+		style()->set_value("padding-left", StyleSetValue::from_length(5.0f, StyleDimension::px));
+		style()->set_value("padding-right", StyleSetValue::from_length(5.0f, StyleDimension::px));
 	}
 
 	inline FlexParagraph::FlexParagraph()
 	{
-		style()->set("width: 750px; margin: 8px auto; flex: none");
+		style()->set_value("width", StyleSetValue::from_length(750.0f, StyleDimension::px));
+		style()->set_value("margin-top", StyleSetValue::from_length(8.0f, StyleDimension::px));
+		style()->set_value("margin-bottom", StyleSetValue::from_length(8.0f, StyleDimension::px));
+		style()->set_value("margin-left", StyleSetValue::from_keyword("auto"));
+		style()->set_value("margin-right", StyleSetValue::from_keyword("auto"));
+		style()->set_value("flex-grow", StyleSetValue::from_number(0.0f));
+		style()->set_value("flex-shrink", StyleSetValue::from_number(0.0f));
+		style()->set_value("flex-basis", StyleSetValue::from_keyword("auto"));
 	}
 
 	inline FlexRedBox::FlexRedBox()
 	{
-		style()->set("width: 100px; height: 100px; background-color: #e46119; border: 1px solid #626262; margin: 3px");
+		style()->set_value("width", StyleSetValue::from_length(100.0f, StyleDimension::px));
+		style()->set_value("height", StyleSetValue::from_length(100.0f, StyleDimension::px));
+		style()->set_value("background-color", StyleSetValue::from_color(Colorf(0.894117653f, 0.380392164f, 0.0980392173f, 1.0f)));
+		style()->set_value("border-left-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-top-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-right-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-bottom-width", StyleSetValue::from_length(1.0f, StyleDimension::px));
+		style()->set_value("border-left-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-top-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-right-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-bottom-style", StyleSetValue::from_keyword("solid"));
+		style()->set_value("border-left-color", StyleSetValue::from_color(Colorf(0.384313732f, 0.384313732f, 0.384313732f, 1.0f)));
+		style()->set_value("border-top-color", StyleSetValue::from_color(Colorf(0.384313732f, 0.384313732f, 0.384313732f, 1.0f)));
+		style()->set_value("border-right-color", StyleSetValue::from_color(Colorf(0.384313732f, 0.384313732f, 0.384313732f, 1.0f)));
+		style()->set_value("border-bottom-color", StyleSetValue::from_color(Colorf(0.384313732f, 0.384313732f, 0.384313732f, 1.0f)));
+		style()->set_value("margin-left", StyleSetValue::from_length(3.0f, StyleDimension::px));
+		style()->set_value("margin-top", StyleSetValue::from_length(3.0f, StyleDimension::px));
+		style()->set_value("margin-right", StyleSetValue::from_length(3.0f, StyleDimension::px));
+		style()->set_value("margin-bottom", StyleSetValue::from_length(3.0f, StyleDimension::px));
 	}
 
 	inline MainWindow::MainWindow()
@@ -579,9 +668,58 @@ namespace uiview
 		example9 = examples->add_child<FlexExample9>();
 		example10 = examples->add_child<FlexExample10>();
 		example11 = examples->add_child<FlexExample11>();
-		style()->set("background: rgb(250,250,250); font: 11px/15px 'Segoe UI'; color: black");
-		panel->style()->set("width: 300px; background: rgb(240,240,240); padding: 15px");
-		examples->style()->set("flex: 1 1");
+		style()->set_value("background-color", StyleSetValue::from_color(Colorf(0.980392158f, 0.980392158f, 0.980392158f, 1.0f)));
+		style()->set_value("background-image", StyleSetValue::from_keyword("array"));
+		style()->set_value("background-image[0]", StyleSetValue::from_keyword("none"));
+		style()->set_value("background-repeat", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-repeat-x", { StyleSetValue::from_keyword("repeat") });
+		style()->set_value_array("background-repeat-y", { StyleSetValue::from_keyword("repeat") });
+		style()->set_value("background-attachment", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-attachment", { StyleSetValue::from_keyword("scroll") });
+		style()->set_value("background-position", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-position-x", { StyleSetValue::from_percentage(0.0f) });
+		style()->set_value_array("background-position-y", { StyleSetValue::from_percentage(0.0f) });
+		style()->set_value("background-origin", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-origin", { StyleSetValue::from_keyword("padding-box") });
+		style()->set_value("background-clip", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-clip", { StyleSetValue::from_keyword("border-box") });
+		style()->set_value("background-size", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("background-size-x", { StyleSetValue::from_keyword("auto") });
+		style()->set_value_array("background-size-y", { StyleSetValue::from_keyword("auto") });
+		style()->set_value("font-style", StyleSetValue::from_keyword("normal"));
+		style()->set_value("font-variant", StyleSetValue::from_keyword("normal"));
+		style()->set_value("font-weight", StyleSetValue::from_keyword("normal"));
+		style()->set_value("font-size", StyleSetValue::from_length(11.0f, StyleDimension::px));
+		style()->set_value("line-height", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		style()->set_value("font-family", StyleSetValue::from_keyword("array"));
+		style()->set_value_array("font-family-names", { StyleSetValue::from_string("Segoe UI") });
+		style()->set_value("color", StyleSetValue::from_color(Colorf(0.0f, 0.0f, 0.0f, 1.0f)));
+		panel->style()->set_value("width", StyleSetValue::from_length(300.0f, StyleDimension::px));
+		panel->style()->set_value("background-color", StyleSetValue::from_color(Colorf(0.941176474f, 0.941176474f, 0.941176474f, 1.0f)));
+		panel->style()->set_value("background-image", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value("background-image[0]", StyleSetValue::from_keyword("none"));
+		panel->style()->set_value("background-repeat", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-repeat-x", { StyleSetValue::from_keyword("repeat") });
+		panel->style()->set_value_array("background-repeat-y", { StyleSetValue::from_keyword("repeat") });
+		panel->style()->set_value("background-attachment", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-attachment", { StyleSetValue::from_keyword("scroll") });
+		panel->style()->set_value("background-position", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-position-x", { StyleSetValue::from_percentage(0.0f) });
+		panel->style()->set_value_array("background-position-y", { StyleSetValue::from_percentage(0.0f) });
+		panel->style()->set_value("background-origin", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-origin", { StyleSetValue::from_keyword("padding-box") });
+		panel->style()->set_value("background-clip", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-clip", { StyleSetValue::from_keyword("border-box") });
+		panel->style()->set_value("background-size", StyleSetValue::from_keyword("array"));
+		panel->style()->set_value_array("background-size-x", { StyleSetValue::from_keyword("auto") });
+		panel->style()->set_value_array("background-size-y", { StyleSetValue::from_keyword("auto") });
+		panel->style()->set_value("padding-left", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		panel->style()->set_value("padding-top", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		panel->style()->set_value("padding-right", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		panel->style()->set_value("padding-bottom", StyleSetValue::from_length(15.0f, StyleDimension::px));
+		examples->style()->set_value("flex-grow", StyleSetValue::from_number(1.0f));
+		examples->style()->set_value("flex-shrink", StyleSetValue::from_number(1.0f));
+		examples->style()->set_value("flex-basis", StyleSetValue::from_length(0.0f, StyleDimension::px));
 		button1->set_properties(
 		{
 			{ "text", "Put flex items into a row" }
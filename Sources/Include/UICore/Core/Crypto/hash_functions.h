@@ -38,6 +38,7 @@
 #include "../Crypto/sha512.h"
 #include "../Crypto/sha512_224.h"
 #include "../Crypto/sha512_256.h"
+#include "../Crypto/xxhash64.h"
 
 namespace uicore
 {
@@ -46,11 +47,25 @@ namespace uicore
 	{
 	public:
 		/// \brief Calculate a CRC32 checksum on the data. 
+		///
+		/// This is the CRC used by zlib, zip and PNG. Pass the previous result as running_crc to continue a checksum.
 		static uint32_t crc32(const void *data, int size, uint32_t running_crc = 0);
 
-		/// \brief Calculate a CRC32 checksum on the data. 
+		/// \brief Calculate a CRC32C (Castagnoli) checksum on the data.
+		///
+		/// Uses the SSE 4.2 crc32 instruction when available. Pass the previous result as running_crc to continue a checksum.
+		static uint32_t crc32c(const void *data, int size, uint32_t running_crc = 0);
+
+		/// \brief Calculate an Adler-32 checksum on the data.
+		///
+		/// Pass the previous result as running_adler32 to continue a checksum.
 		static uint32_t adler32(const void *data, int size, uint32_t running_adler32 = 0);
 
+		/// \brief Calculate a XXH64 hash of the data.
+		///
+		/// Use XXHash64 to hash data arriving in pieces.
+		static uint64_t xxhash64(const void *data, int size, uint64_t seed = 0);
+
 		/// \brief Generate SHA-1 hash from data.
 		static std::string sha1(const void *data, int size, bool uppercase = false);
 
@@ -30,15 +30,32 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 namespace uicore
 {
+	class TLSSessionCache;
+
 	/// \brief Transport Layer Security (TLS) client class
+	///
+	/// Data is exchanged through internal buffers with encrypt(), decrypt() and the *_data() functions.
+	/// The client hello is available from encrypted_data() as soon as the client is created.
+	/// Once the handshake is complete, encrypt_record() and decrypt_record() can be used instead to process
+	/// records in place in buffers owned by the caller.
 	class TLSClient
 	{
 	public:
 		/// \brief Constructs a TLS client
-		static std::shared_ptr<TLSClient> create();
+		///
+		/// \param server_name = Host name of the server, sent in the server name indication extension
+		/// \param session_cache = Cache used to resume the previous session with server_name
+		static std::shared_ptr<TLSClient> create(const std::string &server_name = std::string(), const std::shared_ptr<TLSSessionCache> &session_cache = std::shared_ptr<TLSSessionCache>());
+
+		/// \brief Returns true when the handshake is complete
+		virtual bool is_connected() const = 0;
+
+		/// \brief Returns true if the server accepted a session from the session cache
+		virtual bool is_session_resumed() const = 0;
 
 		/// \brief Return a pointer to decrypted data available for consumption.
 		virtual const void *decrypted_data() const = 0;
@@ -63,5 +80,31 @@ namespace uicore
 
 		/// \brief Marks encrypted data as consumed.
 		virtual void encrypted_data_consumed(int size) = 0;
+
+		/// \brief Maximum application data size of a record
+		static const int max_record_data_size = 1 << 14;
+
+		/// \brief Returns the space encrypt_record() needs in front of the data
+		virtual int record_prefix_size() const = 0;
+
+		/// \brief Returns the space encrypt_record() may need after the data
+		virtual int record_suffix_size() const = 0;
+
+		/// \brief Encrypts application data into a record, in place
+		///
+		/// The data must be placed record_prefix_size() bytes into the buffer, followed by room for
+		/// record_suffix_size() bytes. The buffered encrypted data must have been consumed first.
+		///
+		/// \return The size of the record, which starts at the beginning of the buffer
+		virtual int encrypt_record(void *buffer, int data_size) = 0;
+
+		/// \brief Decrypts the record at the start of the buffer, in place
+		///
+		/// The buffered input and decrypted data must have been consumed first.
+		///
+		/// \param out_data = Set to the application data within the buffer
+		/// \param out_size = Set to the application data size. Zero for records without application data
+		/// \return The size of the record, or 0 if the buffer does not hold a complete record yet
+		virtual int decrypt_record(void *buffer, int size, void *&out_data, int &out_size) = 0;
 	};
 }
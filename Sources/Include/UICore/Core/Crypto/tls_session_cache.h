@@ -0,0 +1,60 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace uicore
+{
+	/// \brief Cache of negotiated TLS sessions shared between TLSClient instances
+	///
+	/// A TLSClient created with a server name and a session cache offers the session from the previous
+	/// connection to that server, using its session ID or RFC 5077 session ticket. When the server accepts it
+	/// the abbreviated handshake skips the certificate and the RSA or ECDHE key exchange.
+	///
+	/// The cache can be shared between threads.
+	class TLSSessionCache
+	{
+	public:
+		/// \brief Constructs a session cache
+		///
+		/// max_sessions = Number of servers to remember sessions for. The least recently used session is removed first
+		static std::shared_ptr<TLSSessionCache> create(int max_sessions = 256);
+
+		/// \brief Returns the number of sessions in the cache
+		virtual int size() const = 0;
+
+		/// \brief Removes the session for a server, so the next connection performs a full handshake
+		virtual void remove(const std::string &server_name) = 0;
+
+		/// \brief Removes all sessions
+		virtual void clear() = 0;
+	};
+}
@@ -0,0 +1,64 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	/// \brief XXH64 hash function class.
+	///
+	/// A fast non-cryptographic 64 bit hash for checksums and hash tables. It offers no protection against
+	/// deliberately constructed collisions, so use SHA-256 when the data cannot be trusted.
+	class XXHash64
+	{
+	public:
+		/// \brief Constructs a XXH64 hash generator.
+		static std::shared_ptr<XXHash64> create(uint64_t seed = 0);
+
+		/// \brief Returns the hash of the data added so far.
+		///
+		/// More data can be added afterwards.
+		virtual uint64_t hash() const = 0;
+
+		/// \brief Resets the hash generator, keeping the seed.
+		virtual void reset() = 0;
+
+		/// \brief Adds data to be hashed.
+		virtual void add(const void *data, int size) = 0;
+
+		/// \brief Add
+		///
+		/// \param data = Data Buffer
+		virtual void add(const std::shared_ptr<DataBuffer> &data) = 0;
+	};
+}
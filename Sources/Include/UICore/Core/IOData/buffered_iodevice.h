@@ -0,0 +1,57 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "iodevice.h"
+
+namespace uicore
+{
+	/// \brief Adds a read-ahead and write-behind buffer to another IODevice
+	///
+	/// Small reads and writes, such as read_uint8 or write_uint32, are served from
+	/// the buffer instead of going to the underlying device each time.
+	class BufferedIODevice : public IODevice
+	{
+	public:
+		static std::shared_ptr<BufferedIODevice> create(const std::shared_ptr<IODevice> &device, int buffer_size = 64 * 1024);
+
+		/// \brief Returns the device being buffered
+		virtual const std::shared_ptr<IODevice> &device() const = 0;
+
+		/// \brief Returns the size of the buffer
+		virtual int buffer_size() const = 0;
+
+		/// \brief Writes any buffered data to the underlying device
+		///
+		/// Also positions the underlying device at the logical position of this device,
+		/// returning bytes read ahead but not yet consumed.
+		virtual void flush() = 0;
+	};
+}
@@ -50,14 +50,26 @@ namespace uicore
 		static std::shared_ptr<File> create_always(const std::string &filename, FileAccess access = FileAccess::read_write);
 		static std::shared_ptr<File> create_new(const std::string &filename, FileAccess access = FileAccess::read_write);
 
+		// read_all_text, read_all_bytes, open_mapped and exists also find files in packs mounted with ResourcePack::mount
 		static std::string read_all_text(const std::string &filename);
 		static void write_all_text(const std::string &filename, const std::string &text);
 
 		static std::shared_ptr<DataBuffer> read_all_bytes(const std::string &filename);
 		static void write_all_bytes(const std::string &filename, const std::shared_ptr<DataBuffer> &data);
 
+		/// \brief Maps the contents of an existing file into memory
+		///
+		/// The returned buffer references the file pages directly and cannot be resized.
+		/// Changes to the buffer are private to the process and never written back to the file.
+		/// Small files are read into an ordinary buffer instead, as mapping them costs more than copying.
+		/// Use MemoryDevice::open to read it as an IODevice.
+		static std::shared_ptr<DataBuffer> open_mapped(const std::string &filename);
+
 		static void copy(const std::string &from, const std::string &to, bool copy_always);
 		static void remove(const std::string &filename);
 		static bool exists(const std::string &filename);
+
+		/// \brief Returns the time the file was last written to, in seconds since 1970-01-01 UTC
+		static long long last_write_time(const std::string &filename);
 	};
 }
@@ -49,6 +49,15 @@ namespace uicore
 		/// \brief Feeds the decoder with base64 encoded data.
 		virtual void feed(const void *data, int size, bool append_result = true) = 0;
 
+		/// \brief Returns the largest number of bytes size characters of base64 data can decode to.
+		static int decoded_size(int size);
+
+		/// \brief Decode base64 data into a preallocated buffer.
+		///
+		/// \param out_data = Buffer with room for decoded_size(size) bytes.
+		/// \return The number of bytes written.
+		static int decode(const void *data, int size, void *out_data);
+
 		/// \brief Decode base64 data and return it in a buffer.
 		static std::shared_ptr<DataBuffer> decode(const void *data, int size);
 		static std::shared_ptr<DataBuffer> decode(const std::string &data);
@@ -53,6 +53,15 @@ namespace uicore
 		/// \brief Ends the base64 encoding.
 		virtual void finalize(bool append_result = true) = 0;
 
+		/// \brief Returns the number of characters needed to base64 encode size bytes, including padding.
+		static int encoded_size(int size);
+
+		/// \brief Base64 encodes data into a preallocated buffer.
+		///
+		/// \param out_data = Buffer with room for encoded_size(size) characters. No terminating null is written.
+		/// \return The number of characters written.
+		static int encode(const void *data, int size, void *out_data);
+
 		/// \brief Base64 encodes data and returns it as a string.
 		static std::string encode(const void *data, int size);
 		static std::string encode(const std::string &data);
@@ -132,11 +132,9 @@ namespace uicore
 
 		/// \brief  Compute c = (a ** b) mod m.
 		///
-		/// Uses a standard square-and-multiply
-		/// method with modular reductions at each step. (This is basically the
-		/// same code as expt(), except for the addition of the reductions)
-		///
-		/// The modular reductions are done using Barrett's algorithm (see reduce() for details)
+		/// For odd moduli this uses Montgomery multiplication with a fixed
+		/// window over the exponent. Even moduli fall back to square-and-multiply
+		/// with the modular reductions done using Barrett's algorithm.
 		void exptmod(const BigInt *b, const BigInt *m, BigInt *c) const;
 
 		/// \brief  Compute c = a (mod m).  Result will always be 0 <= c < m.
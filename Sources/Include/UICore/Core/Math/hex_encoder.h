@@ -0,0 +1,49 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <string>
+
+namespace uicore
+{
+	/// \brief Hexadecimal encoder class.
+	class HexEncoder
+	{
+	public:
+		/// \brief Hex encodes data into a preallocated buffer, two characters per byte.
+		///
+		/// \param out_text = Buffer with room for 2 * size characters. No terminating null is written.
+		static void encode(const void *data, int size, char *out_text, bool uppercase = false);
+
+		/// \brief Hex encodes data and returns it as a string.
+		static std::string encode(const void *data, int size, bool uppercase = false);
+		static std::string encode(const std::string &data, bool uppercase = false);
+	};
+}
@@ -0,0 +1,62 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace uicore
+{
+	/// \brief Pool of worker threads executing queued functions
+	class WorkQueue
+	{
+	public:
+		/// \brief Constructs a work queue
+		///
+		/// \param num_threads Number of worker threads. Zero creates one thread per CPU core.
+		static std::shared_ptr<WorkQueue> create(int num_threads = 0);
+
+		/// \brief Work queue shared by the library for background and parallel processing
+		static const std::shared_ptr<WorkQueue> &shared();
+
+		/// \brief Returns the number of worker threads
+		virtual int thread_count() const = 0;
+
+		/// \brief Executes a function on one of the worker threads
+		virtual void queue(std::function<void()> func) = 0;
+
+		/// \brief Splits the range 0 to count into batches and processes them in parallel
+		///
+		/// The function is called with the start and end of each batch. The calling thread also processes
+		/// batches and the function returns when all of them have completed. The split only depends on
+		/// count, min_batch_size and thread_count, so the same input is always divided the same way.
+		/// If a batch throws an exception it is rethrown on the calling thread.
+		virtual void parallel_for(int count, const std::function<void(int start, int end)> &func, int min_batch_size = 1) = 0;
+	};
+}
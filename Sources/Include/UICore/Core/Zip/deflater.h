@@ -0,0 +1,74 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "zlib_compression.h"
+
+namespace uicore
+{
+	class IODevice;
+
+	/// \brief Streaming deflate compressor
+	///
+	/// The compressor state and scratch buffers are allocated once and reused for every stream.
+	class Deflater
+	{
+	public:
+		/// \brief Constructs a deflater
+		/// \param raw Skips the zlib header and checksum if true
+		/// \param compression_level Compression level in range 0-9. 0 = no compression, 1 = best speed, 6 = default, 9 = best compression.
+		/// \param mode Compression strategy
+		static std::shared_ptr<Deflater> create(bool raw = true, int compression_level = 6, ZLibCompression::CompressionMode mode = ZLibCompression::default_strategy);
+
+		/// \brief Compresses the rest of the input device as one complete stream
+		virtual void compress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output) = 0;
+
+		/// \brief Compresses a block of data as one complete stream
+		virtual std::shared_ptr<DataBuffer> compress(const void *data, size_t size) = 0;
+
+		/// \brief Adds data to the current stream, writing any compressed output produced so far
+		virtual void write(const void *data, size_t size, const std::shared_ptr<IODevice> &output) = 0;
+
+		/// \brief Writes all pending output, padded to a byte boundary, without ending the stream (sync flush)
+		virtual void flush(const std::shared_ptr<IODevice> &output) = 0;
+
+		/// \brief Ends the current stream. The deflater is then ready for a new stream.
+		virtual void finish(const std::shared_ptr<IODevice> &output) = 0;
+
+		/// \brief Abandons the current stream and starts a new one
+		virtual void reset() = 0;
+
+		/// \brief Returns the number of uncompressed bytes passed to the current stream
+		virtual unsigned long long total_in() const = 0;
+
+		/// \brief Returns the number of compressed bytes written for the current stream
+		virtual unsigned long long total_out() const = 0;
+	};
+}
@@ -0,0 +1,73 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	class IODevice;
+
+	/// \brief Streaming deflate decompressor
+	///
+	/// The decompressor state and its dictionary are allocated once and reused for every stream.
+	class Inflater
+	{
+	public:
+		/// \brief Constructs an inflater
+		/// \param raw Expects no zlib header and checksum if true
+		static std::shared_ptr<Inflater> create(bool raw = true);
+
+		/// \brief Decompresses one stream from the input device
+		///
+		/// The input is read in chunks. When the stream ends inside a chunk the input is seeked back, so it is left
+		/// positioned at the first byte after the stream. Data may only follow the stream if the input device can seek.
+		virtual void decompress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output) = 0;
+
+		/// \brief Decompresses one stream into a buffer of known size
+		///
+		/// Nothing is allocated. Throws if the stream is corrupt or does not fit the output buffer.
+		/// \return Number of bytes written to the output buffer
+		virtual size_t decompress(const void *input, size_t input_size, void *output, size_t output_size) = 0;
+
+		/// \brief Adds compressed data to the current stream, writing any decompressed output produced so far
+		///
+		/// Bytes after the end of the stream are not consumed. They belong to whatever follows the stream.
+		/// \param out_consumed Receives the number of bytes consumed from data, if not null. Less than size only when the stream ended
+		/// \return True when the end of the stream was reached
+		virtual bool write(const void *data, size_t size, const std::shared_ptr<IODevice> &output, size_t *out_consumed = nullptr) = 0;
+
+		/// \brief Returns true if the end of the current stream was reached
+		virtual bool is_finished() const = 0;
+
+		/// \brief Abandons the current stream and starts a new one
+		virtual void reset() = 0;
+	};
+}
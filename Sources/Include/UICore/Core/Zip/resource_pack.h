@@ -0,0 +1,94 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	class IODevice;
+
+	/// \brief Read-only archive of resource files with a sorted directory index
+	///
+	/// The pack file is memory mapped and looked up with a binary search, so opening a
+	/// resource costs no file system calls. Stored entries are returned without copying.
+	class ResourcePack
+	{
+	public:
+		/// \brief Opens a pack file created by ResourcePackWriter
+		static std::shared_ptr<ResourcePack> open(const std::string &filename);
+
+		/// \brief Opens a pack already in memory
+		static std::shared_ptr<ResourcePack> open(const std::shared_ptr<DataBuffer> &data);
+
+		/// \brief Makes the entries of a pack available to File, ImageFile and FontFamily under a path
+		///
+		/// A file named path + "/" + entry name is then read from the pack instead of the file system.
+		/// Packs mounted later take precedence over packs mounted earlier.
+		static void mount(const std::shared_ptr<ResourcePack> &pack, const std::string &path = std::string());
+
+		/// \brief Removes a previously mounted pack
+		static void unmount(const std::shared_ptr<ResourcePack> &pack);
+
+		/// \brief Returns the contents of a file from the mounted packs, or null if no pack contains it
+		static std::shared_ptr<DataBuffer> read_mounted(const std::string &filename);
+
+		/// \brief Returns true if a mounted pack contains the file
+		static bool exists_mounted(const std::string &filename);
+
+		/// \brief Returns the number of entries in the pack
+		virtual int entry_count() const = 0;
+
+		/// \brief Returns the name of an entry
+		virtual std::string entry_name(int index) const = 0;
+
+		/// \brief Returns the uncompressed size of an entry
+		virtual size_t entry_size(int index) const = 0;
+
+		/// \brief Returns true if the entry is stored with deflate compression
+		virtual bool entry_compressed(int index) const = 0;
+
+		/// \brief Returns the index of an entry, or -1 if the pack has no entry with that name
+		virtual int find(const std::string &name) const = 0;
+
+		/// \brief Returns true if the pack contains the entry
+		bool exists(const std::string &name) const { return find(name) != -1; }
+
+		/// \brief Returns the contents of an entry
+		///
+		/// Stored entries reference the pack memory directly and cannot be resized.
+		virtual std::shared_ptr<DataBuffer> read(int index) const = 0;
+		std::shared_ptr<DataBuffer> read(const std::string &name) const;
+
+		/// \brief Opens an entry for reading as an IODevice
+		std::shared_ptr<IODevice> open_device(const std::string &name) const;
+	};
+}
@@ -0,0 +1,68 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "../System/databuffer.h"
+
+namespace uicore
+{
+	class IODevice;
+
+	/// \brief How an entry is stored in a resource pack
+	enum class ResourcePackCompression
+	{
+		/// \brief Deflate the entry if that makes it noticeably smaller
+		automatic,
+
+		/// \brief Always store the entry uncompressed
+		stored,
+
+		/// \brief Always deflate the entry
+		deflate
+	};
+
+	/// \brief Creates resource pack files for ResourcePack
+	class ResourcePackWriter
+	{
+	public:
+		static std::shared_ptr<ResourcePackWriter> create();
+
+		/// \brief Adds an entry, replacing any existing entry with the same name
+		virtual void add(const std::string &name, const std::shared_ptr<DataBuffer> &data, ResourcePackCompression compression = ResourcePackCompression::automatic) = 0;
+
+		/// \brief Adds all files below a directory, named relative to it
+		virtual void add_directory(const std::string &path, ResourcePackCompression compression = ResourcePackCompression::automatic) = 0;
+
+		/// \brief Writes the pack
+		virtual void save(const std::string &filename) = 0;
+		virtual void save(const std::shared_ptr<IODevice> &device) = 0;
+	};
+}
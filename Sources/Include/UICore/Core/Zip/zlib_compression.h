@@ -32,7 +32,12 @@
 
 namespace uicore
 {
+	class WorkQueue;
+
 	/// \brief Deflate compressor
+	///
+	/// Compresses and decompresses whole buffers. Use Deflater and Inflater to work on
+	/// streams or to reuse the compressor state between calls.
 	class ZLibCompression
 	{
 	public:
@@ -52,6 +57,14 @@ namespace uicore
 		// \param mode Compression strategy
 		static std::shared_ptr<DataBuffer> compress(const std::shared_ptr<DataBuffer> &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy);
 
+		// \brief Compress data on multiple threads
+		//
+		// The input is split into fixed size blocks that are compressed independently and joined
+		// into a single deflate (or zlib) stream. The output is identical for every run and any
+		// number of threads, but slightly larger than compress() as blocks cannot reference each other.
+		// \param queue Work queue to use. If null the shared work queue is used.
+		static std::shared_ptr<DataBuffer> compress_parallel(const std::shared_ptr<DataBuffer> &data, bool raw = true, int compression_level = 6, CompressionMode mode = default_strategy, const std::shared_ptr<WorkQueue> &queue = std::shared_ptr<WorkQueue>());
+
 		// \brief Decompress data
 		// \param data Data to compress
 		// \param raw Skips header if true
@@ -44,6 +44,7 @@ namespace uicore
 	class Path;
 	class Pen;
 	class Brush;
+	class FrameBuffer;
 
 	/// \brief 2D Graphics Canvas
 	class Canvas
@@ -52,6 +53,11 @@ namespace uicore
 		/// \brief Constructs a canvas
 		static std::shared_ptr<Canvas> create(const std::shared_ptr<DisplayWindow> &window);
 
+		/// \brief Constructs a canvas rendering into a frame buffer
+		///
+		/// The canvas shares the graphic context of the specified canvas. The frame buffer is bound by begin() and the previously bound frame buffer is restored by end().
+		static std::shared_ptr<Canvas> create(const std::shared_ptr<Canvas> &canvas, const std::shared_ptr<FrameBuffer> &frame_buffer);
+
 		/// \brief Returns the graphic context associated with this canvas
 		virtual const std::shared_ptr<GraphicContext> &gc() const = 0;
 
@@ -118,5 +124,11 @@ namespace uicore
 
 		/// \brief Snaps the point to the nearest pixel corner
 		virtual Pointf grid_fit(const Pointf &pos) = 0;
+
+		/// \brief Returns the number of batches submitted to the graphic context since the counter was last reset
+		virtual int draw_call_count() const = 0;
+
+		/// \brief Resets the draw call counter
+		virtual void reset_draw_call_count() = 0;
 	};
 }
@@ -30,6 +30,7 @@
 
 #include <memory>
 #include <functional>
+#include "texture_format.h"
 
 namespace uicore
 {
@@ -60,6 +61,9 @@ namespace uicore
 		/// \brief Returns if this image should be cached
 		bool is_cached() const;
 
+		/// \brief Returns the block compressed format the image is uploaded as, or tf_rgba8 if it is uploaded uncompressed
+		TextureFormat compressed_format() const;
+
 		/// \brief Process the pixel buffers depending of the chosen settings
 		///
 		/// Note, the output may point to a different pixel buffer than the input\n
@@ -86,6 +90,13 @@ namespace uicore
 		/// (This defaults to true)
 		void set_cached(bool enable);
 
+		/// \brief Compresses the image on the CPU before it is uploaded
+		///
+		/// The format must be one supported by TextureCompressor. The sRGB setting selects the sRGB variant of the format.
+		/// Direct3D requires the width and height of compressed textures to be multiples of 4.
+		/// (This defaults to tf_rgba8, which uploads the image uncompressed)
+		void set_compressed_format(TextureFormat format);
+
 		/// \brief User defined fine control of the pixel buffer
 		///
 		/// Note, the output maybe different to the input, if desired
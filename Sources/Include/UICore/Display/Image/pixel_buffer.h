@@ -200,6 +200,12 @@ namespace uicore
 		/// \brief Converts current buffer to a new pixel format and returns the result.
 		std::shared_ptr<PixelBuffer> to_format(TextureFormat texture_format, const std::shared_ptr<PixelConverter> &converter) const;
 
+		/// \brief Returns a copy of the image resized to the given size
+		///
+		/// The image is halved with a box filter while it is at least twice the requested size,
+		/// and the remaining scaling is done with a Lanczos filter.
+		std::shared_ptr<PixelBuffer> resized(int new_width, int new_height) const;
+
 		/// \brief Flip the entire image vertically (turn it upside down)
 		void flip_vertical();
 
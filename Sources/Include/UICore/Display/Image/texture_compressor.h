@@ -0,0 +1,98 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include "texture_format.h"
+
+namespace uicore
+{
+	class PixelBuffer;
+
+	/// \brief Counters for images compressed and uploaded by the texture loading functions
+	struct TextureCompressionMetrics
+	{
+		/// \brief Number of images compressed by TextureCompressor
+		int compressed_images = 0;
+
+		/// \brief Size the compressed images would have had as rgba8
+		int64_t uncompressed_bytes = 0;
+
+		/// \brief Size of the compressed blocks
+		int64_t compressed_bytes = 0;
+
+		/// \brief Time spent encoding blocks
+		int64_t encode_microseconds = 0;
+
+		/// \brief Number of images uploaded by Texture2D::create from files or pixel buffers, and by Image::create from files
+		int uploads = 0;
+
+		/// \brief Number of those uploads that used compressed blocks
+		int compressed_uploads = 0;
+
+		/// \brief Bytes passed to the graphic context by the uploads
+		int64_t upload_bytes = 0;
+
+		/// \brief Time spent creating and filling the textures
+		///
+		/// This is measured on the CPU and does not include any work the driver defers.
+		int64_t upload_microseconds = 0;
+
+		/// \brief Video memory saved by using compressed textures
+		int64_t saved_bytes() const { return uncompressed_bytes - compressed_bytes; }
+	};
+
+	/// \brief Block compression of images on the CPU
+	///
+	/// Encodes 4x4 pixel blocks as BC1 (DXT1), BC2 (DXT3), BC3 (DXT5) or BC7 (BPTC).
+	/// Blocks are encoded in parallel on the shared work queue.
+	class TextureCompressor
+	{
+	public:
+		/// \brief Returns true if compress() can produce the format
+		static bool is_supported(TextureFormat format);
+
+		/// \brief Compresses an image
+		///
+		/// The image is converted to rgba8 first if needed. Partial blocks at the right and bottom edges are padded by repeating the last pixel.
+		/// The sRGB variants of the formats encode the same blocks. They only change how the texture is sampled.
+		static std::shared_ptr<PixelBuffer> compress(const std::shared_ptr<PixelBuffer> &image, TextureFormat format);
+
+		/// \brief Returns the sRGB variant of a compressed format
+		static TextureFormat srgb_format(TextureFormat format);
+
+		/// \brief Returns the counters for compressed images and texture uploads
+		static TextureCompressionMetrics metrics();
+
+		/// \brief Sets all counters to zero
+		static void reset_metrics();
+	};
+}
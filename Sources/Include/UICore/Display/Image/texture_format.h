@@ -131,6 +131,8 @@ namespace uicore
 		tf_compressed_srgb_s3tc_dxt1,
 		tf_compressed_srgb_alpha_s3tc_dxt1,
 		tf_compressed_srgb_alpha_s3tc_dxt3,
-		tf_compressed_srgb_alpha_s3tc_dxt5
+		tf_compressed_srgb_alpha_s3tc_dxt5,
+		tf_compressed_rgba_bptc_unorm,
+		tf_compressed_srgb_alpha_bptc_unorm
 	};
 }
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <map>
+#include "../../Core/Math/size.h"
 
 namespace uicore
 {
@@ -46,7 +47,19 @@ namespace uicore
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, const std::string &type = std::string(), bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, const std::string &type, bool srgb = false);
 
+		/// \brief Loads an image reduced to fit within max_size, keeping its aspect ratio
+		///
+		/// Formats that support it decode at a lower resolution (JPEG DCT scaling) and the rest of the reduction is done by PixelBuffer::resized.
+		/// Images that already fit are returned at full size.
+		static std::shared_ptr<PixelBuffer> load_scaled(const std::string &filename, const Size &max_size, const std::string &type = std::string(), bool srgb = false);
+
+		/// \brief Returns the largest size with the aspect ratio of image_size that fits within max_size, without enlarging it
+		static Size fit_size(const Size &image_size, const Size &max_size);
+
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, const std::string &type = std::string());
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, const std::string &type);
+
+	private:
+		static ImageFileType *find_type(const std::string &filename, const std::string &type);
 	};
 }
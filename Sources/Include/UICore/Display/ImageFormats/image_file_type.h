@@ -48,6 +48,12 @@ namespace uicore
 		virtual std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb) = 0;
 		virtual std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, bool srgb) = 0;
 
+		/// \brief Called to load an image that is going to be reduced to fit within max_size.
+		///
+		/// Formats that can decode at a lower resolution return an image that is smaller, but still at least as large as the fitted size.
+		/// The default implementation loads the image at full size.
+		virtual std::shared_ptr<PixelBuffer> load_reduced(const std::string &filename, const Size &max_size, bool srgb);
+
 		/// \brief Called to save a given PixelBuffer to a file
 		virtual void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename) = 0;
 		virtual void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file) = 0;
@@ -62,4 +62,20 @@ namespace uicore
 			ProviderClass::save(buffer, file);
 		}
 	};
+
+	/// \brief Class template to register a provider type that can decode images at a reduced resolution.
+	///
+	template<class ProviderClass>
+	class ImageFileTypeReduced_Register : public ImageFileType_Register<ProviderClass>
+	{
+	public:
+		ImageFileTypeReduced_Register(const std::string &type) : ImageFileType_Register<ProviderClass>(type)
+		{
+		}
+
+		virtual std::shared_ptr<PixelBuffer> load_reduced(const std::string &filename, const Size &max_size, bool srgb) override
+		{
+			return ProviderClass::load_reduced(filename, max_size, srgb);
+		}
+	};
 }
@@ -41,6 +41,15 @@ namespace uicore
 		static std::shared_ptr<PixelBuffer> load(const std::string &filename, bool srgb = false);
 		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &file, bool srgb = false);
 
+		/// \brief Loads the image scaled down by 1, 2, 4 or 8 in each direction
+		///
+		/// The reduction is done by the inverse DCT, which is much faster than loading the image at full size and scaling it afterwards.
+		static std::shared_ptr<PixelBuffer> load_scaled(const std::string &filename, int scale_denominator, bool srgb = false);
+		static std::shared_ptr<PixelBuffer> load_scaled(const std::shared_ptr<IODevice> &file, int scale_denominator, bool srgb = false);
+
+		/// \brief Loads the image at the smallest of the 1/1, 1/2, 1/4 and 1/8 scales that is still at least as large as the image fitted within max_size
+		static std::shared_ptr<PixelBuffer> load_reduced(const std::string &filename, const Size &max_size, bool srgb = false);
+
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, int quality = 85);
 		static void save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, int quality = 85);
 	};
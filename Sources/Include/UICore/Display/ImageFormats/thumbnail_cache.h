@@ -0,0 +1,58 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "../../Core/Math/size.h"
+
+namespace uicore
+{
+	class PixelBuffer;
+
+	/// \brief Persistent on-disk cache of reduced size images
+	///
+	/// Thumbnails are created with ImageFile::load_scaled and stored as PNG files in the cache directory.
+	/// An entry is keyed by the absolute path of the image, its last write time and the requested size,
+	/// so a modified image gets a new thumbnail.
+	class ThumbnailCache
+	{
+	public:
+		/// \brief Constructs a thumbnail cache storing its files in the given directory
+		///
+		/// The directory is created if it does not exist.
+		static std::shared_ptr<ThumbnailCache> create(const std::string &cache_path);
+
+		/// \brief Returns the image reduced to fit within max_size, loading and storing it if it is not in the cache
+		virtual std::shared_ptr<PixelBuffer> load(const std::string &filename, const Size &max_size, bool srgb = false) = 0;
+
+		/// \brief Removes all thumbnails from the cache directory
+		virtual void clear() = 0;
+	};
+}
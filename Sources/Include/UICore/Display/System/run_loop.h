@@ -28,11 +28,14 @@
 
 #pragma once
 
+#include "UICore/Core/Signals/signal.h"
 #include <functional>
 #include <future>
 
 namespace uicore
 {
+	class NetworkEvent;
+
 	/// \brief Main thread message pump processing
 	class RunLoop
 	{
@@ -52,6 +55,22 @@ namespace uicore
 		/// This provides a thread-safe way to execute some code on the main thread
 		/// as part of the message processing step.
 		static void main_thread_async(std::function<void()> func);
+
+		/// \brief Calls a function on the main thread whenever a network event is ready
+		///
+		/// The event is waited for together with the window messages, so no extra thread is needed to service it.
+		/// The function is called until the returned slot is destroyed. The event must stay alive until then.
+		static Slot connect_network_event(NetworkEvent *event, std::function<void()> func);
+
+		/// \brief Calls a function on the main thread whenever a file descriptor is readable, or writable if write is true
+		///
+		/// Only supported on Unix platforms. The function is called until the returned slot is destroyed.
+		static Slot connect_fd(int fd, bool write, std::function<void()> func);
+
+		/// \brief Calls a function on the main thread when the timeout has passed. Timeout in milliseconds.
+		///
+		/// A repeating timer is called until the returned slot is destroyed.
+		static Slot connect_timer(int timeout_ms, bool repeat, std::function<void()> func);
 		
 		/// \brief Executes a task on the main thread with a future result
 		///
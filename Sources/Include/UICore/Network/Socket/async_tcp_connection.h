@@ -0,0 +1,147 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include "network_reactor.h"
+#include <memory>
+#include <vector>
+#include <functional>
+#include <exception>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+namespace uicore
+{
+	class TCPConnection;
+	class DataBuffer;
+
+	/// \brief Callback receiving the result of an asynchronous network operation
+	///
+	/// If the operation failed, error holds the exception and result is default constructed.
+	template<typename T>
+	using AsyncNetworkCallback = std::function<void(const std::exception_ptr &error, T result)>;
+
+#if defined(__cpp_impl_coroutine)
+	/// \brief Awaitable returned by the coroutine versions of the asynchronous network operations
+	///
+	/// The coroutine is resumed on the reactor thread. Errors are rethrown by co_await.
+	template<typename T>
+	class AsyncNetworkAwaitable
+	{
+	public:
+		AsyncNetworkAwaitable(std::function<void(AsyncNetworkCallback<T>)> start) : start(std::move(start)) { }
+
+		bool await_ready() const { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			start([this, handle](const std::exception_ptr &operation_error, T operation_result)
+			{
+				error = operation_error;
+				result = std::move(operation_result);
+				handle.resume();
+			});
+		}
+
+		T await_resume()
+		{
+			if (error)
+				std::rethrow_exception(error);
+			return std::move(result);
+		}
+
+	private:
+		std::function<void(AsyncNetworkCallback<T>)> start;
+		std::exception_ptr error;
+		T result{};
+	};
+#endif
+
+	/// \brief TCP/IP connection with reads and writes completed by a NetworkReactor
+	///
+	/// Operations can be started from any thread. Reads complete in the order they were started, and so do writes.
+	/// The connection is kept alive by the caller, usually by capturing it in the callbacks of its pending operations.
+	class AsyncTCPConnection
+	{
+	public:
+		/// \brief Constructs an asynchronous connection for a connected socket
+		static std::shared_ptr<AsyncTCPConnection> create(std::shared_ptr<TCPConnection> connection, std::shared_ptr<NetworkReactor> reactor = std::shared_ptr<NetworkReactor>());
+
+		/// \brief Returns the connection the operations are performed on
+		virtual const std::shared_ptr<TCPConnection> &connection() const = 0;
+
+		/// \brief Returns the reactor completing the operations
+		virtual const std::shared_ptr<NetworkReactor> &reactor() const = 0;
+
+		/// \brief Reads up to size bytes as soon as data is available
+		///
+		/// The result is the number of bytes read, or 0 if the remote closed the connection.
+		/// The buffer must stay valid until the callback is called.
+		virtual void async_read(void *data, int size, AsyncNetworkCallback<int> func) = 0;
+
+		/// \brief Queues data for writing
+		///
+		/// Queued writes are sent together with a single gather write when possible.
+		/// The result is size when all the data has been written. The data must stay valid until the callback is called.
+		virtual void async_write(const void *data, int size, AsyncNetworkCallback<int> func) = 0;
+
+		/// \brief Queues several buffers for writing
+		///
+		/// The buffers are kept alive by the connection. The result is the total size written.
+		/// Throws an exception if the total size does not fit in an int.
+		virtual void async_write(std::vector<std::shared_ptr<DataBuffer>> buffers, AsyncNetworkCallback<int> func) = 0;
+
+		/// \brief Closes the connection
+		///
+		/// Pending operations complete with an error on the reactor thread.
+		virtual void close() = 0;
+
+#if defined(__cpp_impl_coroutine)
+		/// \brief Coroutine version of async_read
+		AsyncNetworkAwaitable<int> async_read(void *data, int size)
+		{
+			return AsyncNetworkAwaitable<int>([this, data, size](AsyncNetworkCallback<int> func) { async_read(data, size, std::move(func)); });
+		}
+
+		/// \brief Coroutine version of async_write
+		AsyncNetworkAwaitable<int> async_write(const void *data, int size)
+		{
+			return AsyncNetworkAwaitable<int>([this, data, size](AsyncNetworkCallback<int> func) { async_write(data, size, std::move(func)); });
+		}
+
+		/// \brief Coroutine version of async_write for several buffers
+		AsyncNetworkAwaitable<int> async_write(std::vector<std::shared_ptr<DataBuffer>> buffers)
+		{
+			return AsyncNetworkAwaitable<int>([this, buffers](AsyncNetworkCallback<int> func) { async_write(buffers, std::move(func)); });
+		}
+#endif
+	};
+}
@@ -0,0 +1,63 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include "async_tcp_connection.h"
+
+namespace uicore
+{
+	class TCPListen;
+
+	/// \brief Accepts incoming TCP/IP connections on a NetworkReactor
+	class AsyncTCPListen
+	{
+	public:
+		/// \brief Constructs an asynchronous listener for a listening socket
+		static std::shared_ptr<AsyncTCPListen> create(std::shared_ptr<TCPListen> listen, std::shared_ptr<NetworkReactor> reactor = std::shared_ptr<NetworkReactor>());
+
+		/// \brief Returns the listening socket
+		virtual const std::shared_ptr<TCPListen> &listen() const = 0;
+
+		/// \brief Accepts the next incoming connection
+		///
+		/// The accepted connection uses the same reactor as the listener.
+		virtual void async_accept(AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>> func) = 0;
+
+		/// \brief Stops listening. Pending accepts complete with an error on the reactor thread.
+		virtual void close() = 0;
+
+#if defined(__cpp_impl_coroutine)
+		/// \brief Coroutine version of async_accept
+		AsyncNetworkAwaitable<std::shared_ptr<AsyncTCPConnection>> async_accept()
+		{
+			return AsyncNetworkAwaitable<std::shared_ptr<AsyncTCPConnection>>([this](AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>> func) { async_accept(std::move(func)); });
+		}
+#endif
+	};
+}
@@ -17,6 +17,7 @@ namespace uicore
 		virtual SocketHandle *socket_handle() = 0;
 
 		friend class NetworkConditionVariable;
+		friend class RunLoopImpl;
 	};
 
 	/// \brief Condition variable that also awaken on network events
@@ -32,7 +33,7 @@ namespace uicore
 			lock.unlock();
 			try
 			{
-				bool result = wait_impl(count, events, timeout);
+				bool result = wait_impl(count, events, timeout, nullptr);
 				lock.lock();
 				return result;
 			}
@@ -43,11 +44,50 @@ namespace uicore
 			}
 		}
 
+		/// \brief Waits for event changes or until notify is called, and returns the events that changed
+		///
+		/// ready_events is cleared and then receives the events that have data to read, or that became writable after a write found them full.
+		/// Only those need to be serviced after the wait.
+		template<typename Lock>
+		bool wait(Lock &lock, int count, NetworkEvent **events, std::vector<NetworkEvent *> &ready_events, int timeout = -1)
+		{
+			ready_events.clear();
+			lock.unlock();
+			try
+			{
+				bool result = wait_impl(count, events, timeout, &ready_events);
+				lock.lock();
+				return result;
+			}
+			catch (...)
+			{
+				lock.lock();
+				throw;
+			}
+		}
+
+		/// \brief Waits for changes to the added events or until notify is called, and returns the events that changed
+		///
+		/// Unlike the wait taking an array of events, the cost of this wait does not grow with the number of idle events.
+		template<typename Lock>
+		bool wait(Lock &lock, std::vector<NetworkEvent *> &ready_events, int timeout = -1)
+		{
+			return wait(lock, 0, nullptr, ready_events, timeout);
+		}
+
+		/// \brief Adds an event that every wait includes until it is removed again
+		///
+		/// The event must be removed before it is destroyed.
+		void add(NetworkEvent *event);
+
+		/// \brief Removes an event added with add
+		void remove(NetworkEvent *event);
+
 		/// \brief Awakens any thread waiting for event changes
 		void notify();
 
 	private:
-		bool wait_impl(int count, NetworkEvent **events, int timeout);
+		bool wait_impl(int count, NetworkEvent **events, int timeout, std::vector<NetworkEvent *> *ready_events);
 
 		std::shared_ptr<NetworkConditionVariableImpl> impl;
 	};
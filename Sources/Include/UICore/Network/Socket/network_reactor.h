@@ -0,0 +1,54 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace uicore
+{
+	/// \brief Thread that waits for network events and completes asynchronous network operations
+	///
+	/// All completion callbacks of the asynchronous connections using a reactor are called on its thread.
+	class NetworkReactor
+	{
+	public:
+		/// \brief Constructs a reactor and starts its thread
+		static std::shared_ptr<NetworkReactor> create();
+
+		/// \brief Reactor used by the asynchronous network classes when none is specified
+		static const std::shared_ptr<NetworkReactor> &shared();
+
+		/// \brief Returns true if called from the reactor thread
+		virtual bool is_reactor_thread() const = 0;
+
+		/// \brief Executes a function on the reactor thread
+		virtual void post(std::function<void()> func) = 0;
+	};
+}
@@ -9,6 +9,43 @@ namespace uicore
 {
 	class SocketName;
 
+	/// \brief Preallocated storage for sending or reading several UDP datagrams with one call
+	class UDPDatagramBatch
+	{
+	public:
+		/// \brief Constructs a batch holding up to capacity datagrams of max_datagram_size bytes each
+		static std::shared_ptr<UDPDatagramBatch> create(int capacity, int max_datagram_size = 1472);
+
+		/// \brief Returns the maximum number of datagrams in the batch
+		virtual int capacity() const = 0;
+
+		/// \brief Returns the maximum size of each datagram
+		virtual int max_datagram_size() const = 0;
+
+		/// \brief Returns the number of datagrams in the batch
+		virtual int count() const = 0;
+
+		/// \brief Removes all datagrams from the batch
+		virtual void clear() = 0;
+
+		/// \brief Appends a datagram to be sent to the end point passed to UDPSocket::send
+		/// \return False if the batch is full or the datagram is larger than max_datagram_size
+		virtual bool add(const void *data, int size) = 0;
+
+		/// \brief Appends a datagram to be sent to the specified end point
+		/// \return False if the batch is full or the datagram is larger than max_datagram_size
+		virtual bool add(const void *data, int size, const SocketName &endpoint) = 0;
+
+		/// \brief Returns the data of a datagram
+		virtual const void *data(int index) const = 0;
+
+		/// \brief Returns the size of a datagram
+		virtual int size(int index) const = 0;
+
+		/// \brief Returns the end point a datagram was read from, or is sent to
+		virtual SocketName endpoint(int index) const = 0;
+	};
+
 	/// \brief UDP/IP socket class
 	class UDPSocket : public NetworkEvent
 	{
@@ -28,5 +65,21 @@ namespace uicore
 		/// \brief Read receved UDP packet
 		/// \return Bytes read or 0 if no packet was available
 		virtual int read(void *data, int size, SocketName &endpoint) = 0;
+
+		/// \brief Sends the datagrams of a batch to their end points, starting at the specified index
+		/// \return Number of datagrams sent. Fewer than requested if the send buffer is full.
+		virtual int send(const UDPDatagramBatch &batch, int start = 0) = 0;
+
+		/// \brief Sends the datagrams of a batch to one end point, starting at the specified index
+		///
+		/// Datagrams of equal size are handed to the kernel as one segmented buffer where UDP generic segmentation offload is available.
+		/// \return Number of datagrams sent. Fewer than requested if the send buffer is full.
+		virtual int send(const UDPDatagramBatch &batch, const SocketName &endpoint, int start = 0) = 0;
+
+		/// \brief Reads as many received UDP packets as fit into the batch
+		///
+		/// The batch is cleared first. Packets larger than max_datagram_size are truncated.
+		/// \return Number of packets read, or 0 if no packet was available
+		virtual int read(UDPDatagramBatch &batch) = 0;
 	};
 }
@@ -32,7 +32,9 @@
 #include "../../Core/Math/cl_math.h"
 #include "../../Core/Math/color.h"
 #include "style_get_value.h"
+#include "style_set_value.h"
 #include <memory>
+#include <vector>
 
 namespace uicore
 {
@@ -64,6 +66,40 @@ namespace uicore
 			set(string_format(properties, arg1, values...));
 		}
 
+		/// Set the declared value for a property
+		///
+		/// This function applies an already parsed value and is used by the code generated by the view compiler.
+		void set_value(const std::string &property_name, const StyleSetValue &value);
+
+		/// Set the declared values for an array property
+		void set_value_array(const std::string &property_name, const std::vector<StyleSetValue> &value_array);
+
+		/// Test if this is a shared immutable style
+		///
+		/// Shared styles throw an exception if an attempt is made to modify them.
+		bool is_shared() const;
+
+		/// Creates a modifiable copy of this style
+		std::shared_ptr<Style> clone() const;
+
+		/// Returns a shared immutable style for the specified properties
+		///
+		/// Identical property strings, and property strings resulting in identical declared values, return the same
+		/// style object. Use View::set_style to reference the style from many views without storing a copy per view.
+		static std::shared_ptr<Style> shared(const std::string &properties);
+
+		template <class Arg1, typename... Values>
+		static std::shared_ptr<Style> shared(const std::string &properties, Arg1 arg1, Values... values)
+		{
+			return shared(string_format(properties, arg1, values...));
+		}
+
+		/// Returns the shared immutable style with the same declared values as the specified style
+		static std::shared_ptr<Style> shared(const std::shared_ptr<Style> &style);
+
+		/// Number of shared styles currently alive
+		static size_t shared_count();
+
 		/// Retrieve the declared value for a property
 		StyleGetValue declared_value(const char *property_name) const;
 		StyleGetValue declared_value(const std::string &property_name) const { return declared_value(property_name.c_str()); }
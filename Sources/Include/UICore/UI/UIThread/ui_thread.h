@@ -29,6 +29,9 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <string>
+#include "../../Core/Signals/signal.h"
 
 namespace uicore
 {
@@ -45,7 +48,26 @@ namespace uicore
 		static std::string resource_path();
 		static void set_resource_path(const std::string &path);
 
-		static std::shared_ptr<Image> image(const std::shared_ptr<Canvas> &canvas, const std::string &name);
+		/// Returns an image from the resource path
+		///
+		/// The first request for an image decodes it on a worker thread and returns the placeholder image (or nullptr if no
+		/// placeholder is set) until the image has been uploaded on the UI thread. Pass wait as true to load synchronously.
+		/// If loading failed the exception is rethrown for a few seconds, after which the image is loaded again.
+		/// Views that got the placeholder while measuring or rendering themselves are laid out again when the image arrives.
+		static std::shared_ptr<Image> image(const std::shared_ptr<Canvas> &canvas, const std::string &name, bool wait = false);
+
+		/// Image returned while an image is still loading
+		static std::shared_ptr<Image> placeholder_image();
+		static void set_placeholder_image(const std::shared_ptr<Image> &image);
+
+		/// Maximum number of bytes of pixel data kept in the image cache
+		///
+		/// Least recently used images are removed from the cache when the budget is exceeded.
+		static size_t image_cache_budget();
+		static void set_image_cache_budget(size_t bytes);
+
+		/// Signal invoked on the UI thread after one or more images finished loading
+		static Signal<void()> &sig_images_loaded();
 		static std::shared_ptr<Font> font(const std::string &family, const FontDescription &desc);
 
 		static void set_exception_handler(const std::function<void(const std::exception_ptr &)> &exception_handler);
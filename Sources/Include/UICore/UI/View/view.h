@@ -73,7 +73,14 @@ namespace uicore
 		const StyleCascade &style_cascade() const;
 
 		/// Style properties for the specified state
+		///
+		/// If the state currently references a shared style, it is replaced with a modifiable copy first.
 		const std::shared_ptr<Style> &style(const std::string &state = std::string()) const;
+
+		/// Sets the style properties used for the specified state
+		///
+		/// Pass a style returned by Style::shared to reference the same immutable style from many views.
+		void set_style(const std::shared_ptr<Style> &style, const std::string &state = std::string());
 		
 		/// Test if a style state is currently set
 		bool state(const std::string &name) const;
@@ -223,6 +230,33 @@ namespace uicore
 		/// Specifies if content should be clipped during rendering
 		void set_content_clipped(bool clipped);
 
+		/// Layer caching flag
+		bool layer_cached() const;
+
+		/// Specifies if content and children should be rendered into a cached offscreen layer
+		///
+		/// The layer is only rendered again when the view or one of its descendants needs rendering, while changes to
+		/// the view transform or layer opacity reuse the cached layer. Layer contents are clipped to the content box.
+		/// If the layer cannot be allocated within the layer memory budget the view is rendered directly.
+		void set_layer_cached(bool enable = true);
+
+		/// Opacity used when compositing the cached layer
+		float layer_opacity() const;
+
+		/// Sets the opacity used when compositing the cached layer
+		///
+		/// The opacity is only applied while the view is rendered through its layer.
+		void set_layer_opacity(float opacity);
+
+		/// Maximum number of bytes allocated for cached layers
+		static size_t layer_memory_budget();
+
+		/// Sets the maximum number of bytes allocated for cached layers
+		static void set_layer_memory_budget(size_t bytes);
+
+		/// Number of bytes currently allocated for cached layers
+		static size_t layer_memory_usage();
+
 		/// Calculates the preferred margin box width using simplified layout rules
 		float preferred_margin_width(const std::shared_ptr<Canvas> &canvas);
 
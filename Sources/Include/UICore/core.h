@@ -39,6 +39,7 @@
 #include "Core/System/exception.h"
 #include "Core/System/service.h"
 #include "Core/System/system.h"
+#include "Core/System/work_queue.h"
 #include "Core/System/registry_key.h"
 #include "Core/ErrorReporting/crash_reporter.h"
 #include "Core/ErrorReporting/exception_dialog.h"
@@ -46,14 +47,20 @@
 #include "Core/IOData/endian.h"
 #include "Core/IOData/iodevice.h"
 #include "Core/IOData/memory_device.h"
+#include "Core/IOData/buffered_iodevice.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/path_help.h"
 #include "Core/IOData/directory.h"
 #include "Core/IOData/directory_scanner.h"
 #include "Core/Zip/zlib_compression.h"
+#include "Core/Zip/deflater.h"
+#include "Core/Zip/inflater.h"
+#include "Core/Zip/resource_pack.h"
+#include "Core/Zip/resource_pack_writer.h"
 #include "Core/Math/angle.h"
 #include "Core/Math/base64_encoder.h"
 #include "Core/Math/base64_decoder.h"
+#include "Core/Math/hex_encoder.h"
 #include "Core/Math/circle.h"
 #include "Core/Math/color.h"
 #include "Core/Math/color_hsv.h"
@@ -98,6 +105,7 @@
 #include "Core/Crypto/sha512.h"
 #include "Core/Crypto/sha512_224.h"
 #include "Core/Crypto/sha512_256.h"
+#include "Core/Crypto/xxhash64.h"
 #include "Core/Crypto/aes128_encrypt.h"
 #include "Core/Crypto/aes128_decrypt.h"
 #include "Core/Crypto/aes192_encrypt.h"
@@ -106,6 +114,7 @@
 #include "Core/Crypto/aes256_decrypt.h"
 #include "Core/Crypto/rsa.h"
 #include "Core/Crypto/tls_client.h"
+#include "Core/Crypto/tls_session_cache.h"
 #include "Core/Crypto/hash_functions.h"
 #include "Core/Json/json_value.h"
 #include "Core/Xml/xml_document.h"
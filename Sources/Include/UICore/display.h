@@ -53,11 +53,13 @@
 #include "Display/Image/perlin_noise.h"
 #include "Display/Image/image_import_description.h"
 #include "Display/Image/pixel_converter.h"
+#include "Display/Image/texture_compressor.h"
 #include "Display/ImageFormats/jpeg_format.h"
 #include "Display/ImageFormats/png_format.h"
 #include "Display/ImageFormats/image_file.h"
 #include "Display/ImageFormats/image_file_type.h"
 #include "Display/ImageFormats/image_file_type_register.h"
+#include "Display/ImageFormats/thumbnail_cache.h"
 #include "Display/ImageFormats/targa_format.h"
 #include "Display/ImageFormats/dds_format.h"
 #include "Display/Render/blend_state_description.h"
@@ -33,3 +33,6 @@
 #include "Network/Socket/tcp_connection.h"
 #include "Network/Socket/tcp_listen.h"
 #include "Network/Socket/udp_socket.h"
+#include "Network/Socket/network_reactor.h"
+#include "Network/Socket/async_tcp_connection.h"
+#include "Network/Socket/async_tcp_listen.h"
@@ -95,6 +95,20 @@ namespace uicore
 		while (pos < size)
 		{
 			int data_left = size - pos;
+			if (chunk_filled == 0 && data_left >= aes128_block_size_bytes && is_aesni_available())
+			{
+				// Encrypt the whole blocks directly from the input
+				int num_blocks = data_left / aes128_block_size_bytes;
+				uint32_t iv[4] = { initialisation_vector_1, initialisation_vector_2, initialisation_vector_3, initialisation_vector_4 };
+				encrypt_cbc_aesni(key_expanded, aes128_num_rounds_nr, iv, data + pos, append_blocks(databuffer, num_blocks), num_blocks);
+				initialisation_vector_1 = iv[0];
+				initialisation_vector_2 = iv[1];
+				initialisation_vector_3 = iv[2];
+				initialisation_vector_4 = iv[3];
+				pos += num_blocks * aes128_block_size_bytes;
+				continue;
+			}
+
 			int buffer_space = aes128_block_size_bytes - chunk_filled;
 			int data_used = min(buffer_space, data_left);
 			memcpy(chunk + chunk_filled, data + pos, data_used);
@@ -99,6 +99,6 @@ namespace uicore
 		bool padding_pkcs7;
 		unsigned int padding_num_additional_padded_blocks;
 
-		std::shared_ptr<DataBuffer> databuffer;
+		std::shared_ptr<DataBuffer> databuffer = DataBuffer::create(0);
 	};
 }
@@ -102,6 +102,6 @@ namespace uicore
 		bool padding_enabled;
 		bool padding_pkcs7;
 
-		std::shared_ptr<DataBuffer> databuffer;
+		std::shared_ptr<DataBuffer> databuffer = DataBuffer::create(0);
 	};
 }
@@ -0,0 +1,514 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "UICore/precomp.h"
+#include "aes_gcm.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/Math/cl_math.h"
+
+#ifndef WIN32
+#include <cstring>
+#endif
+
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_AES_GCM_AESNI
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_AESNI __attribute__((target("aes,pclmul,ssse3")))
+#else
+#define UICORE_TARGET_AESNI
+#endif
+#endif
+
+namespace uicore
+{
+	AES_GCM::AES_GCM()
+	{
+#ifdef UICORE_AES_GCM_AESNI
+		static bool cpu_has_aesni = System::detect_cpu_extension(System::aes) && System::detect_cpu_extension(System::pclmul) && System::detect_cpu_extension(System::ssse3);
+		use_aesni = cpu_has_aesni;
+#endif
+		memset(key_expanded, 0, sizeof(key_expanded));
+	}
+
+	AES_GCM::~AES_GCM()
+	{
+		// Remove the key from memory
+		memset(key_expanded, 0, sizeof(key_expanded));
+		memset(aesni_round_keys, 0, sizeof(aesni_round_keys));
+		memset(aesni_hash_powers, 0, sizeof(aesni_hash_powers));
+		memset(ghash_table_high, 0, sizeof(ghash_table_high));
+		memset(ghash_table_low, 0, sizeof(ghash_table_low));
+	}
+
+#ifdef UICORE_AES_GCM_AESNI
+	namespace
+	{
+		UICORE_TARGET_AESNI inline __m128i gcm_byte_swap(__m128i value)
+		{
+			return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+		}
+
+		// Carry-less 128x128 multiplication, accumulated into lo/hi/mid so several products can share one reduction
+		UICORE_TARGET_AESNI inline void gcm_clmul_accumulate(__m128i a, __m128i b, __m128i &lo, __m128i &hi, __m128i &mid)
+		{
+			lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));
+			hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));
+			mid = _mm_xor_si128(mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01)));
+		}
+
+		// Reduces a 256 bit product of byte reflected values modulo x^128 + x^7 + x^2 + x + 1
+		// (Gueron and Kounavis, "Intel Carry-Less Multiplication Instruction and its Usage for Computing the GCM Mode")
+		UICORE_TARGET_AESNI inline __m128i gcm_reduce(__m128i lo, __m128i hi, __m128i mid)
+		{
+			lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+			hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+			// The operands are bit reflected, so the product is shifted left by one bit
+			__m128i lo_carry = _mm_srli_epi32(lo, 31);
+			__m128i hi_carry = _mm_srli_epi32(hi, 31);
+			lo = _mm_slli_epi32(lo, 1);
+			hi = _mm_slli_epi32(hi, 1);
+			__m128i cross_carry = _mm_srli_si128(lo_carry, 12);
+			hi_carry = _mm_slli_si128(hi_carry, 4);
+			lo_carry = _mm_slli_si128(lo_carry, 4);
+			lo = _mm_or_si128(lo, lo_carry);
+			hi = _mm_or_si128(hi, hi_carry);
+			hi = _mm_or_si128(hi, cross_carry);
+
+			__m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+			__m128i b = _mm_srli_si128(a, 4);
+			a = _mm_slli_si128(a, 12);
+			lo = _mm_xor_si128(lo, a);
+
+			__m128i c = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+			c = _mm_xor_si128(c, b);
+			lo = _mm_xor_si128(lo, c);
+			return _mm_xor_si128(hi, lo);
+		}
+
+		UICORE_TARGET_AESNI inline __m128i gcm_multiply(__m128i a, __m128i b)
+		{
+			__m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128(), mid = _mm_setzero_si128();
+			gcm_clmul_accumulate(a, b, lo, hi, mid);
+			return gcm_reduce(lo, hi, mid);
+		}
+
+		UICORE_TARGET_AESNI inline __m128i aesni_encrypt(__m128i block, const __m128i *round_keys, int num_rounds)
+		{
+			block = _mm_xor_si128(block, round_keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				block = _mm_aesenc_si128(block, round_keys[round]);
+			return _mm_aesenclast_si128(block, round_keys[num_rounds]);
+		}
+
+		UICORE_TARGET_AESNI void aesni_setup(const unsigned char *round_key_bytes, int num_rounds, unsigned char *out_hash_powers)
+		{
+			__m128i round_keys[15];
+			for (int i = 0; i <= num_rounds; i++)
+				round_keys[i] = _mm_loadu_si128((const __m128i*)(round_key_bytes + i * 16));
+
+			__m128i h = gcm_byte_swap(aesni_encrypt(_mm_setzero_si128(), round_keys, num_rounds));
+			__m128i h2 = gcm_multiply(h, h);
+			__m128i h3 = gcm_multiply(h2, h);
+			__m128i h4 = gcm_multiply(h3, h);
+			_mm_store_si128((__m128i*)out_hash_powers, h);
+			_mm_store_si128((__m128i*)(out_hash_powers + 16), h2);
+			_mm_store_si128((__m128i*)(out_hash_powers + 32), h3);
+			_mm_store_si128((__m128i*)(out_hash_powers + 48), h4);
+		}
+
+		UICORE_TARGET_AESNI inline __m128i gcm_load_partial(const unsigned char *data, int size)
+		{
+			alignas(16) unsigned char block[16] = { 0 };
+			memcpy(block, data, size);
+			return _mm_load_si128((const __m128i*)block);
+		}
+	}
+#endif
+
+	void AES_GCM::set_key(const unsigned char *key, int key_size)
+	{
+		if (key_size == aes128_key_length_bytes)
+		{
+			num_rounds = aes128_num_rounds_nr;
+			extract_encrypt_key128(key, key_expanded);
+		}
+		else if (key_size == aes256_key_length_bytes)
+		{
+			num_rounds = aes256_num_rounds_nr;
+			extract_encrypt_key256(key, key_expanded);
+		}
+		else
+		{
+			throw Exception("AES-GCM key must be 16 or 32 bytes");
+		}
+
+#ifdef UICORE_AES_GCM_AESNI
+		if (use_aesni)
+		{
+			for (int i = 0; i < (num_rounds + 1) * 4; i++)
+				put_word(key_expanded[i], aesni_round_keys + i * 4);
+			aesni_setup(aesni_round_keys, num_rounds, aesni_hash_powers);
+			return;
+		}
+#endif
+
+		// Shoup's 4-bit tables: entry i holds i * H, with the bits of i in GCM's reflected order
+		unsigned char h[16] = { 0 };
+		encrypt_block(h, h);
+
+		uint64_t vh = 0, vl = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			vh = (vh << 8) | h[i];
+			vl = (vl << 8) | h[i + 8];
+		}
+
+		ghash_table_high[0] = 0;
+		ghash_table_low[0] = 0;
+		ghash_table_high[8] = vh;
+		ghash_table_low[8] = vl;
+		for (int i = 4; i > 0; i >>= 1)
+		{
+			uint64_t reduce = (vl & 1) ? 0xe100000000000000ULL : 0;
+			vl = (vh << 63) | (vl >> 1);
+			vh = (vh >> 1) ^ reduce;
+			ghash_table_high[i] = vh;
+			ghash_table_low[i] = vl;
+		}
+		for (int i = 2; i <= 8; i *= 2)
+		{
+			for (int j = 1; j < i; j++)
+			{
+				ghash_table_high[i + j] = ghash_table_high[i] ^ ghash_table_high[j];
+				ghash_table_low[i + j] = ghash_table_low[i] ^ ghash_table_low[j];
+			}
+		}
+	}
+
+	void AES_GCM::encrypt(const unsigned char iv[iv_size], const void *aad, int aad_size, void *data, int size, unsigned char out_tag[tag_size])
+	{
+		if (num_rounds == 0)
+			throw Exception("AES-GCM cipher key has not been set");
+
+#ifdef UICORE_AES_GCM_AESNI
+		if (use_aesni)
+		{
+			crypt_aesni(iv, aad, aad_size, (unsigned char *)data, size, false, out_tag);
+			return;
+		}
+#endif
+		crypt(iv, aad, aad_size, (unsigned char *)data, size, false, out_tag);
+	}
+
+	bool AES_GCM::decrypt(const unsigned char iv[iv_size], const void *aad, int aad_size, void *data, int size, const unsigned char tag[tag_size])
+	{
+		if (num_rounds == 0)
+			throw Exception("AES-GCM cipher key has not been set");
+
+		unsigned char calculated_tag[tag_size];
+#ifdef UICORE_AES_GCM_AESNI
+		if (use_aesni)
+			crypt_aesni(iv, aad, aad_size, (unsigned char *)data, size, true, calculated_tag);
+		else
+#endif
+			crypt(iv, aad, aad_size, (unsigned char *)data, size, true, calculated_tag);
+
+		// Constant time comparison
+		unsigned char difference = 0;
+		for (int i = 0; i < tag_size; i++)
+			difference |= calculated_tag[i] ^ tag[i];
+
+		if (difference != 0)
+		{
+			memset(data, 0, size);
+			return false;
+		}
+		return true;
+	}
+
+	void AES_GCM::crypt(const unsigned char iv[iv_size], const void *aad, int aad_size, unsigned char *data, int size, bool decrypting, unsigned char out_tag[tag_size])
+	{
+		unsigned char counter[16];
+		memcpy(counter, iv, iv_size);
+		counter[12] = 0;
+		counter[13] = 0;
+		counter[14] = 0;
+		counter[15] = 1;
+
+		unsigned char tag_mask[16];
+		encrypt_block(counter, tag_mask);
+
+		unsigned char x[16] = { 0 };
+		ghash_add(x, (const unsigned char *)aad, aad_size);
+
+		uint32_t counter_value = 1;
+		unsigned char keystream[16];
+		for (int pos = 0; pos < size; pos += 16)
+		{
+			int block_size = min(size - pos, 16);
+
+			counter_value++;
+			put_word(counter_value, counter + 12);
+			encrypt_block(counter, keystream);
+
+			if (decrypting)
+				ghash_add(x, data + pos, block_size);
+			for (int i = 0; i < block_size; i++)
+				data[pos + i] ^= keystream[i];
+			if (!decrypting)
+				ghash_add(x, data + pos, block_size);
+		}
+
+		unsigned char lengths[16];
+		put_word(0, lengths);
+		put_word(((uint32_t)aad_size) << 3, lengths + 4);
+		put_word(((uint32_t)aad_size) >> 29, lengths);
+		put_word(0, lengths + 8);
+		put_word(((uint32_t)size) << 3, lengths + 12);
+		put_word(((uint32_t)size) >> 29, lengths + 8);
+		ghash_add(x, lengths, 16);
+
+		for (int i = 0; i < 16; i++)
+			out_tag[i] = x[i] ^ tag_mask[i];
+
+		memset(keystream, 0, sizeof(keystream));
+	}
+
+	void AES_GCM::ghash_add(unsigned char x[16], const unsigned char *data, int size) const
+	{
+		while (size > 0)
+		{
+			int block_size = min(size, 16);
+			for (int i = 0; i < block_size; i++)
+				x[i] ^= data[i];
+			ghash_multiply(x);
+			data += block_size;
+			size -= block_size;
+		}
+	}
+
+	void AES_GCM::ghash_multiply(unsigned char x[16]) const
+	{
+		static const uint64_t last4[16] =
+		{
+			0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+			0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+		};
+
+		int index = x[15] & 0xf;
+		uint64_t zh = ghash_table_high[index];
+		uint64_t zl = ghash_table_low[index];
+
+		for (int i = 15; i >= 0; i--)
+		{
+			int low = x[i] & 0xf;
+			int high = x[i] >> 4;
+
+			if (i != 15)
+			{
+				int remainder = (int)(zl & 0xf);
+				zl = (zh << 60) | (zl >> 4);
+				zh = (zh >> 4) ^ (last4[remainder] << 48);
+				zh ^= ghash_table_high[low];
+				zl ^= ghash_table_low[low];
+			}
+
+			int remainder = (int)(zl & 0xf);
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ (last4[remainder] << 48);
+			zh ^= ghash_table_high[high];
+			zl ^= ghash_table_low[high];
+		}
+
+		put_word((uint32_t)(zh >> 32), x);
+		put_word((uint32_t)zh, x + 4);
+		put_word((uint32_t)(zl >> 32), x + 8);
+		put_word((uint32_t)zl, x + 12);
+	}
+
+	void AES_GCM::encrypt_block(const unsigned char in[16], unsigned char out[16]) const
+	{
+		const uint32_t *key_expanded_ptr = key_expanded;
+
+		uint32_t s0 = get_word(in) ^ key_expanded_ptr[0];
+		uint32_t s1 = get_word(in + 4) ^ key_expanded_ptr[1];
+		uint32_t s2 = get_word(in + 8) ^ key_expanded_ptr[2];
+		uint32_t s3 = get_word(in + 12) ^ key_expanded_ptr[3];
+
+		for (int round = 1; round < num_rounds; round++)
+		{
+			key_expanded_ptr += 4;
+			uint32_t t0 = table_e0[s0 >> 24] ^ table_e1[(s1 >> 16) & 0xff] ^ table_e2[(s2 >> 8) & 0xff] ^ table_e3[s3 & 0xff] ^ key_expanded_ptr[0];
+			uint32_t t1 = table_e0[s1 >> 24] ^ table_e1[(s2 >> 16) & 0xff] ^ table_e2[(s3 >> 8) & 0xff] ^ table_e3[s0 & 0xff] ^ key_expanded_ptr[1];
+			uint32_t t2 = table_e0[s2 >> 24] ^ table_e1[(s3 >> 16) & 0xff] ^ table_e2[(s0 >> 8) & 0xff] ^ table_e3[s1 & 0xff] ^ key_expanded_ptr[2];
+			uint32_t t3 = table_e0[s3 >> 24] ^ table_e1[(s0 >> 16) & 0xff] ^ table_e2[(s1 >> 8) & 0xff] ^ table_e3[s2 & 0xff] ^ key_expanded_ptr[3];
+			s0 = t0;
+			s1 = t1;
+			s2 = t2;
+			s3 = t3;
+		}
+
+		key_expanded_ptr += 4;
+
+		// Apply last round
+		uint32_t t0 = (sbox_substitution_values[(s0 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s1 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s2 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s3)& 0xff] & 0x000000ff) ^ key_expanded_ptr[0];
+		uint32_t t1 = (sbox_substitution_values[(s1 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s2 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s3 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s0)& 0xff] & 0x000000ff) ^ key_expanded_ptr[1];
+		uint32_t t2 = (sbox_substitution_values[(s2 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s3 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s0 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s1)& 0xff] & 0x000000ff) ^ key_expanded_ptr[2];
+		uint32_t t3 = (sbox_substitution_values[(s3 >> 24)] & 0xff000000) ^ (sbox_substitution_values[(s0 >> 16) & 0xff] & 0x00ff0000) ^ (sbox_substitution_values[(s1 >> 8) & 0xff] & 0x0000ff00) ^ (sbox_substitution_values[(s2)& 0xff] & 0x000000ff) ^ key_expanded_ptr[3];
+
+		put_word(t0, out);
+		put_word(t1, out + 4);
+		put_word(t2, out + 8);
+		put_word(t3, out + 12);
+	}
+
+#ifdef UICORE_AES_GCM_AESNI
+	UICORE_TARGET_AESNI void AES_GCM::crypt_aesni(const unsigned char iv[iv_size], const void *aad, int aad_size, unsigned char *data, int size, bool decrypting, unsigned char out_tag[tag_size])
+	{
+		__m128i round_keys[15];
+		for (int i = 0; i <= num_rounds; i++)
+			round_keys[i] = _mm_load_si128((const __m128i*)(aesni_round_keys + i * 16));
+
+		__m128i h1 = _mm_load_si128((const __m128i*)aesni_hash_powers);
+		__m128i h2 = _mm_load_si128((const __m128i*)(aesni_hash_powers + 16));
+		__m128i h3 = _mm_load_si128((const __m128i*)(aesni_hash_powers + 32));
+		__m128i h4 = _mm_load_si128((const __m128i*)(aesni_hash_powers + 48));
+
+		// The counter block is kept byte swapped so the 32 bit big endian counter can be incremented with _mm_add_epi32
+		alignas(16) unsigned char j0[16];
+		memcpy(j0, iv, iv_size);
+		j0[12] = 0;
+		j0[13] = 0;
+		j0[14] = 0;
+		j0[15] = 1;
+		__m128i counter = gcm_byte_swap(_mm_load_si128((const __m128i*)j0));
+		__m128i one = _mm_set_epi32(0, 0, 0, 1);
+
+		__m128i tag_mask = aesni_encrypt(gcm_byte_swap(counter), round_keys, num_rounds);
+
+		__m128i x = _mm_setzero_si128();
+
+		const unsigned char *aad_data = (const unsigned char *)aad;
+		for (int pos = 0; pos < aad_size; pos += 16)
+		{
+			int block_size = min(aad_size - pos, 16);
+			__m128i block = block_size == 16 ? _mm_loadu_si128((const __m128i*)(aad_data + pos)) : gcm_load_partial(aad_data + pos, block_size);
+			x = gcm_multiply(_mm_xor_si128(x, gcm_byte_swap(block)), h1);
+		}
+
+		int pos = 0;
+
+		// Four blocks at a time: the AES rounds of the blocks are interleaved and the four GHASH multiplications share one reduction
+		while (size - pos >= 64)
+		{
+			__m128i c0 = _mm_add_epi32(counter, one);
+			__m128i c1 = _mm_add_epi32(c0, one);
+			__m128i c2 = _mm_add_epi32(c1, one);
+			__m128i c3 = _mm_add_epi32(c2, one);
+			counter = c3;
+
+			__m128i b0 = _mm_xor_si128(gcm_byte_swap(c0), round_keys[0]);
+			__m128i b1 = _mm_xor_si128(gcm_byte_swap(c1), round_keys[0]);
+			__m128i b2 = _mm_xor_si128(gcm_byte_swap(c2), round_keys[0]);
+			__m128i b3 = _mm_xor_si128(gcm_byte_swap(c3), round_keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+			{
+				b0 = _mm_aesenc_si128(b0, round_keys[round]);
+				b1 = _mm_aesenc_si128(b1, round_keys[round]);
+				b2 = _mm_aesenc_si128(b2, round_keys[round]);
+				b3 = _mm_aesenc_si128(b3, round_keys[round]);
+			}
+			b0 = _mm_aesenclast_si128(b0, round_keys[num_rounds]);
+			b1 = _mm_aesenclast_si128(b1, round_keys[num_rounds]);
+			b2 = _mm_aesenclast_si128(b2, round_keys[num_rounds]);
+			b3 = _mm_aesenclast_si128(b3, round_keys[num_rounds]);
+
+			__m128i *block_ptr = (__m128i*)(data + pos);
+			__m128i in0 = _mm_loadu_si128(block_ptr);
+			__m128i in1 = _mm_loadu_si128(block_ptr + 1);
+			__m128i in2 = _mm_loadu_si128(block_ptr + 2);
+			__m128i in3 = _mm_loadu_si128(block_ptr + 3);
+			__m128i out0 = _mm_xor_si128(in0, b0);
+			__m128i out1 = _mm_xor_si128(in1, b1);
+			__m128i out2 = _mm_xor_si128(in2, b2);
+			__m128i out3 = _mm_xor_si128(in3, b3);
+			_mm_storeu_si128(block_ptr, out0);
+			_mm_storeu_si128(block_ptr + 1, out1);
+			_mm_storeu_si128(block_ptr + 2, out2);
+			_mm_storeu_si128(block_ptr + 3, out3);
+
+			__m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128(), mid = _mm_setzero_si128();
+			gcm_clmul_accumulate(_mm_xor_si128(x, gcm_byte_swap(decrypting ? in0 : out0)), h4, lo, hi, mid);
+			gcm_clmul_accumulate(gcm_byte_swap(decrypting ? in1 : out1), h3, lo, hi, mid);
+			gcm_clmul_accumulate(gcm_byte_swap(decrypting ? in2 : out2), h2, lo, hi, mid);
+			gcm_clmul_accumulate(gcm_byte_swap(decrypting ? in3 : out3), h1, lo, hi, mid);
+			x = gcm_reduce(lo, hi, mid);
+
+			pos += 64;
+		}
+
+		while (pos < size)
+		{
+			int block_size = min(size - pos, 16);
+
+			counter = _mm_add_epi32(counter, one);
+			__m128i keystream = aesni_encrypt(gcm_byte_swap(counter), round_keys, num_rounds);
+
+			__m128i in = block_size == 16 ? _mm_loadu_si128((const __m128i*)(data + pos)) : gcm_load_partial(data + pos, block_size);
+			__m128i out = _mm_xor_si128(in, keystream);
+			if (block_size == 16)
+			{
+				_mm_storeu_si128((__m128i*)(data + pos), out);
+			}
+			else
+			{
+				// Clear the keystream bytes past the end so the padded ciphertext block is hashed correctly
+				alignas(16) unsigned char block[16];
+				_mm_store_si128((__m128i*)block, out);
+				memcpy(data + pos, block, block_size);
+				memset(block + block_size, 0, 16 - block_size);
+				out = _mm_load_si128((const __m128i*)block);
+			}
+
+			x = gcm_multiply(_mm_xor_si128(x, gcm_byte_swap(decrypting ? in : out)), h1);
+			pos += block_size;
+		}
+
+		__m128i lengths = _mm_set_epi64x((long long)aad_size << 3, (long long)size << 3);
+		x = gcm_multiply(_mm_xor_si128(x, lengths), h1);
+
+		_mm_storeu_si128((__m128i*)out_tag, _mm_xor_si128(gcm_byte_swap(x), tag_mask));
+	}
+#endif
+}
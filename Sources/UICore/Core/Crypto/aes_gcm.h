@@ -0,0 +1,82 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include "UICore/Core/System/databuffer.h"
+#include "aes_impl.h"
+
+namespace uicore
+{
+	/// \brief AES in Galois/Counter Mode (NIST SP 800-38D) with 96 bit nonces
+	///
+	/// Uses AES-NI and PCLMULQDQ when the CPU supports them and falls back to the AES_Impl tables otherwise.
+	/// Data is encrypted and decrypted in place.
+	class AES_GCM : AES_Impl
+	{
+	public:
+		AES_GCM();
+		~AES_GCM();
+
+		static const int iv_size = 12;
+		static const int tag_size = 16;
+
+		/// \brief Sets a 16 (AES-128) or 32 (AES-256) byte key
+		void set_key(const unsigned char *key, int key_size);
+
+		/// \brief Encrypts data in place and writes the authentication tag
+		void encrypt(const unsigned char iv[iv_size], const void *aad, int aad_size, void *data, int size, unsigned char out_tag[tag_size]);
+
+		/// \brief Decrypts data in place
+		///
+		/// Returns false (and clears data) if the authentication tag does not match
+		bool decrypt(const unsigned char iv[iv_size], const void *aad, int aad_size, void *data, int size, const unsigned char tag[tag_size]);
+
+	private:
+		void crypt(const unsigned char iv[iv_size], const void *aad, int aad_size, unsigned char *data, int size, bool decrypting, unsigned char out_tag[tag_size]);
+		void crypt_aesni(const unsigned char iv[iv_size], const void *aad, int aad_size, unsigned char *data, int size, bool decrypting, unsigned char out_tag[tag_size]);
+
+		void encrypt_block(const unsigned char in[16], unsigned char out[16]) const;
+		void ghash_multiply(unsigned char x[16]) const;
+		void ghash_add(unsigned char x[16], const unsigned char *data, int size) const;
+
+		bool use_aesni = false;
+		int num_rounds = 0;
+		uint32_t key_expanded[aes256_nb_mult_nr_plus1];
+
+		// 4-bit multiplication tables for H (Shoup's method)
+		uint64_t ghash_table_high[16];
+		uint64_t ghash_table_low[16];
+
+		// AES-NI round keys followed by H, H^2, H^3 and H^4 in byte reflected order
+		alignas(16) unsigned char aesni_round_keys[15 * 16];
+		alignas(16) unsigned char aesni_hash_powers[4 * 16];
+	};
+}
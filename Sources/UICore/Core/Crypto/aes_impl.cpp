@@ -37,6 +37,19 @@
 #include <cstring>
 #endif
 
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_AES_AESNI
+#include "UICore/Core/System/system.h"
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_AESNI __attribute__((target("aes,sse2")))
+#else
+#define UICORE_TARGET_AESNI
+#endif
+#endif
+
 namespace uicore
 {
 	AES_Impl::AES_Impl()
@@ -161,25 +174,142 @@ namespace uicore
 	void AES_Impl::store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, std::shared_ptr<DataBuffer> &databuffer)
 	{
 		// (Note AES 128, 192 and 256 all have the same block size)
+		unsigned char *dest_ptr = append_blocks(databuffer, 1);
 
-		// Store the data
+		put_word(s0, dest_ptr);
+		put_word(s1, dest_ptr + 4);
+		put_word(s2, dest_ptr + 8);
+		put_word(s3, dest_ptr + 12);
+	}
+
+	unsigned char *AES_Impl::append_blocks(std::shared_ptr<DataBuffer> &databuffer, int num_blocks)
+	{
 		int current_size = databuffer->size();
+		int new_size = current_size + num_blocks * aes128_block_size_bytes;
 		int current_capacity = databuffer->capacity();
-		int available = current_capacity - current_size;
-		if (available < aes128_block_size_bytes)	// Increase capacity required
+		if (new_size > current_capacity)	// Increase capacity required
 		{
-			databuffer->set_capacity(current_capacity + 1024);	// Increase in blocks of 1K
+			// Grow geometrically, so that encrypting large buffers a block at a time does not copy the output over and over
+			databuffer->set_capacity(max(new_size, current_capacity + max(current_capacity, 1024)));
 		}
-		databuffer->set_size(current_size + aes128_block_size_bytes);
-		unsigned char *dest_ptr = (unsigned char *)databuffer->data();
-		dest_ptr += current_size;
+		databuffer->set_size(new_size);
+		return databuffer->data<unsigned char>() + current_size;
+	}
 
-		put_word(s0, dest_ptr);
-		put_word(s1, dest_ptr + 4);
-		put_word(s2, dest_ptr + 8);
-		put_word(s3, dest_ptr + 12);
+#ifdef UICORE_AES_AESNI
+	namespace
+	{
+		UICORE_TARGET_AESNI inline __m128i aesni_load_words(const uint32_t *words)
+		{
+			unsigned char bytes[16];
+			for (int i = 0; i < 4; i++)
+			{
+				bytes[i * 4] = (unsigned char)(words[i] >> 24);
+				bytes[i * 4 + 1] = (unsigned char)(words[i] >> 16);
+				bytes[i * 4 + 2] = (unsigned char)(words[i] >> 8);
+				bytes[i * 4 + 3] = (unsigned char)(words[i]);
+			}
+			return _mm_loadu_si128((const __m128i*)bytes);
+		}
+
+		UICORE_TARGET_AESNI inline void aesni_store_words(__m128i value, uint32_t *words)
+		{
+			unsigned char bytes[16];
+			_mm_storeu_si128((__m128i*)bytes, value);
+			for (int i = 0; i < 4; i++)
+				words[i] = (bytes[i * 4] << 24) | (bytes[i * 4 + 1] << 16) | (bytes[i * 4 + 2] << 8) | bytes[i * 4 + 3];
+		}
+	}
+
+	bool AES_Impl::is_aesni_available()
+	{
+		static bool cpu_has_aesni = System::detect_cpu_extension(System::aes);
+		return cpu_has_aesni;
 	}
 
+	UICORE_TARGET_AESNI void AES_Impl::encrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		__m128i round_keys[aes256_num_rounds_nr + 1];
+		for (int round = 0; round <= num_rounds; round++)
+			round_keys[round] = aesni_load_words(key_expanded + round * 4);
+
+		// Each block depends on the previous ciphertext, so encryption cannot be pipelined
+		__m128i state = aesni_load_words(iv);
+		for (int block = 0; block < num_blocks; block++)
+		{
+			state = _mm_xor_si128(state, _mm_loadu_si128((const __m128i*)(input + block * 16)));
+			state = _mm_xor_si128(state, round_keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				state = _mm_aesenc_si128(state, round_keys[round]);
+			state = _mm_aesenclast_si128(state, round_keys[num_rounds]);
+			_mm_storeu_si128((__m128i*)(output + block * 16), state);
+		}
+		aesni_store_words(state, iv);
+	}
+
+	UICORE_TARGET_AESNI void AES_Impl::decrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		// The equivalent inverse cipher key schedule is what aesdec expects
+		__m128i round_keys[aes256_num_rounds_nr + 1];
+		for (int round = 0; round <= num_rounds; round++)
+			round_keys[round] = aesni_load_words(key_expanded + round * 4);
+
+		__m128i previous = aesni_load_words(iv);
+
+		// The blocks are independent when decrypting, so 8 are kept in flight to hide the aesdec latency
+		const int pipeline_size = 8;
+		int block = 0;
+		for (; block + pipeline_size <= num_blocks; block += pipeline_size)
+		{
+			__m128i ciphertext[pipeline_size];
+			__m128i state[pipeline_size];
+			for (int i = 0; i < pipeline_size; i++)
+			{
+				ciphertext[i] = _mm_loadu_si128((const __m128i*)(input + (block + i) * 16));
+				state[i] = _mm_xor_si128(ciphertext[i], round_keys[0]);
+			}
+			for (int round = 1; round < num_rounds; round++)
+			{
+				for (int i = 0; i < pipeline_size; i++)
+					state[i] = _mm_aesdec_si128(state[i], round_keys[round]);
+			}
+			for (int i = 0; i < pipeline_size; i++)
+			{
+				state[i] = _mm_aesdeclast_si128(state[i], round_keys[num_rounds]);
+				_mm_storeu_si128((__m128i*)(output + (block + i) * 16), _mm_xor_si128(state[i], previous));
+				previous = ciphertext[i];
+			}
+		}
+
+		for (; block < num_blocks; block++)
+		{
+			__m128i ciphertext = _mm_loadu_si128((const __m128i*)(input + block * 16));
+			__m128i state = _mm_xor_si128(ciphertext, round_keys[0]);
+			for (int round = 1; round < num_rounds; round++)
+				state = _mm_aesdec_si128(state, round_keys[round]);
+			state = _mm_aesdeclast_si128(state, round_keys[num_rounds]);
+			_mm_storeu_si128((__m128i*)(output + block * 16), _mm_xor_si128(state, previous));
+			previous = ciphertext;
+		}
+		aesni_store_words(previous, iv);
+	}
+#else
+	bool AES_Impl::is_aesni_available()
+	{
+		return false;
+	}
+
+	void AES_Impl::encrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		throw Exception("AES-NI is not available");
+	}
+
+	void AES_Impl::decrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks)
+	{
+		throw Exception("AES-NI is not available");
+	}
+#endif
+
 	void AES_Impl::extract_decrypt_key(uint32_t *key_expanded, int num_rounds)
 	{
 		// Invert the order of the round keys
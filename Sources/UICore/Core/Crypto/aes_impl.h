@@ -77,6 +77,24 @@ namespace uicore
 		void extract_decrypt_key(uint32_t *key_expanded, int num_rounds);
 		void store_block(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3, std::shared_ptr<DataBuffer> &databuffer);
 
+		/// \brief Grows the databuffer by a number of blocks, returning a pointer to the first new block
+		unsigned char *append_blocks(std::shared_ptr<DataBuffer> &databuffer, int num_blocks);
+
+		/// \brief Returns true if the CPU supports the AES-NI instructions
+		static bool is_aesni_available();
+
+		/// \brief Cipher block chaining encryption of whole blocks using AES-NI
+		///
+		/// \param key_expanded = The encryption key schedule
+		/// \param iv = The initialisation vector as big endian words, updated to the last ciphertext block
+		static void encrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks);
+
+		/// \brief Cipher block chaining decryption of whole blocks using AES-NI
+		///
+		/// \param key_expanded = The decryption key schedule, from extract_decrypt_key()
+		/// \param iv = The initialisation vector as big endian words, updated to the last ciphertext block
+		static void decrypt_cbc_aesni(const uint32_t *key_expanded, int num_rounds, uint32_t iv[4], const unsigned char *input, unsigned char *output, int num_blocks);
+
 		inline uint32_t get_word(const unsigned char *data) const
 		{
 			return ((data[0] << 24) | (data[1] << 16) | (data[2] << 8) | (data[3]));
@@ -0,0 +1,472 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "UICore/precomp.h"
+#include "checksum_impl.h"
+#include <algorithm>
+#include <cstring>
+
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_CHECKSUM_SIMD
+#include "UICore/Core/System/system.h"
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define UICORE_TARGET_AVX2 __attribute__((target("avx2")))
+#define UICORE_TARGET_PCLMUL __attribute__((target("pclmul,sse2")))
+#define UICORE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define UICORE_TARGET_SSE42_PCLMUL __attribute__((target("sse4.2,pclmul")))
+#else
+#define UICORE_TARGET_SSSE3
+#define UICORE_TARGET_AVX2
+#define UICORE_TARGET_PCLMUL
+#define UICORE_TARGET_SSE42
+#define UICORE_TARGET_SSE42_PCLMUL
+#endif
+#endif
+
+namespace uicore
+{
+	namespace
+	{
+		const uint32_t crc32_polynomial = 0xedb88320;	// 0x04C11DB7 bit reversed
+		const uint32_t crc32c_polynomial = 0x82f63b78;	// 0x1EDC6F41 bit reversed
+
+		const uint32_t adler32_base = 65521;
+		const size_t adler32_nmax = 5552;	// Largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits
+
+		// Slice-by-8 lookup tables for the scalar CRC fallback
+		class CRCTables
+		{
+		public:
+			CRCTables(uint32_t polynomial)
+			{
+				for (uint32_t n = 0; n < 256; n++)
+				{
+					uint32_t c = n;
+					for (int k = 0; k < 8; k++)
+						c = (c & 1) ? polynomial ^ (c >> 1) : c >> 1;
+					table[0][n] = c;
+				}
+
+				for (uint32_t n = 0; n < 256; n++)
+				{
+					for (int i = 1; i < 8; i++)
+						table[i][n] = (table[i - 1][n] >> 8) ^ table[0][table[i - 1][n] & 0xff];
+				}
+			}
+
+			uint32_t table[8][256];
+		};
+
+		const CRCTables &crc32_tables()
+		{
+			static CRCTables tables(crc32_polynomial);
+			return tables;
+		}
+
+		const CRCTables &crc32c_tables()
+		{
+			static CRCTables tables(crc32c_polynomial);
+			return tables;
+		}
+
+		uint32_t crc_slice8(const CRCTables &tables, uint32_t crc, const unsigned char *data, size_t size)
+		{
+			const uint32_t (*t)[256] = tables.table;
+			while (size >= 8)
+			{
+				uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+				uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+				crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+					t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^ t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+				data += 8;
+				size -= 8;
+			}
+
+			while (size--)
+				crc = t[0][(crc ^ *(data++)) & 0xff] ^ (crc >> 8);
+			return crc;
+		}
+
+		uint32_t adler32_scalar(uint32_t adler, const unsigned char *data, size_t size)
+		{
+			uint32_t s1 = adler & 0xffff;
+			uint32_t s2 = adler >> 16;
+			while (size > 0)
+			{
+				size_t n = std::min(size, adler32_nmax);
+				size -= n;
+				for (; n >= 8; n -= 8, data += 8)
+				{
+					s1 += data[0]; s2 += s1;
+					s1 += data[1]; s2 += s1;
+					s1 += data[2]; s2 += s1;
+					s1 += data[3]; s2 += s1;
+					s1 += data[4]; s2 += s1;
+					s1 += data[5]; s2 += s1;
+					s1 += data[6]; s2 += s1;
+					s1 += data[7]; s2 += s1;
+				}
+				for (; n > 0; n--)
+				{
+					s1 += *(data++);
+					s2 += s1;
+				}
+				s1 %= adler32_base;
+				s2 %= adler32_base;
+			}
+			return s1 | (s2 << 16);
+		}
+
+#ifdef UICORE_CHECKSUM_SIMD
+		// Multiplies two bit reflected polynomials modulo the CRC polynomial
+		uint32_t multiply_mod(uint32_t a, uint32_t b, uint32_t polynomial)
+		{
+			uint32_t product = 0;
+			for (uint32_t m = 0x80000000; m != 0; m >>= 1)
+			{
+				if (a & m)
+					product ^= b;
+				b = (b & 1) ? (b >> 1) ^ polynomial : b >> 1;
+			}
+			return product;
+		}
+
+		// Returns x^n modulo the CRC polynomial, bit reflected
+		uint32_t x_pow_mod(uint32_t n, uint32_t polynomial)
+		{
+			uint32_t result = 0x80000000;
+			uint32_t square = 0x40000000;
+			while (n)
+			{
+				if (n & 1)
+					result = multiply_mod(result, square, polynomial);
+				square = multiply_mod(square, square, polynomial);
+				n >>= 1;
+			}
+			return result;
+		}
+
+		bool cpu_has_pclmul()
+		{
+			static bool has_pclmul = System::detect_cpu_extension(System::pclmul);
+			return has_pclmul;
+		}
+
+		bool cpu_has_sse42()
+		{
+			static bool has_sse42 = System::detect_cpu_extension(System::sse4_2);
+			return has_sse42;
+		}
+
+		bool cpu_has_ssse3()
+		{
+			static bool has_ssse3 = System::detect_cpu_extension(System::ssse3);
+			return has_ssse3;
+		}
+
+		bool cpu_has_avx2()
+		{
+			static bool has_avx2 = System::detect_cpu_extension(System::avx2);
+			return has_avx2;
+		}
+
+		// CRC-32 by folding 64 bytes at a time with carry-less multiplication, followed by a Barrett reduction.
+		// See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009).
+		// Size must be at least 64 and a multiple of 16.
+		UICORE_TARGET_PCLMUL uint32_t crc32_pclmul(uint32_t crc, const unsigned char *data, size_t size)
+		{
+			const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);	// x^(4*128+32), x^(4*128-32)
+			const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);	// x^(128+32), x^(128-32)
+			const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);				// x^64
+			const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);	// Barrett constant and P(x)
+			const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+			__m128i x1 = _mm_loadu_si128((const __m128i*)(data + 0x00));
+			__m128i x2 = _mm_loadu_si128((const __m128i*)(data + 0x10));
+			__m128i x3 = _mm_loadu_si128((const __m128i*)(data + 0x20));
+			__m128i x4 = _mm_loadu_si128((const __m128i*)(data + 0x30));
+			x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+			data += 64;
+			size -= 64;
+
+			while (size >= 64)
+			{
+				__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+				__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+				__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+				__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+				x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+				x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+				x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+				x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(data + 0x00)));
+				x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(data + 0x10)));
+				x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(data + 0x20)));
+				x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(data + 0x30)));
+				data += 64;
+				size -= 64;
+			}
+
+			// Fold the four lanes into one
+			__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+			x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+			while (size >= 16)
+			{
+				x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+				x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+				x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)data)), x5);
+				data += 16;
+				size -= 16;
+			}
+
+			// Fold 128 bits to 64 bits
+			x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+			x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+			x2 = _mm_srli_si128(x1, 4);
+			x1 = _mm_and_si128(x1, mask32);
+			x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+
+			// Barrett reduction to 32 bits
+			x2 = _mm_and_si128(x1, mask32);
+			x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+			x2 = _mm_and_si128(x2, mask32);
+			x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+			x1 = _mm_xor_si128(x1, x2);
+			return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+		}
+
+		UICORE_TARGET_SSE42 inline uint32_t crc32c_u64(uint32_t crc, uint64_t value)
+		{
+#if defined(_M_X64) || defined(__x86_64__)
+			return (uint32_t)_mm_crc32_u64(crc, value);
+#else
+			crc = _mm_crc32_u32(crc, (uint32_t)value);
+			return _mm_crc32_u32(crc, (uint32_t)(value >> 32));
+#endif
+		}
+
+		inline uint64_t load_u64(const unsigned char *data)
+		{
+			uint64_t value;
+			memcpy(&value, data, 8);
+			return value;
+		}
+
+		UICORE_TARGET_SSE42 uint32_t crc32c_sse42(uint32_t crc, const unsigned char *data, size_t size)
+		{
+			for (; size >= 8; size -= 8, data += 8)
+				crc = crc32c_u64(crc, load_u64(data));
+			for (; size > 0; size--)
+				crc = _mm_crc32_u8(crc, *(data++));
+			return crc;
+		}
+
+		// Multiplies a CRC-32C register by the bit reflected polynomial shift modulo P. The carry-less product of two
+		// reflected 32 bit values is A*B*x, and the crc32 instruction multiplies it by x^32 while reducing it.
+		UICORE_TARGET_SSE42_PCLMUL inline uint32_t crc32c_shift(uint32_t crc, uint32_t shift)
+		{
+			__m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)crc), _mm_cvtsi32_si128((int)shift), 0x00);
+			uint64_t low = (uint32_t)_mm_cvtsi128_si32(product);
+			uint64_t high = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(product, 4));
+			return crc32c_u64(0, low | (high << 32));
+		}
+
+		// The crc32 instruction has a latency of three cycles but a throughput of one per cycle. Three independent
+		// CRCs are calculated over adjacent blocks and combined afterwards: crc(A|B) = crc(A) * x^(8*|B|) + crc(B).
+		template<int block_size>
+		UICORE_TARGET_SSE42_PCLMUL uint32_t crc32c_sse42_3way(uint32_t crc, const unsigned char *&data, size_t &size)
+		{
+			static const uint32_t shift = x_pow_mod(block_size * 8 - 33, crc32c_polynomial);
+
+			while (size >= 3 * block_size)
+			{
+				uint32_t crc0 = crc;
+				uint32_t crc1 = 0;
+				uint32_t crc2 = 0;
+				for (int i = 0; i < block_size; i += 8)
+				{
+					crc0 = crc32c_u64(crc0, load_u64(data + i));
+					crc1 = crc32c_u64(crc1, load_u64(data + block_size + i));
+					crc2 = crc32c_u64(crc2, load_u64(data + 2 * block_size + i));
+				}
+				crc = crc32c_shift(crc32c_shift(crc0, shift) ^ crc1, shift) ^ crc2;
+
+				data += 3 * block_size;
+				size -= 3 * block_size;
+			}
+			return crc;
+		}
+
+		// Adler-32 on 32 byte blocks. s1 is the byte sum (psadbw) and s2 the position weighted sum (pmaddubsw with
+		// weights 32..1) plus 32 times the s1 of all previous blocks.
+		UICORE_TARGET_SSSE3 uint32_t adler32_ssse3(uint32_t adler, const unsigned char *data, size_t num_blocks)
+		{
+			uint32_t s1 = adler & 0xffff;
+			uint32_t s2 = adler >> 16;
+
+			const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+			const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i ones = _mm_set1_epi16(1);
+
+			while (num_blocks > 0)
+			{
+				size_t n = std::min(num_blocks, adler32_nmax / 32);
+				num_blocks -= n;
+
+				__m128i v_ps = _mm_cvtsi32_si128((int)(s1 * n));
+				__m128i v_s1 = zero;
+				__m128i v_s2 = _mm_cvtsi32_si128((int)s2);
+				for (size_t i = 0; i < n; i++)
+				{
+					__m128i bytes1 = _mm_loadu_si128((const __m128i*)data);
+					__m128i bytes2 = _mm_loadu_si128((const __m128i*)(data + 16));
+					v_ps = _mm_add_epi32(v_ps, v_s1);
+					v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+					v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+					v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+					v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+					data += 32;
+				}
+				v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+				v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+				v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+				v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+				s1 = (s1 + (uint32_t)_mm_cvtsi128_si32(v_s1)) % adler32_base;
+				s2 = (uint32_t)_mm_cvtsi128_si32(v_s2) % adler32_base;
+			}
+			return s1 | (s2 << 16);
+		}
+
+		UICORE_TARGET_AVX2 uint32_t adler32_avx2(uint32_t adler, const unsigned char *data, size_t num_blocks)
+		{
+			uint32_t s1 = adler & 0xffff;
+			uint32_t s2 = adler >> 16;
+
+			const __m256i taps = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i ones = _mm256_set1_epi16(1);
+
+			while (num_blocks > 0)
+			{
+				size_t n = std::min(num_blocks, adler32_nmax / 32);
+				num_blocks -= n;
+
+				__m256i v_ps = _mm256_setr_epi32((int)(s1 * n), 0, 0, 0, 0, 0, 0, 0);
+				__m256i v_s1 = zero;
+				__m256i v_s2 = _mm256_setr_epi32((int)s2, 0, 0, 0, 0, 0, 0, 0);
+				for (size_t i = 0; i < n; i++)
+				{
+					__m256i bytes = _mm256_loadu_si256((const __m256i*)data);
+					v_ps = _mm256_add_epi32(v_ps, v_s1);
+					v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+					v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, taps), ones));
+					data += 32;
+				}
+				v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+
+				__m128i sum1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1), _mm256_extracti128_si256(v_s1, 1));
+				__m128i sum2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2), _mm256_extracti128_si256(v_s2, 1));
+				sum1 = _mm_add_epi32(sum1, _mm_shuffle_epi32(sum1, _MM_SHUFFLE(1, 0, 3, 2)));
+				sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, _MM_SHUFFLE(2, 3, 0, 1)));
+				sum2 = _mm_add_epi32(sum2, _mm_shuffle_epi32(sum2, _MM_SHUFFLE(1, 0, 3, 2)));
+				s1 = (s1 + (uint32_t)_mm_cvtsi128_si32(sum1)) % adler32_base;
+				s2 = (uint32_t)_mm_cvtsi128_si32(sum2) % adler32_base;
+			}
+			return s1 | (s2 << 16);
+		}
+#endif
+	}
+
+	uint32_t Checksum_Impl::crc32(uint32_t crc, const unsigned char *data, size_t size)
+	{
+#ifdef UICORE_CHECKSUM_SIMD
+		if (size >= 64 && cpu_has_pclmul())
+		{
+			size_t simd_size = size & ~(size_t)15;
+			crc = crc32_pclmul(crc, data, simd_size);
+			data += simd_size;
+			size -= simd_size;
+		}
+#endif
+		return crc_slice8(crc32_tables(), crc, data, size);
+	}
+
+	uint32_t Checksum_Impl::crc32c(uint32_t crc, const unsigned char *data, size_t size)
+	{
+#ifdef UICORE_CHECKSUM_SIMD
+		if (cpu_has_sse42())
+		{
+			if (cpu_has_pclmul())
+			{
+				crc = crc32c_sse42_3way<2048>(crc, data, size);
+				crc = crc32c_sse42_3way<256>(crc, data, size);
+			}
+			return crc32c_sse42(crc, data, size);
+		}
+#endif
+		return crc_slice8(crc32c_tables(), crc, data, size);
+	}
+
+	uint32_t Checksum_Impl::adler32(uint32_t adler, const unsigned char *data, size_t size)
+	{
+#ifdef UICORE_CHECKSUM_SIMD
+		if (size >= 64)
+		{
+			size_t num_blocks = size / 32;
+			if (cpu_has_avx2())
+				adler = adler32_avx2(adler, data, num_blocks);
+			else if (cpu_has_ssse3())
+				adler = adler32_ssse3(adler, data, num_blocks);
+			else
+				num_blocks = 0;
+			data += num_blocks * 32;
+			size -= num_blocks * 32;
+		}
+#endif
+		return adler32_scalar(adler, data, size);
+	}
+}
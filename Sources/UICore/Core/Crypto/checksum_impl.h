@@ -0,0 +1,52 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace uicore
+{
+	/// \brief CRC-32, CRC-32C and Adler-32 kernels used by HashFunctions
+	///
+	/// The CRC functions update the register directly, so callers invert it before and after like zlib does.
+	class Checksum_Impl
+	{
+	public:
+		/// \brief Updates a CRC-32 register (zlib, PNG and zip polynomial 0x04C11DB7)
+		static uint32_t crc32(uint32_t crc, const unsigned char *data, size_t size);
+
+		/// \brief Updates a CRC-32C register (Castagnoli polynomial 0x1EDC6F41, as used by iSCSI, SCTP and ext4)
+		static uint32_t crc32c(uint32_t crc, const unsigned char *data, size_t size);
+
+		/// \brief Updates an Adler-32 checksum
+		static uint32_t adler32(uint32_t adler, const unsigned char *data, size_t size);
+	};
+}
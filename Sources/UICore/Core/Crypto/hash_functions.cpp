@@ -29,26 +29,33 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/Crypto/hash_functions.h"
 #include "UICore/Core/System/databuffer.h"
-#include "UICore/Core/Zip/miniz.h"
+#include "checksum_impl.h"
+#include "xxhash64_impl.h"
 
 namespace uicore
 {
 	uint32_t HashFunctions::crc32(const void *data, int size, uint32_t running_crc/*=0*/)
 	{
-		uint32_t crc = running_crc;
-		if (crc == 0)
-			crc = mz_crc32(0L, nullptr, 0);
+		return ~Checksum_Impl::crc32(~running_crc, (const unsigned char*)data, size);
+	}
 
-		return mz_crc32(running_crc, (const unsigned char*)data, size);;
+	uint32_t HashFunctions::crc32c(const void *data, int size, uint32_t running_crc/*=0*/)
+	{
+		return ~Checksum_Impl::crc32c(~running_crc, (const unsigned char*)data, size);
 	}
 
 	uint32_t HashFunctions::adler32(const void *data, int size, uint32_t running_adler32/*=0*/)
 	{
 		uint32_t adler = running_adler32;
 		if (adler == 0)
-			adler = mz_adler32(0L, nullptr, 0);
+			adler = 1;
 
-		return mz_adler32(adler, (const unsigned char*)data, size);
+		return Checksum_Impl::adler32(adler, (const unsigned char*)data, size);
+	}
+
+	uint64_t HashFunctions::xxhash64(const void *data, int size, uint64_t seed/*=0*/)
+	{
+		return XXHash64_Impl::calculate(data, size, seed);
 	}
 
 	std::string HashFunctions::md5(const void *data, int size, bool uppercase)
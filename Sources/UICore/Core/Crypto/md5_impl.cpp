@@ -30,6 +30,7 @@
 #include "md5_impl.h"
 #include "UICore/Core/Math/cl_math.h"
 #include "UICore/Core/Crypto/md5.h"
+#include "UICore/Core/Math/hex_encoder.h"
 #ifndef WIN32
 #include <cstring>
 #endif
@@ -43,17 +44,9 @@ namespace uicore
 
 	std::string MD5_Impl::hash(bool uppercase) const
 	{
-		if (calculated == false)
-			throw Exception("MD5 hash has not been calculated yet!");
-
-		char digest[33];
-		to_hex_le(digest, h0, uppercase);
-		to_hex_le(digest + 8, h1, uppercase);
-		to_hex_le(digest + 16, h2, uppercase);
-		to_hex_le(digest + 24, h3, uppercase);
-		digest[32] = 0;
-
-		return digest;
+		unsigned char digest[hash_size];
+		hash(digest);
+		return HexEncoder::encode(digest, hash_size, uppercase);
 	}
 
 	void MD5_Impl::hash(unsigned char out_hash[16]) const
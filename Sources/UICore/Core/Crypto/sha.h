@@ -106,9 +106,5 @@ namespace uicore
 		{
 			return (value >> shift) | (value << (64 - shift));
 		}
-
-		void to_hex_be(char *buffer, uint32_t value, bool uppercase) const;
-		void to_hex_le(char *buffer, uint32_t value, bool uppercase) const;
-		void to_hex64_be(char *buffer, uint64_t value, bool uppercase) const;
 	};
 }
@@ -30,11 +30,27 @@
 #include "sha1_impl.h"
 #include "UICore/Core/Math/cl_math.h"
 #include "UICore/Core/Crypto/sha1.h"
+#include "UICore/Core/Math/hex_encoder.h"
 
 #ifndef WIN32
 #include <cstring>
 #endif
 
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_SHA1_SHANI
+#include "UICore/Core/System/system.h"
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define UICORE_TARGET_SHANI
+#endif
+#endif
+
 namespace uicore
 {
 	SHA1_Impl::SHA1_Impl()
@@ -44,17 +60,9 @@ namespace uicore
 
 	std::string SHA1_Impl::hash(bool uppercase) const
 	{
-		if (calculated == false)
-			throw Exception("SHA-1 hash has not been calculated yet!");
-
-		char digest[41];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
-		digest[40] = 0;
-		return digest;
+		unsigned char digest[hash_size];
+		hash(digest);
+		return HexEncoder::encode(digest, hash_size, uppercase);
 	}
 
 	void SHA1_Impl::hash(unsigned char out_hash[20]) const
@@ -110,6 +118,15 @@ namespace uicore
 		while (pos < size)
 		{
 			int data_left = size - pos;
+			if (chunk_filled == 0 && data_left >= block_size)
+			{
+				// Hash the whole blocks directly from the input
+				int num_blocks = data_left / block_size;
+				process_blocks(data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
 			memcpy(chunk + chunk_filled, data + pos, data_used);
@@ -117,7 +134,7 @@ namespace uicore
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(chunk, 1);
 				chunk_filled = 0;
 			}
 		}
@@ -207,65 +224,146 @@ namespace uicore
 		}
 	}
 
-	void SHA1_Impl::process_chunk()
+	void SHA1_Impl::process_blocks(const unsigned char *data, int num_blocks)
 	{
-		int i;
-		unsigned int w[80];
-
-		for (i = 0; i < 16; i++)
+#ifdef UICORE_SHA1_SHANI
+		static bool cpu_has_sha = System::detect_cpu_extension(System::sha) && System::detect_cpu_extension(System::sse4_1);
+		if (cpu_has_sha)
 		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
-			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
+			process_blocks_shani(data, num_blocks);
+			return;
 		}
+#endif
 
-		for (i = 16; i < 80; i++)
-			w[i] = leftrotate_uint32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
-
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
-
-		for (i = 0; i < 80; i++)
+		for (int block = 0; block < num_blocks; block++, data += block_size)
 		{
-			uint32_t f, k;
-			if (i < 20)
-			{
-				f = (b & c) | ((~b) & d);
-				k = 0x5A827999;
-			}
-			else if (i < 40)
+			int i;
+			unsigned int w[80];
+
+			for (i = 0; i < 16; i++)
 			{
-				f = b ^ c ^ d;
-				k = 0x6ED9EBA1;
+				unsigned int b1 = data[i * 4];
+				unsigned int b2 = data[i * 4 + 1];
+				unsigned int b3 = data[i * 4 + 2];
+				unsigned int b4 = data[i * 4 + 3];
+				w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
 			}
-			else if (i < 60)
+
+			for (i = 16; i < 80; i++)
+				w[i] = leftrotate_uint32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+			uint32_t a = h0;
+			uint32_t b = h1;
+			uint32_t c = h2;
+			uint32_t d = h3;
+			uint32_t e = h4;
+
+			for (i = 0; i < 80; i++)
 			{
-				f = (b & c) | (b & d) | (c & d);
-				k = 0x8F1BBCDC;
+				uint32_t f, k;
+				if (i < 20)
+				{
+					f = (b & c) | ((~b) & d);
+					k = 0x5A827999;
+				}
+				else if (i < 40)
+				{
+					f = b ^ c ^ d;
+					k = 0x6ED9EBA1;
+				}
+				else if (i < 60)
+				{
+					f = (b & c) | (b & d) | (c & d);
+					k = 0x8F1BBCDC;
+				}
+				else
+				{
+					f = b ^ c ^ d;
+					k = 0xCA62C1D6;
+				}
+
+				uint32_t temp = leftrotate_uint32(a, 5) + f + e + k + w[i];
+				e = d;
+				d = c;
+				c = leftrotate_uint32(b, 30);
+				b = a;
+				a = temp;
 			}
-			else
+
+			h0 += a;
+			h1 += b;
+			h2 += c;
+			h3 += d;
+			h4 += e;
+		}
+	}
+
+#ifdef UICORE_SHA1_SHANI
+	namespace
+	{
+		// Rounds 20 * Function to 20 * Function + 19. sha1rnds4 needs the round function as an immediate value
+		template<int Function>
+		UICORE_TARGET_SHANI inline void sha1_shani_rounds(__m128i &abcd, __m128i &previous_abcd, __m128i message[4])
+		{
+			for (int group = Function * 5; group < Function * 5 + 5; group++)
 			{
-				f = b ^ c ^ d;
-				k = 0xCA62C1D6;
+				__m128i e;
+				if (group == 0)
+					e = _mm_add_epi32(previous_abcd, message[0]);	// Holds E at the start of the block
+				else
+					e = _mm_sha1nexte_epu32(previous_abcd, message[group % 4]);
+				previous_abcd = abcd;
+				abcd = _mm_sha1rnds4_epu32(abcd, e, Function);
+
+				// Extend the message schedule for the groups that follow
+				if (group >= 1 && group <= 16)
+					message[(group + 3) % 4] = _mm_sha1msg1_epu32(message[(group + 3) % 4], message[group % 4]);
+				if (group >= 2 && group <= 17)
+					message[(group + 2) % 4] = _mm_xor_si128(message[(group + 2) % 4], message[group % 4]);
+				if (group >= 3 && group <= 18)
+					message[(group + 1) % 4] = _mm_sha1msg2_epu32(message[(group + 1) % 4], message[group % 4]);
 			}
+		}
+	}
+
+	UICORE_TARGET_SHANI void SHA1_Impl::process_blocks_shani(const unsigned char *data, int num_blocks)
+	{
+		const __m128i byte_swap_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+		__m128i abcd = _mm_set_epi32(h0, h1, h2, h3);
+		__m128i e = _mm_set_epi32(h4, 0, 0, 0);
+
+		for (int block = 0; block < num_blocks; block++, data += block_size)
+		{
+			__m128i saved_abcd = abcd;
+			__m128i saved_e = e;
+
+			__m128i message[4];
+			for (int i = 0; i < 4; i++)
+				message[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i * 16)), byte_swap_mask);
 
-			uint32_t temp = leftrotate_uint32(a, 5) + f + e + k + w[i];
-			e = d;
-			d = c;
-			c = leftrotate_uint32(b, 30);
-			b = a;
-			a = temp;
+			__m128i previous_abcd = e;
+			sha1_shani_rounds<0>(abcd, previous_abcd, message);
+			sha1_shani_rounds<1>(abcd, previous_abcd, message);
+			sha1_shani_rounds<2>(abcd, previous_abcd, message);
+			sha1_shani_rounds<3>(abcd, previous_abcd, message);
+
+			e = _mm_sha1nexte_epu32(previous_abcd, saved_e);
+			abcd = _mm_add_epi32(abcd, saved_abcd);
 		}
 
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
+		uint32_t state[4];
+		_mm_storeu_si128((__m128i*)state, abcd);
+		h0 = state[3];
+		h1 = state[2];
+		h2 = state[1];
+		h3 = state[0];
+		h4 = (uint32_t)_mm_extract_epi32(e, 3);
+	}
+#else
+	void SHA1_Impl::process_blocks_shani(const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA extensions are not available");
 	}
+#endif
 }
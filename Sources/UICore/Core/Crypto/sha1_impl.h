@@ -50,7 +50,8 @@ namespace uicore
 		void calculate() override;
 
 	private:
-		void process_chunk();
+		void process_blocks(const unsigned char *data, int num_blocks);
+		void process_blocks_shani(const unsigned char *data, int num_blocks);
 
 		inline unsigned int leftrotate_uint32(unsigned int value, int shift) const
 		{
@@ -31,13 +31,49 @@
 #include "UICore/Core/Math/cl_math.h"
 #include "UICore/Core/Crypto/sha224.h"
 #include "UICore/Core/Crypto/sha256.h"
+#include "UICore/Core/Math/hex_encoder.h"
 
 #ifndef WIN32
 #include <cstring>
 #endif
 
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_SHA256_SHANI
+#include "UICore/Core/System/system.h"
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <smmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+#else
+#define UICORE_TARGET_SHANI
+#endif
+#endif
+
 namespace uicore
 {
+	namespace
+	{
+		// Constants defined in FIPS 180-3, section 4.2.2
+		const uint32_t constant_K[64] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+			0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+			0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+			0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+			0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+			0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+			0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+			0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+			0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+		};
+	}
+
 	SHA256_Impl::SHA256_Impl(cl_sha_type new_sha_type) : sha_type(new_sha_type)
 	{
 		reset();
@@ -45,29 +81,9 @@ namespace uicore
 
 	std::string SHA256_Impl::hash(bool uppercase) const
 	{
-		if (calculated == false)
-			throw Exception("SHA-256 hash has not been calculated yet!");
-
-		char digest[32 * 2 + 1];
-		to_hex_be(digest, h0, uppercase);
-		to_hex_be(digest + 8, h1, uppercase);
-		to_hex_be(digest + 16, h2, uppercase);
-		to_hex_be(digest + 24, h3, uppercase);
-		to_hex_be(digest + 32, h4, uppercase);
-		to_hex_be(digest + 40, h5, uppercase);
-		to_hex_be(digest + 48, h6, uppercase);
-
-		if (sha_type == cl_sha_224)
-		{
-			digest[56] = 0;
-		}
-		else
-		{
-			// Must be cl_sha_256
-			to_hex_be(digest + 56, h7, uppercase);
-			digest[64] = 0;
-		}
-		return digest;
+		unsigned char digest[32];
+		hash(digest);
+		return HexEncoder::encode(digest, sha_type == cl_sha_224 ? 28 : 32, uppercase);
 	}
 
 	void SHA256_Impl::hash(unsigned char *out_hash) const
@@ -160,6 +176,15 @@ namespace uicore
 		while (pos < size)
 		{
 			int data_left = size - pos;
+			if (chunk_filled == 0 && data_left >= block_size)
+			{
+				// Hash the whole blocks directly from the input
+				int num_blocks = data_left / block_size;
+				process_blocks(data + pos, num_blocks);
+				pos += num_blocks * block_size;
+				continue;
+			}
+
 			int buffer_space = block_size - chunk_filled;
 			int data_used = min(buffer_space, data_left);
 			memcpy(chunk + chunk_filled, data + pos, data_used);
@@ -167,7 +192,7 @@ namespace uicore
 			pos += data_used;
 			if (chunk_filled == block_size)
 			{
-				process_chunk();
+				process_blocks(chunk, 1);
 				chunk_filled = 0;
 			}
 		}
@@ -286,74 +311,134 @@ namespace uicore
 		}
 	}
 
-	void SHA256_Impl::process_chunk()
+	void SHA256_Impl::process_blocks(const unsigned char *data, int num_blocks)
 	{
-		// Constants defined in FIPS 180-3, section 4.2.2
-		static const uint32_t constant_K[64] = {
-			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-			0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-			0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-			0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-			0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-			0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-			0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-			0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-			0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-			0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-			0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-			0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-		};
-
-		int i;
-		unsigned int w[64];
-
-		for (i = 0; i < 16; i++)
+#ifdef UICORE_SHA256_SHANI
+		static bool cpu_has_sha = System::detect_cpu_extension(System::sha) && System::detect_cpu_extension(System::sse4_1);
+		if (cpu_has_sha)
 		{
-			unsigned int b1 = chunk[i * 4];
-			unsigned int b2 = chunk[i * 4 + 1];
-			unsigned int b3 = chunk[i * 4 + 2];
-			unsigned int b4 = chunk[i * 4 + 3];
-			w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
+			process_blocks_shani(data, num_blocks);
+			return;
 		}
+#endif
 
-		for (i = 16; i < 64; i++)
+		for (int block = 0; block < num_blocks; block++, data += block_size)
 		{
-			w[i] = sigma_rr17_rr19_sr10(w[i - 2]) + w[i - 7] + sigma_rr7_rr18_sr3(w[i - 15]) + w[i - 16];
+			int i;
+			unsigned int w[64];
+
+			for (i = 0; i < 16; i++)
+			{
+				unsigned int b1 = data[i * 4];
+				unsigned int b2 = data[i * 4 + 1];
+				unsigned int b3 = data[i * 4 + 2];
+				unsigned int b4 = data[i * 4 + 3];
+				w[i] = (b1 << 24) + (b2 << 16) + (b3 << 8) + b4;
+			}
+
+			for (i = 16; i < 64; i++)
+			{
+				w[i] = sigma_rr17_rr19_sr10(w[i - 2]) + w[i - 7] + sigma_rr7_rr18_sr3(w[i - 15]) + w[i - 16];
+			}
+
+			uint32_t a = h0;
+			uint32_t b = h1;
+			uint32_t c = h2;
+			uint32_t d = h3;
+			uint32_t e = h4;
+			uint32_t f = h5;
+			uint32_t g = h6;
+			uint32_t h = h7;
+
+			for (i = 0; i < 64; i++)
+			{
+				uint32_t t1, t2;
+
+				t1 = h + sigma_rr6_rr11_rr25(e) + sha_ch(e, f, g) + constant_K[i] + w[i];
+				t2 = sigma_rr2_rr13_rr22(a) + sha_maj(a, b, c);
+				h = g;
+				g = f;
+				f = e;
+				e = d + t1;
+				d = c;
+				c = b;
+				b = a;
+				a = t1 + t2;
+			}
+
+			h0 += a;
+			h1 += b;
+			h2 += c;
+			h3 += d;
+			h4 += e;
+			h5 += f;
+			h6 += g;
+			h7 += h;
 		}
+	}
+
+#ifdef UICORE_SHA256_SHANI
+	UICORE_TARGET_SHANI void SHA256_Impl::process_blocks_shani(const unsigned char *data, int num_blocks)
+	{
+		const __m128i byte_swap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
 
-		uint32_t a = h0;
-		uint32_t b = h1;
-		uint32_t c = h2;
-		uint32_t d = h3;
-		uint32_t e = h4;
-		uint32_t f = h5;
-		uint32_t g = h6;
-		uint32_t h = h7;
+		// The SHA extensions keep the state as ABEF and CDGH
+		__m128i state_abcd = _mm_set_epi32(h3, h2, h1, h0);
+		__m128i state_efgh = _mm_set_epi32(h7, h6, h5, h4);
+		__m128i temp = _mm_shuffle_epi32(state_abcd, 0xB1);
+		state_efgh = _mm_shuffle_epi32(state_efgh, 0x1B);
+		__m128i state0 = _mm_alignr_epi8(temp, state_efgh, 8);
+		__m128i state1 = _mm_blend_epi16(state_efgh, temp, 0xF0);
 
-		for (i = 0; i < 64; i++)
+		for (int block = 0; block < num_blocks; block++, data += block_size)
 		{
-			uint32_t t1, t2;
-
-			t1 = h + sigma_rr6_rr11_rr25(e) + sha_ch(e, f, g) + constant_K[i] + w[i];
-			t2 = sigma_rr2_rr13_rr22(a) + sha_maj(a, b, c);
-			h = g;
-			g = f;
-			f = e;
-			e = d + t1;
-			d = c;
-			c = b;
-			b = a;
-			a = t1 + t2;
+			__m128i saved_state0 = state0;
+			__m128i saved_state1 = state1;
+
+			__m128i message[4];
+			for (int i = 0; i < 4; i++)
+				message[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i * 16)), byte_swap_mask);
+
+			// 16 groups of 4 rounds, each group extending the message schedule by 4 words
+			for (int i = 0; i < 16; i++)
+			{
+				if (i >= 4)
+				{
+					__m128i w = _mm_sha256msg1_epu32(message[i % 4], message[(i + 1) % 4]);
+					w = _mm_add_epi32(w, _mm_alignr_epi8(message[(i + 3) % 4], message[(i + 2) % 4], 4));
+					message[i % 4] = _mm_sha256msg2_epu32(w, message[(i + 3) % 4]);
+				}
+
+				__m128i round_input = _mm_add_epi32(message[i % 4], _mm_loadu_si128((const __m128i*)(constant_K + i * 4)));
+				state1 = _mm_sha256rnds2_epu32(state1, state0, round_input);
+				state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(round_input, 0x0E));
+			}
+
+			state0 = _mm_add_epi32(state0, saved_state0);
+			state1 = _mm_add_epi32(state1, saved_state1);
 		}
 
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
-		h5 += f;
-		h6 += g;
-		h7 += h;
+		temp = _mm_shuffle_epi32(state0, 0x1B);
+		state1 = _mm_shuffle_epi32(state1, 0xB1);
+		state_abcd = _mm_blend_epi16(temp, state1, 0xF0);
+		state_efgh = _mm_alignr_epi8(state1, temp, 8);
+
+		uint32_t state[8];
+		_mm_storeu_si128((__m128i*)state, state_abcd);
+		_mm_storeu_si128((__m128i*)(state + 4), state_efgh);
+		h0 = state[0];
+		h1 = state[1];
+		h2 = state[2];
+		h3 = state[3];
+		h4 = state[4];
+		h5 = state[5];
+		h6 = state[6];
+		h7 = state[7];
+	}
+#else
+	void SHA256_Impl::process_blocks_shani(const unsigned char *data, int num_blocks)
+	{
+		throw Exception("SHA extensions are not available");
 	}
+#endif
 }
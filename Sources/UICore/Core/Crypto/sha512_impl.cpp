@@ -33,6 +33,7 @@
 #include "UICore/Core/Crypto/sha512.h"
 #include "UICore/Core/Crypto/sha512_224.h"
 #include "UICore/Core/Crypto/sha512_256.h"
+#include "UICore/Core/Math/hex_encoder.h"
 
 #ifndef WIN32
 #include <cstring>
@@ -47,47 +48,19 @@ namespace uicore
 
 	std::string SHA512_Impl::hash(bool uppercase) const
 	{
-		if (calculated == false)
-			throw Exception("SHA-512 hash has not been calculated yet!");
-
-		char digest[128 + 1];
-		to_hex64_be(digest, h0, uppercase);
-		to_hex64_be(digest + 16, h1, uppercase);
-		to_hex64_be(digest + 32, h2, uppercase);
-
+		int digest_size;
 		if (sha_type == cl_sha_512_224)
-		{
-			// upper 4 bytes of h3
-			to_hex_be(digest + 48, (uint32_t)(h3 >> 32), uppercase);
-			digest[56] = 0;
-		}
+			digest_size = 28;
+		else if (sha_type == cl_sha_512_256)
+			digest_size = 32;
+		else if (sha_type == cl_sha_384)
+			digest_size = 48;
 		else
-		{
-			to_hex64_be(digest + 48, h3, uppercase);
-			to_hex64_be(digest + 64, h4, uppercase);
-
-			if (sha_type == cl_sha_512_256)
-			{
-				digest[64] = 0;
-			}
-			else
-			{
-				to_hex64_be(digest + 80, h5, uppercase);
+			digest_size = 64;
 
-				if (sha_type == cl_sha_384)
-				{
-					digest[96] = 0;
-				}
-				else
-				{
-					// Must be cl_sha_512
-					to_hex64_be(digest + 96, h6, uppercase);
-					to_hex64_be(digest + 112, h7, uppercase);
-					digest[128] = 0;
-				}
-			}
-		}
-		return digest;
+		unsigned char digest[64];
+		hash(digest);
+		return HexEncoder::encode(digest, digest_size, uppercase);
 	}
 
 	void SHA512_Impl::hash(unsigned char *out_hash) const
@@ -32,8 +32,8 @@
 
 namespace uicore
 {
-	std::shared_ptr<TLSClient> TLSClient::create()
+	std::shared_ptr<TLSClient> TLSClient::create(const std::string &server_name, const std::shared_ptr<TLSSessionCache> &session_cache)
 	{
-		return std::make_shared<TLSClient_Impl>();
+		return std::make_shared<TLSClient_Impl>(server_name, session_cache);
 	}
 }
@@ -36,21 +36,85 @@
 #include "UICore/Core/Crypto/aes256_encrypt.h"
 #include "UICore/Core/Crypto/aes256_decrypt.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/Math/big_int.h"
 #include <ctime>
 #include <algorithm>
 #include "x509.h"
+#include "x25519.h"
 #include "UICore/Core/Math/cl_math.h"
 
 namespace uicore
 {
-	TLSClient_Impl::TLSClient_Impl() : security_parameters(), protocol()
+	namespace
 	{
-		// Set TLS 3.1
+		// P_hash data expansion function of the TLS 1.2 PRF (RFC 5246, section 5)
+		template<typename HashFunction>
+		void tls12_p_hash(unsigned char *output_ptr, unsigned int output_size, const std::shared_ptr<Secret> &secret, const char *label_ptr, const std::shared_ptr<Secret> &seed_part1, const std::shared_ptr<Secret> &seed_part2)
+		{
+			int label_length = strlen(label_ptr);
+
+			auto a = Secret::create(HashFunction::hash_size);
+			auto output_block = Secret::create(HashFunction::hash_size);
+
+			// A(1) = HMAC_hash(secret, seed)
+			auto hash = HashFunction::create();
+			hash->set_hmac(secret->data(), secret->size());
+			hash->add(label_ptr, label_length);
+			hash->add(seed_part1->data(), seed_part1->size());
+			hash->add(seed_part2->data(), seed_part2->size());
+			hash->calculate();
+			hash->hash(a->data());
+
+			unsigned int position = 0;
+			while (position < output_size)
+			{
+				// HMAC_hash(secret, A(i) + seed)
+				hash->set_hmac(secret->data(), secret->size());
+				hash->add(a->data(), a->size());
+				hash->add(label_ptr, label_length);
+				hash->add(seed_part1->data(), seed_part1->size());
+				hash->add(seed_part2->data(), seed_part2->size());
+				hash->calculate();
+				hash->hash(output_block->data());
+
+				unsigned int length = min(output_size - position, (unsigned int)HashFunction::hash_size);
+				memcpy(output_ptr + position, output_block->data(), length);
+				position += length;
+
+				// A(i + 1) = HMAC_hash(secret, A(i))
+				hash->set_hmac(secret->data(), secret->size());
+				hash->add(a->data(), a->size());
+				hash->calculate();
+				hash->hash(a->data());
+			}
+		}
+	}
+
+	TLSClient_Impl::TLSClient_Impl(const std::string &server_name, const std::shared_ptr<TLSSessionCache> &session_cache) : security_parameters(), protocol(), server_name(server_name), session_cache(std::static_pointer_cast<TLSSessionCacheImpl>(session_cache))
+	{
+		// Set TLS 1.2 (3.3). The server may choose a lower version, down to TLS 1.0 (3.1)
 		protocol.major = 3;
-		protocol.minor = 1;
+		protocol.minor = 3;
+		client_hello_version = protocol;
 		is_protocol_chosen = false;
 
 		create_security_parameters_client_random();
+
+		if (this->session_cache && !server_name.empty() && this->session_cache->find(server_name, cached_session))
+		{
+			session_ticket = cached_session.session_ticket;
+
+			// RFC 5077 (3.4) a session ID is sent with the ticket, so the server can signal it was accepted by echoing it
+			offered_session_id = cached_session.session_id;
+			if (offered_session_id.empty())
+			{
+				offered_session_id.resize(32);
+				m_Random->random_bytes(offered_session_id.data(), (int)offered_session_id.size());
+			}
+		}
+
+		// Queue the client hello, so the handshake can be driven by decrypt() alone
+		progress_conversation();
 	}
 
 	TLSClient_Impl::~TLSClient_Impl()
@@ -166,7 +230,8 @@ namespace uicore
 					break;
 				case cl_tls_state_receive_certificate:
 					break;
-				//FIXME: Implement "7.4.3. Server key exchange message"
+				case cl_tls_state_receive_server_key_exchange:
+					break;
 				case cl_tls_state_receive_server_hello_done:
 					break;
 				// FIXME: Should be send a "client certificate message" ?
@@ -202,6 +267,7 @@ namespace uicore
 		catch (...)
 		{
 			conversation_state = cl_tls_state_error;
+			forget_session();
 			throw;
 		}
 	}
@@ -217,19 +283,7 @@ namespace uicore
 		unsigned int max_record_length_gcc_fix = max_record_length;
 		unsigned int data_in_record = uicore::min((unsigned int)size, max_record_length_gcc_fix);
 
-		int offset = 0;
-		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
-		int offset_tls_appdata = offset;				offset += data_in_record;
-
-		auto message = Secret::create(offset);
-		unsigned char *message_ptr = message->data();
-
-		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_application_data, offset - offset_tls_record);
-
-		memcpy(message_ptr + offset_tls_appdata, data, data_in_record);
-
-		send_record(message_ptr, offset);
-
+		send_record(cl_tls_content_application_data, data, data_in_record);
 
 		send_in_data_read_pos += data_in_record;
 		if (send_in_data_read_pos > desired_buffer_size / 2 || send_in_data_read_pos == 0)
@@ -249,22 +303,51 @@ namespace uicore
 		if (recv_out_data->size() - recv_out_data_read_pos >= desired_buffer_size)
 			return false;
 
-		int data_available = recv_in_data->size() - recv_in_data_read_pos;
-		if (data_available < sizeof(TLS_Record))
+		unsigned char *application_data = nullptr;
+		int application_data_size = 0;
+		int record_size = open_record(recv_in_data->data<unsigned char>() + recv_in_data_read_pos, recv_in_data->size() - recv_in_data_read_pos, application_data, application_data_size);
+		if (record_size == 0)
 			return false;
 
+		if (application_data_size > 0)
+		{
+			int pos = recv_out_data->size();
+			recv_out_data->set_size(pos + application_data_size);
+			memcpy(recv_out_data->data() + pos, application_data, application_data_size);
+		}
+
+		recv_in_data_read_pos += record_size;
+		if (recv_in_data_read_pos > desired_buffer_size / 2)
+		{
+			int available = recv_in_data->size() - recv_in_data_read_pos;
+			memmove(recv_in_data->data(), recv_in_data->data() + recv_in_data_read_pos, available);
+			recv_in_data->set_size(available);
+			recv_in_data_read_pos = 0;
+		}
+
+		return true;
+	}
+
+	int TLSClient_Impl::open_record(unsigned char *data_ptr, int data_size, unsigned char *&out_application_data, int &out_application_size)
+	{
+		out_application_data = nullptr;
+		out_application_size = 0;
+
+		if (data_size < (int)sizeof(TLS_Record))
+			return 0;
+
 		TLS_Record record;
-		memcpy(&record, recv_in_data->data() + recv_in_data_read_pos, sizeof(TLS_Record));
+		memcpy(&record, data_ptr, sizeof(TLS_Record));
 
 		int record_length;
 		record_length = record.length[0] << 8 | record.length[1];
-		if (record_length > max_record_length)
+		if (record_length > (int)max_ciphertext_length)
 			throw Exception("Maximum record length exceeded when receieving");
 		if (record_length == 0)	// The TLS Record Layer receives uninterpreted data from higher layers in non-empty blocks of arbitrary size.
 			throw Exception("Received an empty block");
 
-		if (sizeof(TLS_Record) + record_length > data_available)
-			return false;
+		if ((int)sizeof(TLS_Record) + record_length > data_size)
+			return 0;
 
 		if (is_protocol_chosen)
 		{
@@ -278,23 +361,20 @@ namespace uicore
 			// We set the protocol version in ServerHello
 		}
 
-		record_data_buffer->set_size(record_length);
-		memcpy(record_data_buffer->data(), recv_in_data->data() + recv_in_data_read_pos + sizeof(TLS_Record), record_length);
-
-		recv_in_data_read_pos += sizeof(TLS_Record) + record_length;
-		if (recv_in_data_read_pos > desired_buffer_size / 2)
+		unsigned char *plaintext = data_ptr + sizeof(TLS_Record);
+		int plaintext_size = record_length;
+		if (security_parameters.is_receive_encrypted && security_parameters.cipher_type == cl_tls_cipher_type_aead)
 		{
-			int available = recv_in_data->size() - recv_in_data_read_pos;
-			memmove(recv_in_data->data(), recv_in_data->data() + recv_in_data_read_pos, available);
-			recv_in_data->set_size(available);
-			recv_in_data_read_pos = 0;
+			plaintext_size = decrypt_record_aead(record, plaintext, record_length);
+			plaintext += aead_explicit_nonce_size;
+		}
+		else if (security_parameters.is_receive_encrypted)
+		{
+			// The plaintext is never longer than the ciphertext, so it is copied back over it
+			std::shared_ptr<DataBuffer> decrypted = decrypt_record_cbc(record, plaintext, record_length);
+			plaintext_size = decrypted->size();
+			memcpy(plaintext, decrypted->data(), plaintext_size);
 		}
-
-		std::shared_ptr<DataBuffer> plaintext;
-		if (security_parameters.is_receive_encrypted)
-			plaintext = decrypt_record(record, record_data_buffer);
-		else
-			plaintext = record_data_buffer;
 
 		security_parameters.read_sequence_number++;
 		if (security_parameters.read_sequence_number == 0)
@@ -303,19 +383,22 @@ namespace uicore
 		switch (record.type)
 		{
 		case cl_tls_content_change_cipher_spec:
-			change_cipher_spec_data(plaintext);
+			change_cipher_spec_data(plaintext, plaintext_size);
 			break;
 
 		case cl_tls_content_alert:
-			alert_data(plaintext);
+			alert_data(plaintext, plaintext_size);
 			break;
 
 		case cl_tls_content_handshake:
-			handshake_data(plaintext);
+			handshake_data(plaintext, plaintext_size);
 			break;
 
 		case cl_tls_content_application_data:
-			application_data(plaintext);
+			if (conversation_state != cl_tls_state_connected)
+				throw Exception("Unexpected application data record received");
+			out_application_data = plaintext;
+			out_application_size = plaintext_size;
 			break;
 
 		default:
@@ -324,20 +407,20 @@ namespace uicore
 			break;
 		}
 
-		return true;
+		return sizeof(TLS_Record) + record_length;
 	}
 
-	void TLSClient_Impl::change_cipher_spec_data(std::shared_ptr<DataBuffer> record_plaintext)
+	void TLSClient_Impl::change_cipher_spec_data(const unsigned char *data, int size)
 	{
 		if (conversation_state != cl_tls_state_receive_change_cipher_spec)
 			throw Exception("Unexpected TLS change cipher record received");
 
-		if (record_plaintext->size() != 1)
+		if (size != 1)
 			throw Exception("Invalid TLS content change cipher spec size");
 
 		security_parameters.read_sequence_number = 0;
 
-		uint8_t value = record_plaintext->data<uint8_t>()[0];
+		uint8_t value = data[0];
 		if (value != 1)
 			throw Exception("TLS server change cipher spec did not send 1");
 
@@ -346,12 +429,12 @@ namespace uicore
 		conversation_state = cl_tls_state_receive_finished;
 	}
 
-	void TLSClient_Impl::alert_data(std::shared_ptr<DataBuffer> record_plaintext)
+	void TLSClient_Impl::alert_data(const unsigned char *data, int size)
 	{
-		if (record_plaintext->size() != 2) // To do: theoretically this is not safe - it could be split into two 1 byte records.
+		if (size != 2) // To do: theoretically this is not safe - it could be split into two 1 byte records.
 			throw Exception("Invalid TLS content alert message");
 
-		uint8_t *alert_data = record_plaintext->data<uint8_t>();
+		const uint8_t *alert_data = data;
 
 		if (alert_data[0] == cl_tls_warning)
 			return;
@@ -457,37 +540,56 @@ namespace uicore
 		throw Exception(string);
 	}
 
-	void TLSClient_Impl::handshake_data(std::shared_ptr<DataBuffer> record_plaintext)
+	void TLSClient_Impl::handshake_data(const unsigned char *data_ptr, int data_size)
 	{
 		// Copy handshake data into input buffer for easier processing:
 		// "RFC 2246 (5.2.1) multiple client messages of the same ContentType may be coalesced into a single TLSPlaintext record"
 		int pos = handshake_in_data->size();
-		handshake_in_data->set_size(pos + record_plaintext->size());
-		memcpy(handshake_in_data->data() + pos, record_plaintext->data(), record_plaintext->size());
+		handshake_in_data->set_size(pos + data_size);
+		memcpy(handshake_in_data->data() + pos, data_ptr, data_size);
 
-		// Check if we have received enough data to peek at the handshake header:
-		int available = handshake_in_data->size() - handshake_in_read_pos;
-		if (available < sizeof(TLS_Handshake))
-			return;
+		// The record may end with a partial message, or hold several messages
+		while (true)
+		{
+			// Check if we have received enough data to peek at the handshake header:
+			int available = handshake_in_data->size() - handshake_in_read_pos;
+			if (available < (int)sizeof(TLS_Handshake))
+				break;
 
-		// Check if we have received enough data to read the entire handshake message:
-		TLS_Handshake &handshake = *reinterpret_cast<TLS_Handshake*>(handshake_in_data->data() + handshake_in_read_pos);
-		int length = handshake.length[0] << 16 | handshake.length[1] << 8 | handshake.length[2];
-		if (sizeof(TLS_Handshake) + length > available)
-			return;
+			// Check if we have received enough data to read the entire handshake message:
+			TLS_Handshake handshake = *reinterpret_cast<TLS_Handshake*>(handshake_in_data->data() + handshake_in_read_pos);
+			int length = handshake.length[0] << 16 | handshake.length[1] << 8 | handshake.length[2];
+			if ((int)sizeof(TLS_Handshake) + length > available)
+				break;
+
+			// We got a full message.
+			handshake_message(handshake.msg_type, handshake_in_data->data() + handshake_in_read_pos, length);
+
+			// Remove processed handshake message from the input buffer:
+			handshake_in_read_pos += sizeof(TLS_Handshake) + length;
+		}
 
-		const char *data = handshake_in_data->data() + handshake_in_read_pos + sizeof(TLS_Handshake);
+		if (handshake_in_read_pos >= desired_buffer_size / 2 || handshake_in_read_pos == (int)handshake_in_data->size())
+		{
+			int available = handshake_in_data->size() - handshake_in_read_pos;
+			memmove(handshake_in_data->data(), handshake_in_data->data() + handshake_in_read_pos, available);
+			handshake_in_data->set_size(available);
+			handshake_in_read_pos = 0;
+		}
+	}
 
-		// We got a full message.
+	void TLSClient_Impl::handshake_message(int msg_type, const void *message, int length)
+	{
+		const char *data = static_cast<const char*>(message) + sizeof(TLS_Handshake);
 
-		// All handshake messages except handshake_finished needs to be included in the handshake hash calculation:
-		if (handshake.msg_type != cl_tls_handshake_finished)
+		// The finished message is hashed after it has been verified, as its verify data does not include itself
+		if (msg_type != cl_tls_handshake_finished)
 		{
-			hash_handshake(&handshake, length + sizeof(TLS_Handshake));
+			hash_handshake(message, length + sizeof(TLS_Handshake));
 		}
 
 		// Dispatch message for further parsing:
-		switch (handshake.msg_type)
+		switch (msg_type)
 		{
 		case cl_tls_handshake_hello_request:
 			handshake_hello_request_received(data, length);
@@ -498,6 +600,9 @@ namespace uicore
 		case cl_tls_handshake_server_hello:
 			handshake_server_hello_received(data, length);
 			break;
+		case cl_tls_handshake_new_session_ticket:
+			handshake_new_session_ticket_received(data, length);
+			break;
 		case cl_tls_handshake_certificate:
 			handshake_certificate_received(data, length);
 			break;
@@ -518,29 +623,11 @@ namespace uicore
 			break;
 		case cl_tls_handshake_finished:
 			handshake_finished_received(data, length);
+			hash_handshake(message, length + sizeof(TLS_Handshake));
 			break;
 		default:
 			throw Exception("Unknown handshake type");
 		}
-
-		// Remove processed handshake message from the input buffer:
-		handshake_in_read_pos += sizeof(TLS_Handshake) + length;
-		if (handshake_in_read_pos >= desired_buffer_size / 2)
-		{
-			available = handshake_in_data->size() - handshake_in_read_pos;
-			memmove(handshake_in_data->data(), handshake_in_data->data() + handshake_in_read_pos, available);
-			handshake_in_data->set_size(available);
-		}
-	}
-
-	void TLSClient_Impl::application_data(std::shared_ptr<DataBuffer> record_plaintext)
-	{
-		if (conversation_state != cl_tls_state_connected)
-			throw Exception("Unexpected application data record received");
-
-		int pos = recv_out_data->size();
-		recv_out_data->set_size(pos + record_plaintext->size());
-		memcpy(recv_out_data->data() + pos, record_plaintext->data(), record_plaintext->size());
 	}
 
 	void TLSClient_Impl::handshake_hello_request_received(const void *data, int size)
@@ -614,16 +701,84 @@ namespace uicore
 
 		uint8_t session_id_length;
 		copy_data(&session_id_length, 1, data, size);
-		auto session_id = Secret::create(session_id_length);
-		copy_data(session_id->data(), session_id_length, data, size);
+		if (session_id_length > 32)
+			throw Exception("Invalid TLS session ID length");
+		session_id.resize(session_id_length);
+		copy_data(session_id.data(), session_id_length, data, size);
 
-		int8_t buffer[3];
+		uint8_t buffer[3];
 		copy_data(buffer, 3, data, size);
 
 		select_cipher_suite(buffer[0], buffer[1]);
 		select_compression_method(buffer[2]);
+		cipher_suite[0] = buffer[0];
+		cipher_suite[1] = buffer[1];
+
+		if (size > 0)
+		{
+			uint8_t extensions_length[2];
+			copy_data(extensions_length, 2, data, size);
+			if ((extensions_length[0] << 8 | extensions_length[1]) != size)
+				throw Exception("Invalid TLS server hello extensions length");
+
+			while (size > 0)
+			{
+				uint8_t extension_header[4];
+				copy_data(extension_header, 4, data, size);
+				int extension_type = extension_header[0] << 8 | extension_header[1];
+				int extension_size = extension_header[2] << 8 | extension_header[3];
+				if (extension_size > size)
+					throw Exception("Invalid TLS server hello extension length");
+
+				// RFC 5077 (3.2) the server will send a new session ticket before its change cipher spec
+				if (extension_type == cl_tls_extension_session_ticket)
+					is_session_ticket_expected = true;
+
+				// The other extensions are responses to the ones we sent and require no further action
+				data = static_cast<const char*>(data) + extension_size;
+				size -= extension_size;
+			}
+		}
+
+		// RFC 5246 (7.3) the server echoes the offered session ID if it resumes the session
+		if (!offered_session_id.empty() && session_id == offered_session_id)
+		{
+			if (cached_session.protocol_major != protocol.major || cached_session.protocol_minor != protocol.minor || cached_session.cipher_suite[0] != cipher_suite[0] || cached_session.cipher_suite[1] != cipher_suite[1])
+				throw Exception("TLS server resumed a session with different security parameters");
+
+			is_resumed = true;
+			memcpy(security_parameters.master_secret->data(), cached_session.master_secret->data(), security_parameters.master_secret->size());
+			create_key_block();
+
+			conversation_state = cl_tls_state_receive_change_cipher_spec;
+		}
+		else
+		{
+			// Any ticket we sent was rejected. Keep it only if it is replaced by a new ticket
+			session_ticket.clear();
 
-		conversation_state = cl_tls_state_receive_certificate;
+			conversation_state = cl_tls_state_receive_certificate;
+		}
+	}
+
+	void TLSClient_Impl::handshake_new_session_ticket_received(const void *data, int size)
+	{
+		if (conversation_state != cl_tls_state_receive_change_cipher_spec || !is_session_ticket_expected)
+			throw Exception("Unexpected new session ticket handshake message received");
+
+		// RFC 5077 (3.3) ticket_lifetime_hint followed by the opaque ticket
+		uint8_t header[6];
+		copy_data(header, 6, data, size);
+		uint32_t lifetime_hint = (header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+		int ticket_length = header[4] << 8 | header[5];
+		if (ticket_length != size)
+			throw Exception("Invalid TLS new session ticket length");
+
+		session_ticket.resize(ticket_length);
+		copy_data(session_ticket.data(), ticket_length, data, size);
+
+		session_ticket_lifetime = lifetime_hint != 0 ? lifetime_hint : TLSSessionCacheImpl::max_session_lifetime;
+		is_session_ticket_expected = false;
 	}
 
 	void TLSClient_Impl::handshake_certificate_received(const void *data, int size)
@@ -658,12 +813,52 @@ namespace uicore
 			certificate_list_size -= certificate_size;
 		}
 
-		conversation_state = cl_tls_state_receive_server_hello_done;
+		if (security_parameters.key_exchange_algorithm == cl_tls_key_exchange_ecdhe_rsa)
+			conversation_state = cl_tls_state_receive_server_key_exchange;
+		else
+			conversation_state = cl_tls_state_receive_server_hello_done;
 	}
 
 	void TLSClient_Impl::handshake_server_key_exchange_received(const void *data, int size)
 	{
-		throw Exception("Unexpected server key exchange handshake message received");
+		if (conversation_state != cl_tls_state_receive_server_key_exchange)
+			throw Exception("Unexpected server key exchange handshake message received");
+
+		// RFC 4492 (5.4) ServerECDHParams followed by the signature
+		const void *params = data;
+
+		uint8_t curve_params[3];
+		copy_data(curve_params, 3, data, size);
+		if (curve_params[0] != 3)	// named_curve
+			throw Exception("TLS server key exchange uses an unsupported curve type");
+		if ((curve_params[1] << 8 | curve_params[2]) != cl_tls_named_curve_x25519)
+			throw Exception("TLS server key exchange uses an unsupported named curve");
+
+		uint8_t public_key_length;
+		copy_data(&public_key_length, 1, data, size);
+		if (public_key_length != X25519::key_size)
+			throw Exception("Invalid TLS server ECDHE public key size");
+		server_ecdhe_public_key->set_size(public_key_length);
+		copy_data(server_ecdhe_public_key->data(), public_key_length, data, size);
+
+		int params_size = static_cast<const char*>(data) - static_cast<const char*>(params);
+
+		if (!is_tls12())
+			throw Exception("TLS ECDHE key exchange requires TLS 1.2");
+
+		uint8_t signature_header[4];
+		copy_data(signature_header, 4, data, size);
+		if (signature_header[1] != 1)	// rsa
+			throw Exception("TLS server key exchange signature is not RSA");
+
+		int signature_size = signature_header[2] << 8 | signature_header[3];
+		if (signature_size != size)
+			throw Exception("Invalid TLS server key exchange signature size");
+
+		set_server_public_key();
+		verify_server_signature(signature_header[0], params, params_size, data, signature_size);
+
+		conversation_state = cl_tls_state_receive_server_hello_done;
 	}
 
 	void TLSClient_Impl::handshake_certificate_request_received(const void *data, int size)
@@ -676,7 +871,8 @@ namespace uicore
 		if (conversation_state != cl_tls_state_receive_server_hello_done)
 			throw Exception("TLS Expected server hello done");
 
-		set_server_public_key();
+		if (security_parameters.key_exchange_algorithm == cl_tls_key_exchange_rsa)
+			set_server_public_key();
 
 		conversation_state = cl_tls_state_send_client_key_exchange;
 	}
@@ -702,21 +898,21 @@ namespace uicore
 
 		auto client_verify_data = Secret::create(verify_data_size);
 
-		auto md5_handshake_messages = Secret::create(16);
-		auto sha1_handshake_messages = Secret::create(20);
-
-		server_handshake_md5_hash->calculate();
-		server_handshake_sha1_hash->calculate();
-
-		server_handshake_md5_hash->hash(md5_handshake_messages->data());
-		server_handshake_sha1_hash->hash(sha1_handshake_messages->data());
-
-		PRF(client_verify_data->data(), verify_data_size, security_parameters.master_secret, "server finished", md5_handshake_messages, sha1_handshake_messages);
+		PRF(client_verify_data->data(), verify_data_size, security_parameters.master_secret, "server finished", calculate_handshake_hash(), Secret::create(0));
 
 		if (memcmp(client_verify_data->data(), server_verify_data->data(), verify_data_size))
 			throw Exception("TLS server finished verify data failed");
 
-		conversation_state = cl_tls_state_connected;
+		if (is_resumed)
+		{
+			// In the abbreviated handshake the server finishes first
+			conversation_state = cl_tls_state_send_change_cipher_spec;
+		}
+		else
+		{
+			conversation_state = cl_tls_state_connected;
+			store_session();
+		}
 	}
 
 	bool TLSClient_Impl::can_send_record() const
@@ -724,58 +920,189 @@ namespace uicore
 		return send_out_data->size() < desired_buffer_size;
 	}
 
-	void TLSClient_Impl::send_record(void *data_ptr, unsigned int data_size)
+	void TLSClient_Impl::send_record(const void *data_ptr, unsigned int data_size)
 	{
-		TLS_Record *record_ptr = (TLS_Record *) data_ptr;
+		const TLS_Record *record_ptr = (const TLS_Record *) data_ptr;
 
-		int record_length;
-		record_length = record_ptr->length[0] << 8 | record_ptr->length[1];
-		if (record_length > max_record_length)
+		unsigned int record_length = record_ptr->length[0] << 8 | record_ptr->length[1];
+		if (record_length + sizeof(TLS_Record) != data_size)
+			throw Exception("Record length mismatch");
+
+		send_record((TLS_ContentType)record_ptr->type, (const unsigned char *)data_ptr + sizeof(TLS_Record), record_length);
+	}
+
+	void TLSClient_Impl::send_record(TLS_ContentType content_type, const void *data_ptr, unsigned int data_size)
+	{
+		// Reserve room for the largest possible record and seal it in place
+		int prefix_size = send_prefix_size();
+		int pos = send_out_data->size();
+		send_out_data->set_size(pos + prefix_size + data_size + send_suffix_size());
+
+		unsigned char *record_ptr = send_out_data->data<unsigned char>() + pos;
+		memcpy(record_ptr + prefix_size, data_ptr, data_size);
+
+		int record_size = seal_record(record_ptr, content_type, data_size);
+		send_out_data->set_size(pos + record_size);
+	}
+
+	int TLSClient_Impl::send_prefix_size() const
+	{
+		if (!security_parameters.is_send_encrypted)
+			return sizeof(TLS_Record);
+		else if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+			return sizeof(TLS_Record) + aead_explicit_nonce_size;
+		else if (is_explicit_iv())
+			return sizeof(TLS_Record) + security_parameters.iv_size;
+		else
+			return sizeof(TLS_Record);
+	}
+
+	int TLSClient_Impl::send_suffix_size() const
+	{
+		if (!security_parameters.is_send_encrypted)
+			return 0;
+		else if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+			return AES_GCM::tag_size;
+		else
+			return security_parameters.hash_size + 2 * security_parameters.iv_size;	// MAC, padding and the random extra padding block
+	}
+
+	int TLSClient_Impl::seal_record(unsigned char *record_ptr, TLS_ContentType content_type, unsigned int data_size)
+	{
+		if (data_size > max_record_length)
 			throw Exception("Maximum record length exceeded when sending");
-		if (record_length == 0)
+		if (data_size == 0)
 			throw Exception("Trying to send an empty block");
 
-		if (record_length + sizeof(TLS_Record) != data_size)
-			throw Exception("Record length mismatch");
+		set_tls_record(record_ptr, content_type, sizeof(TLS_Record) + data_size);
 
-		if (security_parameters.is_send_encrypted)
+		int record_size;
+		if (security_parameters.is_send_encrypted && security_parameters.cipher_type == cl_tls_cipher_type_aead)
+		{
+			record_size = encrypt_record_aead(record_ptr, data_size);
+		}
+		else if (security_parameters.is_send_encrypted)
 		{
-			// "the encryption and MAC functions convert TLSCompressed.fragment structures to and from block TLSCiphertext.fragment structures."
-			const unsigned char *input_ptr = (const unsigned char *) data_ptr + sizeof(TLS_Record);
-			unsigned int input_size = data_size - sizeof(TLS_Record);
-			auto mac = calculate_mac(data_ptr, data_size, nullptr, 0, security_parameters.write_sequence_number, security_parameters.client_write_mac_secret);	// MAC includes the header and sequence number
-			std::shared_ptr<DataBuffer> encrypted = encrypt_data(input_ptr , input_size, mac->data(), mac->size());
-
-			// Update the length
-			int new_length = encrypted->size();
-			record_ptr->length[0] = new_length >> 8;
-			record_ptr->length[1] = new_length;
-
-			int pos = send_out_data->size();
-			send_out_data->set_size(pos + sizeof(TLS_Record) + new_length);
-			memcpy(send_out_data->data() + pos, data_ptr, sizeof(TLS_Record));
-			memcpy(send_out_data->data() + pos + sizeof(TLS_Record), encrypted->data(), new_length);
+			record_size = encrypt_record_cbc(record_ptr, data_size);
 		}
 		else
 		{
-			int pos = send_out_data->size();
-			send_out_data->set_size(pos + data_size);
-			memcpy(send_out_data->data() + pos, data_ptr, data_size);
+			record_size = sizeof(TLS_Record) + data_size;
 		}
 
 		security_parameters.write_sequence_number++;
 		if (security_parameters.write_sequence_number == 0)
 			throw Exception("Sequence number wraparound");
+
+		return record_size;
+	}
+
+	int TLSClient_Impl::encrypt_record_cbc(unsigned char *record_ptr, unsigned int data_size)
+	{
+		// "the encryption and MAC functions convert TLSCompressed.fragment structures to and from block TLSCiphertext.fragment structures."
+		TLS_Record *record = (TLS_Record *) record_ptr;
+		unsigned char *data_ptr = record_ptr + send_prefix_size();
+
+		auto mac = calculate_mac(record_ptr, sizeof(TLS_Record), data_ptr, data_size, security_parameters.write_sequence_number, security_parameters.client_write_mac_secret);	// MAC includes the header and sequence number
+		std::shared_ptr<DataBuffer> encrypted = encrypt_data(data_ptr, data_size, mac->data(), mac->size());
+
+		// The AES classes encrypt into their own buffer. The explicit IV, if any, is at the start of it
+		int new_length = encrypted->size();
+		memcpy(record_ptr + sizeof(TLS_Record), encrypted->data(), new_length);
+
+		record->length[0] = new_length >> 8;
+		record->length[1] = new_length;
+		return sizeof(TLS_Record) + new_length;
+	}
+
+	int TLSClient_Impl::record_prefix_size() const
+	{
+		if (conversation_state != cl_tls_state_connected)
+			throw Exception("TLS connection is not established");
+		return send_prefix_size();
+	}
+
+	int TLSClient_Impl::record_suffix_size() const
+	{
+		if (conversation_state != cl_tls_state_connected)
+			throw Exception("TLS connection is not established");
+		return send_suffix_size();
+	}
+
+	int TLSClient_Impl::encrypt_record(void *buffer, int data_size)
+	{
+		if (conversation_state != cl_tls_state_connected)
+			throw Exception("TLS connection is not established");
+
+		// Records sealed here must not be interleaved with records still queued by encrypt()
+		if ((int)send_in_data->size() != send_in_data_read_pos || (int)send_out_data->size() != send_out_data_read_pos)
+			throw Exception("TLS encrypted data is still pending");
+
+		return seal_record((unsigned char *)buffer, cl_tls_content_application_data, data_size);
+	}
+
+	int TLSClient_Impl::decrypt_record(void *buffer, int size, void *&out_data, int &out_size)
+	{
+		if (conversation_state != cl_tls_state_connected)
+			throw Exception("TLS connection is not established");
+
+		if ((int)recv_in_data->size() != recv_in_data_read_pos || (int)recv_out_data->size() != recv_out_data_read_pos)
+			throw Exception("TLS decrypted data is still pending");
+
+		try
+		{
+			unsigned char *application_data = nullptr;
+			int record_size = open_record((unsigned char *)buffer, size, application_data, out_size);
+			out_data = application_data;
+			return record_size;
+		}
+		catch (...)
+		{
+			conversation_state = cl_tls_state_error;
+			forget_session();
+			throw;
+		}
+	}
+
+	void TLSClient_Impl::store_session()
+	{
+		if (!session_cache || server_name.empty())
+			return;
+
+		if (session_id.empty() && session_ticket.empty())
+			return;	// The server does not support resumption
+
+		cached_session.session_id = session_id;
+		cached_session.session_ticket = session_ticket;
+		cached_session.master_secret = Secret::create(security_parameters.master_secret->size());
+		memcpy(cached_session.master_secret->data(), security_parameters.master_secret->data(), security_parameters.master_secret->size());
+		cached_session.protocol_major = protocol.major;
+		cached_session.protocol_minor = protocol.minor;
+		cached_session.cipher_suite[0] = cipher_suite[0];
+		cached_session.cipher_suite[1] = cipher_suite[1];
+
+		// A resumed session keeps its original lifetime unless the server issued a new ticket
+		time_t current_time = time(nullptr);
+		if (session_ticket_lifetime != 0)
+			cached_session.expires = current_time + uicore::min(session_ticket_lifetime, (uint32_t)TLSSessionCacheImpl::max_session_lifetime);
+		else if (!is_resumed)
+			cached_session.expires = current_time + TLSSessionCacheImpl::max_session_lifetime;
+
+		session_cache->store(server_name, cached_session);
+	}
+
+	void TLSClient_Impl::forget_session()
+	{
+		// RFC 5246 (7.2.2) sessions ended by a fatal alert or error must not be resumed
+		if (session_cache && !server_name.empty())
+			session_cache->remove(server_name);
 	}
 
 	void TLSClient_Impl::reset()
 	{
 		security_parameters.reset();
 
-		client_handshake_md5_hash.reset();
-		client_handshake_sha1_hash.reset();
-		server_handshake_md5_hash.reset();
-		server_handshake_sha1_hash.reset();
+		handshake_messages->set_size(0);
 	}
 
 	void TLSClient_Impl::copy_data(void *out_data, int size, const void *&data, int &data_left)
@@ -844,14 +1171,15 @@ namespace uicore
 
 	int TLSClient_Impl::get_session_id_length() const
 	{
-		// Enough to write single NUL
-		return 1;
+		// SessionID session_id<0..32>;
+		return 1 + offered_session_id.size();
 	}
 
 	void TLSClient_Impl::set_session_id(unsigned char *dest_ptr) const
 	{
-		// Session id's are not supported
-		*dest_ptr = 0;
+		*(dest_ptr++) = offered_session_id.size();
+		if (!offered_session_id.empty())
+			memcpy(dest_ptr, offered_session_id.data(), offered_session_id.size());
 	}
 
 	int TLSClient_Impl::get_compression_methods_length() const
@@ -884,29 +1212,156 @@ namespace uicore
 	int TLSClient_Impl::get_cipher_suites_length() const
 	{
 		// CipherSuite cipher_suites<2..2^16-1>;
-		return 2 + (4*2);	// We support 4 cipher suites, each id contains 2 bytes
+		return 2 + (9*2);	// We support 8 cipher suites plus the renegotiation SCSV, each id contains 2 bytes
 	}
 
 	void TLSClient_Impl::set_cipher_suites(unsigned char *dest_ptr) const
 	{
-		const int num_ciphers = 4;	// If changing, you MUST change get_cipher_suites_length
+		const int num_ciphers = 9;	// If changing, you MUST change get_cipher_suites_length
 		int length = num_ciphers * 2;
 		*(dest_ptr++) = length >> 8;
 		*(dest_ptr++) = length;
 
 		// Strongest first ... maybe that should be controlled by the user, strong and fast first
+		// The AEAD suites need no separate MAC pass and the ECDHE ones give forward secrecy
+		*(dest_ptr++) = 0xC0;	*(dest_ptr++) = 0x30;	// TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384
+		*(dest_ptr++) = 0xC0;	*(dest_ptr++) = 0x2F;	// TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x9D;	// TLS_RSA_WITH_AES_256_GCM_SHA384
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x9C;	// TLS_RSA_WITH_AES_128_GCM_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3D;	// TLS_RSA_WITH_AES_256_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x3C;	// TLS_RSA_WITH_AES_128_CBC_SHA256
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x35;	// TLS_RSA_WITH_AES_256_CBC_SHA
 		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0x2F;	// TLS_RSA_WITH_AES_128_CBC_SHA
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 0xFF;	// TLS_EMPTY_RENEGOTIATION_INFO_SCSV (RFC 5746)
+	}
+
+	int TLSClient_Impl::get_extensions_length() const
+	{
+		// Extension extensions<0..2^16-1>;
+		int length = 2 + (4 + 2 + 2) + (4 + 1 + 1) + (4 + 2 + 4 * 2);
+		if (!server_name.empty())
+			length += 4 + 2 + 1 + 2 + server_name.size();
+		if (session_cache)
+			length += 4 + session_ticket.size();
+		return length;
+	}
+
+	void TLSClient_Impl::set_extensions(unsigned char *dest_ptr) const
+	{
+		int length = get_extensions_length() - 2;
+		*(dest_ptr++) = length >> 8;
+		*(dest_ptr++) = length;
+
+		// RFC 4492 (5.1.1) supported elliptic curves, X25519 only (RFC 8422)
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_supported_groups;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 4;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_named_curve_x25519;
+
+		// RFC 4492 (5.1.2) supported point formats
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_ec_point_formats;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2;
+		*(dest_ptr++) = 1;
+		*(dest_ptr++) = 0;	// uncompressed
+
+		// RFC 5246 (7.4.1.4.1) signature algorithms. Only RSA PKCS#1 v1.5 signatures can be verified
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_signature_algorithms;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 2 + 4 * 2;
+		*(dest_ptr++) = 0x00;	*(dest_ptr++) = 4 * 2;
+		*(dest_ptr++) = 4;	*(dest_ptr++) = 1;	// sha256, rsa
+		*(dest_ptr++) = 5;	*(dest_ptr++) = 1;	// sha384, rsa
+		*(dest_ptr++) = 6;	*(dest_ptr++) = 1;	// sha512, rsa
+		*(dest_ptr++) = 2;	*(dest_ptr++) = 1;	// sha1, rsa
+
+		// RFC 6066 (3) server name indication. Also the key for the session cache
+		if (!server_name.empty())
+		{
+			int name_length = server_name.size();
+			*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_server_name;
+			*(dest_ptr++) = (name_length + 5) >> 8;	*(dest_ptr++) = name_length + 5;
+			*(dest_ptr++) = (name_length + 3) >> 8;	*(dest_ptr++) = name_length + 3;
+			*(dest_ptr++) = 0;	// host_name
+			*(dest_ptr++) = name_length >> 8;	*(dest_ptr++) = name_length;
+			memcpy(dest_ptr, server_name.data(), name_length);
+			dest_ptr += name_length;
+		}
+
+		// RFC 5077 (3.2) session ticket. Empty to ask the server for a new ticket
+		if (session_cache)
+		{
+			int ticket_length = session_ticket.size();
+			*(dest_ptr++) = 0x00;	*(dest_ptr++) = cl_tls_extension_session_ticket;
+			*(dest_ptr++) = ticket_length >> 8;	*(dest_ptr++) = ticket_length;
+			if (ticket_length > 0)
+				memcpy(dest_ptr, session_ticket.data(), ticket_length);
+		}
 	}
 
 	void TLSClient_Impl::select_cipher_suite(uint8_t value1, uint8_t value2)
 	{
-		if (value1 == 0)
+		security_parameters.key_exchange_algorithm = cl_tls_key_exchange_rsa;
+		security_parameters.cipher_type = cl_tls_cipher_type_block;
+		security_parameters.prf_algorithm = is_tls12() ? cl_tls_prf_sha256 : cl_tls_prf_md5_sha1;
+
+		if (value1 == 0xC0)
+		{
+			switch (value2)
+			{
+				case 0x30:	// TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384 (RFC 5289)
+				{
+					security_parameters.key_exchange_algorithm = cl_tls_key_exchange_ecdhe_rsa;
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.prf_algorithm = cl_tls_prf_sha384;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes256;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;	// Implicit part of the nonce
+					security_parameters.key_material_length = AES256_Encrypt::key_size;
+					break;
+				}
+				case 0x2F:	// TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256 (RFC 5289)
+				{
+					security_parameters.key_exchange_algorithm = cl_tls_key_exchange_ecdhe_rsa;
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.prf_algorithm = cl_tls_prf_sha256;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes128;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;	// Implicit part of the nonce
+					security_parameters.key_material_length = AES128_Encrypt::key_size;
+					break;
+				}
+
+				default:
+					throw Exception("TLS unsupported cipher suite");
+			}
+		}
+		else if (value1 == 0)
 		{
 			switch (value2)
 			{
+				case 0x9D:	// TLS_RSA_WITH_AES_256_GCM_SHA384 (RFC 5288)
+				{
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.prf_algorithm = cl_tls_prf_sha384;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes256;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;	// Implicit part of the nonce
+					security_parameters.key_material_length = AES256_Encrypt::key_size;
+					break;
+				}
+				case 0x9C:	// TLS_RSA_WITH_AES_128_GCM_SHA256 (RFC 5288)
+				{
+					security_parameters.cipher_type = cl_tls_cipher_type_aead;
+					security_parameters.prf_algorithm = cl_tls_prf_sha256;
+					security_parameters.mac_algorithm = cl_tls_mac_algorithm_null;
+					security_parameters.bulk_cipher_algorithm = cl_tls_cipher_algorithm_aes128;
+					security_parameters.hash_size = 0;
+					security_parameters.iv_size = 4;	// Implicit part of the nonce
+					security_parameters.key_material_length = AES128_Encrypt::key_size;
+					break;
+				}
 				case 0x3D:	// TLS_RSA_WITH_AES_256_CBC_SHA256
 				{
 					security_parameters.mac_algorithm = cl_tls_mac_algorithm_sha256;
@@ -952,6 +1407,9 @@ namespace uicore
 		{
 			throw Exception("TLS unsupported cipher suite");
 		}
+
+		if (security_parameters.cipher_type == cl_tls_cipher_type_aead && !is_tls12())
+			throw Exception("TLS server selected an AEAD cipher suite without TLS 1.2");
 	}
 
 	bool TLSClient_Impl::send_client_hello()
@@ -967,6 +1425,7 @@ namespace uicore
 		int offset_tls_session_id = offset;				offset += get_session_id_length();
 		int offset_tls_cipher_suites = offset;			offset += get_cipher_suites_length();
 		int offset_tls_compression_methods = offset;	offset += get_compression_methods_length();
+		int offset_tls_extensions = offset;				offset += get_extensions_length();
 
 		auto message = Secret::create(offset);	// keep data secure
 		unsigned char *message_ptr = message->data();
@@ -978,6 +1437,7 @@ namespace uicore
 		set_session_id(message_ptr + offset_tls_session_id);
 		set_cipher_suites(message_ptr + offset_tls_cipher_suites);
 		set_compression_methods(message_ptr + offset_tls_compression_methods);
+		set_extensions(message_ptr + offset_tls_extensions);
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 
@@ -998,23 +1458,87 @@ namespace uicore
 		if (!can_send_record())
 			return false;
 
-		// If RSA is being used for key agreement and authentication, the
-		// client generates a 48-byte premaster secret, encrypts it using
-		// the public key from the server's certificate or the temporary RSA
-		// key provided in a server key exchange message, and sends the
-		// result in an encrypted premaster secret message. This structure
-		// is a variant of the client key exchange message, not a message in
-		// itself.
-		auto pre_master_secret = Secret::create(48);
-		unsigned char *pms_ptr = pre_master_secret->data();
-		m_Random->random_bytes(pms_ptr + 2, 46);
-		pms_ptr[0] = protocol.major;	// Version number
-		pms_ptr[1] = protocol.minor;
-
-		std::shared_ptr<DataBuffer> wrapped_pre_master_secret = RSA::encrypt(2, *m_Random, server_public_exponent,  server_public_modulus, pre_master_secret);
+		std::shared_ptr<Secret> pre_master_secret;
+		std::shared_ptr<DataBuffer> exchange_keys;
+		int exchange_keys_length_size;
+
+		if (security_parameters.key_exchange_algorithm == cl_tls_key_exchange_ecdhe_rsa)
+		{
+			// RFC 4492 (5.7) Ephemeral ECDH: the premaster secret is the shared X25519 secret (RFC 8422, 5.11)
+			ecdhe_private_key = Secret::create(X25519::key_size);
+			m_Random->random_bytes(ecdhe_private_key->data(), ecdhe_private_key->size());
+
+			exchange_keys = DataBuffer::create(X25519::key_size);
+			X25519::public_key(exchange_keys->data<unsigned char>(), ecdhe_private_key->data());
+
+			pre_master_secret = Secret::create(X25519::key_size);
+			if (!X25519::shared_secret(pre_master_secret->data(), ecdhe_private_key->data(), server_ecdhe_public_key->data<unsigned char>()))
+				throw Exception("Invalid TLS server ECDHE public key");
+
+			ecdhe_private_key.reset();
+			exchange_keys_length_size = 1;
+		}
+		else
+		{
+			// If RSA is being used for key agreement and authentication, the
+			// client generates a 48-byte premaster secret, encrypts it using
+			// the public key from the server's certificate or the temporary RSA
+			// key provided in a server key exchange message, and sends the
+			// result in an encrypted premaster secret message. This structure
+			// is a variant of the client key exchange message, not a message in
+			// itself.
+			pre_master_secret = Secret::create(48);
+			unsigned char *pms_ptr = pre_master_secret->data();
+			m_Random->random_bytes(pms_ptr + 2, 46);
+			pms_ptr[0] = client_hello_version.major;	// Version number
+			pms_ptr[1] = client_hello_version.minor;
+
+			exchange_keys = RSA::encrypt(2, *m_Random, server_public_exponent,  server_public_modulus, pre_master_secret);
+			exchange_keys_length_size = 2;
+		}
+
+		create_master_secret(pre_master_secret);
+		create_key_block();
+
+		const int exchange_keys_length = exchange_keys->size();
 
+		int offset = 0;
+		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
+		int offset_tls_handshake = offset;				offset += sizeof(TLS_Handshake);
+		int offset_tls_exchange_keys_length = offset;	offset+= exchange_keys_length_size;
+		int offset_tls_exchange_keys = offset;			offset+= exchange_keys_length;
+
+		auto message = Secret::create(offset);	// keep data secure
+		unsigned char *message_ptr = message->data();
+		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
+		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_client_key_exchange, offset - offset_tls_handshake);
+
+		memcpy(message_ptr + offset_tls_exchange_keys, exchange_keys->data(), exchange_keys_length);
+		if (exchange_keys_length_size == 2)
+		{
+			message_ptr[offset_tls_exchange_keys_length] = exchange_keys_length >> 8;
+			message_ptr[offset_tls_exchange_keys_length+1] = exchange_keys_length;
+		}
+		else
+		{
+			message_ptr[offset_tls_exchange_keys_length] = exchange_keys_length;
+		}
+
+		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
+
+		send_record(message_ptr, offset);
+
+		conversation_state = cl_tls_state_send_change_cipher_spec;
+		return true;
+	}
+
+	void TLSClient_Impl::create_master_secret(const std::shared_ptr<Secret> &pre_master_secret)
+	{
 		PRF(security_parameters.master_secret->data(), security_parameters.master_secret->size(), pre_master_secret, "master secret", security_parameters.client_random, security_parameters.server_random);
+	}
 
+	void TLSClient_Impl::create_key_block()
+	{
 		auto key_block = Secret::create(2 * (security_parameters.hash_size + security_parameters.key_material_length + security_parameters.iv_size));
 		PRF(key_block->data(), key_block->size(), security_parameters.master_secret, "key expansion", security_parameters.server_random, security_parameters.client_random);
 
@@ -1045,33 +1569,27 @@ namespace uicore
 		memcpy(security_parameters.server_write_iv->data(), key_block_ptr, security_parameters.server_write_iv->size());
 		key_block_ptr+=security_parameters.server_write_iv->size();
 
-		const int wrapped_pre_master_secret_length = wrapped_pre_master_secret->size();
-
-		int offset = 0;
-		int offset_tls_record = offset;					offset += sizeof(TLS_Record);
-		int offset_tls_handshake = offset;				offset += sizeof(TLS_Handshake);
-		int offset_tls_encrypted_pre_master_secret_length = offset;	offset+= 2;
-		int offset_tls_encrypted_pre_master_secret = offset;	offset+= wrapped_pre_master_secret_length;
-
-		auto message = Secret::create(offset);	// keep data secure
-		unsigned char *message_ptr = message->data();
-		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
-		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_client_key_exchange, offset - offset_tls_handshake);
-
-		memcpy(message_ptr + offset_tls_encrypted_pre_master_secret, wrapped_pre_master_secret->data(), wrapped_pre_master_secret_length);
-		message_ptr[offset_tls_encrypted_pre_master_secret_length] = wrapped_pre_master_secret_length >> 8;
-		message_ptr[offset_tls_encrypted_pre_master_secret_length+1] = wrapped_pre_master_secret_length;
-
-		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
-
-		send_record(message_ptr, offset);
-
-		conversation_state = cl_tls_state_send_change_cipher_spec;
-		return true;
+		if (security_parameters.cipher_type == cl_tls_cipher_type_aead)
+		{
+			// The expanded keys are kept for the lifetime of the connection instead of being recreated for every record
+			client_write_gcm.set_key(security_parameters.client_write_key->data(), security_parameters.client_write_key->size());
+			server_write_gcm.set_key(security_parameters.server_write_key->data(), security_parameters.server_write_key->size());
+		}
 	}
 
 	void TLSClient_Impl::PRF(void *output_ptr, unsigned int output_size, const std::shared_ptr<Secret> &secret, const char *label_ptr, const std::shared_ptr<Secret> &seed_part1, const std::shared_ptr<Secret> &seed_part2)
 	{
+		if (security_parameters.prf_algorithm == cl_tls_prf_sha256)
+		{
+			tls12_p_hash<SHA256>((unsigned char *)output_ptr, output_size, secret, label_ptr, seed_part1, seed_part2);
+			return;
+		}
+		else if (security_parameters.prf_algorithm == cl_tls_prf_sha384)
+		{
+			tls12_p_hash<SHA384>((unsigned char *)output_ptr, output_size, secret, label_ptr, seed_part1, seed_part2);
+			return;
+		}
+
 		const uint8_t *secret_part1 = secret->data();
 		int secret_length = secret->size();
 		int split_length = secret_length / 2;
@@ -1167,6 +1685,101 @@ namespace uicore
 		x509.get_rsa_public_key(server_public_exponent, server_public_modulus);
 	}
 
+	void TLSClient_Impl::verify_server_signature(int hash_algorithm, const void *signed_params, int signed_params_size, const void *signature, int signature_size)
+	{
+		// RFC 5246 (7.4.3) the signature covers client_random + server_random + params and is an
+		// RSASSA-PKCS1-v1_5 signature (RFC 3447, 8.2) of the DigestInfo for the chosen hash function
+		static const unsigned char sha1_digest_info[] = { 0x30, 0x21, 0x30, 0x09, 0x06, 0x05, 0x2b, 0x0e, 0x03, 0x02, 0x1a, 0x05, 0x00, 0x04, 0x14 };
+		static const unsigned char sha256_digest_info[] = { 0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20 };
+		static const unsigned char sha384_digest_info[] = { 0x30, 0x41, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x02, 0x05, 0x00, 0x04, 0x30 };
+		static const unsigned char sha512_digest_info[] = { 0x30, 0x51, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x03, 0x05, 0x00, 0x04, 0x40 };
+
+		std::vector<unsigned char> digest_info;
+		unsigned char hash[SHA512::hash_size];
+		int hash_size;
+
+		switch (hash_algorithm)
+		{
+			case 2:
+			{
+				auto sha1 = SHA1::create();
+				sha1->add(security_parameters.client_random->data(), security_parameters.client_random->size());
+				sha1->add(security_parameters.server_random->data(), security_parameters.server_random->size());
+				sha1->add(signed_params, signed_params_size);
+				sha1->calculate();
+				sha1->hash(hash);
+				hash_size = SHA1::hash_size;
+				digest_info.assign(sha1_digest_info, sha1_digest_info + sizeof(sha1_digest_info));
+				break;
+			}
+			case 4:
+			{
+				auto sha256 = SHA256::create();
+				sha256->add(security_parameters.client_random->data(), security_parameters.client_random->size());
+				sha256->add(security_parameters.server_random->data(), security_parameters.server_random->size());
+				sha256->add(signed_params, signed_params_size);
+				sha256->calculate();
+				sha256->hash(hash);
+				hash_size = SHA256::hash_size;
+				digest_info.assign(sha256_digest_info, sha256_digest_info + sizeof(sha256_digest_info));
+				break;
+			}
+			case 5:
+			{
+				auto sha384 = SHA384::create();
+				sha384->add(security_parameters.client_random->data(), security_parameters.client_random->size());
+				sha384->add(security_parameters.server_random->data(), security_parameters.server_random->size());
+				sha384->add(signed_params, signed_params_size);
+				sha384->calculate();
+				sha384->hash(hash);
+				hash_size = SHA384::hash_size;
+				digest_info.assign(sha384_digest_info, sha384_digest_info + sizeof(sha384_digest_info));
+				break;
+			}
+			case 6:
+			{
+				auto sha512 = SHA512::create();
+				sha512->add(security_parameters.client_random->data(), security_parameters.client_random->size());
+				sha512->add(security_parameters.server_random->data(), security_parameters.server_random->size());
+				sha512->add(signed_params, signed_params_size);
+				sha512->calculate();
+				sha512->hash(hash);
+				hash_size = SHA512::hash_size;
+				digest_info.assign(sha512_digest_info, sha512_digest_info + sizeof(sha512_digest_info));
+				break;
+			}
+			default:
+				throw Exception("TLS server key exchange uses an unsupported hash algorithm");
+		}
+		digest_info.insert(digest_info.end(), hash, hash + hash_size);
+
+		BigInt exponent, modulus, message;
+		exponent.read_unsigned_octets(server_public_exponent->data<unsigned char>(), server_public_exponent->size());
+		modulus.read_unsigned_octets(server_public_modulus->data<unsigned char>(), server_public_modulus->size());
+		message.read_unsigned_octets((const unsigned char *)signature, signature_size);
+
+		int modulus_size = modulus.unsigned_octet_size();
+		if (signature_size != modulus_size || message.cmp(&modulus) >= 0)
+			throw Exception("Invalid TLS server key exchange signature");
+		if (modulus_size < (int)digest_info.size() + 11)
+			throw Exception("TLS server RSA key is too small");
+
+		message.exptmod(&exponent, &modulus, &message);
+
+		// Compare against the complete encoding instead of parsing it: EM = 0x00 || 0x01 || PS (0xff) || 0x00 || DigestInfo
+		std::vector<unsigned char> expected(modulus_size, 0xff);
+		expected[0] = 0;
+		expected[1] = 1;
+		expected[modulus_size - digest_info.size() - 1] = 0;
+		memcpy(&expected[modulus_size - digest_info.size()], digest_info.data(), digest_info.size());
+
+		std::vector<unsigned char> decoded(modulus_size);
+		message.to_unsigned_octets(decoded.data(), modulus_size);
+
+		if (decoded != expected)
+			throw Exception("TLS server key exchange signature verification failed");
+	}
+
 	bool TLSClient_Impl::send_change_cipher_spec()
 	{
 		if (!can_send_record())
@@ -1207,21 +1820,20 @@ namespace uicore
 		set_tls_record(message_ptr + offset_tls_record, cl_tls_content_handshake, offset - offset_tls_record);
 		set_tls_handshake(message_ptr + offset_tls_handshake, cl_tls_handshake_finished, offset - offset_tls_handshake);
 
-		auto md5_handshake_messages = Secret::create(MD5::hash_size);
-		auto sha1_handshake_messages = Secret::create(SHA1::hash_size);
-
-		client_handshake_md5_hash->calculate();
-		client_handshake_sha1_hash->calculate();
-
-		client_handshake_md5_hash->hash(md5_handshake_messages->data());
-		client_handshake_sha1_hash->hash(sha1_handshake_messages->data());
-
-		PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", md5_handshake_messages, sha1_handshake_messages);
+		PRF(message_ptr + offset_tls_finished, verify_data_size, security_parameters.master_secret, "client finished", calculate_handshake_hash(), Secret::create(0));
 
 		hash_handshake( message_ptr + offset_tls_handshake, offset - offset_tls_handshake);
 		send_record(message_ptr, offset);
 
-		conversation_state = cl_tls_state_receive_change_cipher_spec;
+		if (is_resumed)
+		{
+			conversation_state = cl_tls_state_connected;
+			store_session();
+		}
+		else
+		{
+			conversation_state = cl_tls_state_receive_change_cipher_spec;
+		}
 		return true;
 	}
 
@@ -1230,6 +1842,14 @@ namespace uicore
 		int additional_unpadded_blocks;
 		m_Random->random_bool() ? additional_unpadded_blocks = 1 : additional_unpadded_blocks = 0;
 
+		// RFC 4346 (6.2.3.2) TLS 1.1 and later send a random IV with each record instead of chaining
+		int record_iv_size = 0;
+		if (is_explicit_iv())
+		{
+			record_iv_size = security_parameters.client_write_iv->size();
+			m_Random->random_bytes(security_parameters.client_write_iv->data(), record_iv_size);
+		}
+
 		std::shared_ptr<DataBuffer> buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1257,6 +1877,15 @@ namespace uicore
 		{
 			throw Exception("Unsupported cipher");
 		}
+
+		if (record_iv_size > 0)
+		{
+			auto record = DataBuffer::create(record_iv_size + buffer->size());
+			memcpy(record->data(), security_parameters.client_write_iv->data(), record_iv_size);
+			memcpy(record->data() + record_iv_size, buffer->data(), buffer->size());
+			return record;
+		}
+
 		memcpy(security_parameters.client_write_iv->data(), buffer->data() + buffer->size() - security_parameters.client_write_iv->size(), security_parameters.client_write_iv->size());
 		return buffer;
 
@@ -1311,14 +1940,59 @@ namespace uicore
 
 	void TLSClient_Impl::hash_handshake(const void *data_ptr, unsigned int data_size)
 	{
-		client_handshake_md5_hash->add(data_ptr, data_size);
-		client_handshake_sha1_hash->add(data_ptr, data_size);
-		server_handshake_md5_hash->add(data_ptr, data_size);
-		server_handshake_sha1_hash->add(data_ptr, data_size);
+		int pos = handshake_messages->size();
+		handshake_messages->set_size(pos + data_size);
+		memcpy(handshake_messages->data() + pos, data_ptr, data_size);
+	}
+
+	std::shared_ptr<Secret> TLSClient_Impl::calculate_handshake_hash() const
+	{
+		if (security_parameters.prf_algorithm == cl_tls_prf_sha256)
+		{
+			auto hash = Secret::create(SHA256::hash_size);
+			auto sha256 = SHA256::create();
+			sha256->add(handshake_messages);
+			sha256->calculate();
+			sha256->hash(hash->data());
+			return hash;
+		}
+		else if (security_parameters.prf_algorithm == cl_tls_prf_sha384)
+		{
+			auto hash = Secret::create(SHA384::hash_size);
+			auto sha384 = SHA384::create();
+			sha384->add(handshake_messages);
+			sha384->calculate();
+			sha384->hash(hash->data());
+			return hash;
+		}
+		else
+		{
+			// MD5(handshake_messages) + SHA-1(handshake_messages)
+			auto hash = Secret::create(MD5::hash_size + SHA1::hash_size);
+			auto md5 = MD5::create();
+			md5->add(handshake_messages);
+			md5->calculate();
+			md5->hash(hash->data());
+			auto sha1 = SHA1::create();
+			sha1->add(handshake_messages);
+			sha1->calculate();
+			sha1->hash(hash->data() + MD5::hash_size);
+			return hash;
+		}
 	}
 
 	std::shared_ptr<DataBuffer> TLSClient_Impl::decrypt_data(const void *data_ptr, unsigned int data_size)
 	{
+		if (is_explicit_iv())
+		{
+			unsigned int record_iv_size = security_parameters.server_write_iv->size();
+			if (data_size < record_iv_size)
+				throw Exception("Invalid TLS record size");
+			memcpy(security_parameters.server_write_iv->data(), data_ptr, record_iv_size);
+			data_ptr = (const unsigned char *) data_ptr + record_iv_size;
+			data_size -= record_iv_size;
+		}
+
 		std::shared_ptr<DataBuffer> buffer;
 		if (security_parameters.bulk_cipher_algorithm == cl_tls_cipher_algorithm_aes128)
 		{
@@ -1351,9 +2025,9 @@ namespace uicore
 
 	}
 
-	std::shared_ptr<DataBuffer> TLSClient_Impl::decrypt_record(TLS_Record &record, const std::shared_ptr<DataBuffer> &record_data)
+	std::shared_ptr<DataBuffer> TLSClient_Impl::decrypt_record_cbc(TLS_Record &record, const unsigned char *data_ptr, unsigned int data_size)
 	{
-		std::shared_ptr<DataBuffer> decrypted = decrypt_data(record_data->data(), record_data->size());
+		std::shared_ptr<DataBuffer> decrypted = decrypt_data(data_ptr, data_size);
 
 		unsigned char *decrypted_data = (unsigned char *) decrypted->data();
 
@@ -1373,4 +2047,63 @@ namespace uicore
 		decrypted->set_size(decoded_size);
 		return decrypted;
 	}
+
+	void TLSClient_Impl::set_aead_nonce_and_additional_data(unsigned char nonce[AES_GCM::iv_size], unsigned char additional_data[13], const std::shared_ptr<Secret> &write_iv, const unsigned char *explicit_nonce, uint64_t sequence_number, const TLS_Record &record, unsigned int data_size) const
+	{
+		// RFC 5288 (3) nonce = salt (implicit write IV) + explicit nonce
+		memcpy(nonce, write_iv->data(), write_iv->size());
+		memcpy(nonce + write_iv->size(), explicit_nonce, aead_explicit_nonce_size);
+
+		// RFC 5246 (6.2.3.3) additional_data = seq_num + TLSCompressed.type + TLSCompressed.version + TLSCompressed.length
+		for (int i = 0; i < 8; i++)
+			additional_data[i] = (unsigned char)(sequence_number >> (56 - i * 8));
+		additional_data[8] = record.type;
+		additional_data[9] = record.version.major;
+		additional_data[10] = record.version.minor;
+		additional_data[11] = (unsigned char)(data_size >> 8);
+		additional_data[12] = (unsigned char)data_size;
+	}
+
+	int TLSClient_Impl::encrypt_record_aead(unsigned char *record_ptr, unsigned int data_size)
+	{
+		TLS_Record *record = (TLS_Record *) record_ptr;
+		unsigned char *explicit_nonce = record_ptr + sizeof(TLS_Record);
+		unsigned char *data_ptr = explicit_nonce + aead_explicit_nonce_size;
+
+		// The sequence number is unique per key, so it doubles as the explicit part of the nonce
+		for (int i = 0; i < aead_explicit_nonce_size; i++)
+			explicit_nonce[i] = (unsigned char)(security_parameters.write_sequence_number >> (56 - i * 8));
+
+		unsigned char nonce[AES_GCM::iv_size];
+		unsigned char additional_data[13];
+		set_aead_nonce_and_additional_data(nonce, additional_data, security_parameters.client_write_iv, explicit_nonce, security_parameters.write_sequence_number, *record, data_size);
+
+		client_write_gcm.encrypt(nonce, additional_data, sizeof(additional_data), data_ptr, data_size, data_ptr + data_size);
+
+		int new_length = aead_explicit_nonce_size + data_size + AES_GCM::tag_size;
+		record->length[0] = new_length >> 8;
+		record->length[1] = new_length;
+		return sizeof(TLS_Record) + new_length;
+	}
+
+	int TLSClient_Impl::decrypt_record_aead(TLS_Record &record, unsigned char *data_ptr, int data_size)
+	{
+		if (data_size < aead_explicit_nonce_size + AES_GCM::tag_size)
+			throw Exception("Invalid TLS AEAD record size");
+
+		unsigned char *explicit_nonce = data_ptr;
+		unsigned char *ciphertext = explicit_nonce + aead_explicit_nonce_size;
+		int plaintext_size = data_size - aead_explicit_nonce_size - AES_GCM::tag_size;
+
+		unsigned char nonce[AES_GCM::iv_size];
+		unsigned char additional_data[13];
+		set_aead_nonce_and_additional_data(nonce, additional_data, security_parameters.server_write_iv, explicit_nonce, security_parameters.read_sequence_number, record, plaintext_size);
+
+		if (!server_write_gcm.decrypt(nonce, additional_data, sizeof(additional_data), ciphertext, plaintext_size, ciphertext + plaintext_size))
+			throw Exception("TLS AEAD record authentication failed");
+
+		record.length[0] = plaintext_size >> 8;
+		record.length[1] = plaintext_size;
+		return plaintext_size;
+	}
 }
@@ -35,7 +35,9 @@
 #include "UICore/Core/Crypto/rsa.h"
 #include "UICore/Core/Crypto/hash_functions.h"
 #include "UICore/Core/Crypto/tls_client.h"
+#include "tls_session_cache_impl.h"
 #include "x509.h"
+#include "aes_gcm.h"
 
 namespace uicore
 {
@@ -60,7 +62,35 @@ namespace uicore
 	enum TLS_CipherType
 	{
 		cl_tls_cipher_type_stream,
-		cl_tls_cipher_type_block
+		cl_tls_cipher_type_block,
+		cl_tls_cipher_type_aead
+	};
+
+	enum TLS_KeyExchangeAlgorithm
+	{
+		cl_tls_key_exchange_rsa,
+		cl_tls_key_exchange_ecdhe_rsa
+	};
+
+	enum TLS_PRFAlgorithm
+	{
+		cl_tls_prf_md5_sha1,	// TLS 1.0 and 1.1
+		cl_tls_prf_sha256,
+		cl_tls_prf_sha384
+	};
+
+	enum TLS_NamedCurve
+	{
+		cl_tls_named_curve_x25519 = 29
+	};
+
+	enum TLS_ExtensionType
+	{
+		cl_tls_extension_server_name = 0,
+		cl_tls_extension_supported_groups = 10,
+		cl_tls_extension_ec_point_formats = 11,
+		cl_tls_extension_signature_algorithms = 13,
+		cl_tls_extension_session_ticket = 35
 	};
 
 	enum TLS_MACAlgorithm
@@ -81,6 +111,7 @@ namespace uicore
 		cl_tls_handshake_hello_request = 0,
 		cl_tls_handshake_client_hello = 1,
 		cl_tls_handshake_server_hello = 2,
+		cl_tls_handshake_new_session_ticket = 4,
 		cl_tls_handshake_certificate = 11,
 		cl_tls_handshake_server_key_exchange = 12,
 		cl_tls_handshake_certificate_request = 13,
@@ -166,6 +197,8 @@ namespace uicore
 		void reset()
 		{
 			entity = cl_tls_connection_client;
+			key_exchange_algorithm = cl_tls_key_exchange_rsa;
+			prf_algorithm = cl_tls_prf_md5_sha1;
 			bulk_cipher_algorithm = cl_tls_cipher_algorithm_null;
 			cipher_type = cl_tls_cipher_type_block;
 			key_size = 0;
@@ -192,6 +225,8 @@ namespace uicore
 		}
 
 		TLS_ConnectionEnd entity;
+		TLS_KeyExchangeAlgorithm key_exchange_algorithm;
+		TLS_PRFAlgorithm prf_algorithm;
 		TLS_BulkCipherAlgorithm bulk_cipher_algorithm;
 		TLS_CipherType cipher_type;
 		uint8_t key_size;
@@ -224,6 +259,7 @@ namespace uicore
 		cl_tls_state_send_client_hello,
 		cl_tls_state_receive_server_hello,
 		cl_tls_state_receive_certificate,
+		cl_tls_state_receive_server_key_exchange,
 		cl_tls_state_receive_server_hello_done,
 		cl_tls_state_send_client_key_exchange,
 		cl_tls_state_send_change_cipher_spec,
@@ -237,9 +273,12 @@ namespace uicore
 	class TLSClient_Impl : public TLSClient
 	{
 	public:
-		TLSClient_Impl();
+		TLSClient_Impl(const std::string &server_name, const std::shared_ptr<TLSSessionCache> &session_cache);
 		~TLSClient_Impl();
 
+		bool is_connected() const override { return conversation_state == cl_tls_state_connected; }
+		bool is_session_resumed() const override { return is_resumed; }
+
 		const void *decrypted_data() const override;
 		int decrypted_data_available() const override;
 
@@ -252,22 +291,37 @@ namespace uicore
 		void decrypted_data_consumed(int size) override;
 		void encrypted_data_consumed(int size) override;
 
+		int record_prefix_size() const override;
+		int record_suffix_size() const override;
+		int encrypt_record(void *buffer, int data_size) override;
+		int decrypt_record(void *buffer, int size, void *&out_data, int &out_size) override;
+
 	private:
 		void progress_conversation();
 
 		bool can_send_record() const;
-		void send_record(void *data_ptr, unsigned int data_size);	// !< Note "data_ptr" may be written to
+		void send_record(const void *data_ptr, unsigned int data_size);
+		void send_record(TLS_ContentType content_type, const void *data_ptr, unsigned int data_size);
+
+		// Encrypts the record in place. The data is placed send_prefix_size() bytes into record_ptr. Returns the record size
+		int seal_record(unsigned char *record_ptr, TLS_ContentType content_type, unsigned int data_size);
+		int send_prefix_size() const;
+		int send_suffix_size() const;
 
 		bool receive_record();
 
-		void change_cipher_spec_data(std::shared_ptr<DataBuffer> record_plaintext);
-		void alert_data(std::shared_ptr<DataBuffer> record_plaintext);
-		void handshake_data(std::shared_ptr<DataBuffer> record_plaintext);
-		void application_data(std::shared_ptr<DataBuffer> record_plaintext);
+		// Decrypts and handles the record at data_ptr in place. Returns the record size, or 0 if it is incomplete
+		int open_record(unsigned char *data_ptr, int data_size, unsigned char *&out_application_data, int &out_application_size);
+
+		void change_cipher_spec_data(const unsigned char *data, int size);
+		void alert_data(const unsigned char *data, int size);
+		void handshake_data(const unsigned char *data_ptr, int data_size);
+		void handshake_message(int msg_type, const void *message, int length);
 
 		void handshake_hello_request_received(const void *data, int size);
 		void handshake_client_hello_received(const void *data, int size);
 		void handshake_server_hello_received(const void *data, int size);
+		void handshake_new_session_ticket_received(const void *data, int size);
 		void handshake_certificate_received(const void *data, int size);
 		void handshake_server_key_exchange_received(const void *data, int size);
 		void handshake_certificate_request_received(const void *data, int size);
@@ -297,24 +351,42 @@ namespace uicore
 		void set_compression_methods(unsigned char *dest_ptr) const;
 		int get_cipher_suites_length() const;
 		void set_cipher_suites(unsigned char *dest_ptr) const;
+		int get_extensions_length() const;
+		void set_extensions(unsigned char *dest_ptr) const;
 		void select_cipher_suite(uint8_t value1, uint8_t value2);
 		void select_compression_method(uint8_t value);
 		void inspect_certificate(std::vector<unsigned char> &cert);
 		void set_server_public_key();
+		void verify_server_signature(int hash_algorithm, const void *signed_params, int signed_params_size, const void *signature, int signature_size);
+		void create_master_secret(const std::shared_ptr<Secret> &pre_master_secret);
+		void create_key_block();
+		void store_session();
+		void forget_session();
 		void PRF(void *output_ptr, unsigned int output_size, const std::shared_ptr<Secret> &secret, const char *label_ptr, const std::shared_ptr<Secret> &seed_part1, const std::shared_ptr<Secret> &seed_part2);
 		void hash_handshake(const void *data_ptr, unsigned int data_size);
+		std::shared_ptr<Secret> calculate_handshake_hash() const;
+		bool is_tls12() const { return protocol.major > 3 || (protocol.major == 3 && protocol.minor >= 3); }
+		bool is_explicit_iv() const { return protocol.major > 3 || (protocol.major == 3 && protocol.minor >= 2); }
 
-		std::shared_ptr<DataBuffer> decrypt_record(TLS_Record &record, const std::shared_ptr<DataBuffer> &record_data);
+		std::shared_ptr<DataBuffer> decrypt_record_cbc(TLS_Record &record, const unsigned char *data_ptr, unsigned int data_size);
 		std::shared_ptr<DataBuffer> decrypt_data(const void *data_ptr, unsigned int data_size);
 
 		std::shared_ptr<Secret> calculate_mac(const void *data_ptr, unsigned int data_size, const void *data2_ptr, unsigned int data2_size, uint64_t sequence_number, const std::shared_ptr<Secret> &mac_secret);
 		std::shared_ptr<DataBuffer> encrypt_data(const void *data_ptr, unsigned int data_size, const void *mac_ptr, unsigned int mac_size);
 
-		static const unsigned int max_record_length = 2 << 14;	// RFC 2246 (6.2.1)
+		int encrypt_record_cbc(unsigned char *record_ptr, unsigned int data_size);
+		int encrypt_record_aead(unsigned char *record_ptr, unsigned int data_size);
+		int decrypt_record_aead(TLS_Record &record, unsigned char *data_ptr, int data_size);
+		void set_aead_nonce_and_additional_data(unsigned char nonce[AES_GCM::iv_size], unsigned char additional_data[13], const std::shared_ptr<Secret> &write_iv, const unsigned char *explicit_nonce, uint64_t sequence_number, const TLS_Record &record, unsigned int data_size) const;
+
+		static const unsigned int max_record_length = 1 << 14;	// RFC 2246 (6.2.1)
+		static const unsigned int max_ciphertext_length = (1 << 14) + 2048;	// RFC 2246 (6.2.3)
 		static const unsigned int max_handshake_length = 2 << 24;	// RFC 2246 (implied by length in7.4)
 
 		static const int desired_buffer_size = 64 * 1024;
 
+		static const int aead_explicit_nonce_size = 8;	// RFC 5288 (3)
+
 		std::shared_ptr<DataBuffer> recv_in_data = DataBuffer::create(0);
 		int recv_in_data_read_pos = 0;
 
@@ -332,22 +404,37 @@ namespace uicore
 
 		TLS_ConversationState conversation_state = cl_tls_state_send_client_hello;
 
-		std::shared_ptr<DataBuffer> record_data_buffer = DataBuffer::create(0); // local variable of receive_record(). Placed here to avoid allocating memory each time a record is processed
-
 		TLS_SecurityParameters security_parameters;
 		TLS_ProtocolVersion protocol;
+		TLS_ProtocolVersion client_hello_version;
 
 		std::shared_ptr<DataBuffer> server_public_exponent = DataBuffer::create(0);
 		std::shared_ptr<DataBuffer> server_public_modulus = DataBuffer::create(0);
 
+		std::shared_ptr<Secret> ecdhe_private_key;
+		std::shared_ptr<DataBuffer> server_ecdhe_public_key = DataBuffer::create(0);
+
+		AES_GCM client_write_gcm;
+		AES_GCM server_write_gcm;
+
 		bool is_protocol_chosen = false;	// Set by the server hello response
 
+		std::string server_name;
+		std::shared_ptr<TLSSessionCacheImpl> session_cache;
+		TLS_CachedSession cached_session;	// Session offered in the client hello, if offered_session_id is set
+		std::vector<unsigned char> offered_session_id;
+		std::vector<unsigned char> session_id;
+		std::vector<unsigned char> session_ticket;
+		uint8_t cipher_suite[2] = { 0, 0 };
+		bool is_resumed = false;
+		bool is_session_ticket_expected = false;
+		uint32_t session_ticket_lifetime = 0;	// Seconds, set when a new session ticket is received
+
 		std::shared_ptr<Random> m_Random = Random::create();
 
-		std::shared_ptr<MD5> client_handshake_md5_hash = MD5::create();
-		std::shared_ptr<SHA1> client_handshake_sha1_hash = SHA1::create();
-		std::shared_ptr<MD5> server_handshake_md5_hash = MD5::create();
-		std::shared_ptr<SHA1> server_handshake_sha1_hash = SHA1::create();
+		// All handshake messages sent and received so far. The hash function used for the finished messages
+		// is only known after the server hello, and TLS 1.2 uses a different one for each cipher suite.
+		std::shared_ptr<DataBuffer> handshake_messages = DataBuffer::create(0);
 
 		std::vector<X509> certificate_chain;
 	};
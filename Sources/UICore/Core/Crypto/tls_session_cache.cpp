@@ -0,0 +1,100 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Crypto/tls_session_cache.h"
+#include "tls_session_cache_impl.h"
+
+namespace uicore
+{
+	std::shared_ptr<TLSSessionCache> TLSSessionCache::create(int max_sessions)
+	{
+		return std::make_shared<TLSSessionCacheImpl>(max_sessions);
+	}
+
+	TLSSessionCacheImpl::TLSSessionCacheImpl(int max_sessions) : max_sessions(max_sessions)
+	{
+		if (max_sessions < 1)
+			throw Exception("TLSSessionCache must hold at least one session");
+	}
+
+	int TLSSessionCacheImpl::size() const
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return (int)sessions.size();
+	}
+
+	void TLSSessionCacheImpl::remove(const std::string &server_name)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		sessions.erase(server_name);
+	}
+
+	void TLSSessionCacheImpl::clear()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		sessions.clear();
+	}
+
+	bool TLSSessionCacheImpl::find(const std::string &server_name, TLS_CachedSession &out_session)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		auto it = sessions.find(server_name);
+		if (it == sessions.end())
+			return false;
+
+		if (it->second.session.expires <= time(nullptr))
+		{
+			sessions.erase(it);
+			return false;
+		}
+
+		it->second.last_used = ++use_counter;
+		out_session = it->second.session;
+		return true;
+	}
+
+	void TLSSessionCacheImpl::store(const std::string &server_name, const TLS_CachedSession &session)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (sessions.find(server_name) == sessions.end() && (int)sessions.size() >= max_sessions)
+		{
+			auto oldest = sessions.begin();
+			for (auto it = sessions.begin(); it != sessions.end(); ++it)
+			{
+				if (it->second.last_used < oldest->second.last_used)
+					oldest = it;
+			}
+			sessions.erase(oldest);
+		}
+
+		Entry &entry = sessions[server_name];
+		entry.session = session;
+		entry.last_used = ++use_counter;
+	}
+}
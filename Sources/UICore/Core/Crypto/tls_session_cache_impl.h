@@ -0,0 +1,83 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+#pragma once
+
+#include "UICore/Core/Crypto/tls_session_cache.h"
+#include "UICore/Core/Crypto/secret.h"
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace uicore
+{
+	/// \brief The state needed to resume a TLS session (RFC 5246 7.3, RFC 5077)
+	class TLS_CachedSession
+	{
+	public:
+		std::vector<unsigned char> session_id;
+		std::vector<unsigned char> session_ticket;
+		std::shared_ptr<Secret> master_secret;
+		uint8_t protocol_major = 0;
+		uint8_t protocol_minor = 0;
+		uint8_t cipher_suite[2] = { 0, 0 };
+		time_t expires = 0;
+	};
+
+	class TLSSessionCacheImpl : public TLSSessionCache
+	{
+	public:
+		TLSSessionCacheImpl(int max_sessions);
+
+		int size() const override;
+		void remove(const std::string &server_name) override;
+		void clear() override;
+
+		/// \brief Finds an unexpired session for the server
+		bool find(const std::string &server_name, TLS_CachedSession &out_session);
+
+		void store(const std::string &server_name, const TLS_CachedSession &session);
+
+		/// \brief Longest time a session is kept (RFC 5246 F.1.4 suggests an upper limit of 24 hours)
+		static const int max_session_lifetime = 24 * 60 * 60;
+
+	private:
+		class Entry
+		{
+		public:
+			TLS_CachedSession session;
+			uint64_t last_used = 0;
+		};
+
+		mutable std::mutex mutex;
+		std::map<std::string, Entry> sessions;
+		uint64_t use_counter = 0;
+		int max_sessions;
+	};
+}
@@ -0,0 +1,426 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "UICore/precomp.h"
+#include "x25519.h"
+
+namespace uicore
+{
+#if defined(__SIZEOF_INT128__)
+
+	// Field elements of GF(2^255 - 19) are stored in five unsigned limbs of 51 bits.
+	// Products are accumulated in 128 bit integers and 2^255 folds back in as a factor of 19.
+	typedef uint64_t X25519_FieldElement[5];
+	typedef unsigned __int128 X25519_Wide;
+
+	static const uint64_t x25519_limb_mask = (((uint64_t)1) << 51) - 1;
+
+	static void fe_set(X25519_FieldElement h, uint64_t value)
+	{
+		h[0] = value;
+		h[1] = h[2] = h[3] = h[4] = 0;
+	}
+
+	static void fe_copy(X25519_FieldElement h, const X25519_FieldElement f)
+	{
+		for (int i = 0; i < 5; i++)
+			h[i] = f[i];
+	}
+
+	static void fe_add(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		for (int i = 0; i < 5; i++)
+			h[i] = f[i] + g[i];
+	}
+
+	static void fe_sub(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		// Add 4p first so the limbs never go negative (g is at most 2^53 per limb)
+		h[0] = f[0] + 0x1fffffffffffb4 - g[0];
+		h[1] = f[1] + 0x1ffffffffffffc - g[1];
+		h[2] = f[2] + 0x1ffffffffffffc - g[2];
+		h[3] = f[3] + 0x1ffffffffffffc - g[3];
+		h[4] = f[4] + 0x1ffffffffffffc - g[4];
+	}
+
+	static void fe_carry(X25519_FieldElement h, X25519_Wide r0, X25519_Wide r1, X25519_Wide r2, X25519_Wide r3, X25519_Wide r4)
+	{
+		r1 += r0 >> 51;
+		r2 += r1 >> 51;
+		r3 += r2 >> 51;
+		r4 += r3 >> 51;
+		uint64_t carry = (uint64_t)(r4 >> 51);
+		h[0] = ((uint64_t)r0 & x25519_limb_mask) + carry * 19;
+		h[1] = (uint64_t)r1 & x25519_limb_mask;
+		h[2] = (uint64_t)r2 & x25519_limb_mask;
+		h[3] = (uint64_t)r3 & x25519_limb_mask;
+		h[4] = (uint64_t)r4 & x25519_limb_mask;
+		h[1] += h[0] >> 51;
+		h[0] &= x25519_limb_mask;
+	}
+
+	static void fe_mul(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		uint64_t g1_19 = g[1] * 19, g2_19 = g[2] * 19, g3_19 = g[3] * 19, g4_19 = g[4] * 19;
+
+		X25519_Wide r0 = (X25519_Wide)f[0] * g[0] + (X25519_Wide)f[1] * g4_19 + (X25519_Wide)f[2] * g3_19 + (X25519_Wide)f[3] * g2_19 + (X25519_Wide)f[4] * g1_19;
+		X25519_Wide r1 = (X25519_Wide)f[0] * g[1] + (X25519_Wide)f[1] * g[0] + (X25519_Wide)f[2] * g4_19 + (X25519_Wide)f[3] * g3_19 + (X25519_Wide)f[4] * g2_19;
+		X25519_Wide r2 = (X25519_Wide)f[0] * g[2] + (X25519_Wide)f[1] * g[1] + (X25519_Wide)f[2] * g[0] + (X25519_Wide)f[3] * g4_19 + (X25519_Wide)f[4] * g3_19;
+		X25519_Wide r3 = (X25519_Wide)f[0] * g[3] + (X25519_Wide)f[1] * g[2] + (X25519_Wide)f[2] * g[1] + (X25519_Wide)f[3] * g[0] + (X25519_Wide)f[4] * g4_19;
+		X25519_Wide r4 = (X25519_Wide)f[0] * g[4] + (X25519_Wide)f[1] * g[3] + (X25519_Wide)f[2] * g[2] + (X25519_Wide)f[3] * g[1] + (X25519_Wide)f[4] * g[0];
+
+		fe_carry(h, r0, r1, r2, r3, r4);
+	}
+
+	static void fe_mul_small(X25519_FieldElement h, const X25519_FieldElement f, uint32_t n)
+	{
+		fe_carry(h, (X25519_Wide)f[0] * n, (X25519_Wide)f[1] * n, (X25519_Wide)f[2] * n, (X25519_Wide)f[3] * n, (X25519_Wide)f[4] * n);
+	}
+
+	static void fe_cswap(X25519_FieldElement f, X25519_FieldElement g, uint64_t swap)
+	{
+		uint64_t mask = 0 - swap;
+		for (int i = 0; i < 5; i++)
+		{
+			uint64_t x = (f[i] ^ g[i]) & mask;
+			f[i] ^= x;
+			g[i] ^= x;
+		}
+	}
+
+	static uint64_t fe_load64(const unsigned char *s)
+	{
+		uint64_t value = 0;
+		for (int i = 7; i >= 0; i--)
+			value = (value << 8) | s[i];
+		return value;
+	}
+
+	static void fe_frombytes(X25519_FieldElement h, const unsigned char s[32])
+	{
+		uint64_t x0 = fe_load64(s), x1 = fe_load64(s + 8), x2 = fe_load64(s + 16), x3 = fe_load64(s + 24);
+		h[0] = x0 & x25519_limb_mask;
+		h[1] = ((x0 >> 51) | (x1 << 13)) & x25519_limb_mask;
+		h[2] = ((x1 >> 38) | (x2 << 26)) & x25519_limb_mask;
+		h[3] = ((x2 >> 25) | (x3 << 39)) & x25519_limb_mask;
+		h[4] = (x3 >> 12) & x25519_limb_mask;	// The top bit of the u-coordinate is masked off (RFC 7748, section 5)
+	}
+
+	static void fe_tobytes(unsigned char s[32], const X25519_FieldElement f)
+	{
+		X25519_FieldElement h;
+		fe_carry(h, f[0], f[1], f[2], f[3], f[4]);
+		fe_carry(h, h[0], h[1], h[2], h[3], h[4]);
+
+		// h is now below 2^255 + 19. Subtract p when h + 19 overflows 2^255, which maps h into [0, p).
+		uint64_t q = (h[0] + 19) >> 51;
+		for (int i = 1; i < 5; i++)
+			q = (h[i] + q) >> 51;
+
+		h[0] += 19 * q;
+		for (int i = 0; i < 4; i++)
+		{
+			h[i + 1] += h[i] >> 51;
+			h[i] &= x25519_limb_mask;
+		}
+		h[4] &= x25519_limb_mask;
+
+		uint64_t words[4] =
+		{
+			h[0] | (h[1] << 51),
+			(h[1] >> 13) | (h[2] << 38),
+			(h[2] >> 26) | (h[3] << 25),
+			(h[3] >> 39) | (h[4] << 12)
+		};
+		for (int i = 0; i < 32; i++)
+			s[i] = (unsigned char)(words[i >> 3] >> ((i & 7) * 8));
+	}
+
+#else
+
+	// Field elements of GF(2^255 - 19) are stored in ten signed limbs of alternating 26 and 25 bits.
+	// Limb i has weight 2^ceil(25.5 * i), so the field prime is folded back in as a factor of 19.
+	typedef int64_t X25519_FieldElement[10];
+
+	static const int x25519_limb_bits[10] = { 26, 25, 26, 25, 26, 25, 26, 25, 26, 25 };
+	static const int x25519_limb_shift[10] = { 0, 26, 51, 77, 102, 128, 153, 179, 204, 230 };
+
+	static void fe_set(X25519_FieldElement h, int64_t value)
+	{
+		h[0] = value;
+		for (int i = 1; i < 10; i++)
+			h[i] = 0;
+	}
+
+	static void fe_copy(X25519_FieldElement h, const X25519_FieldElement f)
+	{
+		for (int i = 0; i < 10; i++)
+			h[i] = f[i];
+	}
+
+	static void fe_carry(X25519_FieldElement h)
+	{
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (int i = 0; i < 9; i++)
+			{
+				int64_t carry = h[i] >> x25519_limb_bits[i];
+				h[i + 1] += carry;
+				h[i] -= carry << x25519_limb_bits[i];
+			}
+			int64_t carry = h[9] >> 25;
+			h[0] += carry * 19;
+			h[9] -= carry << 25;
+		}
+	}
+
+	static void fe_add(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		for (int i = 0; i < 10; i++)
+			h[i] = f[i] + g[i];
+	}
+
+	static void fe_sub(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		for (int i = 0; i < 10; i++)
+			h[i] = f[i] - g[i];
+	}
+
+	static void fe_mul(X25519_FieldElement h, const X25519_FieldElement f, const X25519_FieldElement g)
+	{
+		// Inputs are at most 27 bits per limb (a sum or difference of two carried elements).
+		// 38 * 2^54 * 10 stays below 2^63 so the products can be summed without intermediate carries.
+		int64_t g19[10];
+		for (int i = 0; i < 10; i++)
+			g19[i] = g[i] * 19;
+
+		int64_t t[10];
+		for (int k = 0; k < 10; k++)
+		{
+			int64_t sum = 0;
+			for (int i = 0; i < 10; i++)
+			{
+				int j = k - i;
+				int64_t product;
+				if (j >= 0)
+					product = f[i] * g[j];
+				else
+					product = f[i] * g19[j + 10];
+				if ((i & 1) && (j & 1))
+					product *= 2;
+				sum += product;
+			}
+			t[k] = sum;
+		}
+		for (int i = 0; i < 10; i++)
+			h[i] = t[i];
+		fe_carry(h);
+	}
+
+	static void fe_mul_small(X25519_FieldElement h, const X25519_FieldElement f, int32_t n)
+	{
+		for (int i = 0; i < 10; i++)
+			h[i] = f[i] * n;
+		fe_carry(h);
+	}
+
+	static void fe_cswap(X25519_FieldElement f, X25519_FieldElement g, int64_t swap)
+	{
+		int64_t mask = -swap;
+		for (int i = 0; i < 10; i++)
+		{
+			int64_t x = (f[i] ^ g[i]) & mask;
+			f[i] ^= x;
+			g[i] ^= x;
+		}
+	}
+
+	static void fe_frombytes(X25519_FieldElement h, const unsigned char s[32])
+	{
+		for (int i = 0; i < 10; i++)
+		{
+			int shift = x25519_limb_shift[i];
+			uint64_t value = 0;
+			for (int b = 0; b < 5 && (shift >> 3) + b < 32; b++)
+				value |= ((uint64_t)s[(shift >> 3) + b]) << (b * 8);
+			value >>= (shift & 7);
+			h[i] = (int64_t)(value & ((((uint64_t)1) << x25519_limb_bits[i]) - 1));
+		}
+		// The top bit of the u-coordinate is masked off (RFC 7748, section 5)
+	}
+
+	static void fe_tobytes(unsigned char s[32], const X25519_FieldElement f)
+	{
+		X25519_FieldElement h;
+		for (int i = 0; i < 10; i++)
+			h[i] = f[i];
+		fe_carry(h);
+
+		// q = floor(h / p) is -1, 0 or 1 for carried limbs, so subtracting q * p maps h into [0, p)
+		int64_t q = (19 * h[9] + (((int64_t)1) << 24)) >> 25;
+		for (int i = 0; i < 10; i++)
+			q = (h[i] + q) >> x25519_limb_bits[i];
+
+		h[0] += 19 * q;
+		for (int i = 0; i < 9; i++)
+		{
+			int64_t carry = h[i] >> x25519_limb_bits[i];
+			h[i + 1] += carry;
+			h[i] -= carry << x25519_limb_bits[i];
+		}
+		h[9] &= (1 << 25) - 1;
+
+		for (int i = 0; i < 32; i++)
+			s[i] = 0;
+		for (int i = 0; i < 10; i++)
+		{
+			uint64_t value = ((uint64_t)h[i]) << (x25519_limb_shift[i] & 7);
+			for (int b = 0; b < 5 && (x25519_limb_shift[i] >> 3) + b < 32; b++)
+				s[(x25519_limb_shift[i] >> 3) + b] |= (unsigned char)(value >> (b * 8));
+		}
+	}
+
+#endif
+
+	static void fe_invert(X25519_FieldElement out, const X25519_FieldElement z)
+	{
+		// z^(p - 2) where p - 2 = 2^255 - 21
+		X25519_FieldElement z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+		int i;
+
+		fe_mul(z2, z, z);
+		fe_mul(t, z2, z2);
+		fe_mul(t, t, t);
+		fe_mul(z9, t, z);
+		fe_mul(z11, z9, z2);
+		fe_mul(t, z11, z11);
+		fe_mul(z2_5_0, t, z9);
+
+		fe_mul(t, z2_5_0, z2_5_0);
+		for (i = 1; i < 5; i++) fe_mul(t, t, t);
+		fe_mul(z2_10_0, t, z2_5_0);
+
+		fe_mul(t, z2_10_0, z2_10_0);
+		for (i = 1; i < 10; i++) fe_mul(t, t, t);
+		fe_mul(z2_20_0, t, z2_10_0);
+
+		fe_mul(t, z2_20_0, z2_20_0);
+		for (i = 1; i < 20; i++) fe_mul(t, t, t);
+		fe_mul(t, t, z2_20_0);
+
+		fe_mul(t, t, t);
+		for (i = 1; i < 10; i++) fe_mul(t, t, t);
+		fe_mul(z2_50_0, t, z2_10_0);
+
+		fe_mul(t, z2_50_0, z2_50_0);
+		for (i = 1; i < 50; i++) fe_mul(t, t, t);
+		fe_mul(z2_100_0, t, z2_50_0);
+
+		fe_mul(t, z2_100_0, z2_100_0);
+		for (i = 1; i < 100; i++) fe_mul(t, t, t);
+		fe_mul(t, t, z2_100_0);
+
+		fe_mul(t, t, t);
+		for (i = 1; i < 50; i++) fe_mul(t, t, t);
+		fe_mul(t, t, z2_50_0);
+
+		fe_mul(t, t, t);
+		for (i = 1; i < 5; i++) fe_mul(t, t, t);
+		fe_mul(out, t, z11);
+	}
+
+	void X25519::scalar_mult(unsigned char out_point[key_size], const unsigned char scalar[key_size], const unsigned char point[key_size])
+	{
+		unsigned char e[key_size];
+		for (int i = 0; i < key_size; i++)
+			e[i] = scalar[i];
+		e[0] &= 248;
+		e[31] &= 127;
+		e[31] |= 64;
+
+		X25519_FieldElement x1, x2, z2, x3, z3, a, aa, b, bb, c, d, da, cb, ee, t;
+		fe_frombytes(x1, point);
+		fe_set(x2, 1);
+		fe_set(z2, 0);
+		fe_copy(x3, x1);
+		fe_set(z3, 1);
+
+		// Montgomery ladder (RFC 7748, section 5)
+		uint32_t swap = 0;
+		for (int pos = 254; pos >= 0; pos--)
+		{
+			uint32_t bit = (e[pos >> 3] >> (pos & 7)) & 1;
+			swap ^= bit;
+			fe_cswap(x2, x3, swap);
+			fe_cswap(z2, z3, swap);
+			swap = bit;
+
+			fe_add(a, x2, z2);
+			fe_mul(aa, a, a);
+			fe_sub(b, x2, z2);
+			fe_mul(bb, b, b);
+			fe_sub(ee, aa, bb);
+			fe_add(c, x3, z3);
+			fe_sub(d, x3, z3);
+			fe_mul(da, d, a);
+			fe_mul(cb, c, b);
+			fe_add(t, da, cb);
+			fe_mul(x3, t, t);
+			fe_sub(t, da, cb);
+			fe_mul(t, t, t);
+			fe_mul(z3, x1, t);
+			fe_mul(x2, aa, bb);
+			fe_mul_small(t, ee, 121665);
+			fe_add(t, aa, t);
+			fe_mul(z2, ee, t);
+		}
+		fe_cswap(x2, x3, swap);
+		fe_cswap(z2, z3, swap);
+
+		fe_invert(z2, z2);
+		fe_mul(x2, x2, z2);
+		fe_tobytes(out_point, x2);
+	}
+
+	void X25519::public_key(unsigned char out_public_key[key_size], const unsigned char private_key[key_size])
+	{
+		unsigned char base_point[key_size] = { 9 };
+		scalar_mult(out_public_key, private_key, base_point);
+	}
+
+	bool X25519::shared_secret(unsigned char out_secret[key_size], const unsigned char private_key[key_size], const unsigned char peer_public_key[key_size])
+	{
+		scalar_mult(out_secret, private_key, peer_public_key);
+
+		unsigned char zero = 0;
+		for (int i = 0; i < key_size; i++)
+			zero |= out_secret[i];
+		return zero != 0;
+	}
+}
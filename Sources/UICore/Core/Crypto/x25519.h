@@ -0,0 +1,53 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace uicore
+{
+	/// \brief Elliptic curve Diffie-Hellman on Curve25519 (RFC 7748)
+	class X25519
+	{
+	public:
+		static const int key_size = 32;
+
+		/// \brief Calculates the public key for a 32 byte private key
+		static void public_key(unsigned char out_public_key[key_size], const unsigned char private_key[key_size]);
+
+		/// \brief Calculates the shared secret for our private key and the peer's public key
+		///
+		/// Returns false if the result is all zeros (the peer sent a small order point)
+		static bool shared_secret(unsigned char out_secret[key_size], const unsigned char private_key[key_size], const unsigned char peer_public_key[key_size]);
+
+		/// \brief Multiplies the u-coordinate point by the (clamped) scalar
+		static void scalar_mult(unsigned char out_point[key_size], const unsigned char scalar[key_size], const unsigned char point[key_size]);
+	};
+}
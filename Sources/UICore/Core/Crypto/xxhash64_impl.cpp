@@ -0,0 +1,213 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#include "UICore/precomp.h"
+#include "xxhash64_impl.h"
+#include <cstring>
+
+namespace uicore
+{
+	namespace
+	{
+		const uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+		const uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+		const uint64_t prime3 = 0x165667B19E3779F9ULL;
+		const uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+		const uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+		inline uint64_t rotate_left(uint64_t value, int shift)
+		{
+			return (value << shift) | (value >> (64 - shift));
+		}
+
+		inline uint64_t read_uint64(const unsigned char *data)
+		{
+			return (uint64_t)data[0] | ((uint64_t)data[1] << 8) | ((uint64_t)data[2] << 16) | ((uint64_t)data[3] << 24) |
+				((uint64_t)data[4] << 32) | ((uint64_t)data[5] << 40) | ((uint64_t)data[6] << 48) | ((uint64_t)data[7] << 56);
+		}
+
+		inline uint32_t read_uint32(const unsigned char *data)
+		{
+			return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+		}
+
+		inline uint64_t mix_round(uint64_t accumulator, uint64_t input)
+		{
+			accumulator += input * prime2;
+			accumulator = rotate_left(accumulator, 31);
+			return accumulator * prime1;
+		}
+
+		inline uint64_t merge_round(uint64_t hash, uint64_t accumulator)
+		{
+			hash ^= mix_round(0, accumulator);
+			return hash * prime1 + prime4;
+		}
+
+		void init_accumulators(uint64_t accumulators[4], uint64_t seed)
+		{
+			accumulators[0] = seed + prime1 + prime2;
+			accumulators[1] = seed + prime2;
+			accumulators[2] = seed;
+			accumulators[3] = seed - prime1;
+		}
+
+		// Four independent lanes, so the multiplies of consecutive 8 byte words overlap
+		void process_stripes(uint64_t accumulators[4], const unsigned char *data, size_t num_stripes)
+		{
+			uint64_t v1 = accumulators[0];
+			uint64_t v2 = accumulators[1];
+			uint64_t v3 = accumulators[2];
+			uint64_t v4 = accumulators[3];
+			for (size_t i = 0; i < num_stripes; i++, data += 32)
+			{
+				v1 = mix_round(v1, read_uint64(data));
+				v2 = mix_round(v2, read_uint64(data + 8));
+				v3 = mix_round(v3, read_uint64(data + 16));
+				v4 = mix_round(v4, read_uint64(data + 24));
+			}
+			accumulators[0] = v1;
+			accumulators[1] = v2;
+			accumulators[2] = v3;
+			accumulators[3] = v4;
+		}
+
+		uint64_t converge(const uint64_t accumulators[4])
+		{
+			uint64_t hash = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7) + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+			for (int i = 0; i < 4; i++)
+				hash = merge_round(hash, accumulators[i]);
+			return hash;
+		}
+
+		// Mixes in the last 0 to 31 bytes and avalanches the result
+		uint64_t finalize(uint64_t hash, const unsigned char *data, size_t size)
+		{
+			for (; size >= 8; size -= 8, data += 8)
+			{
+				hash ^= mix_round(0, read_uint64(data));
+				hash = rotate_left(hash, 27) * prime1 + prime4;
+			}
+
+			if (size >= 4)
+			{
+				hash ^= read_uint32(data) * prime1;
+				hash = rotate_left(hash, 23) * prime2 + prime3;
+				data += 4;
+				size -= 4;
+			}
+
+			for (; size > 0; size--)
+			{
+				hash ^= *(data++) * prime5;
+				hash = rotate_left(hash, 11) * prime1;
+			}
+
+			hash ^= hash >> 33;
+			hash *= prime2;
+			hash ^= hash >> 29;
+			hash *= prime3;
+			hash ^= hash >> 32;
+			return hash;
+		}
+	}
+
+	XXHash64_Impl::XXHash64_Impl(uint64_t seed) : seed(seed)
+	{
+		reset();
+	}
+
+	void XXHash64_Impl::reset()
+	{
+		init_accumulators(accumulators, seed);
+		total_length = 0;
+		buffer_size = 0;
+	}
+
+	void XXHash64_Impl::add(const void *_data, int size)
+	{
+		const unsigned char *data = (const unsigned char *)_data;
+		total_length += size;
+
+		if (buffer_size + size < stripe_size)
+		{
+			memcpy(buffer + buffer_size, data, size);
+			buffer_size += size;
+			return;
+		}
+
+		if (buffer_size > 0)
+		{
+			int fill = stripe_size - buffer_size;
+			memcpy(buffer + buffer_size, data, fill);
+			process_stripes(accumulators, buffer, 1);
+			data += fill;
+			size -= fill;
+			buffer_size = 0;
+		}
+
+		size_t num_stripes = size / stripe_size;
+		process_stripes(accumulators, data, num_stripes);
+		data += num_stripes * stripe_size;
+		size -= num_stripes * stripe_size;
+
+		memcpy(buffer, data, size);
+		buffer_size = size;
+	}
+
+	uint64_t XXHash64_Impl::hash() const
+	{
+		uint64_t hash = total_length >= stripe_size ? converge(accumulators) : seed + prime5;
+		hash += total_length;
+		return finalize(hash, buffer, buffer_size);
+	}
+
+	uint64_t XXHash64_Impl::calculate(const void *_data, size_t size, uint64_t seed)
+	{
+		const unsigned char *data = (const unsigned char *)_data;
+
+		uint64_t hash;
+		if (size >= stripe_size)
+		{
+			uint64_t accumulators[4];
+			init_accumulators(accumulators, seed);
+			size_t num_stripes = size / stripe_size;
+			process_stripes(accumulators, data, num_stripes);
+			hash = converge(accumulators);
+		}
+		else
+		{
+			hash = seed + prime5;
+		}
+		hash += size;
+
+		size_t tail = size % stripe_size;
+		return finalize(hash, data + size - tail, tail);
+	}
+}
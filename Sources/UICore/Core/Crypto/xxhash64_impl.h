@@ -0,0 +1,59 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+*/
+
+
+#pragma once
+
+#include "UICore/Core/Crypto/xxhash64.h"
+#include "UICore/Core/System/databuffer.h"
+
+namespace uicore
+{
+	class XXHash64_Impl : public XXHash64
+	{
+	public:
+		XXHash64_Impl(uint64_t seed);
+
+		uint64_t hash() const override;
+		void reset() override;
+		void add(const void *data, int size) override;
+		void add(const std::shared_ptr<DataBuffer> &data) override { add(data->data(), data->size()); }
+
+		/// \brief Hashes a single buffer
+		static uint64_t calculate(const void *data, size_t size, uint64_t seed);
+
+	private:
+		static const int stripe_size = 32;
+
+		uint64_t seed;
+		uint64_t accumulators[4];
+		uint64_t total_length = 0;
+		unsigned char buffer[stripe_size];
+		int buffer_size = 0;
+	};
+}
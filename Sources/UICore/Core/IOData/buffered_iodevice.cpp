@@ -0,0 +1,217 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
+#include "UICore/Core/System/exception.h"
+#include <algorithm>
+#include <vector>
+#include <string.h>
+
+#undef min
+#undef max
+
+namespace uicore
+{
+	class BufferedIODeviceImpl : public BufferedIODevice
+	{
+	public:
+		BufferedIODeviceImpl(const std::shared_ptr<IODevice> &device, int buffer_size) : _device(device), buffer(buffer_size)
+		{
+			_pos = _device->seek_from_current(0);
+		}
+
+		~BufferedIODeviceImpl()
+		{
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+			}
+		}
+
+		const std::shared_ptr<IODevice> &device() const override { return _device; }
+		int buffer_size() const override { return (int)buffer.size(); }
+
+		long long size() const override
+		{
+			const_cast<BufferedIODeviceImpl*>(this)->flush_write();
+			return _device->size();
+		}
+
+		long long seek(long long position) override
+		{
+			// Stay inside the read-ahead buffer if possible
+			long long buffer_start = _pos - read_pos;
+			if (read_end > 0 && position >= buffer_start && position <= buffer_start + read_end)
+			{
+				read_pos = (int)(position - buffer_start);
+				_pos = position;
+				return _pos;
+			}
+
+			flush();
+			_pos = _device->seek(position);
+			return _pos;
+		}
+
+		long long seek_from_current(long long offset) override
+		{
+			if (offset == 0)
+				return _pos;
+			return seek(_pos + offset);
+		}
+
+		long long seek_from_end(long long offset) override
+		{
+			flush();
+			_pos = _device->seek_from_end(offset);
+			return _pos;
+		}
+
+		int try_read(void *data, int size) override
+		{
+			if (size < 0)
+				throw Exception("Read failed");
+
+			flush_write();
+
+			char *dest = static_cast<char*>(data);
+			int bytes_read = 0;
+			while (bytes_read < size)
+			{
+				if (read_pos == read_end)
+				{
+					int remaining = size - bytes_read;
+					if (remaining >= (int)buffer.size())
+					{
+						// Large reads bypass the buffer
+						discard_read_ahead();
+						int result = _device->try_read(dest + bytes_read, remaining);
+						if (result <= 0)
+							break;
+						bytes_read += result;
+						_pos += result;
+						continue;
+					}
+
+					read_pos = 0;
+					read_end = std::max(_device->try_read(buffer.data(), (int)buffer.size()), 0);
+					if (read_end == 0)
+						break;
+				}
+
+				int amount = std::min(size - bytes_read, read_end - read_pos);
+				memcpy(dest + bytes_read, buffer.data() + read_pos, amount);
+				read_pos += amount;
+				bytes_read += amount;
+				_pos += amount;
+			}
+			return bytes_read;
+		}
+
+		void write(const void *data, int size) override
+		{
+			if (size < 0)
+				throw Exception("Write failed");
+
+			if (read_end > 0)
+			{
+				_device->seek(_pos);
+				discard_read_ahead();
+			}
+
+			if (write_length + size > (int)buffer.size())
+				flush_write();
+
+			if (size >= (int)buffer.size())
+			{
+				_device->write(data, size);
+			}
+			else
+			{
+				memcpy(buffer.data() + write_length, data, size);
+				write_length += size;
+			}
+			_pos += size;
+		}
+
+		void flush() override
+		{
+			flush_write();
+			if (read_end > 0)
+			{
+				if (read_pos != read_end)
+					_device->seek(_pos);
+				discard_read_ahead();
+			}
+		}
+
+		void close() override
+		{
+			flush();
+			_device->close();
+		}
+
+		BufferedIODeviceImpl(const BufferedIODeviceImpl &) = delete;
+		BufferedIODeviceImpl &operator=(const BufferedIODeviceImpl &) = delete;
+
+	private:
+		void flush_write()
+		{
+			if (write_length > 0)
+			{
+				int length = write_length;
+				write_length = 0;
+				_device->write(buffer.data(), length);
+			}
+		}
+
+		void discard_read_ahead()
+		{
+			read_pos = 0;
+			read_end = 0;
+		}
+
+		std::shared_ptr<IODevice> _device;
+		std::vector<char> buffer;
+		int read_pos = 0;
+		int read_end = 0;
+		int write_length = 0;
+		long long _pos = 0;
+	};
+
+	std::shared_ptr<BufferedIODevice> BufferedIODevice::create(const std::shared_ptr<IODevice> &device, int buffer_size)
+	{
+		if (buffer_size <= 0)
+			throw Exception("Invalid buffer size");
+		return std::make_shared<BufferedIODeviceImpl>(device, buffer_size);
+	}
+}
@@ -31,11 +31,13 @@
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/System/databuffer.h"
+#include "UICore/Core/Zip/resource_pack.h"
 #if !defined(WIN32)
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 #undef max
@@ -44,6 +46,16 @@
 
 namespace uicore
 {
+	// Below this size a single read is cheaper than setting up and tearing down a mapping
+	static const long long mapped_file_threshold = 64 * 1024;
+
+	static std::shared_ptr<DataBuffer> read_small_file(const std::shared_ptr<File> &file, size_t size)
+	{
+		auto buffer = DataBuffer::create(size);
+		if (size > 0)
+			file->read(buffer->data(), (int)size);
+		return buffer;
+	}
 
 #if defined(WIN32)
 
@@ -77,6 +89,58 @@ namespace uicore
 		HANDLE handle;
 	};
 
+	class MappedDataBuffer : public DataBuffer
+	{
+	public:
+		MappedDataBuffer(HANDLE mapping, void *view, size_t view_size) : mapping(mapping), view(view), view_size(view_size) { }
+		~MappedDataBuffer() { UnmapViewOfFile(view); CloseHandle(mapping); }
+
+		char *data() override { return static_cast<char*>(view); }
+		const char *data() const override { return static_cast<const char*>(view); }
+		size_t size() const override { return view_size; }
+		size_t capacity() const override { return view_size; }
+		void set_size(size_t size) override { if (size != view_size) throw Exception("Memory mapped buffers cannot be resized"); }
+		void set_capacity(size_t capacity) override { if (capacity > view_size) throw Exception("Memory mapped buffers cannot be resized"); }
+
+		std::shared_ptr<DataBuffer> copy(size_t pos, size_t size) override { return DataBuffer::create(data() + pos, size); }
+
+		MappedDataBuffer(const MappedDataBuffer &) = delete;
+		MappedDataBuffer &operator=(const MappedDataBuffer &) = delete;
+
+	private:
+		HANDLE mapping;
+		void *view;
+		size_t view_size;
+	};
+
+	std::shared_ptr<DataBuffer> File::open_mapped(const std::string &filename)
+	{
+		auto packed = ResourcePack::read_mounted(filename);
+		if (packed)
+			return packed;
+
+		auto file = std::static_pointer_cast<FileImpl>(open_existing(filename));
+
+		long long size = file->size();
+		if (size >= (long long)(std::numeric_limits<size_t>::max() / 2))
+			throw Exception("File too large!");
+		else if (size < mapped_file_threshold)
+			return read_small_file(file, (size_t)size);
+
+		HANDLE mapping = CreateFileMapping(file->handle, 0, PAGE_WRITECOPY, 0, 0, 0);
+		if (mapping == 0)
+			throw Exception("Could not map file: " + filename);
+
+		void *view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+		if (view == 0)
+		{
+			CloseHandle(mapping);
+			throw Exception("Could not map file: " + filename);
+		}
+
+		return std::make_shared<MappedDataBuffer>(mapping, view, (size_t)size);
+	}
+
 	std::shared_ptr<File> File::open_existing(const std::string &filename, FileAccess access)
 	{
 		DWORD access_flags = 0;
@@ -239,6 +303,51 @@ namespace uicore
 		int handle;
 	};
 
+	class MappedDataBuffer : public DataBuffer
+	{
+	public:
+		MappedDataBuffer(void *view, size_t view_size) : view(view), view_size(view_size) { }
+		~MappedDataBuffer() { munmap(view, view_size); }
+
+		char *data() override { return static_cast<char*>(view); }
+		const char *data() const override { return static_cast<const char*>(view); }
+		size_t size() const override { return view_size; }
+		size_t capacity() const override { return view_size; }
+		void set_size(size_t size) override { if (size != view_size) throw Exception("Memory mapped buffers cannot be resized"); }
+		void set_capacity(size_t capacity) override { if (capacity > view_size) throw Exception("Memory mapped buffers cannot be resized"); }
+
+		std::shared_ptr<DataBuffer> copy(size_t pos, size_t size) override { return DataBuffer::create(data() + pos, size); }
+
+		MappedDataBuffer(const MappedDataBuffer &) = delete;
+		MappedDataBuffer &operator=(const MappedDataBuffer &) = delete;
+
+	private:
+		void *view;
+		size_t view_size;
+	};
+
+	std::shared_ptr<DataBuffer> File::open_mapped(const std::string &filename)
+	{
+		auto packed = ResourcePack::read_mounted(filename);
+		if (packed)
+			return packed;
+
+		auto file = std::static_pointer_cast<FileImpl>(open_existing(filename));
+
+		long long size = file->size();
+		if (size >= (long long)(std::numeric_limits<size_t>::max() / 2))
+			throw Exception("File too large!");
+		else if (size < mapped_file_threshold)
+			return read_small_file(file, (size_t)size);
+
+		// Private mapping: pages are shared with the page cache until written to, writes never reach the file
+		void *view = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file->handle, 0);
+		if (view == MAP_FAILED)
+			throw Exception("Could not map file: " + filename);
+
+		return std::make_shared<MappedDataBuffer>(view, (size_t)size);
+	}
+
 	std::shared_ptr<File> File::open_existing(const std::string &filename, FileAccess access)
 	{
 		int access_flags = 0;
@@ -367,6 +476,10 @@ namespace uicore
 
 	std::string File::read_all_text(const std::string &filename)
 	{
+		auto packed = ResourcePack::read_mounted(filename);
+		if (packed)
+			return std::string(packed->data(), packed->size());
+
 		auto file = FileImpl::open_existing(filename);
 
 		if (file->size() >= std::numeric_limits<size_t>::max() / 2)
@@ -389,6 +502,10 @@ namespace uicore
 
 	std::shared_ptr<DataBuffer> File::read_all_bytes(const std::string &filename)
 	{
+		auto packed = ResourcePack::read_mounted(filename);
+		if (packed)
+			return packed->copy(0, packed->size()); // Callers may resize the returned buffer
+
 		auto file = FileImpl::open_existing(filename);
 
 		if (file->size() >= std::numeric_limits<size_t>::max() / 2)
@@ -445,6 +562,9 @@ namespace uicore
 
 	bool File::exists(const std::string &filename)
 	{
+		if (ResourcePack::exists_mounted(filename))
+			return true;
+
 #ifdef WIN32
 		HANDLE file = CreateFile(Text::to_utf16(filename).c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_EXISTING, 0, 0);
 		if (file != INVALID_HANDLE_VALUE)
@@ -453,6 +573,24 @@ namespace uicore
 #else
 		struct stat stFileInfo;
 		return (stat(filename.c_str(), &stFileInfo) == 0);
+#endif
+	}
+
+	long long File::last_write_time(const std::string &filename)
+	{
+#ifdef WIN32
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (GetFileAttributesEx(Text::to_utf16(filename).c_str(), GetFileExInfoStandard, &attributes) == FALSE)
+			throw Exception("Unable to get file attributes");
+
+		// FILETIME counts 100 nanosecond intervals since 1601-01-01
+		long long filetime = (((long long)attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+		return filetime / 10000000LL - 11644473600LL;
+#else
+		struct stat stFileInfo;
+		if (stat(filename.c_str(), &stFileInfo) != 0)
+			throw Exception("Unable to get file attributes");
+		return stFileInfo.st_mtime;
 #endif
 	}
 }
@@ -49,7 +49,7 @@ namespace uicore
 
 		long long size() const override { return _buffer->size(); }
 
-		long long seek(long long pos) override { if (pos >= 0 && pos < size()) _pos = pos; return _pos; }
+		long long seek(long long pos) override { if (pos >= 0 && pos <= size()) _pos = pos; return _pos; }
 		long long seek_from_current(long long offset) override { return seek(_pos + offset); }
 		long long seek_from_end(long long offset) override { return seek(size() + offset); }
 
@@ -56,6 +56,393 @@ namespace uicore
 
 	std::vector<uint32_t> BigInt_Impl::prime_tab;
 
+	namespace
+	{
+		// Arithmetic kernels for multiplication and Montgomery exponentiation.
+		// These work on plain little-endian limb arrays in the widest type where
+		// the compiler offers a double-width product.
+#ifdef __SIZEOF_INT128__
+		typedef uint64_t big_limb;
+		typedef unsigned __int128 big_dlimb;
+#else
+		typedef uint32_t big_limb;
+		typedef uint64_t big_dlimb;
+#endif
+		const int big_limb_bits = 8 * sizeof(big_limb);
+		const unsigned int digits_per_limb = sizeof(big_limb) / sizeof(uint32_t);
+
+		// Below this many limbs the schoolbook loops are faster than Karatsuba
+		const unsigned int karatsuba_threshold = 32;
+
+		unsigned int digits_to_limbs(unsigned int num_digits)
+		{
+			return (num_digits + digits_per_limb - 1) / digits_per_limb;
+		}
+
+		void limbs_from_digits(big_limb *limbs, unsigned int num_limbs, const uint32_t *digits, unsigned int num_digits)
+		{
+			for (unsigned int i = 0; i < num_limbs; i++)
+			{
+				big_limb value = 0;
+				for (unsigned int j = 0; j < digits_per_limb; j++)
+				{
+					unsigned int index = i * digits_per_limb + j;
+					if (index < num_digits)
+						value |= ((big_limb)digits[index]) << (32 * j);
+				}
+				limbs[i] = value;
+			}
+		}
+
+		void limbs_to_digits(uint32_t *digits, const big_limb *limbs, unsigned int num_limbs)
+		{
+			for (unsigned int i = 0; i < num_limbs; i++)
+			{
+				for (unsigned int j = 0; j < digits_per_limb; j++)
+					digits[i * digits_per_limb + j] = (uint32_t)(limbs[i] >> (32 * j));
+			}
+		}
+
+		// r[0..rn) += a[0..an), returns the carry out. an must be <= rn
+		big_limb limbs_add_to(big_limb *r, unsigned int rn, const big_limb *a, unsigned int an)
+		{
+			big_limb carry = 0;
+			unsigned int i;
+			for (i = 0; i < an; i++)
+			{
+				big_dlimb s = (big_dlimb)r[i] + a[i] + carry;
+				r[i] = (big_limb)s;
+				carry = (big_limb)(s >> big_limb_bits);
+			}
+			for (; carry && i < rn; i++)
+			{
+				r[i]++;
+				carry = (r[i] == 0);
+			}
+			return carry;
+		}
+
+		// r[0..rn) -= a[0..an), returns the borrow out. an must be <= rn
+		big_limb limbs_sub_from(big_limb *r, unsigned int rn, const big_limb *a, unsigned int an)
+		{
+			big_limb borrow = 0;
+			unsigned int i;
+			for (i = 0; i < an; i++)
+			{
+				big_limb ri = r[i];
+				big_limb d = ri - a[i] - borrow;
+				borrow = (ri < a[i]) || (ri - a[i] < borrow);
+				r[i] = d;
+			}
+			for (; borrow && i < rn; i++)
+			{
+				borrow = (r[i] == 0);
+				r[i]--;
+			}
+			return borrow;
+		}
+
+		// r[0..n) += a[0..n) * b, returns the carry limb
+		big_limb limbs_mul_add_1(big_limb *r, const big_limb *a, unsigned int n, big_limb b)
+		{
+			big_limb carry = 0;
+			for (unsigned int i = 0; i < n; i++)
+			{
+				big_dlimb s = (big_dlimb)a[i] * b + r[i] + carry;
+				r[i] = (big_limb)s;
+				carry = (big_limb)(s >> big_limb_bits);
+			}
+			return carry;
+		}
+
+		int limbs_cmp(const big_limb *a, const big_limb *b, unsigned int n)
+		{
+			for (unsigned int i = n; i > 0; i--)
+			{
+				if (a[i - 1] != b[i - 1])
+					return a[i - 1] < b[i - 1] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		// r[0..na+nb) = a * b
+		void limbs_mul_basecase(big_limb *r, const big_limb *a, unsigned int na, const big_limb *b, unsigned int nb)
+		{
+			memset(r, 0, (na + nb) * sizeof(big_limb));
+			for (unsigned int i = 0; i < nb; i++)
+				r[i + na] = limbs_mul_add_1(r + i, a, na, b[i]);
+		}
+
+		// r[0..2n) = a * a
+		void limbs_sqr_basecase(big_limb *r, const big_limb *a, unsigned int n)
+		{
+			// Sum the products below the diagonal, double them and then add the squares
+			memset(r, 0, 2 * n * sizeof(big_limb));
+			for (unsigned int i = 0; i + 1 < n; i++)
+				r[i + n] = limbs_mul_add_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+
+			big_limb carry = 0;
+			for (unsigned int i = 0; i < 2 * n; i++)
+			{
+				big_limb next_carry = r[i] >> (big_limb_bits - 1);
+				r[i] = (r[i] << 1) | carry;
+				carry = next_carry;
+			}
+
+			carry = 0;
+			for (unsigned int i = 0; i < n; i++)
+			{
+				big_dlimb square = (big_dlimb)a[i] * a[i];
+				big_dlimb s = (big_dlimb)r[2 * i] + (big_limb)square + carry;
+				r[2 * i] = (big_limb)s;
+				s = (big_dlimb)r[2 * i + 1] + (big_limb)(square >> big_limb_bits) + (big_limb)(s >> big_limb_bits);
+				r[2 * i + 1] = (big_limb)s;
+				carry = (big_limb)(s >> big_limb_bits);
+			}
+		}
+
+		// Scratch space needed by limbs_mul_karatsuba and limbs_sqr_karatsuba
+		unsigned int karatsuba_scratch_size(unsigned int n)
+		{
+			unsigned int size = 0;
+			while (n >= karatsuba_threshold)
+			{
+				unsigned int low = n - n / 2;
+				size += 4 * low + 1;
+				n = low;
+			}
+			return size;
+		}
+
+		// r[0..2n) = a * b, where a and b both are n limbs
+		void limbs_mul_karatsuba(big_limb *r, const big_limb *a, const big_limb *b, unsigned int n, big_limb *scratch)
+		{
+			if (n < karatsuba_threshold)
+			{
+				limbs_mul_basecase(r, a, n, b, n);
+				return;
+			}
+
+			// a = a1 * B^low + a0, b = b1 * B^low + b0
+			unsigned int high = n / 2;
+			unsigned int low = n - high;
+
+			big_limb *sum_a = scratch;
+			big_limb *sum_b = sum_a + low;
+			big_limb *middle = sum_b + low;
+			big_limb *next_scratch = middle + 2 * low + 1;
+
+			// z0 = a0 * b0 and z2 = a1 * b1 are placed directly in the result
+			limbs_mul_karatsuba(r, a, b, low, next_scratch);
+			if (high == low)
+				limbs_mul_karatsuba(r + 2 * low, a + low, b + low, high, next_scratch);
+			else
+				limbs_mul_basecase(r + 2 * low, a + low, high, b + low, high);
+
+			// z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+			memcpy(sum_a, a, low * sizeof(big_limb));
+			memcpy(sum_b, b, low * sizeof(big_limb));
+			big_limb carry_a = limbs_add_to(sum_a, low, a + low, high);
+			big_limb carry_b = limbs_add_to(sum_b, low, b + low, high);
+
+			limbs_mul_karatsuba(middle, sum_a, sum_b, low, next_scratch);
+			middle[2 * low] = carry_a & carry_b;
+			if (carry_a)
+				limbs_add_to(middle + low, low + 1, sum_b, low);
+			if (carry_b)
+				limbs_add_to(middle + low, low + 1, sum_a, low);
+
+			limbs_sub_from(middle, 2 * low + 1, r, 2 * low);
+			limbs_sub_from(middle, 2 * low + 1, r + 2 * low, 2 * high);
+
+			// z1 < 2 * B^n, so any limbs beyond the result are zero
+			unsigned int result_limbs = 2 * n - low;
+			limbs_add_to(r + low, result_limbs, middle, std::min(2 * low + 1, result_limbs));
+		}
+
+		// r[0..2n) = a * a
+		void limbs_sqr_karatsuba(big_limb *r, const big_limb *a, unsigned int n, big_limb *scratch)
+		{
+			if (n < karatsuba_threshold)
+			{
+				limbs_sqr_basecase(r, a, n);
+				return;
+			}
+
+			unsigned int high = n / 2;
+			unsigned int low = n - high;
+
+			big_limb *sum_a = scratch;
+			big_limb *middle = sum_a + 2 * low;
+			big_limb *next_scratch = middle + 2 * low + 1;
+
+			limbs_sqr_karatsuba(r, a, low, next_scratch);
+			if (high == low)
+				limbs_sqr_karatsuba(r + 2 * low, a + low, high, next_scratch);
+			else
+				limbs_sqr_basecase(r + 2 * low, a + low, high);
+
+			memcpy(sum_a, a, low * sizeof(big_limb));
+			big_limb carry_a = limbs_add_to(sum_a, low, a + low, high);
+
+			limbs_sqr_karatsuba(middle, sum_a, low, next_scratch);
+			middle[2 * low] = carry_a;
+			if (carry_a)
+			{
+				limbs_add_to(middle + low, low + 1, sum_a, low);
+				limbs_add_to(middle + low, low + 1, sum_a, low);
+			}
+
+			limbs_sub_from(middle, 2 * low + 1, r, 2 * low);
+			limbs_sub_from(middle, 2 * low + 1, r + 2 * low, 2 * high);
+
+			unsigned int result_limbs = 2 * n - low;
+			limbs_add_to(r + low, result_limbs, middle, std::min(2 * low + 1, result_limbs));
+		}
+
+		// r[0..na+nb) = a * b
+		void limbs_mul(big_limb *r, const big_limb *a, unsigned int na, const big_limb *b, unsigned int nb)
+		{
+			if (na == nb && na >= karatsuba_threshold)
+			{
+				std::vector<big_limb> scratch(karatsuba_scratch_size(na));
+				limbs_mul_karatsuba(r, a, b, na, scratch.data());
+			}
+			else
+			{
+				limbs_mul_basecase(r, a, na, b, nb);
+			}
+		}
+
+		// Montgomery arithmetic modulo an odd m, with R = B^n
+		class BigMontgomery
+		{
+		public:
+			BigMontgomery(const big_limb *modulus, unsigned int n) : n(n), m(modulus, modulus + n), product(2 * n + 2), scratch(karatsuba_scratch_size(n))
+			{
+				// m_inv = -1/m[0] mod B, by Newton iteration (each step doubles the correct low bits)
+				big_limb inv = m[0];
+				for (int i = 0; i < 6; i++)
+					inv *= 2 - m[0] * inv;
+				m_inv = (big_limb)0 - inv;
+			}
+
+			// r = a * b / R (mod m), where a, b < m. r may alias a or b
+			void mul(big_limb *r, const big_limb *a, const big_limb *b)
+			{
+				if (n >= karatsuba_threshold)
+				{
+					limbs_mul_karatsuba(product.data(), a, b, n, scratch.data());
+					reduce(r);
+					return;
+				}
+
+				// Coarsely integrated operand scanning (CIOS)
+				big_limb *t = product.data();
+				memset(t, 0, (n + 2) * sizeof(big_limb));
+				for (unsigned int i = 0; i < n; i++)
+				{
+					big_dlimb s = (big_dlimb)t[n] + limbs_mul_add_1(t, a, n, b[i]);
+					t[n] = (big_limb)s;
+					t[n + 1] = (big_limb)(s >> big_limb_bits);
+
+					big_limb u = t[0] * m_inv;
+					s = (big_dlimb)u * m[0] + t[0];
+					big_limb carry = (big_limb)(s >> big_limb_bits);
+					for (unsigned int j = 1; j < n; j++)
+					{
+						s = (big_dlimb)u * m[j] + t[j] + carry;
+						t[j - 1] = (big_limb)s;
+						carry = (big_limb)(s >> big_limb_bits);
+					}
+					s = (big_dlimb)t[n] + carry;
+					t[n - 1] = (big_limb)s;
+					t[n] = t[n + 1] + (big_limb)(s >> big_limb_bits);
+				}
+				final_subtract(r, t, t[n]);
+			}
+
+			// r = a * a / R (mod m)
+			void sqr(big_limb *r, const big_limb *a)
+			{
+				limbs_sqr_karatsuba(product.data(), a, n, scratch.data());
+				reduce(r);
+			}
+
+			unsigned int size() const { return n; }
+
+		private:
+			// r = product / R (mod m) for a 2n limb product
+			void reduce(big_limb *r)
+			{
+				big_limb *t = product.data();
+				big_limb extra = 0;
+				for (unsigned int i = 0; i < n; i++)
+				{
+					big_limb u = t[i] * m_inv;
+					big_dlimb s = (big_dlimb)t[i + n] + limbs_mul_add_1(t + i, m.data(), n, u) + extra;
+					t[i + n] = (big_limb)s;
+					extra = (big_limb)(s >> big_limb_bits);
+				}
+				final_subtract(r, t + n, extra);
+			}
+
+			void final_subtract(big_limb *r, big_limb *t, big_limb overflow)
+			{
+				if (overflow || limbs_cmp(t, m.data(), n) >= 0)
+					limbs_sub_from(t, n, m.data(), n);
+				memcpy(r, t, n * sizeof(big_limb));
+			}
+
+			unsigned int n;
+			std::vector<big_limb> m;
+			big_limb m_inv;
+			std::vector<big_limb> product;
+			std::vector<big_limb> scratch;
+		};
+
+		// Fixed window size for an exponent of the given length
+		unsigned int exptmod_window_bits(unsigned int exponent_bits)
+		{
+			if (exponent_bits > 937)
+				return 6;
+			else if (exponent_bits > 306)
+				return 5;
+			else if (exponent_bits > 89)
+				return 4;
+			else if (exponent_bits > 22)
+				return 3;
+			else
+				return 1;
+		}
+		// r = table[index], reading every entry so the access pattern does not depend on index
+		void limbs_select(big_limb *r, const big_limb *table, unsigned int n, unsigned int count, unsigned int index)
+		{
+			memset(r, 0, n * sizeof(big_limb));
+			for (unsigned int i = 0; i < count; i++)
+			{
+				big_limb mask = (big_limb)0 - (big_limb)(i == index);
+				for (unsigned int j = 0; j < n; j++)
+					r[j] |= table[i * n + j] & mask;
+			}
+		}
+
+		// Bits [first_bit, first_bit + num_bits) of a digit array
+		unsigned int digits_window(const uint32_t *digits, unsigned int num_digits, unsigned int first_bit, unsigned int num_bits)
+		{
+			unsigned int value = 0;
+			for (unsigned int i = num_bits; i > 0; i--)
+			{
+				unsigned int bit = first_bit + i - 1;
+				unsigned int digit = bit / 32;
+				value <<= 1;
+				if (digit < num_digits)
+					value |= (digits[digit] >> (bit % 32)) & 1;
+			}
+			return value;
+		}
+	}
+
 	BigInt_Impl::BigInt_Impl(unsigned int prec) : digits_negative(false), digits_alloc(0), digits_used(0), digits(nullptr)
 	{
 		if (prec)
@@ -1019,9 +1406,11 @@ namespace uicore
 			if(rem_impl.internal_cmp(b) < 0)
 				break;
 
-			// Compute a guess for the next quotient digit
+			// Compute a guess for the next quotient digit.  The two leading
+			// digits are only used when the remainder is a digit longer than b,
+			// otherwise the guess could be off by the radix.
 			q = rem_impl.digits[rem_impl.digits_used - 1];
-			if(q <= b->digits[b->digits_used - 1] && rem_impl.digits_used > 1)
+			if(q <= b->digits[b->digits_used - 1] && rem_impl.digits_used > b->digits_used)
 				q = (q << num_bits_in_digit) | rem_impl.digits[rem_impl.digits_used - 2];
 
 			q /= (uint64_t) b->digits[b->digits_used - 1];
@@ -1314,45 +1703,23 @@ namespace uicore
 	void BigInt_Impl::internal_mul(const BigInt_Impl *b)
 	{
 		// Compute a = |a| * |b|
-		uint64_t   w, k = 0;
-		unsigned int   ix, jx, ua = digits_used, ub = b->digits_used;
-		uint32_t *pa;
-		const uint32_t *pb;
-		uint32_t *pt, *pbt;
+		unsigned int na = digits_to_limbs(digits_used), nb = digits_to_limbs(b->digits_used);
 
-		BigInt_Impl tmp_impl(ua + ub);
+		std::vector<big_limb> limbs(2 * (na + nb));
+		big_limb *la = limbs.data();
+		big_limb *lb = la + na;
+		big_limb *lr = lb + nb;
+		limbs_from_digits(la, na, digits, digits_used);
+		limbs_from_digits(lb, nb, b->digits, b->digits_used);
 
-		// This has the effect of left-padding with zeroes...
-		tmp_impl.digits_used = ua + ub;
+		limbs_mul(lr, la, na, lb, nb);
 
-		// We're going to need the base value each iteration
-		pbt = tmp_impl.digits;
-
-		// Outer loop:  Digits of b
-
-		pb = b->digits;
-		for(ix = 0; ix < ub; ++ix, ++pb)
-		{
-			if(*pb == 0)
-			continue;
-
-			// Inner product:  Digits of a
-			pa = digits;
-			for(jx = 0; jx < ua; ++jx, ++pa)
-			{
-				pt = pbt + ix + jx;
-				w = (uint64_t) *pb * (uint64_t) *pa + k + (uint64_t) *pt;
-				*pt = internal_accum(w);
-				k = internal_carryout(w);
-			}
-
-			pbt[ix + jx] = k;
-			k = 0;
-		}
+		BigInt_Impl tmp_impl((na + nb) * digits_per_limb);
+		limbs_to_digits(tmp_impl.digits, lr, na + nb);
+		tmp_impl.digits_used = (na + nb) * digits_per_limb;
 
 		tmp_impl.internal_clamp();
 		tmp_impl.internal_exch(this);
-
 	}
 
 	/*
@@ -1501,105 +1868,106 @@ namespace uicore
 	void BigInt_Impl::internal_sqr()
 	{
 		// Computes the square of a, in place.  This can be done more
-		// efficiently than a general multiplication, because many of the
-		// computation steps are redundant when squaring.  The inner product
-		// step is a bit more complicated, but we save a fair number of
-		// iterations of the multiplication loop.
+		// efficiently than a general multiplication, because the products
+		// below the diagonal are the same as those above it.
 
-		uint64_t  w, k = 0;
-		unsigned int  ix, jx, kx, used = digits_used;
-		uint32_t *pa1, *pa2, *pt, *pbt;
+		unsigned int n = digits_to_limbs(digits_used);
 
-		BigInt_Impl tmp_impl( 2 * used);
+		std::vector<big_limb> limbs(3 * n + karatsuba_scratch_size(n));
+		big_limb *la = limbs.data();
+		big_limb *lr = la + n;
+		limbs_from_digits(la, n, digits, digits_used);
 
-		// Left-pad with zeroes
-		tmp_impl.digits_used = 2 * used;
+		limbs_sqr_karatsuba(lr, la, n, lr + 2 * n);
 
-		// We need the base value each time through the loop
-		pbt = tmp_impl.digits;
+		BigInt_Impl tmp_impl(2 * n * digits_per_limb);
+		limbs_to_digits(tmp_impl.digits, lr, 2 * n);
+		tmp_impl.digits_used = 2 * n * digits_per_limb;
 
-		pa1 = digits;
-		for(ix = 0; ix < used; ++ix, ++pa1)
-		{
-			if(*pa1 == 0)
-				continue;
-
-			w = (uint64_t) tmp_impl.digits[ix + ix] + ( (uint64_t) *pa1 * (uint64_t) *pa1);
-
-			pbt[ix + ix] = internal_accum(w);
-			k = internal_carryout(w);
-
-
-			// The inner product is computed as:
-			// (C, S) = t[i,j] + 2 a[i] a[j] + C
-			// This can overflow what can be represented in an mp_word, and
-			// since C arithmetic does not provide any way to check for
-			// overflow, we have to check explicitly for overflow conditions
-			// before they happen.
-
-			for(jx = ix + 1, pa2 = digits + jx; jx < used; ++jx, ++pa2)
-			{
-				uint64_t  u = 0, v;
+		tmp_impl.internal_clamp();
+		tmp_impl.internal_exch(this);
+	}
 
-				// Store this in a temporary to avoid indirections later
-				pt = pbt + ix + jx;
+	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	{
+		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
+			throw Exception("Divide by zero");
 
-				// Compute the multiplicative step
-				w = (uint64_t) *pa1 * (uint64_t) *pa2;
+		if (m->isodd())
+			internal_exptmod_montgomery(b, m, c);
+		else
+			internal_exptmod_barrett(b, m, c);
+	}
 
-				// If w is more than half MP_WORD_MAX, the doubling will
-				// overflow, and we need to record a carry out into the next
-				// word
-				u = (w >> (num_bits_in_word - 1)) & 1;
+	void BigInt_Impl::internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	{
+		// Montgomery multiplication with a fixed window, scanning the exponent from the top.
+		// Every window costs the same squarings and one multiplication by a table entry.
 
-				// Double what we've got, overflow will be ignored as defined
-				// for C arithmetic (we've already noted if it is to occur)
-				w *= 2;
+		if (m->internal_cmp_d(1) == 0)
+		{
+			c->zero();
+			return;
+		}
 
-				// Compute the additive step
-				v = (uint64_t) *pt + k;
+		unsigned int n = digits_to_limbs(m->digits_used);
 
-				// If we do not already have an overflow carry, check to see
-				// if the addition will cause one, and set the carry out if so
-				u |= ((word_maximim_value - v) < w);
+		std::vector<big_limb> modulus(n);
+		limbs_from_digits(modulus.data(), n, m->digits, m->digits_used);
+		BigMontgomery mont(modulus.data(), n);
 
-				// Add in the rest, again ignoring overflow
-				w += v;
+		// R^2 mod m, used to convert values into Montgomery form
+		BigInt_Impl r2;
+		r2.set(1);
+		r2.internal_lshd(2 * n * digits_per_limb);
+		r2.mod(m, &r2);
 
-				// Set the i,j digit of the output
-				*pt = internal_accum(w);
+		BigInt_Impl x;
+		mod(m, &x);
 
-				// Save carry information for the next iteration of the loop.
-				// This is why k must be an mp_word, instead of an mp_digit
-				k = internal_carryout(w) | ( (uint64_t) u << num_bits_in_digit);
+		unsigned int exponent_bits = b->significant_bits();
+		unsigned int window_bits = exptmod_window_bits(exponent_bits);
+		unsigned int table_size = 1 << window_bits;
+		unsigned int num_windows = (exponent_bits + window_bits - 1) / window_bits;
 
-			}
+		std::vector<big_limb> limbs((table_size + 3) * n);
+		big_limb *table = limbs.data();
+		big_limb *acc = table + table_size * n;
+		big_limb *entry = acc + n;
+		big_limb *one = entry + n;
 
-			// Set the last digit in the cycle and reset the carry
-			k = (uint64_t) tmp_impl.digits[ix + jx] + k;
-			pbt[ix + jx] = internal_accum(k);
-			k = internal_carryout(k);
+		one[0] = 1;
+		limbs_from_digits(acc, n, r2.digits, r2.digits_used);
+		limbs_from_digits(entry, n, x.digits, x.digits_used);
 
-			// If we are carrying out, propagate the carry to the next digit
-			// in the output.  This may cascade, so we have to be somewhat
-			// circumspect -- but we will have enough precision in the output
-			// that we won't overflow
+		// table[i] = x^i * R mod m
+		mont.mul(table, acc, one);
+		mont.mul(table + n, entry, acc);
+		for (unsigned int i = 2; i < table_size; i++)
+			mont.mul(table + i * n, table + (i - 1) * n, table + n);
 
-			kx = 1;
-			while(k)
-			{
-				k = (uint64_t) pbt[ix + jx + kx] + 1;
-				pbt[ix + jx + kx] = internal_accum(k);
-				k = internal_carryout(k);
-				++kx;
-			}
+		unsigned int window = num_windows - 1;
+		limbs_select(acc, table, n, table_size, digits_window(b->digits, b->digits_used, window * window_bits, window_bits));
+		while (window > 0)
+		{
+			window--;
+			for (unsigned int i = 0; i < window_bits; i++)
+				mont.sqr(acc, acc);
+			limbs_select(entry, table, n, table_size, digits_window(b->digits, b->digits_used, window * window_bits, window_bits));
+			mont.mul(acc, acc, entry);
 		}
 
-		tmp_impl.internal_clamp();
-		tmp_impl.internal_exch(this);
+		// Leave Montgomery form
+		mont.mul(acc, acc, one);
+
+		BigInt_Impl s(n * digits_per_limb);
+		limbs_to_digits(s.digits, acc, n);
+		s.digits_used = n * digits_per_limb;
+		s.internal_clamp();
+		s.internal_exch(c);
 	}
 
-	void BigInt_Impl::exptmod(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
+	void BigInt_Impl::internal_exptmod_barrett(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const
 	{
 		BigInt_Impl s, mu;
 		uint32_t d;
@@ -1608,9 +1976,6 @@ namespace uicore
 		unsigned int  ub = b->digits_used;
 		unsigned int dig, bit;
 
-		if (b->cmp_z() < 0 || m->cmp_z() <= 0)
-			throw Exception("Divide by zero");
-
 		BigInt_Impl x(*this);
 
 		x.mod(m, &x);
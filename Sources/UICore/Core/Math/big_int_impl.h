@@ -168,6 +168,10 @@ namespace uicore
 		void internal_reduce(const BigInt_Impl *m, BigInt_Impl *mu);
 		void internal_sqr();
 
+		// Modular exponentiation for odd and even moduli, called by exptmod
+		void internal_exptmod_montgomery(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
+		void internal_exptmod_barrett(const BigInt_Impl *b, const BigInt_Impl *m, BigInt_Impl *c) const;
+
 		bool digits_negative;	// True if the value is negative
 		unsigned int digits_alloc;		// How many digits allocated
 		unsigned int digits_used;		// How many digits used
@@ -0,0 +1,134 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Math/hex_encoder.h"
+
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+#define UICORE_HEX_SIMD
+#include "UICore/Core/System/system.h"
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define UICORE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UICORE_TARGET_SSSE3
+#define UICORE_TARGET_AVX2
+#endif
+#endif
+
+namespace uicore
+{
+	namespace
+	{
+		const char hex_lowercase[17] = "0123456789abcdef";
+		const char hex_uppercase[17] = "0123456789ABCDEF";
+
+#ifdef UICORE_HEX_SIMD
+		// The nibbles are used as indices into a 16 byte table of digits, then interleaved high nibble first
+
+		// Encodes 16 bytes per iteration. Returns the number of bytes processed
+		UICORE_TARGET_SSSE3 int encode_ssse3(char *output, const unsigned char *input, int size, const char *digits)
+		{
+			const __m128i lut = _mm_loadu_si128((const __m128i*)digits);
+			const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+			int i;
+			for (i = 0; i + 16 <= size; i += 16)
+			{
+				__m128i in = _mm_loadu_si128((const __m128i*)(input + i));
+				__m128i high = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), nibble_mask));
+				__m128i low = _mm_shuffle_epi8(lut, _mm_and_si128(in, nibble_mask));
+				_mm_storeu_si128((__m128i*)(output + i * 2), _mm_unpacklo_epi8(high, low));
+				_mm_storeu_si128((__m128i*)(output + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+			}
+			return i;
+		}
+
+		// Encodes 32 bytes per iteration. Returns the number of bytes processed
+		UICORE_TARGET_AVX2 int encode_avx2(char *output, const unsigned char *input, int size, const char *digits)
+		{
+			const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)digits));
+			const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+
+			int i;
+			for (i = 0; i + 32 <= size; i += 32)
+			{
+				__m256i in = _mm256_loadu_si256((const __m256i*)(input + i));
+				__m256i high = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble_mask));
+				__m256i low = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, nibble_mask));
+
+				// The unpacks work within each 128 bit lane
+				__m256i first = _mm256_unpacklo_epi8(high, low);
+				__m256i second = _mm256_unpackhi_epi8(high, low);
+				_mm256_storeu_si256((__m256i*)(output + i * 2), _mm256_permute2x128_si256(first, second, 0x20));
+				_mm256_storeu_si256((__m256i*)(output + i * 2 + 32), _mm256_permute2x128_si256(first, second, 0x31));
+			}
+			return i;
+		}
+#endif
+	}
+
+	void HexEncoder::encode(const void *data, int size, char *out_text, bool uppercase)
+	{
+		const unsigned char *input = (const unsigned char *)data;
+		const char *digits = uppercase ? hex_uppercase : hex_lowercase;
+		int i = 0;
+
+#ifdef UICORE_HEX_SIMD
+		static bool cpu_has_ssse3 = System::detect_cpu_extension(System::ssse3);
+		static bool cpu_has_avx2 = System::detect_cpu_extension(System::avx2);
+		if (cpu_has_avx2)
+			i = encode_avx2(out_text, input, size, digits);
+		if (cpu_has_ssse3)
+			i += encode_ssse3(out_text + i * 2, input + i, size - i, digits);
+#endif
+
+		for (; i < size; i++)
+		{
+			out_text[i * 2 + 0] = digits[input[i] >> 4];
+			out_text[i * 2 + 1] = digits[input[i] & 0x0f];
+		}
+	}
+
+	std::string HexEncoder::encode(const void *data, int size, bool uppercase)
+	{
+		std::string result(size * 2, 0);
+		if (size > 0)
+			encode(data, size, &result[0], uppercase);
+		return result;
+	}
+
+	std::string HexEncoder::encode(const std::string &data, bool uppercase)
+	{
+		return encode(data.data(), data.length(), uppercase);
+	}
+}
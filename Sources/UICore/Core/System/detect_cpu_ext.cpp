@@ -54,6 +54,9 @@ namespace uicore
 
 #define __cpuid(out, infoType)\
 	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
+
+#define __cpuidex(out, infoType, subType)\
+	asm("cpuid": "=a" ((out)[0]), "=b" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
 #else
 
 #define __cpuid(out, infoType) \
@@ -63,10 +66,34 @@ namespace uicore
 			"popl %%ebx" \
 		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType));
 
+#define __cpuidex(out, infoType, subType) \
+	asm volatile(	"pushl %%ebx \n" \
+			"cpuid \n" \
+			"movl %%ebx, %1 \n" \
+			"popl %%ebx" \
+		: "=a" ((out)[0]), "=r" ((out)[1]), "=c" ((out)[2]), "=d" ((out)[3]): "a" (infoType), "c" (subType));
+
 #endif
 
+	static unsigned long long _xgetbv(unsigned int index)
+	{
+		unsigned int eax, edx;
+		asm("xgetbv" : "=a" (eax), "=d" (edx) : "c" (index));
+		return ((unsigned long long)edx << 32) | eax;
+	}
+
 #endif
 
+	// True if the OS saves the AVX (YMM) registers on context switches
+	static bool os_supports_avx()
+	{
+		unsigned int cpuinfo[4] = { 0 };
+		__cpuid((int*)cpuinfo, 0x1);
+		if ((cpuinfo[2] & (1 << 27)) == 0 || (cpuinfo[2] & (1 << 28)) == 0)
+			return false;
+		return (_xgetbv(0) & 0x6) == 0x6;
+	}
+
 	bool System::detect_cpu_extension(CPU_ExtensionPPC ext)
 	{
 		throw ("Congratulations, you've just been selected to code this feature!");
@@ -167,6 +194,11 @@ namespace uicore
 			__cpuid((int*)cpuinfo, 0x1);
 			return ((cpuinfo[2] & (1 << 25)) != 0);
 		}
+		else if (ext == pclmul)
+		{
+			__cpuid((int*)cpuinfo, 0x1);
+			return ((cpuinfo[2] & (1 << 1)) != 0);
+		}
 		else if (ext == fma3)
 		{
 			__cpuid((int*)cpuinfo, 0x1);
@@ -181,6 +213,24 @@ namespace uicore
 			__cpuid((int*)cpuinfo, 0x80000001);
 			return ((cpuinfo[2] & (1 << 16)) != 0);
 		}
+		else if (ext == avx2)
+		{
+			__cpuid((int*)cpuinfo, 0);
+			if (cpuinfo[0] < 7 || !os_supports_avx())
+				return false;
+
+			__cpuidex((int*)cpuinfo, 7, 0);
+			return ((cpuinfo[1] & (1 << 5)) != 0);
+		}
+		else if (ext == sha)
+		{
+			__cpuid((int*)cpuinfo, 0);
+			if (cpuinfo[0] < 7)
+				return false;
+
+			__cpuidex((int*)cpuinfo, 7, 0);
+			return ((cpuinfo[1] & (1 << 29)) != 0);
+		}
 		return false;
 	}
 
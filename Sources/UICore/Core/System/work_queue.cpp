@@ -0,0 +1,194 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/System/work_queue.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/singleton_bugfix.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+namespace uicore
+{
+	class WorkQueueParallelFor
+	{
+	public:
+		WorkQueueParallelFor(int count, int num_batches, const std::function<void(int, int)> *func) : count(count), num_batches(num_batches), func(func) { }
+
+		void run()
+		{
+			while (true)
+			{
+				int batch = next_batch++;
+				if (batch >= num_batches)
+					break;
+
+				int start = (int)((int64_t)count * batch / num_batches);
+				int end = (int)((int64_t)count * (batch + 1) / num_batches);
+				try
+				{
+					(*func)(start, end);
+				}
+				catch (...)
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					if (!exception)
+						exception = std::current_exception();
+				}
+
+				std::unique_lock<std::mutex> lock(mutex);
+				completed++;
+				if (completed == num_batches)
+					completed_event.notify_all();
+			}
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completed_event.wait(lock, [&]() { return completed == num_batches; });
+			if (exception)
+				std::rethrow_exception(exception);
+		}
+
+	private:
+		int count;
+		int num_batches;
+		const std::function<void(int, int)> *func;
+		std::atomic<int> next_batch{ 0 };
+
+		std::mutex mutex;
+		std::condition_variable completed_event;
+		int completed = 0;
+		std::exception_ptr exception;
+	};
+
+	class WorkQueueImpl : public WorkQueue
+	{
+	public:
+		WorkQueueImpl(int num_threads)
+		{
+			if (num_threads <= 0)
+				num_threads = std::max(System::num_cores(), 1);
+
+			for (int i = 0; i < num_threads; i++)
+				threads.push_back(std::thread([=]() { worker_main(); }));
+		}
+
+		~WorkQueueImpl()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			stop_flag = true;
+			lock.unlock();
+			work_available_event.notify_all();
+
+			for (auto &thread : threads)
+				thread.join();
+		}
+
+		int thread_count() const override
+		{
+			return (int)threads.size();
+		}
+
+		void queue(std::function<void()> func) override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_items.push_back(std::move(func));
+			lock.unlock();
+			work_available_event.notify_one();
+		}
+
+		void parallel_for(int count, const std::function<void(int start, int end)> &func, int min_batch_size) override
+		{
+			if (count <= 0)
+				return;
+
+			min_batch_size = std::max(min_batch_size, 1);
+			int num_batches = std::min(thread_count() + 1, (count + min_batch_size - 1) / min_batch_size);
+			if (num_batches <= 1)
+			{
+				func(0, count);
+				return;
+			}
+
+			// Workers only touch func while a batch is left, and wait() returns after the last batch completed
+			auto parallel = std::make_shared<WorkQueueParallelFor>(count, num_batches, &func);
+			for (int i = 1; i < num_batches; i++)
+				queue([=]() { parallel->run(); });
+			parallel->run();
+			parallel->wait();
+		}
+
+	private:
+		void worker_main()
+		{
+			while (true)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				work_available_event.wait(lock, [&]() { return stop_flag || !work_items.empty(); });
+				if (stop_flag)
+					break;
+
+				std::function<void()> func = std::move(work_items.front());
+				work_items.pop_front();
+				lock.unlock();
+
+				func();
+			}
+		}
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable work_available_event;
+		std::deque<std::function<void()>> work_items;
+		bool stop_flag = false;
+	};
+
+	class WorkQueueShared
+	{
+	public:
+		std::shared_ptr<WorkQueue> queue = WorkQueue::create();
+	};
+
+	std::shared_ptr<WorkQueue> WorkQueue::create(int num_threads)
+	{
+		return std::make_shared<WorkQueueImpl>(num_threads);
+	}
+
+	const std::shared_ptr<WorkQueue> &WorkQueue::shared()
+	{
+		static Singleton<WorkQueueShared> shared_queue;
+		return shared_queue->queue;
+	}
+}
@@ -0,0 +1,167 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/deflater.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/System/exception.h"
+#include "miniz.h"
+#include <vector>
+
+namespace uicore
+{
+	class DeflaterImpl : public Deflater
+	{
+	public:
+		DeflaterImpl(bool raw, int compression_level, ZLibCompression::CompressionMode mode);
+
+		void compress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output) override;
+		std::shared_ptr<DataBuffer> compress(const void *data, size_t size) override;
+		void write(const void *data, size_t size, const std::shared_ptr<IODevice> &output) override;
+		void flush(const std::shared_ptr<IODevice> &output) override;
+		void finish(const std::shared_ptr<IODevice> &output) override;
+		void reset() override;
+		unsigned long long total_in() const override { return _total_in; }
+		unsigned long long total_out() const override { return _total_out; }
+
+	private:
+		void process(const void *data, size_t size, tdefl_flush flush, IODevice *output);
+
+		std::unique_ptr<tdefl_compressor> compressor;
+		mz_uint flags = 0;
+		std::vector<unsigned char> in_buffer;
+		std::vector<unsigned char> out_buffer;
+		unsigned long long _total_in = 0;
+		unsigned long long _total_out = 0;
+	};
+
+	std::shared_ptr<Deflater> Deflater::create(bool raw, int compression_level, ZLibCompression::CompressionMode mode)
+	{
+		return std::make_shared<DeflaterImpl>(raw, compression_level, mode);
+	}
+
+	DeflaterImpl::DeflaterImpl(bool raw, int compression_level, ZLibCompression::CompressionMode mode) : compressor(new tdefl_compressor()), out_buffer(64 * 1024)
+	{
+		const int window_bits = 15;
+
+		int strategy = MZ_DEFAULT_STRATEGY;
+		switch (mode)
+		{
+		case ZLibCompression::default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
+		case ZLibCompression::filtered: strategy = MZ_FILTERED; break;
+		case ZLibCompression::huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
+		case ZLibCompression::rle: strategy = MZ_RLE; break;
+		case ZLibCompression::fixed: strategy = MZ_FIXED; break;
+		}
+
+		flags = tdefl_create_comp_flags_from_zip_params(compression_level, raw ? -window_bits : window_bits, strategy);
+		reset();
+	}
+
+	void DeflaterImpl::reset()
+	{
+		if (tdefl_init(compressor.get(), nullptr, nullptr, flags) != TDEFL_STATUS_OKAY)
+			throw Exception("Deflate init failed");
+		_total_in = 0;
+		_total_out = 0;
+	}
+
+	void DeflaterImpl::compress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output)
+	{
+		reset();
+
+		if (in_buffer.empty())
+			in_buffer.resize(64 * 1024);
+
+		while (true)
+		{
+			int bytes_read = input->try_read(in_buffer.data(), (int)in_buffer.size());
+			if (bytes_read <= 0)
+				break;
+			process(in_buffer.data(), bytes_read, TDEFL_NO_FLUSH, output.get());
+		}
+
+		finish(output);
+	}
+
+	std::shared_ptr<DataBuffer> DeflaterImpl::compress(const void *data, size_t size)
+	{
+		auto output = MemoryDevice::create();
+		output->buffer()->set_capacity(size / 2 + 64);
+
+		reset();
+		process(data, size, TDEFL_FINISH, output.get());
+		reset();
+
+		return output->buffer();
+	}
+
+	void DeflaterImpl::write(const void *data, size_t size, const std::shared_ptr<IODevice> &output)
+	{
+		process(data, size, TDEFL_NO_FLUSH, output.get());
+	}
+
+	void DeflaterImpl::flush(const std::shared_ptr<IODevice> &output)
+	{
+		process(nullptr, 0, TDEFL_SYNC_FLUSH, output.get());
+	}
+
+	void DeflaterImpl::finish(const std::shared_ptr<IODevice> &output)
+	{
+		process(nullptr, 0, TDEFL_FINISH, output.get());
+		reset();
+	}
+
+	void DeflaterImpl::process(const void *data, size_t size, tdefl_flush flush, IODevice *output)
+	{
+		const unsigned char *input = static_cast<const unsigned char *>(data);
+		while (true)
+		{
+			size_t in_bytes = size;
+			size_t out_bytes = out_buffer.size();
+			tdefl_status status = tdefl_compress(compressor.get(), input, &in_bytes, out_buffer.data(), &out_bytes, flush);
+			if (status < 0)
+				throw Exception("Deflate failed");
+
+			input += in_bytes;
+			size -= in_bytes;
+			_total_in += in_bytes;
+
+			if (out_bytes > 0)
+			{
+				output->write(out_buffer.data(), (int)out_bytes);
+				_total_out += out_bytes;
+			}
+
+			if (status == TDEFL_STATUS_DONE)
+				break;
+			else if (size == 0 && flush != TDEFL_FINISH && out_bytes < out_buffer.size())
+				break;
+		}
+	}
+}
@@ -0,0 +1,158 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/inflater.h"
+#include "UICore/Core/IOData/iodevice.h"
+#include "UICore/Core/System/exception.h"
+#include "miniz.h"
+#include <vector>
+
+namespace uicore
+{
+	class InflaterImpl : public Inflater
+	{
+	public:
+		InflaterImpl(bool raw);
+
+		void decompress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output) override;
+		size_t decompress(const void *input, size_t input_size, void *output, size_t output_size) override;
+		bool write(const void *data, size_t size, const std::shared_ptr<IODevice> &output, size_t *out_consumed) override;
+		bool is_finished() const override { return finished; }
+		void reset() override;
+
+	private:
+		std::unique_ptr<tinfl_decompressor> decompressor;
+		mz_uint32 flags = 0;
+		std::vector<unsigned char> dictionary;
+		size_t dictionary_pos = 0;
+		std::vector<unsigned char> in_buffer;
+		bool finished = false;
+	};
+
+	std::shared_ptr<Inflater> Inflater::create(bool raw)
+	{
+		return std::make_shared<InflaterImpl>(raw);
+	}
+
+	InflaterImpl::InflaterImpl(bool raw) : decompressor(new tinfl_decompressor())
+	{
+		flags = raw ? 0 : TINFL_FLAG_PARSE_ZLIB_HEADER;
+		reset();
+	}
+
+	void InflaterImpl::reset()
+	{
+		tinfl_init(decompressor.get());
+		dictionary_pos = 0;
+		finished = false;
+	}
+
+	void InflaterImpl::decompress(const std::shared_ptr<IODevice> &input, const std::shared_ptr<IODevice> &output)
+	{
+		reset();
+
+		if (in_buffer.empty())
+			in_buffer.resize(64 * 1024);
+
+		while (true)
+		{
+			int bytes_read = input->try_read(in_buffer.data(), (int)in_buffer.size());
+			if (bytes_read <= 0)
+				throw Exception("Unexpected end of deflate stream");
+
+			size_t consumed = 0;
+			if (write(in_buffer.data(), bytes_read, output, &consumed))
+			{
+				// Leave the input positioned at the first byte after the stream
+				if (consumed < (size_t)bytes_read)
+					input->seek_from_current(-(long long)(bytes_read - consumed));
+				break;
+			}
+		}
+	}
+
+	size_t InflaterImpl::decompress(const void *input, size_t input_size, void *output, size_t output_size)
+	{
+		reset();
+
+		size_t in_bytes = input_size;
+		size_t out_bytes = output_size;
+		mz_uint8 *dest = static_cast<mz_uint8 *>(output);
+		tinfl_status status = tinfl_decompress(decompressor.get(), static_cast<const mz_uint8 *>(input), &in_bytes, dest, dest, &out_bytes, flags | TINFL_FLAG_USING_NON_WRAPCL_PING_OUTPUT_BUF);
+
+		if (status == TINFL_STATUS_HAS_MORE_OUTPUT)
+			throw Exception("Deflate stream does not fit the output buffer");
+		else if (status != TINFL_STATUS_DONE)
+			throw Exception("Deflate stream is corrupted");
+
+		finished = true;
+		return out_bytes;
+	}
+
+	bool InflaterImpl::write(const void *data, size_t size, const std::shared_ptr<IODevice> &output, size_t *out_consumed)
+	{
+		if (out_consumed)
+			*out_consumed = 0;
+
+		if (finished)
+			return true;
+
+		if (dictionary.empty())
+			dictionary.resize(TINFL_LZ_DICT_SIZE);
+
+		const mz_uint8 *input = static_cast<const mz_uint8 *>(data);
+		while (true)
+		{
+			size_t in_bytes = size;
+			size_t out_bytes = TINFL_LZ_DICT_SIZE - dictionary_pos;
+			tinfl_status status = tinfl_decompress(decompressor.get(), input, &in_bytes, dictionary.data(), dictionary.data() + dictionary_pos, &out_bytes, flags | TINFL_FLAG_HAS_MORE_INPUT);
+			if (status < 0)
+				throw Exception("Deflate stream is corrupted");
+
+			input += in_bytes;
+			size -= in_bytes;
+			if (out_consumed)
+				*out_consumed += in_bytes;
+
+			if (out_bytes > 0)
+				output->write(dictionary.data() + dictionary_pos, (int)out_bytes);
+			dictionary_pos = (dictionary_pos + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+			if (status == TINFL_STATUS_DONE)
+			{
+				finished = true;
+				return true;
+			}
+			else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && size == 0)
+			{
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,324 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/resource_pack.h"
+#include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/path_help.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/singleton_bugfix.h"
+#include "resource_pack_format.h"
+#include "miniz.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <string.h>
+
+namespace uicore
+{
+	/// \brief Stored entry referencing the memory of its pack
+	class ResourcePackEntryBuffer : public DataBuffer
+	{
+	public:
+		ResourcePackEntryBuffer(const std::shared_ptr<DataBuffer> &pack_data, size_t offset, size_t entry_size) : pack_data(pack_data), offset(offset), entry_size(entry_size) { }
+
+		char *data() override { return pack_data->data() + offset; }
+		const char *data() const override { return pack_data->data() + offset; }
+		size_t size() const override { return entry_size; }
+		size_t capacity() const override { return entry_size; }
+		void set_size(size_t size) override { if (size != entry_size) throw Exception("Resource pack entries cannot be resized"); }
+		void set_capacity(size_t capacity) override { if (capacity > entry_size) throw Exception("Resource pack entries cannot be resized"); }
+
+		std::shared_ptr<DataBuffer> copy(size_t pos, size_t size) override { return DataBuffer::create(data() + pos, size); }
+
+	private:
+		std::shared_ptr<DataBuffer> pack_data;
+		size_t offset;
+		size_t entry_size;
+	};
+
+	class ResourcePackImpl : public ResourcePack
+	{
+	public:
+		ResourcePackImpl(const std::shared_ptr<DataBuffer> &data);
+
+		int entry_count() const override { return count; }
+		std::string entry_name(int index) const override;
+		size_t entry_size(int index) const override;
+		bool entry_compressed(int index) const override;
+		int find(const std::string &name) const override;
+		std::shared_ptr<DataBuffer> read(int index) const override;
+
+	private:
+		const unsigned char *entry(int index) const;
+		const char *name_data(int index, size_t &length) const;
+
+		std::shared_ptr<DataBuffer> data;
+		int count = 0;
+		const unsigned char *index_data = nullptr;
+		const char *names = nullptr;
+		size_t names_size = 0;
+	};
+
+	ResourcePackImpl::ResourcePackImpl(const std::shared_ptr<DataBuffer> &pack_data) : data(pack_data)
+	{
+		const unsigned char *bytes = data->data<unsigned char>();
+		size_t size = data->size();
+
+		if (size < ResourcePackFormat::header_size || memcmp(bytes, ResourcePackFormat::magic(), 4) != 0)
+			throw Exception("Not a resource pack");
+		if (ResourcePackFormat::read_uint32(bytes + 4) != ResourcePackFormat::version)
+			throw Exception("Unsupported resource pack version");
+
+		uint64_t entries = ResourcePackFormat::read_uint32(bytes + 8);
+		uint64_t index_offset = ResourcePackFormat::read_uint64(bytes + 16);
+		uint64_t names_offset = ResourcePackFormat::read_uint64(bytes + 24);
+		uint64_t names_end = ResourcePackFormat::read_uint64(bytes + 32);
+
+		if (index_offset > size || entries > (size - index_offset) / ResourcePackFormat::entry_size || names_offset > names_end || names_end > size)
+			throw Exception("Resource pack directory is corrupt");
+
+		count = (int)entries;
+		index_data = bytes + index_offset;
+		names = reinterpret_cast<const char*>(bytes + names_offset);
+		names_size = (size_t)(names_end - names_offset);
+
+		// Validate everything once so lookups can trust the directory
+		for (int i = 0; i < count; i++)
+		{
+			const unsigned char *e = entry(i);
+			uint64_t name_offset = ResourcePackFormat::read_uint32(e);
+			uint64_t name_length = ResourcePackFormat::read_uint32(e + 4);
+			uint64_t data_offset = ResourcePackFormat::read_uint64(e + 8);
+			uint64_t stored_size = ResourcePackFormat::read_uint64(e + 16);
+			uint32_t method = ResourcePackFormat::read_uint32(e + 32);
+
+			if (name_offset + name_length > names_size || data_offset > size || stored_size > size - data_offset)
+				throw Exception("Resource pack directory is corrupt");
+			if (method != ResourcePackFormat::method_stored && method != ResourcePackFormat::method_deflate)
+				throw Exception("Unsupported resource pack compression method");
+			if (method == ResourcePackFormat::method_stored && ResourcePackFormat::read_uint64(e + 24) != stored_size)
+				throw Exception("Resource pack directory is corrupt");
+		}
+	}
+
+	const unsigned char *ResourcePackImpl::entry(int index) const
+	{
+		if (index < 0 || index >= count)
+			throw Exception("Resource pack entry index out of bounds");
+		return index_data + (size_t)index * ResourcePackFormat::entry_size;
+	}
+
+	const char *ResourcePackImpl::name_data(int index, size_t &length) const
+	{
+		const unsigned char *e = entry(index);
+		length = ResourcePackFormat::read_uint32(e + 4);
+		return names + ResourcePackFormat::read_uint32(e);
+	}
+
+	std::string ResourcePackImpl::entry_name(int index) const
+	{
+		size_t length = 0;
+		const char *name = name_data(index, length);
+		return std::string(name, length);
+	}
+
+	size_t ResourcePackImpl::entry_size(int index) const
+	{
+		return (size_t)ResourcePackFormat::read_uint64(entry(index) + 24);
+	}
+
+	bool ResourcePackImpl::entry_compressed(int index) const
+	{
+		return ResourcePackFormat::read_uint32(entry(index) + 32) == ResourcePackFormat::method_deflate;
+	}
+
+	int ResourcePackImpl::find(const std::string &name) const
+	{
+		int first = 0;
+		int last = count;
+		while (first < last)
+		{
+			int middle = first + (last - first) / 2;
+
+			size_t length = 0;
+			const char *middle_name = name_data(middle, length);
+			int result = memcmp(middle_name, name.data(), std::min(length, name.length()));
+			if (result == 0)
+				result = (length < name.length()) ? -1 : (length > name.length()) ? 1 : 0;
+
+			if (result == 0)
+				return middle;
+			else if (result < 0)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return -1;
+	}
+
+	std::shared_ptr<DataBuffer> ResourcePackImpl::read(int index) const
+	{
+		const unsigned char *e = entry(index);
+		size_t data_offset = (size_t)ResourcePackFormat::read_uint64(e + 8);
+		size_t stored_size = (size_t)ResourcePackFormat::read_uint64(e + 16);
+		size_t size = (size_t)ResourcePackFormat::read_uint64(e + 24);
+
+		if (ResourcePackFormat::read_uint32(e + 32) == ResourcePackFormat::method_stored)
+			return std::make_shared<ResourcePackEntryBuffer>(data, data_offset, size);
+
+		auto buffer = DataBuffer::create(size);
+		size_t result = tinfl_decompress_mem_to_mem(buffer->data(), size, data->data() + data_offset, stored_size, 0);
+		if (result != size)
+			throw Exception("Resource pack entry is corrupt: " + entry_name(index));
+		return buffer;
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	std::shared_ptr<ResourcePack> ResourcePack::open(const std::string &filename)
+	{
+		return std::make_shared<ResourcePackImpl>(File::open_mapped(filename));
+	}
+
+	std::shared_ptr<ResourcePack> ResourcePack::open(const std::shared_ptr<DataBuffer> &data)
+	{
+		return std::make_shared<ResourcePackImpl>(data);
+	}
+
+	std::shared_ptr<DataBuffer> ResourcePack::read(const std::string &name) const
+	{
+		int index = find(name);
+		if (index == -1)
+			throw Exception("Resource pack has no entry named " + name);
+		return read(index);
+	}
+
+	std::shared_ptr<IODevice> ResourcePack::open_device(const std::string &name) const
+	{
+		return MemoryDevice::open(read(name));
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	class ResourcePackMounts
+	{
+	public:
+		struct Mount
+		{
+			std::string path;	// Normalized with slashes, empty or ending with a slash
+			std::shared_ptr<ResourcePack> pack;
+		};
+
+		std::mutex mutex;
+		std::shared_ptr<std::vector<Mount>> mounts;
+
+		static ResourcePackMounts *instance()
+		{
+			static Singleton<ResourcePackMounts> mounts;
+			return mounts.get();
+		}
+
+		std::shared_ptr<std::vector<Mount>> snapshot()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return mounts;
+		}
+
+		static bool entry_name(const Mount &mount, const std::string &normalized_filename, std::string &out_name)
+		{
+			if (normalized_filename.compare(0, mount.path.length(), mount.path) != 0)
+				return false;
+			out_name = normalized_filename.substr(mount.path.length());
+			return true;
+		}
+	};
+
+	void ResourcePack::mount(const std::shared_ptr<ResourcePack> &pack, const std::string &path)
+	{
+		ResourcePackMounts::Mount mount;
+		mount.pack = pack;
+		if (!path.empty())
+			mount.path = FilePath::add_trailing_slash(FilePath::normalize(path, FilePathType::slashes), FilePathType::slashes);
+
+		auto mounts = ResourcePackMounts::instance();
+		std::unique_lock<std::mutex> lock(mounts->mutex);
+		auto new_mounts = mounts->mounts ? std::make_shared<std::vector<ResourcePackMounts::Mount>>(*mounts->mounts) : std::make_shared<std::vector<ResourcePackMounts::Mount>>();
+		new_mounts->insert(new_mounts->begin(), mount);
+		mounts->mounts = new_mounts;
+	}
+
+	void ResourcePack::unmount(const std::shared_ptr<ResourcePack> &pack)
+	{
+		auto mounts = ResourcePackMounts::instance();
+		std::unique_lock<std::mutex> lock(mounts->mutex);
+		if (!mounts->mounts)
+			return;
+
+		auto new_mounts = std::make_shared<std::vector<ResourcePackMounts::Mount>>(*mounts->mounts);
+		new_mounts->erase(std::remove_if(new_mounts->begin(), new_mounts->end(), [&](const ResourcePackMounts::Mount &mount) { return mount.pack == pack; }), new_mounts->end());
+		mounts->mounts = new_mounts->empty() ? nullptr : new_mounts;
+	}
+
+	std::shared_ptr<DataBuffer> ResourcePack::read_mounted(const std::string &filename)
+	{
+		auto mounts = ResourcePackMounts::instance()->snapshot();
+		if (!mounts)
+			return nullptr;
+
+		std::string normalized_filename = FilePath::normalize(filename, FilePathType::slashes);
+		std::string name;
+		for (const auto &mount : *mounts)
+		{
+			if (ResourcePackMounts::entry_name(mount, normalized_filename, name))
+			{
+				int index = mount.pack->find(name);
+				if (index != -1)
+					return mount.pack->read(index);
+			}
+		}
+		return nullptr;
+	}
+
+	bool ResourcePack::exists_mounted(const std::string &filename)
+	{
+		auto mounts = ResourcePackMounts::instance()->snapshot();
+		if (!mounts)
+			return false;
+
+		std::string normalized_filename = FilePath::normalize(filename, FilePathType::slashes);
+		std::string name;
+		for (const auto &mount : *mounts)
+		{
+			if (ResourcePackMounts::entry_name(mount, normalized_filename, name) && mount.pack->exists(name))
+				return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,82 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace uicore
+{
+	/// \brief Layout of resource pack files
+	///
+	/// All numbers are little endian. The file starts with a header, followed by the directory
+	/// index sorted by name (compared bytewise), the entry names and finally the entry data:
+	///
+	/// Header: "UIPK", uint32 version, uint32 entry count, uint32 reserved, uint64 index offset, uint64 names offset, uint64 names end
+	/// Entry: uint32 name offset, uint32 name length, uint64 data offset, uint64 stored size, uint64 size, uint32 method, uint32 reserved
+	class ResourcePackFormat
+	{
+	public:
+		static const char *magic() { return "UIPK"; }
+
+		enum
+		{
+			version = 1,
+			header_size = 40,
+			entry_size = 40,
+			data_alignment = 16,
+
+			method_stored = 0,
+			method_deflate = 1
+		};
+
+		static uint32_t read_uint32(const unsigned char *p)
+		{
+			return ((uint32_t)p[0]) | (((uint32_t)p[1]) << 8) | (((uint32_t)p[2]) << 16) | (((uint32_t)p[3]) << 24);
+		}
+
+		static uint64_t read_uint64(const unsigned char *p)
+		{
+			return ((uint64_t)read_uint32(p)) | (((uint64_t)read_uint32(p + 4)) << 32);
+		}
+
+		static void write_uint32(unsigned char *p, uint32_t value)
+		{
+			p[0] = (unsigned char)value;
+			p[1] = (unsigned char)(value >> 8);
+			p[2] = (unsigned char)(value >> 16);
+			p[3] = (unsigned char)(value >> 24);
+		}
+
+		static void write_uint64(unsigned char *p, uint64_t value)
+		{
+			write_uint32(p, (uint32_t)value);
+			write_uint32(p + 4, (uint32_t)(value >> 32));
+		}
+	};
+}
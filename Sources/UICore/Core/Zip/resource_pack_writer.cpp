@@ -0,0 +1,184 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Core/Zip/resource_pack_writer.h"
+#include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
+#include "UICore/Core/IOData/directory_scanner.h"
+#include "UICore/Core/IOData/path_help.h"
+#include "UICore/Core/System/exception.h"
+#include "resource_pack_format.h"
+#include <map>
+#include <vector>
+
+namespace uicore
+{
+	class ResourcePackWriterImpl : public ResourcePackWriter
+	{
+	public:
+		void add(const std::string &name, const std::shared_ptr<DataBuffer> &data, ResourcePackCompression compression) override;
+		void add_directory(const std::string &path, ResourcePackCompression compression) override;
+		void save(const std::string &filename) override;
+		void save(const std::shared_ptr<IODevice> &device) override;
+
+	private:
+		void add_directory(const std::string &path, const std::string &prefix, ResourcePackCompression compression);
+
+		struct Entry
+		{
+			std::shared_ptr<DataBuffer> data;	// As written to the pack
+			size_t size = 0;
+			uint32_t method = ResourcePackFormat::method_stored;
+		};
+
+		// std::map keeps the names sorted bytewise, as required by the directory index
+		std::map<std::string, Entry> entries;
+	};
+
+	std::shared_ptr<ResourcePackWriter> ResourcePackWriter::create()
+	{
+		return std::make_shared<ResourcePackWriterImpl>();
+	}
+
+	void ResourcePackWriterImpl::add(const std::string &name, const std::shared_ptr<DataBuffer> &data, ResourcePackCompression compression)
+	{
+		std::string entry_name = FilePath::normalize(name, FilePathType::slashes);
+		if (entry_name.empty() || entry_name[0] == '/')
+			throw Exception("Invalid resource pack entry name: " + name);
+
+		Entry entry;
+		entry.data = data;
+		entry.size = data->size();
+
+		if (compression != ResourcePackCompression::stored && data->size() > 0)
+		{
+			auto compressed = ZLibCompression::compress(data, true, 9);
+
+			// Already compressed formats (png, jpeg, ttf with compressed tables) are left stored so they can be read without copying
+			if (compression == ResourcePackCompression::deflate || compressed->size() < data->size() - data->size() / 8)
+			{
+				entry.data = compressed;
+				entry.method = ResourcePackFormat::method_deflate;
+			}
+		}
+
+		entries[entry_name] = entry;
+	}
+
+	void ResourcePackWriterImpl::add_directory(const std::string &path, ResourcePackCompression compression)
+	{
+		add_directory(path, std::string(), compression);
+	}
+
+	void ResourcePackWriterImpl::add_directory(const std::string &path, const std::string &prefix, ResourcePackCompression compression)
+	{
+		auto scanner = DirectoryScanner::create();
+		if (!scanner->scan(path))
+			throw Exception("Unable to scan directory: " + path);
+
+		while (scanner->next())
+		{
+			std::string name = scanner->name();
+			if (name == "." || name == "..")
+				continue;
+
+			if (scanner->is_directory())
+				add_directory(scanner->pathname(), prefix + name + "/", compression);
+			else
+				add(prefix + name, File::read_all_bytes(scanner->pathname()), compression);
+		}
+	}
+
+	void ResourcePackWriterImpl::save(const std::string &filename)
+	{
+		auto file = BufferedIODevice::create(File::create_always(filename));
+		save(file);
+		file->flush();
+	}
+
+	void ResourcePackWriterImpl::save(const std::shared_ptr<IODevice> &device)
+	{
+		uint64_t index_offset = ResourcePackFormat::header_size;
+		uint64_t names_offset = index_offset + (uint64_t)entries.size() * ResourcePackFormat::entry_size;
+
+		std::vector<unsigned char> index(entries.size() * ResourcePackFormat::entry_size);
+		std::string names;
+
+		uint64_t data_offset = names_offset;
+		for (const auto &it : entries)
+			data_offset += it.first.length();
+
+		size_t i = 0;
+		for (const auto &it : entries)
+		{
+			data_offset = (data_offset + ResourcePackFormat::data_alignment - 1) / ResourcePackFormat::data_alignment * ResourcePackFormat::data_alignment;
+
+			unsigned char *e = index.data() + i * ResourcePackFormat::entry_size;
+			ResourcePackFormat::write_uint32(e, (uint32_t)names.length());
+			ResourcePackFormat::write_uint32(e + 4, (uint32_t)it.first.length());
+			ResourcePackFormat::write_uint64(e + 8, data_offset);
+			ResourcePackFormat::write_uint64(e + 16, it.second.data->size());
+			ResourcePackFormat::write_uint64(e + 24, it.second.size);
+			ResourcePackFormat::write_uint32(e + 32, it.second.method);
+			ResourcePackFormat::write_uint32(e + 36, 0);
+
+			names += it.first;
+			data_offset += it.second.data->size();
+			i++;
+		}
+
+		unsigned char header[ResourcePackFormat::header_size] = { 0 };
+		memcpy(header, ResourcePackFormat::magic(), 4);
+		ResourcePackFormat::write_uint32(header + 4, ResourcePackFormat::version);
+		ResourcePackFormat::write_uint32(header + 8, (uint32_t)entries.size());
+		ResourcePackFormat::write_uint64(header + 16, index_offset);
+		ResourcePackFormat::write_uint64(header + 24, names_offset);
+		ResourcePackFormat::write_uint64(header + 32, names_offset + names.length());
+
+		device->write(header, ResourcePackFormat::header_size);
+		if (!index.empty())
+			device->write(index.data(), (int)index.size());
+		if (!names.empty())
+			device->write(names.data(), (int)names.length());
+
+		static const char padding[ResourcePackFormat::data_alignment] = { 0 };
+		uint64_t position = names_offset + names.length();
+		for (const auto &it : entries)
+		{
+			uint64_t aligned = (position + ResourcePackFormat::data_alignment - 1) / ResourcePackFormat::data_alignment * ResourcePackFormat::data_alignment;
+			if (aligned != position)
+				device->write(padding, (int)(aligned - position));
+
+			if (it.second.data->size() > 0)
+				device->write(it.second.data->data(), (int)it.second.data->size());
+			position = aligned + it.second.data->size();
+		}
+	}
+}
@@ -30,6 +30,12 @@
 #include "UICore/Core/Zip/zlib_compression.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/Zip/deflater.h"
+#include "UICore/Core/Zip/inflater.h"
+#include "UICore/Core/System/work_queue.h"
+#include "UICore/Core/Crypto/hash_functions.h"
+#include <algorithm>
+#include <vector>
 
 #define INCLUDED_FROM_ZLIB_COMPRESSION_CPP
 #include "miniz.h"
@@ -38,55 +44,90 @@ namespace uicore
 {
 	std::shared_ptr<DataBuffer> ZLibCompression::compress(const std::shared_ptr<DataBuffer> &data, bool raw, int compression_level, CompressionMode mode)
 	{
-		const int window_bits = 15;
+		return Deflater::create(raw, compression_level, mode)->compress(data->data(), data->size());
+	}
 
-		auto zbuffer = DataBuffer::create(1024 * 1024);
-		auto output = MemoryDevice::create();
+	// Appends the checksum of a second block to the checksum of a first block (as adler32_combine in zlib)
+	static mz_ulong adler32_combine(mz_ulong adler1, mz_ulong adler2, size_t length2)
+	{
+		const mz_ulong base = 65521;
+		mz_ulong remainder = (mz_ulong)(length2 % base);
+		mz_ulong sum1 = adler1 & 0xffff;
+		mz_ulong sum2 = (remainder * sum1) % base;
+		sum1 += (adler2 & 0xffff) + base - 1;
+		sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - remainder;
+		if (sum1 >= base) sum1 -= base;
+		if (sum1 >= base) sum1 -= base;
+		if (sum2 >= (base << 1)) sum2 -= (base << 1);
+		if (sum2 >= base) sum2 -= base;
+		return sum1 | (sum2 << 16);
+	}
 
-		int strategy = MZ_DEFAULT_STRATEGY;
-		switch (mode)
-		{
-		case default_strategy: strategy = MZ_DEFAULT_STRATEGY; break;
-		case filtered: strategy = MZ_FILTERED; break;
-		case huffman_only: strategy = MZ_HUFFMAN_ONLY; break;
-		case rle: strategy = MZ_RLE; break;
-		case fixed: strategy = MZ_FIXED; break;
-		}
+	std::shared_ptr<DataBuffer> ZLibCompression::compress_parallel(const std::shared_ptr<DataBuffer> &data, bool raw, int compression_level, CompressionMode mode, const std::shared_ptr<WorkQueue> &queue)
+	{
+		const size_t block_size = 128 * 1024;
 
-		mz_stream zs = { nullptr };
-		int result = mz_deflateInit2(&zs, compression_level, MZ_DEFLATED, raw ? -window_bits : window_bits, 8, strategy); // Undocumented: if wbits is negative, zlib skips header check
-		if (result != MZ_OK)
-			throw Exception("Zlib deflateInit failed");
+		const auto &work_queue = queue ? queue : WorkQueue::shared();
+		size_t num_blocks = (data->size() + block_size - 1) / block_size;
+		if (num_blocks < 2 || num_blocks > 0x7fffffff)
+			return compress(data, raw, compression_level, mode);
 
-		try
+		// Every block but the last ends with a sync flush, so the blocks can simply be concatenated
+		std::vector<std::shared_ptr<MemoryDevice>> blocks(num_blocks);
+		std::vector<mz_ulong> checksums(num_blocks);
+		work_queue->parallel_for((int)num_blocks, [&](int start, int end)
 		{
-			zs.next_in = (unsigned char *)data->data();
-			zs.avail_in = data->size();
-			while (true)
+			auto deflater = Deflater::create(true, compression_level, mode);
+			for (int i = start; i < end; i++)
 			{
-				zs.next_out = (unsigned char *)zbuffer->data();
-				zs.avail_out = zbuffer->size();
-
-				int result = mz_deflate(&zs, MZ_FINISH);
-				if (result == MZ_NEED_DICT) throw Exception("Zlib deflate wants a dictionary!");
-				if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-				if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-				if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to compress file!");
-				if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-				if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib deflate failed while compressing zip file!");
-				int zsize = zbuffer->size() - zs.avail_out;
-				if (zsize == 0)
-					break;
-				output->write(zbuffer->data(), zsize);
-				if (result == MZ_STREAM_END)
-					break;
+				size_t offset = i * block_size;
+				size_t size = std::min(block_size, data->size() - offset);
+				const unsigned char *block_data = data->data<unsigned char>() + offset;
+
+				blocks[i] = MemoryDevice::create();
+				blocks[i]->buffer()->set_capacity(size / 2 + 64);
+				deflater->write(block_data, size, blocks[i]);
+				if (i + 1 < (int)num_blocks)
+				{
+					deflater->flush(blocks[i]);
+					deflater->reset();
+				}
+				else
+				{
+					deflater->finish(blocks[i]);
+				}
+
+				if (!raw)
+					checksums[i] = HashFunctions::adler32(block_data, (int)size);
 			}
-			mz_deflateEnd(&zs);
+		});
+
+		size_t output_size = raw ? 0 : 6;
+		for (const auto &block : blocks)
+			output_size += block->buffer()->size();
+
+		auto output = MemoryDevice::create();
+		output->buffer()->set_capacity(output_size);
+
+		if (!raw)
+		{
+			// Same header as miniz writes for the compression level
+			unsigned char level_flags = compression_level <= 1 ? 0x01 : compression_level <= 5 ? 0x5e : compression_level == 6 ? 0x9c : 0xda;
+			unsigned char header[2] = { 0x78, level_flags };
+			output->write(header, 2);
 		}
-		catch (...)
+
+		for (const auto &block : blocks)
+			output->write(block->buffer()->data(), (int)block->buffer()->size());
+
+		if (!raw)
 		{
-			mz_deflateEnd(&zs);
-			throw;
+			mz_ulong adler = checksums[0];
+			for (size_t i = 1; i < num_blocks; i++)
+				adler = adler32_combine(adler, checksums[i], std::min(block_size, data->size() - i * block_size));
+
+			unsigned char trailer[4] = { (unsigned char)(adler >> 24), (unsigned char)(adler >> 16), (unsigned char)(adler >> 8), (unsigned char)adler };
+			output->write(trailer, 4);
 		}
 
 		return output->buffer();
@@ -94,42 +135,10 @@ namespace uicore
 
 	std::shared_ptr<DataBuffer> ZLibCompression::decompress(const std::shared_ptr<DataBuffer> &data, bool raw)
 	{
-		const int window_bits = 15;
-
-		auto zbuffer = DataBuffer::create(1024 * 1024);
 		auto output = MemoryDevice::create();
-
-		mz_stream zs = { nullptr };
-		int result = mz_inflateInit2(&zs, raw ? -window_bits : window_bits);
-		if (result != MZ_OK)
-			throw Exception("Zlib inflateInit failed");
-
-
-		zs.next_in = (unsigned char *)data->data();
-		zs.avail_in = data->size();
-
-		// Continue feeding zlib data until we get our data:
-		while (true)
-		{
-			zs.next_out = (unsigned char *)zbuffer->data();
-			zs.avail_out = zbuffer->size();
-
-			// Decompress data:
-			int result = mz_inflate(&zs, 0);
-			if (result == MZ_NEED_DICT) throw Exception("Zlib inflate wants a dictionary!");
-			if (result == MZ_DATA_ERROR) throw Exception("Zip data stream is corrupted");
-			if (result == MZ_STREAM_ERROR) throw Exception("Zip stream structure was inconsistent!");
-			if (result == MZ_MEM_ERROR) throw Exception("Zlib did not have enough memory to decompress file!");
-			if (result == MZ_BUF_ERROR) throw Exception("Not enough data in buffer when Z_FINISH was used");
-			if (result != MZ_OK && result != MZ_STREAM_END) throw Exception("Zlib inflate failed while decompressing zip file!");
-
-			output->write(zbuffer->data(), zbuffer->size() - zs.avail_out);
-
-			if (result == MZ_STREAM_END)
-				break;
-		}
-		mz_inflateEnd(&zs);
-
+		output->buffer()->set_capacity(data->size() * 2);
+		if (!Inflater::create(raw)->write(data->data(), data->size(), output))
+			throw Exception("Unexpected end of deflate stream");
 		return output->buffer();
 	}
 }
@@ -68,6 +68,15 @@ namespace uicore
 		return _bind_target;
 	}
 
+	D3DTextureObject *D3DFrameBuffer::get_color_texture_provider(int attachment_index, int &out_level) const
+	{
+		if (attachment_index < 0 || attachment_index >= (int)color_buffers.size() || !color_buffers[attachment_index].texture)
+			return nullptr;
+
+		out_level = color_buffers[attachment_index].level;
+		return color_buffers[attachment_index].get_texture_provider();
+	}
+
 	std::vector<ID3D11RenderTargetView*> D3DFrameBuffer::get_views(ID3D11DepthStencilView *&out_dsv)
 	{
 		std::vector<ID3D11RenderTargetView*> views;
@@ -48,6 +48,9 @@ namespace uicore
 		ComPtr<ID3D11Device> &get_device() { return device; }
 		std::vector<ID3D11RenderTargetView*> get_views(ID3D11DepthStencilView *&out_dsv);
 
+		/// \brief Returns the texture attached to a color buffer, or null if none is
+		D3DTextureObject *get_color_texture_provider(int attachment_index, int &out_level) const;
+
 		void attach_color(int attachment_index, const std::shared_ptr<RenderBuffer> &render_buffer) override;
 		void attach_color(int attachment_index, const std::shared_ptr<Texture1D> &texture, int level) override;
 		void attach_color(int attachment_index, const std::shared_ptr<Texture1DArray> &texture, int array_index, int level) override;
@@ -31,6 +31,7 @@
 #include "d3d_staging_texture.h"
 #include "d3d_graphic_context.h"
 #include "d3d_display_window.h"
+#include "d3d_frame_buffer.h"
 #include "UICore/Display/Image/pixel_buffer.h"
 #include "UICore/Display/Render/staging_texture.h"
 #include "UICore/D3D/d3d_target.h"
@@ -881,7 +882,23 @@ namespace uicore
 		int level,
 		GraphicContextImpl *gc)
 	{
-		throw Exception("copy_subimage_from not supported yet by D3D target");
+		D3DGraphicContext *gc_provider = static_cast<D3DGraphicContext*>(gc);
+		std::shared_ptr<FrameBuffer> read_buffer = gc_provider->read_frame_buffer();
+
+		int source_level = 0;
+		D3DTextureObject *source = read_buffer ? static_cast<D3DFrameBuffer*>(read_buffer.get())->get_color_texture_provider(0, source_level) : nullptr;
+		if (!source)
+			throw Exception("copy_subimage_from is only supported from a frame buffer texture by D3D target");
+
+		const ComPtr<ID3D11Device> &device = gc_provider->get_window()->get_device();
+		D3D11_BOX box;
+		box.left = x;
+		box.top = y;
+		box.right = x + width;
+		box.bottom = y + height;
+		box.front = 0;
+		box.back = 1;
+		gc_provider->get_window()->get_device_context()->CopySubresourceRegion(get_texture_2d(device), level, offset_x, offset_y, 0, source->get_texture_2d(device), source_level, &box);
 	}
 
 	void D3DTextureObject::set_min_lod(double min_lod)
@@ -1095,6 +1112,8 @@ namespace uicore
 		case tf_compressed_srgb_alpha_s3tc_dxt1: return DXGI_FORMAT_BC1_UNORM_SRGB;
 		case tf_compressed_srgb_alpha_s3tc_dxt3: return DXGI_FORMAT_BC2_UNORM_SRGB;
 		case tf_compressed_srgb_alpha_s3tc_dxt5: return DXGI_FORMAT_BC3_UNORM_SRGB;
+		case tf_compressed_rgba_bptc_unorm: return DXGI_FORMAT_BC7_UNORM;
+		case tf_compressed_srgb_alpha_bptc_unorm: return DXGI_FORMAT_BC7_UNORM_SRGB;
 		}
 		throw Exception("Unsupported format");
 	}
@@ -1201,8 +1220,8 @@ namespace uicore
 		case DXGI_FORMAT_BC6H_UF16: break;
 		case DXGI_FORMAT_BC6H_SF16: break;
 		case DXGI_FORMAT_BC7_TYPELESS: break;
-		case DXGI_FORMAT_BC7_UNORM: break;
-		case DXGI_FORMAT_BC7_UNORM_SRGB: break;
+		case DXGI_FORMAT_BC7_UNORM: return tf_compressed_rgba_bptc_unorm;
+		case DXGI_FORMAT_BC7_UNORM_SRGB: return tf_compressed_srgb_alpha_bptc_unorm;
 		};
 		throw Exception("Unsupported format");
 	}
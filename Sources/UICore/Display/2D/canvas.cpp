@@ -36,4 +36,9 @@ namespace uicore
 	{
 		return std::make_shared<CanvasImpl>(window);
 	}
+
+	std::shared_ptr<Canvas> Canvas::create(const std::shared_ptr<Canvas> &canvas, const std::shared_ptr<FrameBuffer> &frame_buffer)
+	{
+		return std::make_shared<CanvasImpl>(static_cast<CanvasImpl*>(canvas.get()), frame_buffer);
+	}
 }
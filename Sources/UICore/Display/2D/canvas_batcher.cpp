@@ -47,6 +47,7 @@ namespace uicore
 		std::shared_ptr<GraphicContext> current_gc;
 
 		RenderBatcher *active_batcher;
+		int draw_calls = 0;
 		RenderBatchBuffer render_batcher_buffer;
 
 		RenderBatchTriangle render_batcher_triangle;
@@ -115,6 +116,7 @@ namespace uicore
 			RenderBatcher *batcher = active_batcher;
 			active_batcher = nullptr;
 			batcher->flush(current_gc);
+			draw_calls++;
 		}
 	}
 
@@ -149,6 +151,16 @@ namespace uicore
 		impl->flush();
 	}
 
+	int CanvasBatcher::draw_call_count() const
+	{
+		return impl->draw_calls;
+	}
+
+	void CanvasBatcher::reset_draw_call_count()
+	{
+		impl->draw_calls = 0;
+	}
+
 	void CanvasBatcher::update_batcher_matrix(const std::shared_ptr<GraphicContext> &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis)
 	{
 		impl->update_batcher_matrix(gc, modelview, projection, image_yaxis);
@@ -54,6 +54,8 @@ namespace uicore
 		bool is_null() const { return !impl; }
 
 		void flush();
+		int draw_call_count() const;
+		void reset_draw_call_count();
 		bool set_batcher(const std::shared_ptr<GraphicContext> &gc, RenderBatcher *batcher);
 		void update_batcher_matrix(const std::shared_ptr<GraphicContext> &gc, const Mat4f &modelview, const Mat4f &projection, TextureImageYAxis image_yaxis);
 
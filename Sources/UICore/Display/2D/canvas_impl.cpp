@@ -38,7 +38,19 @@ namespace uicore
 	{
 		current_window = window;
 		_gc = window->gc();
+		setup();
+	}
+
+	CanvasImpl::CanvasImpl(CanvasImpl *canvas, const std::shared_ptr<FrameBuffer> &new_frame_buffer)
+	{
+		current_window = canvas->current_window;
+		_gc = canvas->_gc;
+		frame_buffer = new_frame_buffer;
+		setup();
+	}
 
+	void CanvasImpl::setup()
+	{
 		rasterizer_state = _gc->create_rasterizer_state(RasterizerStateDescription());
 		depth_stencil_state = _gc->create_depth_stencil_state(DepthStencilStateDescription());
 		opaque_blend = _gc->create_blend_state(BlendStateDescription::opaque());
@@ -49,7 +61,7 @@ namespace uicore
 
 		batcher = CanvasBatcher(_gc);
 
-		if (!_gc->write_frame_buffer())	// No framebuffer attached to canvas
+		if (!frame_buffer && !_gc->write_frame_buffer())	// No framebuffer attached to canvas
 		{
 			canvas_y_axis = y_axis_top_down;
 		}
@@ -72,6 +84,13 @@ namespace uicore
 
 	void CanvasImpl::begin()
 	{
+		if (frame_buffer)
+		{
+			saved_write_frame_buffer = gc()->write_frame_buffer();
+			saved_read_frame_buffer = gc()->read_frame_buffer();
+			gc()->set_frame_buffer(frame_buffer);
+		}
+
 		update_viewport_size();
 
 		gc()->set_viewport(gc()->size(), gc()->texture_image_y_axis());
@@ -92,6 +111,14 @@ namespace uicore
 		gc()->set_depth_stencil_state(nullptr);
 		gc()->set_blend_state(nullptr);
 		gc()->set_program_object(nullptr);
+
+		if (frame_buffer)
+		{
+			gc()->set_frame_buffer(saved_write_frame_buffer, saved_read_frame_buffer);
+			saved_write_frame_buffer.reset();
+			saved_read_frame_buffer.reset();
+		}
+
 		gc()->set_viewport(gc()->size(), gc()->texture_image_y_axis());
 	}
 
@@ -54,6 +54,7 @@ namespace uicore
 	{
 	public:
 		CanvasImpl(const std::shared_ptr<DisplayWindow> &window);
+		CanvasImpl(CanvasImpl *canvas, const std::shared_ptr<FrameBuffer> &frame_buffer);
 
 		const std::shared_ptr<GraphicContext> &gc() const override { return _gc; }
 
@@ -87,6 +88,8 @@ namespace uicore
 		const Mat4f &projection() const override;
 
 		Pointf grid_fit(const Pointf &pos) override;
+		int draw_call_count() const override { return batcher.draw_call_count(); }
+		void reset_draw_call_count() override { batcher.reset_draw_call_count(); }
 
 		void set_batcher(RenderBatcher *batcher);
 
@@ -101,6 +104,7 @@ namespace uicore
 		CanvasBatcher batcher;
 
 	private:
+		void setup();
 		void calculate_map_mode_matrices();
 		MapMode top_down_map_mode() const;
 		void update_batcher_matrix();
@@ -116,6 +120,9 @@ namespace uicore
 		Rectf viewport_rect;
 
 		std::shared_ptr<DisplayWindow> current_window;
+		std::shared_ptr<FrameBuffer> frame_buffer;
+		std::shared_ptr<FrameBuffer> saved_write_frame_buffer;
+		std::shared_ptr<FrameBuffer> saved_read_frame_buffer;
 
 		std::shared_ptr<RasterizerState> rasterizer_state;
 		std::shared_ptr<BlendState> opaque_blend;
@@ -33,13 +33,37 @@
 #include "UICore/Display/2D/texture_group.h"
 #include "UICore/Display/Render/graphic_context.h"
 #include "UICore/Display/Render/texture_2d.h"
+#include "UICore/Display/Render/frame_buffer.h"
+#include "UICore/Display/Render/graphic_context_impl.h"
+#include "UICore/Display/Image/image_import_description.h"
+#include "UICore/Display/Image/texture_compressor_impl.h"
+#include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/Math/quad.h"
 #include "render_batch_triangle.h"
 #include "canvas_impl.h"
+#include "texture_group_impl.h"
 
 namespace uicore
 {
+	/// \brief Space reserved for an image in the shared atlas of a graphic context
+	class ImageAtlasAllocation
+	{
+	public:
+		ImageAtlasAllocation(const std::shared_ptr<GraphicContext> &gc, const TextureGroupImage &sub_texture) : gc(gc), atlas(static_cast<GraphicContextImpl*>(gc.get())->image_atlas()), sub_texture(sub_texture) { }
+		~ImageAtlasAllocation() { auto group = atlas.lock(); if (group) static_cast<TextureGroupImpl*>(group.get())->try_remove(sub_texture); }
+
+		std::weak_ptr<GraphicContext> gc;
+		std::weak_ptr<TextureGroup> atlas;
+		TextureGroupImage sub_texture;
+
+		// Images up to this size (in pixels) are packed into the atlas
+		static const int max_image_size = 256;
+
+		// Pixels duplicated around each image to avoid bleeding between neighbours when filtering
+		static const int border_size = 1;
+	};
+
 	class ImageImpl : public Image
 	{
 	public:
@@ -70,6 +94,8 @@ namespace uicore
 		void set_linear_filter(bool linear_filter = true) override;
 
 	private:
+		bool add_to_atlas(const std::shared_ptr<GraphicContext> &gc, const std::shared_ptr<PixelBuffer> &pb, const Rect &rect);
+		void detach_from_atlas();
 		void calc_hotspot();
 
 		Colorf _color = StandardColorf::white();
@@ -85,6 +111,7 @@ namespace uicore
 		std::shared_ptr<Texture2D> _texture;
 		Rect _texture_rect;
 		float _pixel_ratio = 1.0f;
+		std::shared_ptr<ImageAtlasAllocation> _atlas_allocation;
 	};
 
 	std::shared_ptr<Image> Image::create(std::shared_ptr<Texture2D> texture, const Rect &rect, float pixel_ratio)
@@ -109,10 +136,13 @@ namespace uicore
 
 	ImageImpl::ImageImpl(const std::shared_ptr<Canvas> &canvas, const std::shared_ptr<PixelBuffer> &pb, const Rect &rect, float pixel_ratio)
 	{
+		_pixel_ratio = pixel_ratio;
+		if (add_to_atlas(canvas->gc(), pb, rect))
+			return;
+
 		_texture = Texture2D::create(canvas->gc(), pb->width(), pb->height(), pb->format());
 		_texture->set_subimage(canvas->gc(), 0, 0, pb, rect);
 		_texture_rect = Rect(0, 0, pb->width(), pb->height());
-		_pixel_ratio = pixel_ratio;
 	}
 
 	ImageImpl::ImageImpl(std::shared_ptr<Texture2D> texture, const Rect &rect, float pixel_ratio)
@@ -131,9 +161,76 @@ namespace uicore
 
 	ImageImpl::ImageImpl(const std::shared_ptr<Canvas> &canvas, const std::string &filename, const ImageImportDescription &import_desc, float pixel_ratio)
 	{
-		_texture = Texture2D::create(canvas->gc(), filename, import_desc);
-		_texture_rect = _texture->size();
 		_pixel_ratio = pixel_ratio;
+
+		auto pb = import_desc.process(ImageFile::load(filename, std::string()));
+		if (!import_desc.is_srgb() && import_desc.compressed_format() == tf_rgba8 && add_to_atlas(canvas->gc(), pb, pb->size()))
+			return;
+
+		_texture = TextureCompressorImpl::create_texture(canvas->gc(), pb, import_desc);
+		_texture_rect = _texture->size();
+	}
+
+	bool ImageImpl::add_to_atlas(const std::shared_ptr<GraphicContext> &gc, const std::shared_ptr<PixelBuffer> &pb, const Rect &rect)
+	{
+		if (rect.width() <= 0 || rect.height() <= 0 || rect.width() > ImageAtlasAllocation::max_image_size || rect.height() > ImageAtlasAllocation::max_image_size)
+			return false;
+
+		if (rect.left < 0 || rect.top < 0 || rect.right > pb->width() || rect.bottom > pb->height())
+			return false;
+
+		switch (pb->format())
+		{
+		case tf_rgba8:
+		case tf_bgra8:
+		case tf_rgb8:
+		case tf_bgr8:
+			break;
+		default:
+			return false; // Atlas pages are plain rgba8
+		}
+
+		auto buffer_with_border = PixelBuffer::add_border(pb, ImageAtlasAllocation::border_size, rect);
+		auto sub_texture = static_cast<GraphicContextImpl*>(gc.get())->image_atlas()->add(gc, buffer_with_border->size());
+		sub_texture.texture()->set_subimage(gc, sub_texture.geometry().left, sub_texture.geometry().top, buffer_with_border, buffer_with_border->size());
+
+		_atlas_allocation = std::make_shared<ImageAtlasAllocation>(gc, sub_texture);
+		_texture = sub_texture.texture();
+		_texture_rect = Rect(sub_texture.geometry().left + ImageAtlasAllocation::border_size, sub_texture.geometry().top + ImageAtlasAllocation::border_size, rect.size());
+		return true;
+	}
+
+	void ImageImpl::detach_from_atlas()
+	{
+		if (!_atlas_allocation)
+			return;
+
+		auto gc = _atlas_allocation->gc.lock();
+		if (!gc)
+			return;
+
+		auto texture = Texture2D::create(gc, _texture_rect.width(), _texture_rect.height());
+		if (gc->shader_language() == shader_fixed_function)
+		{
+			// GL1 frame buffers render into a pbuffer that does not mirror the attached texture
+			texture->set_subimage(gc, 0, 0, _texture->pixeldata(gc, tf_rgba8), _texture_rect);
+		}
+		else
+		{
+			// Copy the image on the GPU by reading from a frame buffer with the atlas page attached
+			auto saved_write_frame_buffer = gc->write_frame_buffer();
+			auto saved_read_frame_buffer = gc->read_frame_buffer();
+
+			auto frame_buffer = FrameBuffer::create(gc);
+			frame_buffer->attach_color(0, _texture);
+			gc->set_frame_buffer(frame_buffer);
+			texture->copy_subimage_from(gc, Point(), _texture_rect);
+			gc->set_frame_buffer(saved_write_frame_buffer, saved_read_frame_buffer);
+		}
+
+		_texture = texture;
+		_texture_rect = texture->size();
+		_atlas_allocation.reset();
 	}
 
 	std::shared_ptr<Image> ImageImpl::clone() const
@@ -254,11 +351,20 @@ namespace uicore
 
 	void ImageImpl::set_wrap_mode(TextureWrapMode wrap_s, TextureWrapMode wrap_t)
 	{
+		// Atlas pages are always sampled inside the image rectangle, which matches clamp to edge
+		if (_atlas_allocation && wrap_s == wrap_clamp_to_edge && wrap_t == wrap_clamp_to_edge)
+			return;
+
+		detach_from_atlas();
 		_texture->set_wrap_mode(wrap_s, wrap_t);
 	}
 
 	void ImageImpl::set_linear_filter(bool linear_filter)
 	{
+		if (_atlas_allocation && linear_filter)
+			return;
+
+		detach_from_atlas();
 		_texture->set_mag_filter(linear_filter ? filter_linear : filter_nearest);
 		_texture->set_min_filter(linear_filter ? filter_linear : filter_nearest);
 	}
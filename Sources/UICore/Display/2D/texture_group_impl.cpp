@@ -90,6 +90,7 @@ namespace uicore
 	{
 		// Try inserting in current active texture
 		Node *node;
+		RootNode *root = active_root;
 		if (!active_root)
 		{
 			// Create an initial root, if it does not exist
@@ -112,7 +113,10 @@ namespace uicore
 				{
 					node = root_nodes[index]->node.insert(texture_size, next_id);
 					if (node)	// We found space in a previous texture
+					{
+						root = root_nodes[index];
 						break;
+					}
 				}
 			}
 
@@ -121,12 +125,13 @@ namespace uicore
 				if (texture_size.width > initial_texture_size.width || texture_size.height > initial_texture_size.height)
 				{
 					// If the specified size is greater than the initial size,  then create a texture using the specified size
-					node = add_new_root(context, texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, texture_size);
 				}
 				else
 				{
-					node = add_new_root(context, initial_texture_size)->node.insert(texture_size, next_id);
+					root = add_new_root(context, initial_texture_size);
 				}
+				node = root->node.insert(texture_size, next_id);
 			}
 
 			if (node == nullptr)
@@ -135,7 +140,7 @@ namespace uicore
 
 		next_id++;
 
-		return TextureGroupImage(active_root->texture, node->image_rect);
+		return TextureGroupImage(root->texture, node->image_rect);
 	}
 
 	TextureGroupImpl::RootNode *TextureGroupImpl::add_new_root(const std::shared_ptr<GraphicContext> &context, const Size &texture_size)
@@ -164,6 +169,12 @@ namespace uicore
 	}
 
 	void TextureGroupImpl::remove(const TextureGroupImage &subtexture)
+	{
+		if (!try_remove(subtexture))
+			throw Exception("Cannot find the TextureGroupImage in the TextureGroup");
+	}
+
+	bool TextureGroupImpl::try_remove(const TextureGroupImage &subtexture)
 	{
 		// Find the texture
 		Node *node = nullptr;
@@ -198,10 +209,11 @@ namespace uicore
 			{
 				active_root = root_nodes.back();
 			}
+			return true;
 		}
 		else
 		{
-			throw Exception("Cannot find the TextureGroupImage in the TextureGroup");
+			return false;
 		}
 	}
 
@@ -50,6 +50,9 @@ namespace uicore
 		std::vector<std::shared_ptr<Texture2D>> textures() const override;
 		TextureGroupImage add(const std::shared_ptr<GraphicContext> &context, const Size &size) override { return add_new_node(context, size); }
 		void remove(const TextureGroupImage &subtexture) override;
+
+		/// \brief Same as remove, but returns false instead of throwing if the subtexture is not in the group
+		bool try_remove(const TextureGroupImage &subtexture);
 		void set_allocation_policy(TextureGroupAllocationPolicy policy) override { texture_allocation_policy = policy; }
 		void insert_texture(const std::shared_ptr<Texture2D> &texture, const Rect &texture_rect) override;
 
@@ -96,7 +96,7 @@ namespace uicore
 
 	void FontFamily_Impl::add(const FontDescription &desc, const std::string &ttf_filename)
 	{
-		add(desc, !ttf_filename.empty() ? File::read_all_bytes(ttf_filename) : nullptr);
+		add(desc, !ttf_filename.empty() ? File::open_mapped(ttf_filename) : nullptr);
 	}
 
 	void FontFamily_Impl::add(const FontDescription &desc, const std::shared_ptr<DataBuffer> &font_databuffer)
@@ -150,7 +150,7 @@ namespace uicore
 		// Obtain the best matching font file from fontconfig.
 		FontConfig &fc = FontConfig::instance();
 		std::string font_file_path = fc.match_font(typeface_name, desc);
-		auto font_databuffer = File::read_all_bytes(font_file_path);
+		auto font_databuffer = File::open_mapped(font_file_path);
 		font_face_load(desc, font_databuffer, pixel_ratio);
 #endif
 	}
@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include "UICore/Display/Image/image_import_description.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/Image/texture_compressor.h"
 #include "image_import_description_impl.h"
 
 namespace uicore
@@ -62,6 +63,11 @@ namespace uicore
 		return impl->cached;
 	}
 
+	TextureFormat ImageImportDescription::compressed_format() const
+	{
+		return impl->compressed_format;
+	}
+
 	void ImageImportDescription::set_premultiply_alpha(bool enable)
 	{
 		impl->premultiply_alpha = enable;
@@ -82,6 +88,13 @@ namespace uicore
 		impl->cached = enable;
 	}
 
+	void ImageImportDescription::set_compressed_format(TextureFormat format)
+	{
+		if (format != tf_rgba8 && !TextureCompressor::is_supported(format))
+			throw Exception("Unsupported compressed texture format");
+		impl->compressed_format = format;
+	}
+
 	std::shared_ptr<PixelBuffer> ImageImportDescription::process(std::shared_ptr<PixelBuffer> image) const
 	{
 		if (impl->premultiply_alpha)
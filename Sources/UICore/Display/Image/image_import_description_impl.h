@@ -29,6 +29,7 @@
 #pragma once
 
 #include "UICore/Core/Math/rect.h"
+#include "UICore/Display/Image/texture_format.h"
 
 namespace uicore
 {
@@ -39,6 +40,7 @@ namespace uicore
 		bool flip_vertical = false;
 		bool srgb = false;
 		bool cached = false;
+		TextureFormat compressed_format = tf_rgba8;
 
 		std::function<std::shared_ptr<PixelBuffer>(std::shared_ptr<PixelBuffer>)> func_process;
 	};
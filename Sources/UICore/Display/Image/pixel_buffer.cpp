@@ -32,6 +32,7 @@
 #include "UICore/Display/Image/pixel_converter.h"
 #include "UICore/Core/Math/color.h"
 #include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/work_queue.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Display/Render/staging_texture.h"
@@ -41,7 +42,11 @@
 #include "UICore/Core/Math/half_float.h"
 #include "UICore/Core/Math/half_float_vector.h"
 #include "cpu_pixel_buffer_provider.h"
+#include "pixel_resampler.h"
+#include "pixel_converter_impl.h"
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 namespace uicore
 {
@@ -66,6 +71,17 @@ namespace uicore
 
 			converter->convert(dest_data, dest_pitch, target->format(), src_data, src_pitch, source->format(), dest_rect.width(), dest_rect.height());
 		}
+
+		// Calls func for bands of rows, in parallel on the shared work queue for large images
+		static void process_rows(int width, int height, const std::function<void(int start_y, int end_y)> &func)
+		{
+			// Shares the thresholds of the pixel converter
+			const auto &queue = WorkQueue::shared();
+			if (width > 0 && (long long)width * height >= PixelConverterImpl::parallel_min_pixels && queue->thread_count() > 1)
+				queue->parallel_for(height, func, std::max(PixelConverterImpl::parallel_min_band_pixels / width, 1));
+			else
+				func(0, height);
+		}
 	};
 
 	std::shared_ptr<PixelBuffer> PixelBuffer::create(int width, int height, TextureFormat texture_format, const void *data, bool only_reference_data)
@@ -103,6 +119,8 @@ namespace uicore
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
 			return true;
 
 		case tf_rgb8:
@@ -283,6 +301,8 @@ namespace uicore
 			return 8;
 		case tf_compressed_rgba_s3tc_dxt5:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
 			return 16;
 		default:
 			throw Exception("cannot obtain block count for this TextureFormat");
@@ -323,6 +343,8 @@ namespace uicore
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_rgba_s3tc_dxt5:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
 			return true;
 		default:
 			return false;
@@ -396,6 +418,61 @@ namespace uicore
 		return result;
 	}
 
+	std::shared_ptr<PixelBuffer> PixelBuffer::resized(int new_width, int new_height) const
+	{
+		if (new_width <= 0 || new_height <= 0)
+			throw Exception("Invalid size passed to PixelBuffer::resized()");
+
+		// The resampler works on four 8-bit channels. Other formats are resampled as rgba8.
+		std::shared_ptr<PixelBuffer> work_pb;
+		const PixelBuffer *src = this;
+		TextureFormat work_format = format();
+		if (work_format != tf_rgba8 && work_format != tf_bgra8 && work_format != tf_srgb8_alpha8)
+		{
+			work_pb = to_format(tf_rgba8);
+			work_format = tf_rgba8;
+			src = work_pb.get();
+		}
+
+		while (src->width() >= new_width * 2 && src->height() >= new_height * 2)
+		{
+			auto half = PixelBuffer::create((src->width() + 1) / 2, (src->height() + 1) / 2, work_format);
+			PixelBufferImpl::process_rows(half->width(), half->height(), [&](int start_y, int end_y)
+			{
+				PixelResampler::box_half(src->data<unsigned char>(), src->pitch(), src->width(), src->height(), half->data<unsigned char>(), half->pitch(), start_y, end_y);
+			});
+			work_pb = half;
+			src = work_pb.get();
+		}
+
+		if (src->width() != new_width || src->height() != new_height)
+		{
+			PixelResampler::Filter filter_x = PixelResampler::create_lanczos_filter(src->width(), new_width);
+			PixelResampler::Filter filter_y = PixelResampler::create_lanczos_filter(src->height(), new_height);
+
+			std::vector<float> columns((size_t)new_width * src->height() * 4);
+			PixelBufferImpl::process_rows(new_width, src->height(), [&](int start_y, int end_y)
+			{
+				PixelResampler::filter_horizontal(src->data<unsigned char>(), src->pitch(), filter_x, new_width, columns.data(), start_y, end_y);
+			});
+
+			auto result = PixelBuffer::create(new_width, new_height, work_format);
+			PixelBufferImpl::process_rows(new_width, new_height, [&](int start_y, int end_y)
+			{
+				PixelResampler::filter_vertical(columns.data(), new_width, filter_y, result->data<unsigned char>(), result->pitch(), start_y, end_y);
+			});
+			work_pb = result;
+		}
+		else if (!work_pb)
+		{
+			work_pb = copy();
+		}
+
+		if (work_format != format())
+			work_pb = work_pb->to_format(format());
+		return work_pb;
+	}
+
 	void PixelBuffer::flip_vertical()
 	{
 		if (width() == 0 || height() <= 1)
@@ -559,75 +636,107 @@ namespace uicore
 
 	void PixelBuffer::premultiply_gamma(float gamma)
 	{
+		int w = width();
+		int h = height();
+
 		if (format() == tf_rgba8 || format() == tf_srgb8_alpha8 || format() == tf_bgra8)
 		{
-			int w = width();
-			int h = height();
-			for (int y = 0; y < h; y++)
+			unsigned char table[256];
+			for (int i = 0; i < 256; i++)
+			{
+				const float rcp_255 = 1.0f / 255.0f;
+				float value = std::pow(i * rcp_255, gamma);
+				table[i] = static_cast<unsigned char>(clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+			}
+
+			PixelBufferImpl::process_rows(w, h, [&](int start_y, int end_y)
 			{
-				Vec4ub *pixels = line<Vec4ub>(y);
-				for (int x = 0; x < w; x++)
+				for (int y = start_y; y < end_y; y++)
 				{
-					const float rcp_255 = 1.0f / 255.0f;
-					float red = std::pow(pixels[x].x * rcp_255, gamma);
-					float green = std::pow(pixels[x].y * rcp_255, gamma);
-					float blue = std::pow(pixels[x].z * rcp_255, gamma);
-					pixels[x].x = static_cast<unsigned short>(clamp(red * 255.0f + 0.5f, 0.0f, 255.0f));
-					pixels[x].y = static_cast<unsigned short>(clamp(green * 255.0f + 0.5f, 0.0f, 255.0f));
-					pixels[x].z = static_cast<unsigned short>(clamp(blue * 255.0f + 0.5f, 0.0f, 255.0f));
+					Vec4ub *pixels = line<Vec4ub>(y);
+					for (int x = 0; x < w; x++)
+					{
+						pixels[x].x = table[pixels[x].x];
+						pixels[x].y = table[pixels[x].y];
+						pixels[x].z = table[pixels[x].z];
+					}
 				}
-			}
+			});
 		}
 		else if (format() == tf_rgba16)
 		{
-			int w = width();
-			int h = height();
-			for (int y = 0; y < h; y++)
+			PixelBufferImpl::process_rows(w, h, [&](int start_y, int end_y)
 			{
-				Vec4us *pixels = line<Vec4us>(y);
-				for (int x = 0; x < w; x++)
+				for (int y = start_y; y < end_y; y++)
 				{
-					const float rcp_65535 = 1.0f / 65535.0f;
-					float red = std::pow(pixels[x].x * rcp_65535, gamma);
-					float green = std::pow(pixels[x].y * rcp_65535, gamma);
-					float blue = std::pow(pixels[x].z * rcp_65535, gamma);
-					pixels[x].x = static_cast<unsigned short>(clamp(red * 65535.0f + 0.5f, 0.0f, 65535.0f));
-					pixels[x].y = static_cast<unsigned short>(clamp(green * 65535.0f + 0.5f, 0.0f, 65535.0f));
-					pixels[x].z = static_cast<unsigned short>(clamp(blue * 65535.0f + 0.5f, 0.0f, 65535.0f));
+					Vec4us *pixels = line<Vec4us>(y);
+					for (int x = 0; x < w; x++)
+					{
+						const float rcp_65535 = 1.0f / 65535.0f;
+						float red = std::pow(pixels[x].x * rcp_65535, gamma);
+						float green = std::pow(pixels[x].y * rcp_65535, gamma);
+						float blue = std::pow(pixels[x].z * rcp_65535, gamma);
+						pixels[x].x = static_cast<unsigned short>(clamp(red * 65535.0f + 0.5f, 0.0f, 65535.0f));
+						pixels[x].y = static_cast<unsigned short>(clamp(green * 65535.0f + 0.5f, 0.0f, 65535.0f));
+						pixels[x].z = static_cast<unsigned short>(clamp(blue * 65535.0f + 0.5f, 0.0f, 65535.0f));
+					}
 				}
-			}
+			});
+		}
+		else if (format() == tf_rgba16f && (long long)w * h >= 65536)
+		{
+			// Cheaper to evaluate all half-float values once than three per pixel
+			std::vector<unsigned short> table(65536);
+			for (int i = 0; i < 65536; i++)
+				table[i] = HalfFloat::float_to_half(std::pow(HalfFloat::half_to_float(i), gamma));
+
+			PixelBufferImpl::process_rows(w, h, [&](int start_y, int end_y)
+			{
+				for (int y = start_y; y < end_y; y++)
+				{
+					unsigned short *pixels = line<unsigned short>(y);
+					for (int x = 0; x < w; x++)
+					{
+						pixels[x * 4] = table[pixels[x * 4]];
+						pixels[x * 4 + 1] = table[pixels[x * 4 + 1]];
+						pixels[x * 4 + 2] = table[pixels[x * 4 + 2]];
+					}
+				}
+			});
 		}
 		else if (format() == tf_rgba16f)
 		{
-			int w = width();
-			int h = height();
-			for (int y = 0; y < h; y++)
+			PixelBufferImpl::process_rows(w, h, [&](int start_y, int end_y)
 			{
-				Vec4hf *pixels = line<Vec4hf>(y);
-				for (int x = 0; x < w; x++)
+				for (int y = start_y; y < end_y; y++)
 				{
-					Vec4f v = pixels[x].to_float();
-					v.x = std::pow(v.x, gamma);
-					v.y = std::pow(v.y, gamma);
-					v.z = std::pow(v.z, gamma);
-					pixels[x] = Vec4hf(v);
+					Vec4hf *pixels = line<Vec4hf>(y);
+					for (int x = 0; x < w; x++)
+					{
+						Vec4f v = pixels[x].to_float();
+						v.x = std::pow(v.x, gamma);
+						v.y = std::pow(v.y, gamma);
+						v.z = std::pow(v.z, gamma);
+						pixels[x] = Vec4hf(v);
+					}
 				}
-			}
+			});
 		}
 		else if (format() == tf_rgba32f)
 		{
-			int w = width();
-			int h = height();
-			for (int y = 0; y < h; y++)
+			PixelBufferImpl::process_rows(w, h, [&](int start_y, int end_y)
 			{
-				Vec4f *pixels = line<Vec4f>(y);
-				for (int x = 0; x < w; x++)
+				for (int y = start_y; y < end_y; y++)
 				{
-					pixels[x].x = std::pow(pixels[x].x, gamma);
-					pixels[x].y = std::pow(pixels[x].y, gamma);
-					pixels[x].z = std::pow(pixels[x].z, gamma);
+					Vec4f *pixels = line<Vec4f>(y);
+					for (int x = 0; x < w; x++)
+					{
+						pixels[x].x = std::pow(pixels[x].x, gamma);
+						pixels[x].y = std::pow(pixels[x].y, gamma);
+						pixels[x].z = std::pow(pixels[x].z, gamma);
+					}
 				}
-			}
+			});
 		}
 	}
 
@@ -641,9 +750,6 @@ namespace uicore
 			border_size = 0;
 		}
 
-		int old_width = pb->width();
-		int old_height = pb->height();
-
 		int new_width = rect.width() + border_size * 2;
 		int new_height = rect.height() + border_size * 2;
 
@@ -673,8 +779,8 @@ namespace uicore
 			if (real_ypos < 0)
 				real_ypos = 0;
 
-			if (real_ypos >= old_height)
-				real_ypos = old_height - 1;
+			if (real_ypos >= rect.height())
+				real_ypos = rect.height() - 1;
 
 			int32_t *src_data = actual_src_data;
 			src_data += (old_pitch * real_ypos) / 4;
@@ -688,8 +794,8 @@ namespace uicore
 				if (real_xpos < 0)
 					real_xpos = 0;
 
-				if (real_xpos >= old_width)
-					real_xpos = old_width - 1;
+				if (real_xpos >= rect.width())
+					real_xpos = rect.width() - 1;
 
 				dest_data[xpos] = src_data[real_xpos];
 			}
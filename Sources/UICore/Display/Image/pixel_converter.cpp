@@ -31,6 +31,7 @@
 #include "UICore/Display/Image/pixel_converter.h"
 #include "UICore/Core/System/databuffer.h"
 #include "UICore/Core/System/system.h"
+#include "UICore/Core/System/work_queue.h"
 #include "pixel_converter_impl.h"
 #include "pixel_reader_cast.h"
 #include "pixel_reader_half_float.h"
@@ -54,6 +55,7 @@
 #include "pixel_filter_premultiply_alpha.h"
 #include "pixel_filter_swizzle.h"
 #include "pixel_filter_rgb_to_ycrcb.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -67,13 +69,39 @@ namespace uicore
 		bool sse2 = System::detect_cpu_extension(System::sse2);
 		bool sse4 = System::detect_cpu_extension(System::sse4_1);
 
+		PixelConverterDirect::Kernel kernel = nullptr;
+		if (!_input_is_ycrcb && !_output_is_ycrcb && _gamma == 1.0f && _swizzle == Vec4i(0, 1, 2, 3))
+		{
+			static bool avx2 = System::detect_cpu_extension(System::avx2);
+			kernel = PixelConverterDirect::find(input_format, output_format, _premultiply_alpha, sse2, avx2);
+		}
+
+		auto convert_rows = [&](int start_y, int end_y)
+		{
+			if (kernel)
+				convert_direct(kernel, output, output_pitch, output_format, input, input_pitch, input_format, width, height, start_y, end_y);
+			else
+				convert_generic(output, output_pitch, output_format, input, input_pitch, input_format, width, height, start_y, end_y, sse2, sse4);
+		};
+
+		// Large images are converted in bands of rows on the shared work queue.
+		// Rows are converted independently, so the result does not depend on how the image was split.
+		const auto &queue = WorkQueue::shared();
+		if (width > 0 && (long long)width * height >= parallel_min_pixels && queue->thread_count() > 1)
+			queue->parallel_for(height, convert_rows, std::max(parallel_min_band_pixels / width, 1));
+		else
+			convert_rows(0, height);
+	}
+
+	void PixelConverterImpl::convert_generic(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int start_y, int end_y, bool sse2, bool sse4)
+	{
 		std::unique_ptr<PixelReader> reader = create_reader(input_format, sse2);
 		std::unique_ptr<PixelWriter> writer = create_writer(output_format, sse2, sse4);
 		std::vector<std::shared_ptr<PixelFilter> > filters = create_filters(sse2);
 
 		auto work_buffer = DataBuffer::create(width * sizeof(Vec4f));
 		Vec4f *temp = work_buffer->data<Vec4f>();
-		for (int input_y = 0; input_y < height; input_y++)
+		for (int input_y = start_y; input_y < end_y; input_y++)
 		{
 			int output_y = _flip_vertical ? (height - 1 - input_y) : input_y;
 
@@ -86,6 +114,28 @@ namespace uicore
 		}
 	}
 
+	void PixelConverterImpl::convert_direct(PixelConverterDirect::Kernel kernel, void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int start_y, int end_y)
+	{
+		int input_row_size = width * PixelConverterDirect::bytes_per_pixel(input_format);
+		int output_row_size = width * PixelConverterDirect::bytes_per_pixel(output_format);
+
+		// Tightly packed rows can be converted in one go
+		if (!_flip_vertical && input_pitch == input_row_size && output_pitch == output_row_size && (long long)width * (end_y - start_y) <= 0x7fffffff)
+		{
+			kernel(static_cast<char*>(output) + (size_t)output_pitch * start_y, static_cast<const char*>(input) + (size_t)input_pitch * start_y, width * (end_y - start_y));
+			return;
+		}
+
+		for (int input_y = start_y; input_y < end_y; input_y++)
+		{
+			int output_y = _flip_vertical ? (height - 1 - input_y) : input_y;
+
+			const char *input_line = static_cast<const char*>(input)+input_pitch * input_y;
+			char *output_line = static_cast<char*>(output)+output_pitch * output_y;
+			kernel(output_line, input_line, width);
+		}
+	}
+
 	std::unique_ptr<PixelReader> PixelConverterImpl::create_reader(TextureFormat format, bool sse2)
 	{
 		switch (format)
@@ -267,6 +317,8 @@ namespace uicore
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
 		default:
 			break;
 		};
@@ -456,6 +508,8 @@ namespace uicore
 		case tf_compressed_srgb_alpha_s3tc_dxt1:
 		case tf_compressed_srgb_alpha_s3tc_dxt3:
 		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
 		default:
 			break;
 		};
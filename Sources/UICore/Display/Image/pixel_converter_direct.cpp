@@ -0,0 +1,347 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "UICore/precomp.h"
+#include "pixel_converter_direct.h"
+#include <cstring>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UICORE_TARGET_AVX2
+#endif
+#endif
+
+namespace uicore
+{
+	// Exact round(x / 255) for x in [0, 255 * 255], matching the rounding of the float writers
+	static inline unsigned int div255(unsigned int x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	static void copy4(void *output, const void *input, int num_pixels)
+	{
+		memcpy(output, input, num_pixels * 4);
+	}
+
+	static void copy3(void *output, const void *input, int num_pixels)
+	{
+		memcpy(output, input, num_pixels * 3);
+	}
+
+	static void swap_rb4(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		for (int i = 0; i < num_pixels; i++, s += 4, d += 4)
+		{
+			unsigned char r = s[0], g = s[1], b = s[2], a = s[3];
+			d[0] = b; d[1] = g; d[2] = r; d[3] = a;
+		}
+	}
+
+	static void swap_rb3(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		for (int i = 0; i < num_pixels; i++, s += 3, d += 3)
+		{
+			unsigned char r = s[0], g = s[1], b = s[2];
+			d[0] = b; d[1] = g; d[2] = r;
+		}
+	}
+
+	template<bool swap>
+	static void expand3to4(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		for (int i = 0; i < num_pixels; i++, s += 3, d += 4)
+		{
+			d[0] = swap ? s[2] : s[0];
+			d[1] = s[1];
+			d[2] = swap ? s[0] : s[2];
+			d[3] = 255;
+		}
+	}
+
+	template<bool swap>
+	static void remove_alpha4to3(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		for (int i = 0; i < num_pixels; i++, s += 4, d += 3)
+		{
+			unsigned char r = s[0], g = s[1], b = s[2];
+			d[0] = swap ? b : r;
+			d[1] = g;
+			d[2] = swap ? r : b;
+		}
+	}
+
+	template<bool swap>
+	static void premultiply4(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		for (int i = 0; i < num_pixels; i++, s += 4, d += 4)
+		{
+			unsigned int a = s[3];
+			unsigned char r = div255(s[0] * a), g = div255(s[1] * a), b = div255(s[2] * a);
+			d[0] = swap ? b : r;
+			d[1] = g;
+			d[2] = swap ? r : b;
+			d[3] = a;
+		}
+	}
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+
+	static inline __m128i swap_rb_sse2(__m128i pixels)
+	{
+		__m128i ga = _mm_and_si128(pixels, _mm_set1_epi32(0xff00ff00));
+		__m128i rb = _mm_and_si128(pixels, _mm_set1_epi32(0x00ff00ff));
+		rb = _mm_shufflelo_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+		rb = _mm_shufflehi_epi16(rb, _MM_SHUFFLE(2, 3, 0, 1));
+		return _mm_or_si128(ga, rb);
+	}
+
+	// Multiplies the color channels of eight 16-bit expanded pixels by their alpha
+	static inline __m128i premultiply_sse2(__m128i pixels)
+	{
+		__m128i alpha = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_or_si128(alpha, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+		x = _mm_add_epi16(x, _mm_srli_epi16(x, 8));
+		return _mm_srli_epi16(x, 8);
+	}
+
+	static void swap_rb4_sse2(void *output, const void *input, int num_pixels)
+	{
+		const __m128i *s = static_cast<const __m128i*>(input);
+		__m128i *d = static_cast<__m128i*>(output);
+		int sse_length = num_pixels / 4;
+		for (int i = 0; i < sse_length; i++)
+			_mm_storeu_si128(d + i, swap_rb_sse2(_mm_loadu_si128(s + i)));
+		swap_rb4(d + sse_length, s + sse_length, num_pixels - sse_length * 4);
+	}
+
+	template<bool swap>
+	static void premultiply4_sse2(void *output, const void *input, int num_pixels)
+	{
+		const __m128i *s = static_cast<const __m128i*>(input);
+		__m128i *d = static_cast<__m128i*>(output);
+		int sse_length = num_pixels / 4;
+		for (int i = 0; i < sse_length; i++)
+		{
+			__m128i pixels = _mm_loadu_si128(s + i);
+			__m128i lo = premultiply_sse2(_mm_unpacklo_epi8(pixels, _mm_setzero_si128()));
+			__m128i hi = premultiply_sse2(_mm_unpackhi_epi8(pixels, _mm_setzero_si128()));
+			pixels = _mm_packus_epi16(lo, hi);
+			if (swap)
+				pixels = swap_rb_sse2(pixels);
+			_mm_storeu_si128(d + i, pixels);
+		}
+		premultiply4<swap>(d + sse_length, s + sse_length, num_pixels - sse_length * 4);
+	}
+
+	UICORE_TARGET_AVX2 static inline __m256i premultiply_avx2(__m256i pixels)
+	{
+		__m256i alpha = _mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm256_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm256_or_si256(alpha, _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0));
+		__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+		x = _mm256_add_epi16(x, _mm256_srli_epi16(x, 8));
+		return _mm256_srli_epi16(x, 8);
+	}
+
+	UICORE_TARGET_AVX2 static void swap_rb4_avx2(void *output, const void *input, int num_pixels)
+	{
+		const __m256i *s = static_cast<const __m256i*>(input);
+		__m256i *d = static_cast<__m256i*>(output);
+		const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		int avx_length = num_pixels / 8;
+		for (int i = 0; i < avx_length; i++)
+			_mm256_storeu_si256(d + i, _mm256_shuffle_epi8(_mm256_loadu_si256(s + i), mask));
+		swap_rb4(d + avx_length, s + avx_length, num_pixels - avx_length * 8);
+	}
+
+	template<bool swap>
+	UICORE_TARGET_AVX2 static void expand3to4_avx2(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		const __m256i mask = swap ?
+			_mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+			_mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m256i alpha = _mm256_set1_epi32(0xff000000);
+
+		// Each iteration loads 16 bytes at offset 12, so stop while 4 bytes of input remain beyond the last pixel
+		int i = 0;
+		for (; i + 10 <= num_pixels; i += 8)
+		{
+			__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 3));
+			__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * 3 + 12));
+			__m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+			pixels = _mm256_or_si256(_mm256_shuffle_epi8(pixels, mask), alpha);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i * 4), pixels);
+		}
+		expand3to4<swap>(d + i * 4, s + i * 3, num_pixels - i);
+	}
+
+	template<bool swap>
+	UICORE_TARGET_AVX2 static void remove_alpha4to3_avx2(void *output, const void *input, int num_pixels)
+	{
+		const unsigned char *s = static_cast<const unsigned char*>(input);
+		unsigned char *d = static_cast<unsigned char*>(output);
+		const __m256i mask = swap ?
+			_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+			_mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+		// Each lane stores 16 bytes of which 12 are used, so stop while 4 bytes of output remain beyond the last pixel
+		int i = 0;
+		for (; i + 10 <= num_pixels; i += 8)
+		{
+			__m256i pixels = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i * 4)), mask);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 3), _mm256_castsi256_si128(pixels));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 3 + 12), _mm256_extracti128_si256(pixels, 1));
+		}
+		remove_alpha4to3<swap>(d + i * 3, s + i * 4, num_pixels - i);
+	}
+
+	template<bool swap>
+	UICORE_TARGET_AVX2 static void premultiply4_avx2(void *output, const void *input, int num_pixels)
+	{
+		const __m256i *s = static_cast<const __m256i*>(input);
+		__m256i *d = static_cast<__m256i*>(output);
+		const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		int avx_length = num_pixels / 8;
+		for (int i = 0; i < avx_length; i++)
+		{
+			__m256i pixels = _mm256_loadu_si256(s + i);
+			__m256i lo = premultiply_avx2(_mm256_unpacklo_epi8(pixels, _mm256_setzero_si256()));
+			__m256i hi = premultiply_avx2(_mm256_unpackhi_epi8(pixels, _mm256_setzero_si256()));
+			pixels = _mm256_packus_epi16(lo, hi);
+			if (swap)
+				pixels = _mm256_shuffle_epi8(pixels, mask);
+			_mm256_storeu_si256(d + i, pixels);
+		}
+		premultiply4<swap>(d + avx_length, s + avx_length, num_pixels - avx_length * 8);
+	}
+
+#endif
+
+	namespace
+	{
+		struct DirectKernel
+		{
+			TextureFormat input_format;
+			TextureFormat output_format;
+			bool premultiply_alpha;
+			PixelConverterDirect::Kernel generic;
+			PixelConverterDirect::Kernel sse2;
+			PixelConverterDirect::Kernel avx2;
+		};
+	}
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#define DIRECT_KERNEL(input, output, premultiply, generic, sse2, avx2) { input, output, premultiply, generic, sse2, avx2 }
+#else
+#define DIRECT_KERNEL(input, output, premultiply, generic, sse2, avx2) { input, output, premultiply, generic, nullptr, nullptr }
+#endif
+
+	static const DirectKernel direct_kernels[] =
+	{
+		DIRECT_KERNEL(tf_rgba8, tf_rgba8, false, copy4, nullptr, nullptr),
+		DIRECT_KERNEL(tf_bgra8, tf_bgra8, false, copy4, nullptr, nullptr),
+		DIRECT_KERNEL(tf_rgb8, tf_rgb8, false, copy3, nullptr, nullptr),
+		DIRECT_KERNEL(tf_bgr8, tf_bgr8, false, copy3, nullptr, nullptr),
+		DIRECT_KERNEL(tf_rgba8, tf_bgra8, false, swap_rb4, swap_rb4_sse2, swap_rb4_avx2),
+		DIRECT_KERNEL(tf_bgra8, tf_rgba8, false, swap_rb4, swap_rb4_sse2, swap_rb4_avx2),
+		DIRECT_KERNEL(tf_rgb8, tf_bgr8, false, swap_rb3, nullptr, nullptr),
+		DIRECT_KERNEL(tf_bgr8, tf_rgb8, false, swap_rb3, nullptr, nullptr),
+		DIRECT_KERNEL(tf_rgb8, tf_rgba8, false, expand3to4<false>, nullptr, expand3to4_avx2<false>),
+		DIRECT_KERNEL(tf_bgr8, tf_bgra8, false, expand3to4<false>, nullptr, expand3to4_avx2<false>),
+		DIRECT_KERNEL(tf_rgb8, tf_bgra8, false, expand3to4<true>, nullptr, expand3to4_avx2<true>),
+		DIRECT_KERNEL(tf_bgr8, tf_rgba8, false, expand3to4<true>, nullptr, expand3to4_avx2<true>),
+		DIRECT_KERNEL(tf_rgba8, tf_rgb8, false, remove_alpha4to3<false>, nullptr, remove_alpha4to3_avx2<false>),
+		DIRECT_KERNEL(tf_bgra8, tf_bgr8, false, remove_alpha4to3<false>, nullptr, remove_alpha4to3_avx2<false>),
+		DIRECT_KERNEL(tf_rgba8, tf_bgr8, false, remove_alpha4to3<true>, nullptr, remove_alpha4to3_avx2<true>),
+		DIRECT_KERNEL(tf_bgra8, tf_rgb8, false, remove_alpha4to3<true>, nullptr, remove_alpha4to3_avx2<true>),
+		DIRECT_KERNEL(tf_rgba8, tf_rgba8, true, premultiply4<false>, premultiply4_sse2<false>, premultiply4_avx2<false>),
+		DIRECT_KERNEL(tf_bgra8, tf_bgra8, true, premultiply4<false>, premultiply4_sse2<false>, premultiply4_avx2<false>),
+		DIRECT_KERNEL(tf_rgba8, tf_bgra8, true, premultiply4<true>, premultiply4_sse2<true>, premultiply4_avx2<true>),
+		DIRECT_KERNEL(tf_bgra8, tf_rgba8, true, premultiply4<true>, premultiply4_sse2<true>, premultiply4_avx2<true>)
+	};
+
+#undef DIRECT_KERNEL
+
+	PixelConverterDirect::Kernel PixelConverterDirect::find(TextureFormat input_format, TextureFormat output_format, bool premultiply_alpha, bool sse2, bool avx2)
+	{
+		// Premultiplying has no effect when the input has no alpha channel
+		if (input_format == tf_rgb8 || input_format == tf_bgr8)
+			premultiply_alpha = false;
+
+		for (const auto &kernel : direct_kernels)
+		{
+			if (kernel.input_format == input_format && kernel.output_format == output_format && kernel.premultiply_alpha == premultiply_alpha)
+			{
+				if (avx2 && kernel.avx2)
+					return kernel.avx2;
+				else if (sse2 && kernel.sse2)
+					return kernel.sse2;
+				else
+					return kernel.generic;
+			}
+		}
+		return nullptr;
+	}
+
+	int PixelConverterDirect::bytes_per_pixel(TextureFormat format)
+	{
+		switch (format)
+		{
+		case tf_rgba8:
+		case tf_bgra8:
+			return 4;
+		case tf_rgb8:
+		case tf_bgr8:
+			return 3;
+		default:
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include "UICore/Display/Image/texture_format.h"
+
+namespace uicore
+{
+	/// \brief Integer conversion kernels for common 8-bit format pairs
+	///
+	/// These bypass the PixelReader/PixelFilter/PixelWriter float pipeline when a conversion is
+	/// a plain copy, swizzle, channel expansion/removal or alpha premultiplication.
+	class PixelConverterDirect
+	{
+	public:
+		typedef void (*Kernel)(void *output, const void *input, int num_pixels);
+
+		/// \brief Returns a kernel converting between the formats, or null if none exists
+		static Kernel find(TextureFormat input_format, TextureFormat output_format, bool premultiply_alpha, bool sse2, bool avx2);
+
+		/// \brief Bytes per pixel for the formats handled by the direct kernels
+		static int bytes_per_pixel(TextureFormat format);
+	};
+}
@@ -31,6 +31,7 @@
 
 #include "UICore/Core/Math/vec4.h"
 #include "UICore/Core/Math/half_float_vector.h"
+#include "pixel_converter_direct.h"
 #include <memory>
 #include <vector>
 
@@ -75,7 +76,13 @@ namespace uicore
 
 		void convert(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height) override;
 
+		// Images with at least this many pixels are processed on multiple threads, in bands of at least parallel_min_band_pixels
+		static const int parallel_min_pixels = 256 * 1024;
+		static const int parallel_min_band_pixels = 64 * 1024;
+
 	private:
+		void convert_generic(void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int start_y, int end_y, bool sse2, bool sse4);
+		void convert_direct(PixelConverterDirect::Kernel kernel, void *output, int output_pitch, TextureFormat output_format, const void *input, int input_pitch, TextureFormat input_format, int width, int height, int start_y, int end_y);
 		std::unique_ptr<PixelReader> create_reader(TextureFormat format, bool sse2);
 		std::unique_ptr<PixelWriter> create_writer(TextureFormat format, bool sse2, bool sse4);
 		std::vector<std::shared_ptr<PixelFilter> > create_filters(bool sse2);
@@ -53,13 +53,13 @@ namespace uicore
 	public:
 		void filter(Vec4f *pixels, int num_pixels) override
 		{
-			__m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, 0xffffffff));
+			__m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(0xffffffff, 0, 0, 0));
 			for (int i = 0; i < num_pixels; i++)
 			{
 				__m128 pixel = _mm_loadu_ps(reinterpret_cast<float*>(pixels + i));
 
 				__m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
-				pixel = _mm_or_ps(_mm_and_ps(pixel, alpha_mask), _mm_andnot_ps(_mm_mul_ps(pixel, alpha), alpha_mask));
+				pixel = _mm_or_ps(_mm_and_ps(pixel, alpha_mask), _mm_andnot_ps(alpha_mask, _mm_mul_ps(pixel, alpha)));
 
 				_mm_storeu_ps(reinterpret_cast<float*>(pixels + i), pixel);
 			}
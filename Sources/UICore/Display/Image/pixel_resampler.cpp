@@ -0,0 +1,185 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "UICore/precomp.h"
+#include "pixel_resampler.h"
+#include <algorithm>
+#include <cmath>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace uicore
+{
+	void PixelResampler::box_half(const unsigned char *src, int src_pitch, int src_width, int src_height, unsigned char *dest, int dest_pitch, int start_y, int end_y)
+	{
+		int dest_width = (src_width + 1) / 2;
+		for (int y = start_y; y < end_y; y++)
+		{
+			const unsigned char *line0 = src + 2 * y * src_pitch;
+			const unsigned char *line1 = (2 * y + 1 < src_height) ? line0 + src_pitch : line0;
+			unsigned char *output = dest + y * dest_pitch;
+
+			int x = 0;
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+			// Two destination pixels from four source pixels in each of the two lines
+			__m128i zero = _mm_setzero_si128();
+			__m128i rounding = _mm_set1_epi16(2);
+			for (; x + 1 < src_width / 2; x += 2)
+			{
+				__m128i a = _mm_loadu_si128((const __m128i*)(line0 + x * 8));
+				__m128i b = _mm_loadu_si128((const __m128i*)(line1 + x * 8));
+				__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+				lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+				hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+				__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), rounding), 2);
+				_mm_storel_epi64((__m128i*)(output + x * 4), _mm_packus_epi16(sum, sum));
+			}
+#endif
+			for (; x < dest_width; x++)
+			{
+				int x0 = 2 * x;
+				int x1 = std::min(x0 + 1, src_width - 1);
+				for (int c = 0; c < 4; c++)
+					output[x * 4 + c] = (line0[x0 * 4 + c] + line0[x1 * 4 + c] + line1[x0 * 4 + c] + line1[x1 * 4 + c] + 2) >> 2;
+			}
+		}
+	}
+
+	static float lanczos2(float x)
+	{
+		const float pi = 3.14159265f;
+		x = std::abs(x);
+		if (x < 1e-6f)
+			return 1.0f;
+		if (x >= 2.0f)
+			return 0.0f;
+		return 2.0f * std::sin(pi * x) * std::sin(pi * x * 0.5f) / (pi * pi * x * x);
+	}
+
+	PixelResampler::Filter PixelResampler::create_lanczos_filter(int src_size, int dest_size)
+	{
+		float scale = src_size / (float)dest_size;
+		float support = 2.0f * std::max(scale, 1.0f);
+		float filter_scale = 1.0f / std::max(scale, 1.0f);
+
+		Filter filter;
+		filter.taps = (int)std::ceil(support) * 2 + 1;
+		filter.indices.resize(dest_size * filter.taps);
+		filter.weights.resize(dest_size * filter.taps);
+
+		for (int i = 0; i < dest_size; i++)
+		{
+			float center = (i + 0.5f) * scale;
+			int first = (int)std::floor(center - support);
+
+			float total = 0.0f;
+			for (int t = 0; t < filter.taps; t++)
+			{
+				float weight = lanczos2((first + t + 0.5f - center) * filter_scale);
+				filter.indices[i * filter.taps + t] = std::min(std::max(first + t, 0), src_size - 1);
+				filter.weights[i * filter.taps + t] = weight;
+				total += weight;
+			}
+			for (int t = 0; t < filter.taps; t++)
+				filter.weights[i * filter.taps + t] /= total;
+		}
+		return filter;
+	}
+
+	void PixelResampler::filter_horizontal(const unsigned char *src, int src_pitch, const Filter &filter, int dest_width, float *dest, int start_y, int end_y)
+	{
+		for (int y = start_y; y < end_y; y++)
+		{
+			const unsigned char *input = src + y * src_pitch;
+			float *output = dest + y * dest_width * 4;
+			for (int x = 0; x < dest_width; x++)
+			{
+				const int *indices = &filter.indices[x * filter.taps];
+				const float *weights = &filter.weights[x * filter.taps];
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+				__m128 sum = _mm_setzero_ps();
+				for (int t = 0; t < filter.taps; t++)
+				{
+					__m128i pixel = _mm_cvtsi32_si128(*(const int*)(input + indices[t] * 4));
+					pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(pixel, _mm_setzero_si128()), _mm_setzero_si128());
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(pixel), _mm_set1_ps(weights[t])));
+				}
+				_mm_storeu_ps(output + x * 4, sum);
+#else
+				float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (int t = 0; t < filter.taps; t++)
+				{
+					const unsigned char *pixel = input + indices[t] * 4;
+					for (int c = 0; c < 4; c++)
+						sum[c] += pixel[c] * weights[t];
+				}
+				for (int c = 0; c < 4; c++)
+					output[x * 4 + c] = sum[c];
+#endif
+			}
+		}
+	}
+
+	void PixelResampler::filter_vertical(const float *src, int width, const Filter &filter, unsigned char *dest, int dest_pitch, int start_y, int end_y)
+	{
+		for (int y = start_y; y < end_y; y++)
+		{
+			const int *indices = &filter.indices[y * filter.taps];
+			const float *weights = &filter.weights[y * filter.taps];
+			unsigned char *output = dest + y * dest_pitch;
+			for (int x = 0; x < width; x++)
+			{
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+				__m128 sum = _mm_setzero_ps();
+				for (int t = 0; t < filter.taps; t++)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + (indices[t] * width + x) * 4), _mm_set1_ps(weights[t])));
+
+				// cvtps rounds to nearest and the packs saturate to 0-255
+				__m128i pixel = _mm_cvtps_epi32(sum);
+				pixel = _mm_packs_epi32(pixel, pixel);
+				pixel = _mm_packus_epi16(pixel, pixel);
+				*(int*)(output + x * 4) = _mm_cvtsi128_si32(pixel);
+#else
+				float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (int t = 0; t < filter.taps; t++)
+				{
+					const float *pixel = src + (indices[t] * width + x) * 4;
+					for (int c = 0; c < 4; c++)
+						sum[c] += pixel[c] * weights[t];
+				}
+				for (int c = 0; c < 4; c++)
+					output[x * 4 + c] = (unsigned char)std::min(std::max(sum[c] + 0.5f, 0.0f), 255.0f);
+#endif
+			}
+		}
+	}
+}
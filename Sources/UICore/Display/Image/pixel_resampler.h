@@ -0,0 +1,64 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace uicore
+{
+	/// \brief Resampling kernels for images with four 8-bit channels
+	///
+	/// All functions process the destination rows from start_y to end_y, so they can be run in parallel bands.
+	class PixelResampler
+	{
+	public:
+		/// \brief Source pixels and weights contributing to each destination pixel along one axis
+		struct Filter
+		{
+			int taps = 0;
+			std::vector<int> indices; // taps entries per destination pixel, clamped to the source edges
+			std::vector<float> weights;
+		};
+
+		/// \brief Halves the image with a 2x2 box filter
+		///
+		/// The destination is (src_width + 1) / 2 by (src_height + 1) / 2. An odd last column or row is averaged with itself.
+		static void box_half(const unsigned char *src, int src_pitch, int src_width, int src_height, unsigned char *dest, int dest_pitch, int start_y, int end_y);
+
+		/// \brief Creates a Lanczos-2 filter, widened by the scale factor when reducing
+		static Filter create_lanczos_filter(int src_size, int dest_size);
+
+		/// \brief Filters the rows horizontally into four floats per pixel
+		static void filter_horizontal(const unsigned char *src, int src_pitch, const Filter &filter, int dest_width, float *dest, int start_y, int end_y);
+
+		/// \brief Filters the output of filter_horizontal vertically and stores the result as 8-bit
+		static void filter_vertical(const float *src, int width, const Filter &filter, unsigned char *dest, int dest_pitch, int start_y, int end_y);
+	};
+}
@@ -0,0 +1,764 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Display/Image/texture_compressor.h"
+#include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/Image/image_import_description.h"
+#include "UICore/Display/Render/texture_2d.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/system.h"
+#include "UICore/Core/System/work_queue.h"
+#include "texture_compressor_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace uicore
+{
+	namespace
+	{
+		std::mutex metrics_mutex;
+		TextureCompressionMetrics metrics_counters;
+	}
+
+	/// \brief Encodes one block of 4x4 rgba8 pixels
+	///
+	/// Endpoints are found by fitting a line through the pixels, followed by least squares refinement against the chosen indices.
+	class TextureBlockEncoder
+	{
+	public:
+		static void encode_bc1(const unsigned char *pixels, unsigned char *out) { encode_color(pixels, false, out); }
+		static void encode_bc1_alpha(const unsigned char *pixels, unsigned char *out) { encode_color(pixels, true, out); }
+
+		static void encode_bc2(const unsigned char *pixels, unsigned char *out)
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				int alpha0 = (pixels[i * 8 + 3] * 15 + 127) / 255;
+				int alpha1 = (pixels[i * 8 + 7] * 15 + 127) / 255;
+				out[i] = alpha0 | (alpha1 << 4);
+			}
+			encode_color(pixels, false, out + 8);
+		}
+
+		static void encode_bc3(const unsigned char *pixels, unsigned char *out)
+		{
+			encode_alpha(pixels, out);
+			encode_color(pixels, false, out + 8);
+		}
+
+		static void encode_bc7(const unsigned char *pixels, unsigned char *out)
+		{
+			float endpoint0[4], endpoint1[4];
+			fit_line(pixels, 0xffff, 4, endpoint0, endpoint1);
+
+			BC7Mode6 best;
+			int best_error = evaluate_bc7(pixels, endpoint0, endpoint1, best);
+			for (int iteration = 0; iteration < 2 && best_error > 0; iteration++)
+			{
+				float weights[16];
+				for (int i = 0; i < 16; i++)
+					weights[i] = bc7_weights[best.indices[i]] / 64.0f;
+				if (!least_squares(pixels, 0xffff, 4, weights, endpoint0, endpoint1))
+					break;
+
+				BC7Mode6 block;
+				int error = evaluate_bc7(pixels, endpoint0, endpoint1, block);
+				if (error >= best_error)
+					break;
+				best_error = error;
+				best = block;
+			}
+
+			// The most significant bit of the first index is implied to be zero
+			if (best.indices[0] >= 8)
+			{
+				for (int c = 0; c < 4; c++)
+					std::swap(best.endpoints[0][c], best.endpoints[1][c]);
+				std::swap(best.pbits[0], best.pbits[1]);
+				for (int i = 0; i < 16; i++)
+					best.indices[i] = 15 - best.indices[i];
+			}
+
+			BitWriter writer;
+			writer.write(1 << 6, 7);
+			for (int c = 0; c < 4; c++)
+			{
+				writer.write(best.endpoints[0][c], 7);
+				writer.write(best.endpoints[1][c], 7);
+			}
+			writer.write(best.pbits[0], 1);
+			writer.write(best.pbits[1], 1);
+			writer.write(best.indices[0], 3);
+			for (int i = 1; i < 16; i++)
+				writer.write(best.indices[i], 4);
+			writer.store(out);
+		}
+
+	private:
+		struct BC7Mode6
+		{
+			int endpoints[2][4];
+			int pbits[2];
+			unsigned char indices[16];
+		};
+
+		class BitWriter
+		{
+		public:
+			void write(unsigned int value, int bits)
+			{
+				for (int i = 0; i < bits; i++, pos++)
+				{
+					if (value & (1 << i))
+						data[pos / 64] |= 1ull << (pos % 64);
+				}
+			}
+
+			void store(unsigned char *out) const
+			{
+				for (int i = 0; i < 16; i++)
+					out[i] = (unsigned char)(data[i / 8] >> ((i % 8) * 8));
+			}
+
+		private:
+			uint64_t data[2] = { 0, 0 };
+			int pos = 0;
+		};
+
+		static const int bc7_weights[16];
+
+		static float clamp_channel(float v) { return std::max(std::min(v, 255.0f), 0.0f); }
+
+		/// \brief Finds the principal axis of the pixels in the mask and returns the extent of the pixels projected onto it
+		static void fit_line(const unsigned char *pixels, unsigned int mask, int channels, float *endpoint0, float *endpoint1)
+		{
+			float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+			float maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			int count = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				if (mask & (1 << i))
+				{
+					for (int c = 0; c < channels; c++)
+					{
+						float v = pixels[i * 4 + c];
+						mean[c] += v;
+						minimum[c] = std::min(minimum[c], v);
+						maximum[c] = std::max(maximum[c], v);
+					}
+					count++;
+				}
+			}
+			for (int c = 0; c < channels; c++)
+				mean[c] /= count;
+
+			float covariance[4][4] = {};
+			for (int i = 0; i < 16; i++)
+			{
+				if (mask & (1 << i))
+				{
+					float d[4];
+					for (int c = 0; c < channels; c++)
+						d[c] = pixels[i * 4 + c] - mean[c];
+					for (int a = 0; a < channels; a++)
+					{
+						for (int b = a; b < channels; b++)
+							covariance[a][b] += d[a] * d[b];
+					}
+				}
+			}
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < a; b++)
+					covariance[a][b] = covariance[b][a];
+			}
+
+			// Power iteration, starting along the diagonal of the bounding box
+			float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int c = 0; c < channels; c++)
+				axis[c] = maximum[c] - minimum[c];
+			for (int iteration = 0; iteration < 8; iteration++)
+			{
+				float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				float largest = 0.0f;
+				for (int a = 0; a < channels; a++)
+				{
+					for (int b = 0; b < channels; b++)
+						next[a] += covariance[a][b] * axis[b];
+					largest = std::max(largest, std::abs(next[a]));
+				}
+				if (largest == 0.0f)
+					break;
+				for (int c = 0; c < channels; c++)
+					axis[c] = next[c] / largest;
+			}
+
+			float length2 = 0.0f;
+			for (int c = 0; c < channels; c++)
+				length2 += axis[c] * axis[c];
+
+			float tmin = 0.0f, tmax = 0.0f;
+			if (length2 > 1e-6f)
+			{
+				tmin = 1e30f;
+				tmax = -1e30f;
+				for (int i = 0; i < 16; i++)
+				{
+					if (mask & (1 << i))
+					{
+						float t = 0.0f;
+						for (int c = 0; c < channels; c++)
+							t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+						t /= length2;
+						tmin = std::min(tmin, t);
+						tmax = std::max(tmax, t);
+					}
+				}
+			}
+
+			for (int c = 0; c < channels; c++)
+			{
+				endpoint0[c] = clamp_channel(mean[c] + axis[c] * tmin);
+				endpoint1[c] = clamp_channel(mean[c] + axis[c] * tmax);
+			}
+		}
+
+		/// \brief Solves for the endpoints that best reproduce the pixels in the mask at the given interpolation weights
+		static bool least_squares(const unsigned char *pixels, unsigned int mask, int channels, const float *weights, float *endpoint0, float *endpoint1)
+		{
+			float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+			float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (int i = 0; i < 16; i++)
+			{
+				if (mask & (1 << i))
+				{
+					float b = weights[i];
+					float a = 1.0f - b;
+					aa += a * a;
+					bb += b * b;
+					ab += a * b;
+					for (int c = 0; c < channels; c++)
+					{
+						ax[c] += a * pixels[i * 4 + c];
+						bx[c] += b * pixels[i * 4 + c];
+					}
+				}
+			}
+
+			float det = aa * bb - ab * ab;
+			if (std::abs(det) < 1e-6f)
+				return false;
+
+			float inv_det = 1.0f / det;
+			for (int c = 0; c < channels; c++)
+			{
+				endpoint0[c] = clamp_channel((ax[c] * bb - bx[c] * ab) * inv_det);
+				endpoint1[c] = clamp_channel((bx[c] * aa - ax[c] * ab) * inv_det);
+			}
+			return true;
+		}
+
+		/// \brief Finds the nearest palette entry for the pixels in the mask and returns the total squared error
+		static int find_indices(const unsigned char *pixels, const unsigned char *palette, int palette_size, bool use_alpha, unsigned int mask, unsigned char *indices)
+		{
+			int distances[16];
+			int best_indices[16];
+
+#if !defined __ANDROID__ && ! defined CL_DISABLE_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i channel_mask = _mm_set1_epi32(use_alpha ? -1 : 0x00ffffff);
+
+			__m128i pixels_lo[4], pixels_hi[4], best_distance[4], best_index[4];
+			for (int j = 0; j < 4; j++)
+			{
+				__m128i p = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + j * 16)), channel_mask);
+				pixels_lo[j] = _mm_unpacklo_epi8(p, zero);
+				pixels_hi[j] = _mm_unpackhi_epi8(p, zero);
+				best_distance[j] = _mm_set1_epi32(0x7fffffff);
+				best_index[j] = zero;
+			}
+
+			for (int k = 0; k < palette_size; k++)
+			{
+				int entry;
+				memcpy(&entry, palette + k * 4, 4);
+				__m128i color = _mm_unpacklo_epi8(_mm_and_si128(_mm_set1_epi32(entry), channel_mask), zero);
+				__m128i index = _mm_set1_epi32(k);
+
+				for (int j = 0; j < 4; j++)
+				{
+					// Squared distance of each channel pair, then the pairs summed for each of the four pixels
+					__m128i lo = _mm_sub_epi16(pixels_lo[j], color);
+					__m128i hi = _mm_sub_epi16(pixels_hi[j], color);
+					__m128 sums_lo = _mm_castsi128_ps(_mm_madd_epi16(lo, lo));
+					__m128 sums_hi = _mm_castsi128_ps(_mm_madd_epi16(hi, hi));
+					__m128i distance = _mm_add_epi32(
+						_mm_castps_si128(_mm_shuffle_ps(sums_lo, sums_hi, _MM_SHUFFLE(2, 0, 2, 0))),
+						_mm_castps_si128(_mm_shuffle_ps(sums_lo, sums_hi, _MM_SHUFFLE(3, 1, 3, 1))));
+
+					__m128i closer = _mm_cmplt_epi32(distance, best_distance[j]);
+					best_distance[j] = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best_distance[j]));
+					best_index[j] = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, best_index[j]));
+				}
+			}
+
+			for (int j = 0; j < 4; j++)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(distances + j * 4), best_distance[j]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(best_indices + j * 4), best_index[j]);
+			}
+#else
+			int channels = use_alpha ? 4 : 3;
+			for (int i = 0; i < 16; i++)
+			{
+				distances[i] = 0x7fffffff;
+				best_indices[i] = 0;
+				for (int k = 0; k < palette_size; k++)
+				{
+					int distance = 0;
+					for (int c = 0; c < channels; c++)
+					{
+						int d = pixels[i * 4 + c] - palette[k * 4 + c];
+						distance += d * d;
+					}
+					if (distance < distances[i])
+					{
+						distances[i] = distance;
+						best_indices[i] = k;
+					}
+				}
+			}
+#endif
+
+			int error = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				if (mask & (1 << i))
+				{
+					error += distances[i];
+					indices[i] = best_indices[i];
+				}
+			}
+			return error;
+		}
+
+		static int to_565(const float *color)
+		{
+			int r = (int)(color[0] * (31.0f / 255.0f) + 0.5f);
+			int g = (int)(color[1] * (63.0f / 255.0f) + 0.5f);
+			int b = (int)(color[2] * (31.0f / 255.0f) + 0.5f);
+			return (r << 11) | (g << 5) | b;
+		}
+
+		static void from_565(int color, unsigned char *out)
+		{
+			int r = color >> 11;
+			int g = (color >> 5) & 63;
+			int b = color & 31;
+			out[0] = (r << 3) | (r >> 2);
+			out[1] = (g << 2) | (g >> 4);
+			out[2] = (b << 3) | (b >> 2);
+			out[3] = 255;
+		}
+
+		static void encode_color(const unsigned char *pixels, bool punch_through, unsigned char *out)
+		{
+			unsigned int mask = 0xffff;
+			if (punch_through)
+			{
+				mask = 0;
+				for (int i = 0; i < 16; i++)
+				{
+					if (pixels[i * 4 + 3] >= 128)
+						mask |= 1 << i;
+				}
+			}
+
+			if (mask == 0)
+			{
+				// Fully transparent block
+				memset(out, 0, 4);
+				memset(out + 4, 0xff, 4);
+				return;
+			}
+
+			bool three_color = mask != 0xffff;
+
+			float endpoint0[4], endpoint1[4];
+			fit_line(pixels, mask, 3, endpoint0, endpoint1);
+
+			unsigned char best[8];
+			int best_error = evaluate_color(pixels, mask, three_color, to_565(endpoint0), to_565(endpoint1), best);
+			for (int iteration = 0; iteration < 2 && best_error > 0; iteration++)
+			{
+				static const float weights4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+				static const float weights3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+				float weights[16];
+				for (int i = 0; i < 16; i++)
+				{
+					int index = (best[4 + i / 4] >> ((i % 4) * 2)) & 3;
+					weights[i] = three_color ? weights3[index] : weights4[index];
+				}
+				if (!least_squares(pixels, mask, 3, weights, endpoint0, endpoint1))
+					break;
+
+				unsigned char block[8];
+				int error = evaluate_color(pixels, mask, three_color, to_565(endpoint0), to_565(endpoint1), block);
+				if (error >= best_error)
+					break;
+				best_error = error;
+				memcpy(best, block, 8);
+			}
+
+			memcpy(out, best, 8);
+		}
+
+		static int evaluate_color(const unsigned char *pixels, unsigned int mask, bool three_color, int color0, int color1, unsigned char *out)
+		{
+			// The order of the endpoints selects between the four color and the three color plus transparent modes
+			if (three_color ? color0 > color1 : color0 < color1)
+				std::swap(color0, color1);
+
+			unsigned char palette[4 * 4];
+			from_565(color0, palette);
+			from_565(color1, palette + 4);
+			for (int c = 0; c < 4; c++)
+			{
+				if (three_color)
+				{
+					palette[8 + c] = (palette[c] + palette[4 + c]) / 2;
+				}
+				else
+				{
+					palette[8 + c] = (2 * palette[c] + palette[4 + c]) / 3;
+					palette[12 + c] = (palette[c] + 2 * palette[4 + c]) / 3;
+				}
+			}
+
+			unsigned char indices[16];
+			int error = find_indices(pixels, palette, three_color ? 3 : 4, false, mask, indices);
+
+			unsigned int bits = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int index = (mask & (1 << i)) ? indices[i] : 3;
+				bits |= index << (i * 2);
+			}
+
+			out[0] = color0 & 0xff;
+			out[1] = color0 >> 8;
+			out[2] = color1 & 0xff;
+			out[3] = color1 >> 8;
+			for (int i = 0; i < 4; i++)
+				out[4 + i] = (bits >> (i * 8)) & 0xff;
+			return error;
+		}
+
+		static void encode_alpha(const unsigned char *pixels, unsigned char *out)
+		{
+			int minimum = 255, maximum = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				minimum = std::min(minimum, (int)pixels[i * 4 + 3]);
+				maximum = std::max(maximum, (int)pixels[i * 4 + 3]);
+			}
+
+			out[0] = maximum;
+			out[1] = minimum;
+			if (minimum == maximum)
+			{
+				memset(out + 2, 0, 6);
+				return;
+			}
+
+			// Eight value mode: the two endpoints and six interpolated values
+			int palette[8];
+			palette[0] = maximum;
+			palette[1] = minimum;
+			for (int k = 2; k < 8; k++)
+				palette[k] = ((8 - k) * maximum + (k - 1) * minimum + 3) / 7;
+
+			uint64_t bits = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int alpha = pixels[i * 4 + 3];
+				int best_index = 0;
+				int best_distance = 256;
+				for (int k = 0; k < 8; k++)
+				{
+					int distance = std::abs(alpha - palette[k]);
+					if (distance < best_distance)
+					{
+						best_distance = distance;
+						best_index = k;
+					}
+				}
+				bits |= (uint64_t)best_index << (i * 3);
+			}
+
+			for (int i = 0; i < 6; i++)
+				out[2 + i] = (bits >> (i * 8)) & 0xff;
+		}
+
+		static int evaluate_bc7(const unsigned char *pixels, const float *endpoint0, const float *endpoint1, BC7Mode6 &result)
+		{
+			// Each endpoint has 7 bits per channel plus a shared lowest bit
+			const float *endpoints[2] = { endpoint0, endpoint1 };
+			int values[2][4];
+			for (int e = 0; e < 2; e++)
+			{
+				float best_error = 1e30f;
+				for (int pbit = 0; pbit < 2; pbit++)
+				{
+					int q[4];
+					float error = 0.0f;
+					for (int c = 0; c < 4; c++)
+					{
+						q[c] = std::max(std::min((int)((endpoints[e][c] - pbit) * 0.5f + 0.5f), 127), 0);
+						float d = ((q[c] << 1) | pbit) - endpoints[e][c];
+						error += d * d;
+					}
+					if (error < best_error)
+					{
+						best_error = error;
+						result.pbits[e] = pbit;
+						for (int c = 0; c < 4; c++)
+						{
+							result.endpoints[e][c] = q[c];
+							values[e][c] = (q[c] << 1) | pbit;
+						}
+					}
+				}
+			}
+
+			unsigned char palette[16 * 4];
+			for (int k = 0; k < 16; k++)
+			{
+				for (int c = 0; c < 4; c++)
+					palette[k * 4 + c] = ((64 - bc7_weights[k]) * values[0][c] + bc7_weights[k] * values[1][c] + 32) >> 6;
+			}
+
+			return find_indices(pixels, palette, 16, true, 0xffff, result.indices);
+		}
+	};
+
+	const int TextureBlockEncoder::bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	bool TextureCompressor::is_supported(TextureFormat format)
+	{
+		switch (format)
+		{
+		case tf_compressed_rgb_s3tc_dxt1:
+		case tf_compressed_rgba_s3tc_dxt1:
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_rgba_s3tc_dxt5:
+		case tf_compressed_srgb_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt5:
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	TextureFormat TextureCompressor::srgb_format(TextureFormat format)
+	{
+		switch (format)
+		{
+		case tf_compressed_rgb_s3tc_dxt1:
+		case tf_compressed_srgb_s3tc_dxt1:
+			return tf_compressed_srgb_s3tc_dxt1;
+		case tf_compressed_rgba_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt1:
+			return tf_compressed_srgb_alpha_s3tc_dxt1;
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
+			return tf_compressed_srgb_alpha_s3tc_dxt3;
+		case tf_compressed_rgba_s3tc_dxt5:
+		case tf_compressed_srgb_alpha_s3tc_dxt5:
+			return tf_compressed_srgb_alpha_s3tc_dxt5;
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+			return tf_compressed_srgb_alpha_bptc_unorm;
+		default:
+			throw Exception("Texture format has no sRGB variant");
+		}
+	}
+
+	std::shared_ptr<PixelBuffer> TextureCompressor::compress(const std::shared_ptr<PixelBuffer> &image, TextureFormat format)
+	{
+		void(*encode_block)(const unsigned char *pixels, unsigned char *out);
+		switch (format)
+		{
+		case tf_compressed_rgb_s3tc_dxt1:
+		case tf_compressed_srgb_s3tc_dxt1:
+			encode_block = &TextureBlockEncoder::encode_bc1;
+			break;
+		case tf_compressed_rgba_s3tc_dxt1:
+		case tf_compressed_srgb_alpha_s3tc_dxt1:
+			encode_block = &TextureBlockEncoder::encode_bc1_alpha;
+			break;
+		case tf_compressed_rgba_s3tc_dxt3:
+		case tf_compressed_srgb_alpha_s3tc_dxt3:
+			encode_block = &TextureBlockEncoder::encode_bc2;
+			break;
+		case tf_compressed_rgba_s3tc_dxt5:
+		case tf_compressed_srgb_alpha_s3tc_dxt5:
+			encode_block = &TextureBlockEncoder::encode_bc3;
+			break;
+		case tf_compressed_rgba_bptc_unorm:
+		case tf_compressed_srgb_alpha_bptc_unorm:
+			encode_block = &TextureBlockEncoder::encode_bc7;
+			break;
+		default:
+			throw Exception("Unsupported compressed texture format");
+		}
+
+		int64_t start_time = System::microseconds();
+
+		std::shared_ptr<PixelBuffer> rgba = image;
+		if (image->format() != tf_rgba8 && image->format() != tf_srgb8_alpha8)
+			rgba = image->to_format(tf_rgba8);
+
+		int width = rgba->width();
+		int height = rgba->height();
+		int blocks_x = (width + 3) / 4;
+		int blocks_y = (height + 3) / 4;
+		int bytes_per_block = PixelBuffer::bytes_per_block(format);
+
+		auto result = PixelBuffer::create(width, height, format);
+		const unsigned char *src = rgba->data<unsigned char>();
+		int src_pitch = rgba->pitch();
+		unsigned char *dest = result->data<unsigned char>();
+
+		auto encode_rows = [&](int start_y, int end_y)
+		{
+			unsigned char pixels[16 * 4];
+			for (int block_y = start_y; block_y < end_y; block_y++)
+			{
+				for (int block_x = 0; block_x < blocks_x; block_x++)
+				{
+					// Partial blocks repeat the last column and row
+					for (int y = 0; y < 4; y++)
+					{
+						const unsigned char *line = src + std::min(block_y * 4 + y, height - 1) * src_pitch;
+						if (block_x * 4 + 4 <= width)
+						{
+							memcpy(pixels + y * 16, line + block_x * 16, 16);
+						}
+						else
+						{
+							for (int x = 0; x < 4; x++)
+								memcpy(pixels + y * 16 + x * 4, line + std::min(block_x * 4 + x, width - 1) * 4, 4);
+						}
+					}
+					encode_block(pixels, dest + ((size_t)block_y * blocks_x + block_x) * bytes_per_block);
+				}
+			}
+		};
+
+		const int parallel_min_blocks = 4 * 1024;
+		const int parallel_min_band_blocks = 1024;
+
+		const auto &queue = WorkQueue::shared();
+		if (blocks_x > 0 && (long long)blocks_x * blocks_y >= parallel_min_blocks && queue->thread_count() > 1)
+			queue->parallel_for(blocks_y, encode_rows, std::max(parallel_min_band_blocks / blocks_x, 1));
+		else
+			encode_rows(0, blocks_y);
+
+		int64_t encode_time = System::microseconds() - start_time;
+
+		std::unique_lock<std::mutex> lock(metrics_mutex);
+		metrics_counters.compressed_images++;
+		metrics_counters.uncompressed_bytes += (int64_t)width * height * 4;
+		metrics_counters.compressed_bytes += result->data_size();
+		metrics_counters.encode_microseconds += encode_time;
+		return result;
+	}
+
+	TextureCompressionMetrics TextureCompressor::metrics()
+	{
+		std::unique_lock<std::mutex> lock(metrics_mutex);
+		return metrics_counters;
+	}
+
+	void TextureCompressor::reset_metrics()
+	{
+		std::unique_lock<std::mutex> lock(metrics_mutex);
+		metrics_counters = TextureCompressionMetrics();
+	}
+
+	std::shared_ptr<Texture2D> TextureCompressorImpl::create_texture(const std::shared_ptr<GraphicContext> &gc, const std::shared_ptr<PixelBuffer> &image, const ImageImportDescription &import_desc)
+	{
+		std::shared_ptr<PixelBuffer> pb = image;
+		TextureFormat format;
+		if (pb->is_compressed())
+		{
+			format = import_desc.is_srgb() && TextureCompressor::is_supported(pb->format()) ? TextureCompressor::srgb_format(pb->format()) : pb->format();
+		}
+		else if (import_desc.compressed_format() != tf_rgba8)
+		{
+			format = import_desc.is_srgb() ? TextureCompressor::srgb_format(import_desc.compressed_format()) : import_desc.compressed_format();
+			pb = TextureCompressor::compress(pb, format);
+		}
+		else
+		{
+			format = import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8;
+		}
+
+		int64_t start_time = System::microseconds();
+		auto texture = Texture2D::create(gc, pb->width(), pb->height(), format);
+		texture->set_subimage(gc, Point(0, 0), pb, Rect(pb->size()), 0);
+		add_upload(pb->is_compressed(), pb->data_size(), System::microseconds() - start_time);
+		return texture;
+	}
+
+	void TextureCompressorImpl::add_upload(bool compressed, int64_t bytes, int64_t microseconds)
+	{
+		std::unique_lock<std::mutex> lock(metrics_mutex);
+		metrics_counters.uploads++;
+		if (compressed)
+			metrics_counters.compressed_uploads++;
+		metrics_counters.upload_bytes += bytes;
+		metrics_counters.upload_microseconds += microseconds;
+	}
+}
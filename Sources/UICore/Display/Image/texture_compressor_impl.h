@@ -0,0 +1,50 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    Mark Page
+*/
+
+#pragma once
+
+#include "UICore/Display/Image/texture_compressor.h"
+
+namespace uicore
+{
+	class GraphicContext;
+	class Texture2D;
+	class ImageImportDescription;
+
+	class TextureCompressorImpl
+	{
+	public:
+		/// \brief Creates a texture for an image loaded from a file and uploads it
+		///
+		/// The image is compressed first if the import description asks for it. Images that are already compressed are uploaded as is.
+		static std::shared_ptr<Texture2D> create_texture(const std::shared_ptr<GraphicContext> &gc, const std::shared_ptr<PixelBuffer> &image, const ImageImportDescription &import_desc);
+
+		static void add_upload(bool compressed, int64_t bytes, int64_t microseconds);
+	};
+}
@@ -33,9 +33,15 @@
 namespace uicore
 {
 	JPEGBitReader::JPEGBitReader(JPEGFileReader *reader)
-		: reader(reader), length(0), pos(0), bitpos(0)
+		: reader(reader), data(nullptr), length(0), pos(0), bitpos(0)
 	{
 		buffer.resize(16 * 1024);
+		data = &buffer[0];
+	}
+
+	JPEGBitReader::JPEGBitReader(const unsigned char *data, int length)
+		: reader(nullptr), data(data), length(length), pos(0), bitpos(0)
+	{
 	}
 
 	void JPEGBitReader::reset()
@@ -55,6 +61,9 @@ namespace uicore
 		}
 		if (pos == length)
 		{
+			if (!reader)
+				throw Exception("Premature end of JPEG entropy data");
+
 			length = reader->read_entropy_data(&buffer[0], buffer.size());
 			if (length == 0)
 			{
@@ -64,7 +73,7 @@ namespace uicore
 			pos = 0;
 		}
 
-		unsigned int v = (buffer[pos] >> (7 - bitpos)) & 0x01;
+		unsigned int v = (data[pos] >> (7 - bitpos)) & 0x01;
 		bitpos++;
 		return v;
 	}
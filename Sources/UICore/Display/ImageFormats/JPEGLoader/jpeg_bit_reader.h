@@ -36,6 +36,7 @@ namespace uicore
 	{
 	public:
 		JPEGBitReader(JPEGFileReader *reader);
+		JPEGBitReader(const unsigned char *data, int length);
 
 		void reset();
 		unsigned int get_bit();
@@ -44,6 +45,7 @@ namespace uicore
 	private:
 		JPEGFileReader *reader;
 		std::vector<unsigned char> buffer;
+		const unsigned char *data;
 		int length;
 		int pos;
 		int bitpos;
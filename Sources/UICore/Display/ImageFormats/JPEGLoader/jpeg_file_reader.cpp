@@ -361,4 +361,56 @@ namespace uicore
 		}
 		return j;
 	}
+
+	void JPEGFileReader::read_entropy_intervals(std::vector<unsigned char> &out_data, std::vector<int> &out_interval_offsets)
+	{
+		// Reads the entropy data up to the next marker that is not a restart marker. The stuffed zero
+		// bytes are removed and the offset where each restart interval begins is recorded.
+
+		out_data.clear();
+		out_interval_offsets.clear();
+		out_interval_offsets.push_back(0);
+
+		std::vector<uint8_t> chunk(64 * 1024);
+		while (true)
+		{
+			int start = iodevice->position();
+			int len = iodevice->try_read(&chunk[0], chunk.size());
+			if (len == 0)
+				return;
+
+			int i;
+			for (i = 0; i < len; i++)
+			{
+				if (chunk[i] != 0xff)
+				{
+					out_data.push_back(chunk[i]);
+				}
+				else if (i + 1 == len)
+				{
+					if (len == 1)
+						return;
+					break; // Read the byte after 0xff with the next chunk
+				}
+				else if (chunk[i + 1] == 0x00)
+				{
+					out_data.push_back(0xff);
+					i++;
+				}
+				else if (chunk[i + 1] >= marker_rst0 && chunk[i + 1] <= marker_rst7)
+				{
+					out_interval_offsets.push_back(out_data.size());
+					i++;
+				}
+				else if (chunk[i + 1] != 0xff) // 0xff followed by 0xff is fill
+				{
+					iodevice->seek(start + i);
+					return;
+				}
+			}
+
+			if (i < len)
+				iodevice->seek(start + i);
+		}
+	}
 }
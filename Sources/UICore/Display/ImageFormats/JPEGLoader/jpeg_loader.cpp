@@ -32,53 +32,91 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "UICore/Core/System/work_queue.h"
+#include "UICore/Display/ImageFormats/image_file.h"
+#include <algorithm>
 
 namespace uicore
 {
-	std::shared_ptr<PixelBuffer> JPEGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb)
+	std::shared_ptr<PixelBuffer> JPEGLoader::load(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator, const Size &max_size)
 	{
-		JPEGLoader loader(iodevice);
-		JPEGMCUDecoder mcu_decoder(&loader);
-		JPEGRGBDecoder rgb_decoder(&loader);
+		if (scale_denominator != 1 && scale_denominator != 2 && scale_denominator != 4 && scale_denominator != 8)
+			throw Exception("JPEG scale denominator must be 1, 2, 4 or 8");
 
-		int image_width = loader.start_of_frame.width;
-		int image_height = loader.start_of_frame.height;
-		auto image = PixelBuffer::create(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+		JPEGLoader loader(iodevice, srgb, scale_denominator, max_size);
+
+		// Baseline images with a single interleaved scan have already been decoded while the scan was read
+		if (loader.image)
+			return loader.image;
+
+		loader.create_image();
+
+		// MCU rows are independent once the entropy data has been decoded
+		WorkQueue::shared()->parallel_for(loader.mcu_height, [&](int start_row, int end_row)
+		{
+			JPEGMCUDecoder mcu_decoder(&loader);
+			JPEGRGBDecoder rgb_decoder(&loader);
+			for (int mcu_row = start_row; mcu_row < end_row; mcu_row++)
+				loader.convert_mcu_row(loader.component_dcts, mcu_row * loader.mcu_width, mcu_row, mcu_decoder, rgb_decoder);
+		}, loader.get_min_rows_per_batch());
+
+		return loader.image;
+	}
+
+	void JPEGLoader::create_image()
+	{
+		int width = (start_of_frame.width + scale_denominator - 1) / scale_denominator;
+		int height = (start_of_frame.height + scale_denominator - 1) / scale_denominator;
+		image = PixelBuffer::create(width, height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+	}
+
+	int JPEGLoader::get_min_rows_per_batch() const
+	{
+		return std::max(64 * 1024 / std::max(start_of_frame.width * mcu_y * 8, 1), 1);
+	}
+
+	void JPEGLoader::create_row_dcts(std::vector<JPEGComponentDCTs> &dcts) const
+	{
+		dcts.resize(start_of_frame.components.size());
+		for (size_t c = 0; c < dcts.size(); c++)
+			dcts[c].resize(mcu_width * start_of_frame.components[c].horz_sampling_factor * start_of_frame.components[c].vert_sampling_factor);
+	}
+
+	void JPEGLoader::convert_mcu_row(std::vector<JPEGComponentDCTs> &dcts, int first_block, int mcu_row, JPEGMCUDecoder &mcu_decoder, JPEGRGBDecoder &rgb_decoder)
+	{
+		int image_width = image->width();
+		int image_height = image->height();
 		unsigned int *image_pixels = image->data_uint32();
 
 		const unsigned int *block_pixels = rgb_decoder.get_pixels();
 		int block_width = rgb_decoder.get_width();
 		int block_height = rgb_decoder.get_height();
 
-		for (int curMcuY = 0, y = 0; curMcuY < loader.mcu_height; curMcuY++, y += block_height)
+		int y = mcu_row * block_height;
+		for (int curMcuX = 0, x = 0; curMcuX < mcu_width; curMcuX++, x += block_width)
 		{
-			for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
-			{
-				mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
-				rgb_decoder.decode(&mcu_decoder);
+			mcu_decoder.decode(dcts, first_block + curMcuX);
+			rgb_decoder.decode(&mcu_decoder);
 
-				int w = min(block_width, image_width - x);
-				int h = min(block_height, image_height - y);
-				for (int yy = 0; yy < h; yy++)
+			int w = min(block_width, image_width - x);
+			int h = min(block_height, image_height - y);
+			for (int yy = 0; yy < h; yy++)
+			{
+				for (int xx = 0; xx < w; xx++)
 				{
-					for (int xx = 0; xx < w; xx++)
-					{
-						unsigned int p = block_pixels[xx + yy*block_width];
-						unsigned int red = (p >> 16) & 0xff;
-						unsigned int green = (p >> 8) & 0xff;
-						unsigned int blue = p & 0xff;
-						unsigned int alpha = (p >> 24) & 0xff;
-						image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
-					}
+					unsigned int p = block_pixels[xx + yy*block_width];
+					unsigned int red = (p >> 16) & 0xff;
+					unsigned int green = (p >> 8) & 0xff;
+					unsigned int blue = p & 0xff;
+					unsigned int alpha = (p >> 24) & 0xff;
+					image_pixels[x + xx + (y + yy)*image_width] = (alpha << 24) | (blue << 16) | (green << 8) | red;
 				}
 			}
 		}
-
-		return image;
 	}
 
-	JPEGLoader::JPEGLoader(const std::shared_ptr<IODevice> &iodevice)
-		: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
+	JPEGLoader::JPEGLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator, const Size &max_size)
+		: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), srgb(srgb), scale_denominator(scale_denominator), block_size(8 / scale_denominator), max_size(max_size), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
 	{
 		JPEGFileReader reader(iodevice);
 
@@ -195,8 +233,14 @@ namespace uicore
 			mcu_width = (start_of_frame.width + (mcu_x * 8 - 1)) / (mcu_x * 8);
 			mcu_height = (start_of_frame.height + (mcu_y * 8 - 1)) / (mcu_y * 8);
 
-			for (size_t c = 0; c < component_dcts.size(); c++)
-				component_dcts[c].resize(mcu_width*mcu_height*start_of_frame.components[c].horz_sampling_factor*start_of_frame.components[c].vert_sampling_factor);
+			if (max_size.width > 0 && max_size.height > 0)
+			{
+				Size fitted = ImageFile::fit_size(Size(start_of_frame.width, start_of_frame.height), max_size);
+				scale_denominator = 8;
+				while (scale_denominator > 1 && ((start_of_frame.width + scale_denominator - 1) / scale_denominator < fitted.width || (start_of_frame.height + scale_denominator - 1) / scale_denominator < fitted.height))
+					scale_denominator /= 2;
+				block_size = 8 / scale_denominator;
+			}
 
 			last_dc_values.resize(start_of_frame.components.size());
 		}
@@ -249,10 +293,24 @@ namespace uicore
 				throw Exception("Invalid JPEG file");
 		}
 
-		if (progressive)
-			process_sos_progressive(start_of_scan, component_to_sof, reader);
+		if (image)
+			throw Exception("Invalid JPEG file");
+
+		if (is_streamable(start_of_scan))
+		{
+			process_sos_streaming(start_of_scan, component_to_sof, reader);
+		}
 		else
-			process_sos_sequential(start_of_scan, component_to_sof, reader);
+		{
+			// Coefficients for the whole image are kept until all scans have been read
+			for (size_t c = 0; c < component_dcts.size(); c++)
+				component_dcts[c].resize(mcu_width*mcu_height*start_of_frame.components[c].horz_sampling_factor*start_of_frame.components[c].vert_sampling_factor);
+
+			if (progressive)
+				process_sos_progressive(start_of_scan, component_to_sof, reader);
+			else
+				process_sos_sequential(start_of_scan, component_to_sof, reader);
+		}
 
 		scan_count++;
 	}
@@ -305,65 +363,219 @@ namespace uicore
 		verify_dc_table_selector(start_of_scan);
 		verify_ac_table_selector(start_of_scan);
 
+		int mcu_count = mcu_width * mcu_height;
+		if (restart_interval != 0 && mcu_count > restart_interval)
+		{
+			process_sos_sequential_intervals(start_of_scan, component_to_sof, reader);
+			return;
+		}
+
 		JPEGBitReader bit_reader(&reader);
 		int restart_counter = 0;
-		for (int mcu_block = 0; mcu_block < mcu_width*mcu_height; mcu_block++)
+		for (int mcu_block = 0; mcu_block < mcu_count; mcu_block++)
 		{
 			if (restart_interval != 0 && restart_counter == restart_interval)
 			{
-				JPEGMarker marker = reader.read_marker();
-				if (marker < marker_rst0 || marker > marker_rst7)
+				process_restart(reader, bit_reader);
+				restart_counter = 0;
+			}
+			restart_counter++;
+
+			decode_sequential_mcu(start_of_scan, component_to_sof, bit_reader, component_dcts, mcu_block, last_dc_values.data());
+		}
+	}
+
+	void JPEGLoader::process_restart(JPEGFileReader &reader, JPEGBitReader &bit_reader)
+	{
+		JPEGMarker marker = reader.read_marker();
+		if (marker < marker_rst0 || marker > marker_rst7)
+		{
+			throw Exception("Restart marker missing between JPEG entropy data");
+		}
+		for (auto & elem : last_dc_values)
+			elem = 0;
+		bit_reader.reset();
+		eobrun = 0;
+	}
+
+	bool JPEGLoader::is_streamable(const JPEGStartOfScan &start_of_scan) const
+	{
+		// A sequential scan containing all components holds the whole image, in MCU order
+		return !progressive && scan_count == 0 && start_of_frame.height != 0 && start_of_scan.components.size() == start_of_frame.components.size();
+	}
+
+	void JPEGLoader::process_sos_streaming(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader)
+	{
+		// Each MCU row is converted to pixels as soon as it has been decoded, so only the coefficients of one row are kept in memory
+
+		verify_dc_table_selector(start_of_scan);
+		verify_ac_table_selector(start_of_scan);
+
+		create_image();
+
+		int mcu_count = mcu_width * mcu_height;
+		if (restart_interval != 0 && mcu_count > restart_interval)
+		{
+			std::vector<unsigned char> data;
+			std::vector<int> interval_offsets;
+			reader.read_entropy_intervals(data, interval_offsets);
+
+			int interval_count = (mcu_count + restart_interval - 1) / restart_interval;
+			if ((int)interval_offsets.size() < interval_count)
+				throw Exception("Restart marker missing between JPEG entropy data");
+			interval_offsets.push_back(data.size());
+
+			// A band of rows can begin in the middle of a restart interval. The MCUs before it are decoded and thrown away,
+			// which is at most one interval per band.
+			int min_rows = std::max(get_min_rows_per_batch(), restart_interval / mcu_width);
+
+			WorkQueue::shared()->parallel_for(mcu_height, [&](int start_row, int end_row)
+			{
+				JPEGMCUDecoder mcu_decoder(this);
+				JPEGRGBDecoder rgb_decoder(this);
+				std::vector<JPEGComponentDCTs> dcts;
+				create_row_dcts(dcts);
+				std::vector<short> dc_values(start_of_frame.components.size());
+				std::unique_ptr<JPEGBitReader> bit_reader;
+
+				auto decode_mcu = [&](int mcu_block, int block)
 				{
-					throw Exception("Restart marker missing between JPEG entropy data");
+					if (mcu_block % restart_interval == 0)
+					{
+						int interval = mcu_block / restart_interval;
+						bit_reader.reset(new JPEGBitReader(data.data() + interval_offsets[interval], interval_offsets[interval + 1] - interval_offsets[interval]));
+						for (auto & elem : dc_values)
+							elem = 0;
+					}
+					decode_sequential_mcu(start_of_scan, component_to_sof, *bit_reader, dcts, block, dc_values.data());
+				};
+
+				int first_block = start_row * mcu_width;
+				int skip_start = first_block / restart_interval * restart_interval;
+				for (int mcu_block = skip_start; mcu_block < first_block; mcu_block++)
+				{
+					int block = (mcu_block - skip_start) % mcu_width;
+					if (block == 0)
+					{
+						for (auto & elem : dcts)
+							elem.clear();
+					}
+					decode_mcu(mcu_block, block);
 				}
-				restart_counter = 0;
-				for (auto & elem : last_dc_values)
+
+				for (int mcu_row = start_row; mcu_row < end_row; mcu_row++)
+				{
+					for (auto & elem : dcts)
+						elem.clear();
+					for (int block = 0; block < mcu_width; block++)
+						decode_mcu(mcu_row * mcu_width + block, block);
+					convert_mcu_row(dcts, 0, mcu_row, mcu_decoder, rgb_decoder);
+				}
+			}, min_rows);
+		}
+		else
+		{
+			JPEGMCUDecoder mcu_decoder(this);
+			JPEGRGBDecoder rgb_decoder(this);
+			std::vector<JPEGComponentDCTs> dcts;
+			create_row_dcts(dcts);
+
+			JPEGBitReader bit_reader(&reader);
+			int restart_counter = 0;
+			for (int mcu_row = 0; mcu_row < mcu_height; mcu_row++)
+			{
+				for (auto & elem : dcts)
+					elem.clear();
+
+				for (int block = 0; block < mcu_width; block++)
+				{
+					if (restart_interval != 0 && restart_counter == restart_interval)
+					{
+						process_restart(reader, bit_reader);
+						restart_counter = 0;
+					}
+					restart_counter++;
+
+					decode_sequential_mcu(start_of_scan, component_to_sof, bit_reader, dcts, block, last_dc_values.data());
+				}
+				convert_mcu_row(dcts, 0, mcu_row, mcu_decoder, rgb_decoder);
+			}
+		}
+	}
+
+	void JPEGLoader::process_sos_sequential_intervals(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader)
+	{
+		// Each restart interval starts at a byte boundary with the DC predictions reset, so the intervals can be decoded independently
+
+		std::vector<unsigned char> data;
+		std::vector<int> interval_offsets;
+		reader.read_entropy_intervals(data, interval_offsets);
+
+		int mcu_count = mcu_width * mcu_height;
+		int interval_count = (mcu_count + restart_interval - 1) / restart_interval;
+		if ((int)interval_offsets.size() < interval_count)
+			throw Exception("Restart marker missing between JPEG entropy data");
+		interval_offsets.push_back(data.size());
+
+		WorkQueue::shared()->parallel_for(interval_count, [&](int start, int end)
+		{
+			std::vector<short> dc_values(start_of_frame.components.size());
+			for (int interval = start; interval < end; interval++)
+			{
+				int offset = interval_offsets[interval];
+				JPEGBitReader bit_reader(data.data() + offset, interval_offsets[interval + 1] - offset);
+
+				for (auto & elem : dc_values)
 					elem = 0;
-				bit_reader.reset();
-				eobrun = 0;
+
+				int mcu_end = std::min((interval + 1) * restart_interval, mcu_count);
+				for (int mcu_block = interval * restart_interval; mcu_block < mcu_end; mcu_block++)
+					decode_sequential_mcu(start_of_scan, component_to_sof, bit_reader, component_dcts, mcu_block, dc_values.data());
 			}
-			restart_counter++;
+		});
+	}
 
-			for (size_t c = 0; c < start_of_scan.components.size(); c++)
+	void JPEGLoader::decode_sequential_mcu(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, std::vector<JPEGComponentDCTs> &dcts, int block, short *dc_values)
+	{
+		for (size_t c = 0; c < start_of_scan.components.size(); c++)
+		{
+			int c_sof = component_to_sof[c];
+			const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
+			const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
+			int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
+			int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
+			for (int i = 0; i < scale_x * scale_y; i++)
 			{
-				int c_sof = component_to_sof[c];
-				const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
-				const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
-				int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
-				int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
-				for (int i = 0; i < scale_x * scale_y; i++)
+				short *dct = dcts[c_sof].get(block*scale_x*scale_y + i);
+				for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
 				{
-					short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y + i);
-					for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
+					if (j == 0) // DCT DC coefficient
 					{
-						if (j == 0) // DCT DC coefficient
-						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
-							if (code != huffman_eob)
-								dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
-							dct[0] <<= start_of_scan.point_transform;
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
+						if (code != huffman_eob)
+							dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
+						dct[0] <<= start_of_scan.point_transform;
 
-							dct[0] += last_dc_values[c_sof];
-							last_dc_values[c_sof] = dct[0];
-						}
-						else // DCT AC coefficient
+						dct[0] += dc_values[c_sof];
+						dc_values[c_sof] = dct[0];
+					}
+					else // DCT AC coefficient
+					{
+						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
+						if (code != huffman_eob)
 						{
-							unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
-							if (code != huffman_eob)
-							{
-								unsigned int zeros = (code >> 4);
-								j += zeros;
-								if (j <= start_of_scan.end_dct_coefficient)
-								{
-									dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
-									dct[zigzag_map[j]] <<= start_of_scan.point_transform;
-								}
-							}
-							else
+							unsigned int zeros = (code >> 4);
+							j += zeros;
+							if (j <= start_of_scan.end_dct_coefficient)
 							{
-								break;
+								dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
+								dct[zigzag_map[j]] <<= start_of_scan.point_transform;
 							}
 						}
+						else
+						{
+							break;
+						}
 					}
 				}
 			}
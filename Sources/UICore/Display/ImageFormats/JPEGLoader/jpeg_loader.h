@@ -41,11 +41,14 @@
 namespace uicore
 {
 	class JPEGBitReader;
+	class JPEGMCUDecoder;
+	class JPEGRGBDecoder;
 
 	class JPEGLoader
 	{
 	public:
-		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb);
+		// When max_size is set, the scale is instead picked from the image size (see JPEGFormat::load_reduced)
+		static std::shared_ptr<PixelBuffer> load(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator = 1, const Size &max_size = Size());
 
 	private:
 		enum ColorSpace
@@ -57,13 +60,17 @@ namespace uicore
 			colorspace_grayscale
 		};
 
-		JPEGLoader(const std::shared_ptr<IODevice> &iodevice);
+		JPEGLoader(const std::shared_ptr<IODevice> &iodevice, bool srgb, int scale_denominator, const Size &max_size);
 
 		void process_app0(JPEGFileReader &reader);
 		void process_app14(JPEGFileReader &reader);
 		void process_dnl(JPEGFileReader &reader);
 		void process_sos(JPEGFileReader &reader);
 		void process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+		void process_sos_sequential_intervals(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+		void process_sos_streaming(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+		void process_restart(JPEGFileReader &reader, JPEGBitReader &bit_reader);
+		void decode_sequential_mcu(const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, JPEGBitReader &bit_reader, std::vector<JPEGComponentDCTs> &dcts, int block, short *dc_values);
 		void process_sos_progressive(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
 		void process_dqt(JPEGFileReader &reader);
 		void process_dht(JPEGFileReader &reader);
@@ -71,6 +78,11 @@ namespace uicore
 		void verify_dc_table_selector(const JPEGStartOfScan &start_of_scan);
 		void verify_ac_table_selector(const JPEGStartOfScan &start_of_scan);
 		ColorSpace get_colorspace() const;
+		bool is_streamable(const JPEGStartOfScan &start_of_scan) const;
+		int get_min_rows_per_batch() const;
+		void create_image();
+		void create_row_dcts(std::vector<JPEGComponentDCTs> &dcts) const;
+		void convert_mcu_row(std::vector<JPEGComponentDCTs> &dcts, int first_block, int mcu_row, JPEGMCUDecoder &mcu_decoder, JPEGRGBDecoder &rgb_decoder);
 
 		JPEGStartOfFrame start_of_frame;
 		JPEGHuffmanTable huffman_dc_tables[4];
@@ -87,6 +99,12 @@ namespace uicore
 		int eobrun;
 		std::vector<short> last_dc_values;
 
+		bool srgb;
+		int scale_denominator;
+		int block_size; // Size of a decoded block, 8 / scale_denominator
+		Size max_size;
+		std::shared_ptr<PixelBuffer> image;
+
 		bool is_jfif_jpeg;
 		bool is_adobe_jpeg;
 		int adobe_app14_transform;
@@ -30,23 +30,48 @@
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_loader.h"
 #include "UICore/Core/System/system.h"
+#include <cmath>
 
 #ifndef CL_DISABLE_SSE2
 #ifndef ARM_PLATFORM
 #include <xmmintrin.h>
 #include <emmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define UICORE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UICORE_TARGET_AVX2
+#endif
 #endif
 #endif // not CL_DISABLE_SSE2
 
 namespace uicore
 {
 	JPEGMCUDecoder::JPEGMCUDecoder(JPEGLoader *loader)
-		: loader(loader)
+		: loader(loader), block_size(loader->block_size), avx2(false)
 	{
+		/* Basis for the reduced IDCT: reduced_cos[x * 4 + u] = c(u) / 2 * cos((2x+1)*u*PI/(2n)),
+		 * where n is the scaled block size and c(0) = 1/sqrt(2), c(u) = 1 otherwise
+		 */
+		for (int x = 0; x < 4; x++)
+		{
+			for (int u = 0; u < 4; u++)
+			{
+				float cu = (u == 0) ? 0.707106781f : 1.0f;
+				reduced_cos[x * 4 + u] = 0.5f * cu * std::cos((2 * x + 1) * u * 3.14159265f / (2 * block_size));
+			}
+		}
+
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+		static bool cpu_has_avx2 = System::detect_cpu_extension(System::avx2);
+		avx2 = cpu_has_avx2;
+#endif
+
 		try
 		{
 			for (size_t c = 0; c < loader->start_of_frame.components.size(); c++)
-				channels.push_back((unsigned char *)System::aligned_alloc(loader->mcu_x*loader->mcu_y * 64, 16));
+				channels.push_back((unsigned char *)System::aligned_alloc(loader->mcu_x*loader->mcu_y * block_size * block_size, 16));
 
 			/* For float AA&N IDCT method, divisors are equal to quantization
 			 * coefficients scaled by scalefactor[row]*scalefactor[col], where
@@ -66,6 +91,19 @@ namespace uicore
 				for (int y = 0; y < 8; y++)
 					for (int x = 0; x < 8; x++)
 						quant[c][x + y * 8] = aanscalefactor[x] * aanscalefactor[y] * qtable.values[x + y * 8];
+
+				// The integer IDCT keeps two fractional bits (see idct_avx2)
+				int_quant.push_back(std::vector<short>(64));
+				for (int i = 0; i < 64; i++)
+				{
+					float value = quant[c][i] * 4.0f + 0.5f;
+					if (value > 32767.0f)
+					{
+						int_quant[c].clear();
+						break;
+					}
+					int_quant[c][i] = (short)value;
+				}
 			}
 		}
 		catch (...)
@@ -86,18 +124,33 @@ namespace uicore
 			System::aligned_free(elem);
 	}
 
-	void JPEGMCUDecoder::decode(int block)
+	void JPEGMCUDecoder::decode(std::vector<JPEGComponentDCTs> &dcts, int block)
 	{
+		if (block_size != 8)
+		{
+			decode_reduced(dcts, block);
+			return;
+		}
+
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+		if (avx2)
+		{
+			decode_avx2(dcts, block);
+			return;
+		}
+#endif
+
 		for (size_t c = 0; c < channels.size(); c++)
 		{
 			int scale_x = loader->start_of_frame.components[c].horz_sampling_factor;
 			int scale_y = loader->start_of_frame.components[c].vert_sampling_factor;
-			int block_size = scale_x * scale_y;
+			int block_count = scale_x * scale_y;
+
 			for (int dct_y = 0; dct_y < scale_y; dct_y++)
 			{
 				for (int dct_x = 0; dct_x < scale_x; dct_x++)
 				{
-					short *dct = loader->component_dcts[c].get(block * block_size + dct_x + dct_y * scale_x);
+					short *dct = dcts[c].get(block * block_count + dct_x + dct_y * scale_x);
 
 #ifdef CL_DISABLE_SSE2
 					idct(dct, channels[c]+dct_x*8+dct_y*scale_x*64, scale_x*8, quant[c]);
@@ -116,6 +169,117 @@ namespace uicore
 		}
 	}
 
+#if !defined(CL_DISABLE_SSE2) && !defined(ARM_PLATFORM)
+	void JPEGMCUDecoder::decode_avx2(std::vector<JPEGComponentDCTs> &dcts, int block)
+	{
+		// The integer IDCT transforms two blocks at a time, so all blocks of the MCU are gathered and processed in pairs
+		struct BlockIDCT
+		{
+			short *dct;
+			unsigned char *output;
+			int pitch;
+			short *quant;
+		};
+		BlockIDCT blocks[10 * 4];
+		int num_blocks = 0;
+
+		for (size_t c = 0; c < channels.size(); c++)
+		{
+			int scale_x = loader->start_of_frame.components[c].horz_sampling_factor;
+			int scale_y = loader->start_of_frame.components[c].vert_sampling_factor;
+			int block_count = scale_x * scale_y;
+			for (int dct_y = 0; dct_y < scale_y; dct_y++)
+			{
+				for (int dct_x = 0; dct_x < scale_x; dct_x++)
+				{
+					short *dct = dcts[c].get(block * block_count + dct_x + dct_y * scale_x);
+					unsigned char *output = channels[c] + dct_x * 8 + dct_y * scale_x * 64;
+
+					if (int_quant[c].empty() || num_blocks == 10 * 4)
+					{
+						idct_sse(dct, output, scale_x * 8, quant[c]);
+					}
+					else
+					{
+						BlockIDCT &b = blocks[num_blocks++];
+						b.dct = dct;
+						b.output = output;
+						b.pitch = scale_x * 8;
+						b.quant = int_quant[c].data();
+					}
+				}
+			}
+		}
+
+		for (int i = 0; i + 1 < num_blocks; i += 2)
+			idct_avx2(blocks[i].dct, blocks[i + 1].dct, blocks[i].output, blocks[i + 1].output, blocks[i].pitch, blocks[i + 1].pitch, blocks[i].quant, blocks[i + 1].quant);
+
+		if (num_blocks % 2 == 1)
+		{
+			const BlockIDCT &b = blocks[num_blocks - 1];
+			unsigned char discard[64];
+			idct_avx2(b.dct, b.dct, b.output, discard, b.pitch, 8, b.quant, b.quant);
+		}
+	}
+#endif
+
+	void JPEGMCUDecoder::decode_reduced(std::vector<JPEGComponentDCTs> &dcts, int block)
+	{
+		for (size_t c = 0; c < channels.size(); c++)
+		{
+			int scale_x = loader->start_of_frame.components[c].horz_sampling_factor;
+			int scale_y = loader->start_of_frame.components[c].vert_sampling_factor;
+			int block_count = scale_x * scale_y;
+			const uint16_t *qtable = loader->quantization_tables[loader->start_of_frame.components[c].quantization_table_selector].values;
+
+			for (int dct_y = 0; dct_y < scale_y; dct_y++)
+			{
+				for (int dct_x = 0; dct_x < scale_x; dct_x++)
+				{
+					short *dct = dcts[c].get(block * block_count + dct_x + dct_y * scale_x);
+					idct_reduced(dct, channels[c] + (dct_x + dct_y * scale_x * block_size) * block_size, scale_x * block_size, qtable);
+				}
+			}
+		}
+	}
+
+	void JPEGMCUDecoder::idct_reduced(short *inptr, unsigned char *outptr, int pitch, const uint16_t *qtable)
+	{
+		/* Computes the n x n output block directly from the n x n lowest frequency coefficients.
+		 * This is the n-point IDCT of those coefficients scaled by n/8, which approximates
+		 * the full 8x8 IDCT followed by a box filter.
+		 */
+
+		if (block_size == 1)
+		{
+			outptr[0] = float_to_int(inptr[0] * qtable[0] * (1.0f / 8.0f) + 0.5f);
+			return;
+		}
+
+		float workspace[4 * 4];
+		for (int u = 0; u < block_size; u++)
+		{
+			for (int y = 0; y < block_size; y++)
+			{
+				float sum = 0.0f;
+				for (int v = 0; v < block_size; v++)
+					sum += reduced_cos[y * 4 + v] * (float)(inptr[v * 8 + u] * qtable[v * 8 + u]);
+				workspace[y * 4 + u] = sum;
+			}
+		}
+
+		for (int y = 0; y < block_size; y++)
+		{
+			for (int x = 0; x < block_size; x++)
+			{
+				float sum = 0.0f;
+				for (int u = 0; u < block_size; u++)
+					sum += reduced_cos[x * 4 + u] * workspace[y * 4 + u];
+				outptr[x + y * pitch] = float_to_int(sum + 0.5f);
+			}
+		}
+	}
+
 	void JPEGMCUDecoder::idct(short *inptr, unsigned char *outptr, int pitch, float *quantptr)
 	{
 		float tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
@@ -436,6 +600,135 @@ namespace uicore
 			wsptr += 8 * 4; /* advance pointer to next row */
 		}
 	}
+
+	/* Integer version of the AA&N IDCT above, processing the rows of two blocks side by side in the
+	 * lower and upper 128-bit lanes. Coefficients are dequantized to 16 bits with two fractional bits
+	 * (the quantization table is prescaled by 4), the constant multiplications use rounded Q15 products
+	 * and the additions saturate, like the 16-bit "ifast" IDCT in libjpeg.
+	 */
+
+#define AVX2_IDCT_1D(v0, v1, v2, v3, v4, v5, v6, v7) \
+	{ \
+		__m256i tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7; \
+		__m256i tmp10, tmp11, tmp12, tmp13; \
+		__m256i z5, z10, z11, z12, z13; \
+		\
+		tmp10 = _mm256_adds_epi16(v0, v4); /* phase 3 */ \
+		tmp11 = _mm256_subs_epi16(v0, v4); \
+		\
+		tmp13 = _mm256_adds_epi16(v2, v6); /* phases 5-3 */ \
+		tmp12 = _mm256_subs_epi16(v2, v6); \
+		tmp12 = _mm256_subs_epi16(_mm256_adds_epi16(tmp12, _mm256_mulhrs_epi16(tmp12, c_0_414213562)), tmp13); /* 2*c4 */ \
+		\
+		tmp0 = _mm256_adds_epi16(tmp10, tmp13); /* phase 2 */ \
+		tmp3 = _mm256_subs_epi16(tmp10, tmp13); \
+		tmp1 = _mm256_adds_epi16(tmp11, tmp12); \
+		tmp2 = _mm256_subs_epi16(tmp11, tmp12); \
+		\
+		z13 = _mm256_adds_epi16(v5, v3); /* phase 6 */ \
+		z10 = _mm256_subs_epi16(v5, v3); \
+		z11 = _mm256_adds_epi16(v1, v7); \
+		z12 = _mm256_subs_epi16(v1, v7); \
+		\
+		tmp7 = _mm256_adds_epi16(z11, z13); /* phase 5 */ \
+		tmp11 = _mm256_subs_epi16(z11, z13); \
+		tmp11 = _mm256_adds_epi16(tmp11, _mm256_mulhrs_epi16(tmp11, c_0_414213562)); /* 2*c4 */ \
+		\
+		z5 = _mm256_adds_epi16(z10, z12); \
+		z5 = _mm256_adds_epi16(z5, _mm256_mulhrs_epi16(z5, c_0_847759065)); /* 2*c2 */ \
+		tmp10 = _mm256_subs_epi16(_mm256_adds_epi16(z12, _mm256_mulhrs_epi16(z12, c_0_082392200)), z5); /* 2*(c2-c6) */ \
+		tmp12 = _mm256_subs_epi16(z5, _mm256_adds_epi16(_mm256_adds_epi16(z10, z10), _mm256_mulhrs_epi16(z10, c_0_613125930))); /* -2*(c2+c6) */ \
+		\
+		tmp6 = _mm256_subs_epi16(tmp12, tmp7); /* phase 2 */ \
+		tmp5 = _mm256_subs_epi16(tmp11, tmp6); \
+		tmp4 = _mm256_adds_epi16(tmp10, tmp5); \
+		\
+		v0 = _mm256_adds_epi16(tmp0, tmp7); \
+		v7 = _mm256_subs_epi16(tmp0, tmp7); \
+		v1 = _mm256_adds_epi16(tmp1, tmp6); \
+		v6 = _mm256_subs_epi16(tmp1, tmp6); \
+		v2 = _mm256_adds_epi16(tmp2, tmp5); \
+		v5 = _mm256_subs_epi16(tmp2, tmp5); \
+		v4 = _mm256_adds_epi16(tmp3, tmp4); \
+		v3 = _mm256_subs_epi16(tmp3, tmp4); \
+	}
+
+	// Transposes the 8x8 matrix of 16-bit values in each 128-bit lane
+#define AVX2_TRANSPOSE_8X8_EPI16(r0, r1, r2, r3, r4, r5, r6, r7) \
+	{ \
+		__m256i a0 = _mm256_unpacklo_epi16(r0, r1), a1 = _mm256_unpackhi_epi16(r0, r1); \
+		__m256i a2 = _mm256_unpacklo_epi16(r2, r3), a3 = _mm256_unpackhi_epi16(r2, r3); \
+		__m256i a4 = _mm256_unpacklo_epi16(r4, r5), a5 = _mm256_unpackhi_epi16(r4, r5); \
+		__m256i a6 = _mm256_unpacklo_epi16(r6, r7), a7 = _mm256_unpackhi_epi16(r6, r7); \
+		__m256i b0 = _mm256_unpacklo_epi32(a0, a2), b1 = _mm256_unpackhi_epi32(a0, a2); \
+		__m256i b2 = _mm256_unpacklo_epi32(a1, a3), b3 = _mm256_unpackhi_epi32(a1, a3); \
+		__m256i b4 = _mm256_unpacklo_epi32(a4, a6), b5 = _mm256_unpackhi_epi32(a4, a6); \
+		__m256i b6 = _mm256_unpacklo_epi32(a5, a7), b7 = _mm256_unpackhi_epi32(a5, a7); \
+		r0 = _mm256_unpacklo_epi64(b0, b4); r1 = _mm256_unpackhi_epi64(b0, b4); \
+		r2 = _mm256_unpacklo_epi64(b1, b5); r3 = _mm256_unpackhi_epi64(b1, b5); \
+		r4 = _mm256_unpacklo_epi64(b2, b6); r5 = _mm256_unpackhi_epi64(b2, b6); \
+		r6 = _mm256_unpacklo_epi64(b3, b7); r7 = _mm256_unpackhi_epi64(b3, b7); \
+	}
+
+	UICORE_TARGET_AVX2 void JPEGMCUDecoder::idct_avx2(short *inptr0, short *inptr1, unsigned char *outptr0, unsigned char *outptr1, int pitch0, int pitch1, short *quantptr0, short *quantptr1)
+	{
+		// Fractional parts of the AA&N constants in Q15
+		const __m256i c_0_414213562 = _mm256_set1_epi16(13573);
+		const __m256i c_0_847759065 = _mm256_set1_epi16(27779);
+		const __m256i c_0_082392200 = _mm256_set1_epi16(2700);
+		const __m256i c_0_613125930 = _mm256_set1_epi16(20091);
+
+#define AVX2_LOAD_DEQUANTIZE(k) \
+		_mm256_mullo_epi16( \
+			_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(inptr0 + 8 * k))), _mm_loadu_si128((const __m128i*)(inptr1 + 8 * k)), 1), \
+			_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(quantptr0 + 8 * k))), _mm_loadu_si128((const __m128i*)(quantptr1 + 8 * k)), 1))
+
+		__m256i v0 = AVX2_LOAD_DEQUANTIZE(0);
+		__m256i v1 = AVX2_LOAD_DEQUANTIZE(1);
+		__m256i v2 = AVX2_LOAD_DEQUANTIZE(2);
+		__m256i v3 = AVX2_LOAD_DEQUANTIZE(3);
+		__m256i v4 = AVX2_LOAD_DEQUANTIZE(4);
+		__m256i v5 = AVX2_LOAD_DEQUANTIZE(5);
+		__m256i v6 = AVX2_LOAD_DEQUANTIZE(6);
+		__m256i v7 = AVX2_LOAD_DEQUANTIZE(7);
+#undef AVX2_LOAD_DEQUANTIZE
+
+		/* Pass 1: process columns. Each register holds one row of coefficients for all columns. */
+		AVX2_IDCT_1D(v0, v1, v2, v3, v4, v5, v6, v7);
+
+		/* Pass 2: process rows */
+		AVX2_TRANSPOSE_8X8_EPI16(v0, v1, v2, v3, v4, v5, v6, v7);
+		AVX2_IDCT_1D(v0, v1, v2, v3, v4, v5, v6, v7);
+		AVX2_TRANSPOSE_8X8_EPI16(v0, v1, v2, v3, v4, v5, v6, v7);
+
+		/* Final output stage: scale down by 8 and the two fractional bits, add 128 and range-limit */
+		const __m256i rounding = _mm256_set1_epi16(16);
+		const __m256i offset = _mm256_set1_epi16(128);
+
+#define AVX2_DESCALE(v) _mm256_add_epi16(_mm256_srai_epi16(_mm256_adds_epi16(v, rounding), 5), offset)
+#define AVX2_STORE_ROWS(y, va, vb) \
+		{ \
+			__m256i t = _mm256_packus_epi16(AVX2_DESCALE(va), AVX2_DESCALE(vb)); \
+			__m128i t0 = _mm256_castsi256_si128(t); \
+			__m128i t1 = _mm256_extracti128_si256(t, 1); \
+			_mm_storel_epi64((__m128i*)(outptr0 + pitch0 * y), t0); \
+			_mm_storel_epi64((__m128i*)(outptr0 + pitch0 * (y + 1)), _mm_srli_si128(t0, 8)); \
+			_mm_storel_epi64((__m128i*)(outptr1 + pitch1 * y), t1); \
+			_mm_storel_epi64((__m128i*)(outptr1 + pitch1 * (y + 1)), _mm_srli_si128(t1, 8)); \
+		}
+
+		AVX2_STORE_ROWS(0, v0, v1);
+		AVX2_STORE_ROWS(2, v2, v3);
+		AVX2_STORE_ROWS(4, v4, v5);
+		AVX2_STORE_ROWS(6, v6, v7);
+
+#undef AVX2_STORE_ROWS
+#undef AVX2_DESCALE
+	}
+
+#undef AVX2_TRANSPOSE_8X8_EPI16
+#undef AVX2_IDCT_1D
+
 #endif
 #endif // not CL_DISABLE_SSE2
 
@@ -31,6 +31,7 @@
 namespace uicore
 {
 	class JPEGLoader;
+	class JPEGComponentDCTs;
 
 	class JPEGMCUDecoder
 	{
@@ -38,17 +39,25 @@ namespace uicore
 		JPEGMCUDecoder(JPEGLoader *loader);
 		~JPEGMCUDecoder();
 
-		void decode(int block);
+		void decode(std::vector<JPEGComponentDCTs> &dcts, int block);
 		int get_channel_count() const { return (int)channels.size(); }
 		const unsigned char *get_channel(int c) const { return channels[c]; }
 
 	private:
 		void idct(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
 		void idct_sse(short *inptr, unsigned char *outptr, int pitch, float *quantptr);
+		void decode_avx2(std::vector<JPEGComponentDCTs> &dcts, int block);
+		void decode_reduced(std::vector<JPEGComponentDCTs> &dcts, int block);
+		void idct_reduced(short *inptr, unsigned char *outptr, int pitch, const uint16_t *qtable);
+		void idct_avx2(short *inptr0, short *inptr1, unsigned char *outptr0, unsigned char *outptr1, int pitch0, int pitch1, short *quantptr0, short *quantptr1);
 		static inline unsigned char float_to_int(float v);
 
 		JPEGLoader *loader;
+		int block_size;
+		float reduced_cos[4 * 4];
 		std::vector<unsigned char *> channels;
 		std::vector<float *> quant;
+		std::vector<std::vector<short> > int_quant;
+		bool avx2;
 	};
 }
@@ -42,15 +42,22 @@
 namespace uicore
 {
 	JPEGRGBDecoder::JPEGRGBDecoder(JPEGLoader *loader)
-		: loader(loader), mcu_x(0), mcu_y(0), pixels(nullptr)
+		: loader(loader), mcu_x(0), mcu_y(0), block_size(8), pixels(nullptr)
 	{
 		mcu_x = loader->mcu_x;
 		mcu_y = loader->mcu_y;
+		block_size = loader->block_size;
+
+		// Scaled blocks can be smaller than the 4 pixels the SSE conversion processes at a time
+		int size = (mcu_x * mcu_y * block_size * block_size + 3) & ~3;
 		try
 		{
-			pixels = (unsigned int *)System::aligned_alloc(mcu_x*mcu_y * 64 * 4, 16);
+			pixels = (unsigned int *)System::aligned_alloc(size * 4, 16);
 			for (auto & elem : loader->start_of_frame.components)
-				channels.push_back((unsigned char *)System::aligned_alloc(mcu_x*mcu_y * 64, 16));
+			{
+				channels.push_back((unsigned char *)System::aligned_alloc(size, 16));
+				memset(channels.back(), 0, size);
+			}
 		}
 		catch (...)
 		{
@@ -79,7 +86,8 @@ namespace uicore
 			break;
 		case JPEGLoader::colorspace_ycrcb:
 #ifndef CL_DISABLE_SSE2
-			if (System::detect_cpu_extension(System::sse2))
+			static bool cpu_has_sse2 = System::detect_cpu_extension(System::sse2);
+			if (cpu_has_sse2)
 				convert_ycrcb_sse();
 			else
 				convert_ycrcb_float();
@@ -99,8 +107,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::upsample(JPEGMCUDecoder *mcu_decoder)
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 
 		for (size_t c = 0; c < channels.size(); c++)
 		{
@@ -120,7 +128,7 @@ namespace uicore
 				int sy = step_sy >> 1;
 				for (int y = 0; y < height; y++)
 				{
-					const unsigned char *input_line = input + (sy >> 16)*v * 8;
+					const unsigned char *input_line = input + (sy >> 16)*h * block_size;
 					int sx = step_sx >> 1;
 					for (int x = 0; x < width; x++)
 					{
@@ -135,8 +143,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_monochrome()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 
 		for (int y = 0; y < height; y++)
 		{
@@ -164,46 +172,43 @@ namespace uicore
 #ifndef ARM_PLATFORM
 	void JPEGRGBDecoder::convert_ycrcb_sse()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
-		for (int y = 0; y < height; y++)
+		// The channels and pixels are stored without padding between the lines, so they are processed as one long line
+		int count = mcu_x * block_size * mcu_y * block_size;
+		unsigned char *c_line[3] =
 		{
-			unsigned char *c_line[3] =
-			{
-				&channels[0][y*width],
-				&channels[1][y*width],
-				&channels[2][y*width]
-			};
-			unsigned int *p_line = pixels + y * width;
-			for (int x = 0; x < width; x += 4)
-			{
-				__m128i c0 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[0] + x));
-				__m128i c1 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[1] + x));
-				__m128i c2 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[2] + x));
+			channels[0],
+			channels[1],
+			channels[2]
+		};
+		unsigned int *p_line = pixels;
+		for (int x = 0; x < count; x += 4)
+		{
+			__m128i c0 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[0] + x));
+			__m128i c1 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[1] + x));
+			__m128i c2 = _mm_cvtsi32_si128(*reinterpret_cast<unsigned int*>(c_line[2] + x));
 
-				c0 = _mm_unpacklo_epi8(c0, _mm_setzero_si128());
-				c0 = _mm_unpacklo_epi16(c0, _mm_setzero_si128());
-				c1 = _mm_unpacklo_epi8(c1, _mm_setzero_si128());
-				c1 = _mm_unpacklo_epi16(c1, _mm_setzero_si128());
-				c2 = _mm_unpacklo_epi8(c2, _mm_setzero_si128());
-				c2 = _mm_unpacklo_epi16(c2, _mm_setzero_si128());
+			c0 = _mm_unpacklo_epi8(c0, _mm_setzero_si128());
+			c0 = _mm_unpacklo_epi16(c0, _mm_setzero_si128());
+			c1 = _mm_unpacklo_epi8(c1, _mm_setzero_si128());
+			c1 = _mm_unpacklo_epi16(c1, _mm_setzero_si128());
+			c2 = _mm_unpacklo_epi8(c2, _mm_setzero_si128());
+			c2 = _mm_unpacklo_epi16(c2, _mm_setzero_si128());
 
-				__m128 Y = _mm_cvtepi32_ps(c0);
-				__m128 Cb = _mm_cvtepi32_ps(c1);
-				__m128 Cr = _mm_cvtepi32_ps(c2);
-				Cr = _mm_sub_ps(Cr, _mm_set1_ps(128.0f));
-				Cb = _mm_sub_ps(Cb, _mm_set1_ps(128.0f));
+			__m128 Y = _mm_cvtepi32_ps(c0);
+			__m128 Cb = _mm_cvtepi32_ps(c1);
+			__m128 Cr = _mm_cvtepi32_ps(c2);
+			Cr = _mm_sub_ps(Cr, _mm_set1_ps(128.0f));
+			Cb = _mm_sub_ps(Cb, _mm_set1_ps(128.0f));
 
-				__m128 R = _mm_add_ps(Y, _mm_mul_ps(_mm_set1_ps(1.40200f), Cr));
-				__m128 G = _mm_sub_ps(_mm_sub_ps(Y, _mm_mul_ps(_mm_set1_ps(0.34414f), Cb)), _mm_mul_ps(_mm_set1_ps(0.71414f), Cr));
-				__m128 B = _mm_add_ps(Y, _mm_mul_ps(_mm_set1_ps(1.77200f), Cb));
+			__m128 R = _mm_add_ps(Y, _mm_mul_ps(_mm_set1_ps(1.40200f), Cr));
+			__m128 G = _mm_sub_ps(_mm_sub_ps(Y, _mm_mul_ps(_mm_set1_ps(0.34414f), Cb)), _mm_mul_ps(_mm_set1_ps(0.71414f), Cr));
+			__m128 B = _mm_add_ps(Y, _mm_mul_ps(_mm_set1_ps(1.77200f), Cb));
 
-				R = _mm_add_ps(_mm_min_ps(_mm_max_ps(R, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
-				G = _mm_add_ps(_mm_min_ps(_mm_max_ps(G, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
-				B = _mm_add_ps(_mm_min_ps(_mm_max_ps(B, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+			R = _mm_add_ps(_mm_min_ps(_mm_max_ps(R, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+			G = _mm_add_ps(_mm_min_ps(_mm_max_ps(G, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+			B = _mm_add_ps(_mm_min_ps(_mm_max_ps(B, _mm_setzero_ps()), _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
 
-				_mm_store_si128(reinterpret_cast<__m128i*>(p_line + x), _mm_add_epi32(_mm_set1_epi32(0xff000000), _mm_add_epi32(_mm_add_epi32(_mm_cvttps_epi32(B), _mm_slli_epi32(_mm_cvttps_epi32(G), 8)), _mm_slli_epi32(_mm_cvttps_epi32(R), 16))));
-			}
+			_mm_store_si128(reinterpret_cast<__m128i*>(p_line + x), _mm_add_epi32(_mm_set1_epi32(0xff000000), _mm_add_epi32(_mm_add_epi32(_mm_cvttps_epi32(B), _mm_slli_epi32(_mm_cvttps_epi32(G), 8)), _mm_slli_epi32(_mm_cvttps_epi32(R), 16))));
 		}
 	}
 #endif
@@ -211,8 +216,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_ycrcb_float()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
@@ -245,8 +250,8 @@ namespace uicore
 
 	void JPEGRGBDecoder::convert_rgb()
 	{
-		int height = mcu_y * 8;
-		int width = mcu_x * 8;
+		int height = mcu_y * block_size;
+		int width = mcu_x * block_size;
 		for (int y = 0; y < height; y++)
 		{
 			for (int x = 0; x < width; x++)
@@ -41,8 +41,8 @@ namespace uicore
 
 		void decode(JPEGMCUDecoder *mcu_decoder);
 
-		int get_width() const { return mcu_x * 8; }
-		int get_height() const { return mcu_y * 8; }
+		int get_width() const { return mcu_x * block_size; }
+		int get_height() const { return mcu_y * block_size; }
 		const unsigned int *get_pixels() const { return pixels; }
 
 	private:
@@ -54,6 +54,7 @@ namespace uicore
 
 		JPEGLoader *loader;
 		int mcu_x, mcu_y;
+		int block_size;
 		unsigned int *pixels;
 		std::vector<unsigned char *> channels;
 	};
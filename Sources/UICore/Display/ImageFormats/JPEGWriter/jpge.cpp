@@ -26,7 +26,7 @@ namespace uicore_jpge {
 	static inline void jpge_free(void *p) { free(p); }
 
 	// Various JPEG enums and tables.
-	enum { M_SOF0 = 0xC0, M_DHT = 0xC4, M_SOI = 0xD8, M_EOI = 0xD9, M_SOS = 0xDA, M_DQT = 0xDB, M_APP0 = 0xE0 };
+	enum { M_SOF0 = 0xC0, M_DHT = 0xC4, M_RST0 = 0xD0, M_SOI = 0xD8, M_EOI = 0xD9, M_SOS = 0xDA, M_DQT = 0xDB, M_DRI = 0xDD, M_APP0 = 0xE0 };
 	enum { DC_LUM_CODES = 12, AC_LUM_CODES = 256, DC_CHROMA_CODES = 12, AC_CHROMA_CODES = 256, MAX_HUFF_SYMBOLS = 257, MAX_HUFF_CODESIZE = 32 };
 
 	static uint8 s_zag[64] = { 0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63 };
@@ -357,6 +357,14 @@ namespace uicore_jpge {
 		emit_byte(0);
 	}
 
+	// Emit restart interval marker
+	void jpeg_encoder::emit_dri()
+	{
+		emit_marker(M_DRI);
+		emit_word(4);
+		emit_word(m_params.m_restart_interval);
+	}
+
 	// Emit all markers at beginning of image file.
 	void jpeg_encoder::emit_markers()
 	{
@@ -365,6 +373,8 @@ namespace uicore_jpge {
 		emit_dqt();
 		emit_sof();
 		emit_dhts();
+		if (m_params.m_restart_interval)
+			emit_dri();
 		emit_sos();
 	}
 
@@ -422,6 +432,8 @@ namespace uicore_jpge {
 	{
 		m_bit_buffer = 0; m_bits_in = 0;
 		memset(m_last_dc_val, 0, 3 * sizeof(m_last_dc_val[0]));
+		m_mcus_since_restart = 0;
+		m_restart_marker_index = 0;
 		m_mcu_y_ofs = 0;
 		m_pass_num = 1;
 	}
@@ -620,6 +632,33 @@ namespace uicore_jpge {
 		}
 	}
 
+	// Pads the entropy data to a byte boundary and writes the next RSTn marker
+	void jpeg_encoder::emit_restart()
+	{
+		put_bits(0x7F, 7);
+		m_bit_buffer = 0;
+		m_bits_in = 0;
+		JPGE_PUT_BYTE(0xFF);
+		JPGE_PUT_BYTE(static_cast<uint8>(M_RST0 + m_restart_marker_index));
+		m_restart_marker_index = (m_restart_marker_index + 1) & 7;
+	}
+
+	// Starts a new restart interval when the current one is full
+	void jpeg_encoder::begin_mcu()
+	{
+		if (m_params.m_restart_interval == 0)
+			return;
+
+		if (m_mcus_since_restart == m_params.m_restart_interval)
+		{
+			if (m_pass_num == 2)
+				emit_restart();
+			memset(m_last_dc_val, 0, 3 * sizeof(m_last_dc_val[0]));
+			m_mcus_since_restart = 0;
+		}
+		m_mcus_since_restart++;
+	}
+
 	void jpeg_encoder::code_coefficients_pass_one(int component_num)
 	{
 		if (component_num >= 3) return; // just to shut up static analysis
@@ -739,6 +778,7 @@ namespace uicore_jpge {
 		{
 			for (int i = 0; i < m_mcus_per_row; i++)
 			{
+				begin_mcu();
 				load_block_8_8_grey(i); code_block(0);
 			}
 		}
@@ -746,6 +786,7 @@ namespace uicore_jpge {
 		{
 			for (int i = 0; i < m_mcus_per_row; i++)
 			{
+				begin_mcu();
 				load_block_8_8(i, 0, 0); code_block(0); load_block_8_8(i, 0, 1); code_block(1); load_block_8_8(i, 0, 2); code_block(2);
 			}
 		}
@@ -753,6 +794,7 @@ namespace uicore_jpge {
 		{
 			for (int i = 0; i < m_mcus_per_row; i++)
 			{
+				begin_mcu();
 				load_block_8_8(i * 2 + 0, 0, 0); code_block(0); load_block_8_8(i * 2 + 1, 0, 0); code_block(0);
 				load_block_16_8_8(i, 1); code_block(1); load_block_16_8_8(i, 2); code_block(2);
 			}
@@ -761,6 +803,7 @@ namespace uicore_jpge {
 		{
 			for (int i = 0; i < m_mcus_per_row; i++)
 			{
+				begin_mcu();
 				load_block_8_8(i * 2 + 0, 0, 0); code_block(0); load_block_8_8(i * 2 + 1, 0, 0); code_block(0);
 				load_block_8_8(i * 2 + 0, 1, 0); code_block(0); load_block_8_8(i * 2 + 1, 1, 0); code_block(0);
 				load_block_16_8(i, 1); code_block(1); load_block_16_8(i, 2); code_block(2);
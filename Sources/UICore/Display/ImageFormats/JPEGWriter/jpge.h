@@ -19,12 +19,13 @@ namespace uicore_jpge
 	// JPEG compression parameters structure.
 	struct params
 	{
-		inline params() : m_quality(85), m_subsampling(H2V2), m_no_chroma_discrim_flag(false), m_two_pass_flag(false) { }
+		inline params() : m_quality(85), m_subsampling(H2V2), m_no_chroma_discrim_flag(false), m_two_pass_flag(false), m_restart_interval(0) { }
 
 		inline bool check() const
 		{
 			if ((m_quality < 1) || (m_quality > 100)) return false;
 			if ((uint)m_subsampling > (uint)H2V2) return false;
+			if ((m_restart_interval < 0) || (m_restart_interval > 0xFFFF)) return false;
 			return true;
 		}
 
@@ -43,6 +44,9 @@ namespace uicore_jpge
 		bool m_no_chroma_discrim_flag;
 
 		bool m_two_pass_flag;
+
+		// Number of MCUs between restart markers, or 0 for none. Restart intervals allow a decoder to decode them in parallel.
+		int m_restart_interval;
 	};
 
 	// Writes JPEG image to a file. 
@@ -119,6 +123,8 @@ namespace uicore_jpge
 		uint8 m_huff_val[4][256];
 		uint32 m_huff_count[4][256];
 		int m_last_dc_val[3];
+		int m_mcus_since_restart;
+		int m_restart_marker_index;
 		enum { JPGE_OUT_BUF_SIZE = 2048 };
 		uint8 m_out_buf[JPGE_OUT_BUF_SIZE];
 		uint8 *m_pOut_buf;
@@ -138,6 +144,9 @@ namespace uicore_jpge
 		void emit_dht(uint8 *bits, uint8 *val, int index, bool ac_flag);
 		void emit_dhts();
 		void emit_sos();
+		void emit_dri();
+		void emit_restart();
+		void begin_mcu();
 		void emit_markers();
 		void compute_huffman_table(uint *codes, uint8 *code_sizes, uint8 *bits, uint8 *val);
 		void compute_quant_table(int32 *dst, int16 *src);
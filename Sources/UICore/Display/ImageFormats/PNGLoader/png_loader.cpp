@@ -28,7 +28,7 @@
 
 #include "UICore/precomp.h"
 #include "png_loader.h"
-#include "UICore/Core/Zip/zlib_compression.h"
+#include "UICore/Core/Zip/inflater.h"
 #include "UICore/Core/System/system.h"
 #include "UICore/Display/ImageFormats/PNGWriter/png_writer.h"
 
@@ -218,7 +218,10 @@ namespace uicore
 
 	void PNGLoader::decode_image()
 	{
-		std::shared_ptr<DataBuffer> image_data = ZLibCompression::decompress(idat, false);
+		// The decompressed size is known from the header, so inflate directly into a buffer of that size
+		auto image_data = DataBuffer::create(get_image_data_size());
+		size_t image_data_size = Inflater::create(false)->decompress(idat->data(), idat->size(), image_data->data(), image_data->size());
+		image_data->set_size(image_data_size);
 
 		create_image();
 		create_scanline_buffers();
@@ -254,6 +257,30 @@ namespace uicore
 		scanline_4us = static_cast<Vec4us *>(System::aligned_alloc(image_width * sizeof(Vec4us)));
 	}
 
+	size_t PNGLoader::get_image_data_size()
+	{
+		size_t bits_per_pixel = bit_depth * get_image_data_channels();
+		if (interlace_method != 1)
+			return (1 + (image_width * bits_per_pixel + 7) / 8) * image_height;
+
+		int starting_row[7] = { 0, 0, 4, 0, 2, 0, 1 };
+		int starting_col[7] = { 0, 4, 0, 2, 0, 1, 0 };
+		int row_increment[7] = { 8, 8, 8, 4, 4, 2, 2 };
+		int col_increment[7] = { 8, 8, 4, 4, 2, 2, 1 };
+
+		size_t size = 0;
+		for (int pass = 0; pass < 7; pass++)
+		{
+			if (starting_col[pass] < (int)image_width && starting_row[pass] < (int)image_height)
+			{
+				size_t pass_width = (image_width - starting_col[pass] + col_increment[pass] - 1) / col_increment[pass];
+				size_t pass_height = (image_height - starting_row[pass] + row_increment[pass] - 1) / row_increment[pass];
+				size += (1 + (pass_width * bits_per_pixel + 7) / 8) * pass_height;
+			}
+		}
+		return size;
+	}
+
 	int PNGLoader::get_image_data_channels()
 	{
 		switch (color_type)
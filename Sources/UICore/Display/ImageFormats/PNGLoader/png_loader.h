@@ -55,6 +55,7 @@ namespace uicore
 		void create_image();
 		void create_scanline_buffers();
 		int get_image_data_channels();
+		size_t get_image_data_size();
 
 		void filter_scanline(int predictor_type, int scanline_byte_length);
 		static void predictor_sub(unsigned char *scanline, const unsigned char *prev_scanline, int byte_length, int channels, int bit_depth);
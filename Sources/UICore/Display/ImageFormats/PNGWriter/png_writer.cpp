@@ -159,7 +159,7 @@ namespace uicore
 			memcpy(idat_uncompressed->data<unsigned char>() + y * scanline_filtered.size(), scanline_filtered.data(), scanline_filtered.size());
 		}
 		
-		std::shared_ptr<DataBuffer> idat = ZLibCompression::compress(idat_uncompressed, false);
+		std::shared_ptr<DataBuffer> idat = ZLibCompression::compress_parallel(idat_uncompressed, false);
 		
 		write_chunk("IDAT", idat->data(), idat->size());
 	}
@@ -31,6 +31,7 @@
 #include "UICore/Core/IOData/iodevice.h"
 #include "UICore/Display/Image/pixel_buffer.h"
 #include "UICore/Core/System/databuffer.h"
+#include "UICore/Core/Crypto/hash_functions.h"
 
 namespace uicore
 {
@@ -58,38 +59,8 @@ namespace uicore
 	public:
 		static unsigned long crc(const char name[4], const void *data, int len)
 		{
-			static PNGCRC32 impl;
-			
-			const unsigned char *buf = reinterpret_cast<const unsigned char*>(data);
-			
-			unsigned int c = 0xffffffff;
-
-			for (int n = 0; n < 4; n++)
-				c = impl.crc_table[(c ^ name[n]) & 0xff] ^ (c >> 8);
-
-			for (int n = 0; n < len; n++)
-				c = impl.crc_table[(c ^ buf[n]) & 0xff] ^ (c >> 8);
-
-			return c ^ 0xffffffff;
-		}
-		
-	private:
-		unsigned int crc_table[256];
-		
-		PNGCRC32()
-		{
-			for (unsigned int n = 0; n < 256; n++)
-			{
-				unsigned int c = n;
-				for (unsigned int k = 0; k < 8; k++)
-				{
-					if ((c & 1) == 1)
-						c = 0xedb88320 ^ (c >> 1);
-					else
-						c = c >> 1;
-				}
-				crc_table[n] = c;
-			}
+			uint32_t c = HashFunctions::crc32(name, 4);
+			return HashFunctions::crc32(data, len, c);
 		}
 	};
 }
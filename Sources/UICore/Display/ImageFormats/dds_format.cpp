@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/dds_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -39,7 +40,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBufferSet> DDSFormat::load(const std::string &filename)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(File::open_mapped(filename));
 		return load(file);
 	}
 
@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Display/ImageFormats/image_file_type.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -36,6 +37,7 @@
 #include "UICore/Core/Text/text.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "../setup_display.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -55,24 +57,60 @@ namespace uicore
 	}
 
 	std::shared_ptr<PixelBuffer> ImageFile::load(const std::string &filename, const std::string &type, bool srgb)
+	{
+		return find_type(filename, type)->load(filename, srgb);
+	}
+
+	std::shared_ptr<PixelBuffer> ImageFile::load_scaled(const std::string &filename, const Size &max_size, const std::string &type, bool srgb)
+	{
+		if (max_size.width <= 0 || max_size.height <= 0)
+			throw Exception("Invalid size passed to ImageFile::load_scaled");
+
+		auto image = find_type(filename, type)->load_reduced(filename, max_size, srgb);
+
+		Size size = fit_size(image->size(), max_size);
+		if (size != image->size())
+			image = image->resized(size.width, size.height);
+		return image;
+	}
+
+	Size ImageFile::fit_size(const Size &image_size, const Size &max_size)
+	{
+		if (image_size.width <= max_size.width && image_size.height <= max_size.height)
+			return image_size;
+
+		// Scale by the smaller of the two ratios
+		Size size;
+		if ((long long)image_size.width * max_size.height > (long long)image_size.height * max_size.width)
+		{
+			size.width = max_size.width;
+			size.height = (int)(((long long)image_size.height * max_size.width + image_size.width / 2) / image_size.width);
+		}
+		else
+		{
+			size.height = max_size.height;
+			size.width = (int)(((long long)image_size.width * max_size.height + image_size.height / 2) / image_size.height);
+		}
+		size.width = std::max(size.width, 1);
+		size.height = std::max(size.height, 1);
+		return size;
+	}
+
+	ImageFileType *ImageFile::find_type(const std::string &filename, const std::string &type)
 	{
 		SetupDisplay::start();
 		auto &types = *SetupDisplay::get_image_provider_factory_types();
 		if (type != "")
 		{
 			if (types.find(type) == types.end()) throw Exception("Unknown image provider type " + type);
-
-			ImageFileType *factory = types[type];
-			return factory->load(filename, srgb);
+			return types[type];
 		}
 
 		// Determine file extension and use it to lookup type.
 		std::string ext = FilePath::extension(filename);
 		ext = Text::to_lower(ext);
 		if (types.find(ext) == types.end()) throw Exception(std::string("Unknown image provider type ") + ext);
-
-		ImageFileType *factory = types[ext];
-		return factory->load(filename, srgb);
+		return types[ext];
 	}
 
 	std::shared_ptr<PixelBuffer> ImageFile::load(const std::shared_ptr<IODevice> &file, const std::string &type, bool srgb)
@@ -96,8 +134,9 @@ namespace uicore
 			ext = Text::to_lower(ext);
 		}
 
-		auto file = File::create_always(filename);
-		return ImageFile::save(buffer, file, ext);
+		auto file = BufferedIODevice::create(File::create_always(filename));
+		ImageFile::save(buffer, file, ext);
+		file->flush();
 	}
 
 	void ImageFile::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &file, const std::string &type)
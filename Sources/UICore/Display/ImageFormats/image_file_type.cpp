@@ -53,4 +53,9 @@ namespace uicore
 			}
 		}
 	}
+
+	std::shared_ptr<PixelBuffer> ImageFileType::load_reduced(const std::string &filename, const Size &/*max_size*/, bool srgb)
+	{
+		return load(filename, srgb);
+	}
 }
@@ -30,6 +30,7 @@
 #include "UICore/precomp.h"
 #include <iostream>
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/jpeg_format.h"
 #include "UICore/Core/System/databuffer.h"
@@ -37,12 +38,13 @@
 #include "UICore/Core/Text/text.h"
 #include "JPEGLoader/jpeg_loader.h"
 #include "JPEGWriter/jpge.h"
+#include <algorithm>
 
 namespace uicore
 {
 	std::shared_ptr<PixelBuffer> JPEGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(File::open_mapped(filename));
 		return JPEGLoader::load(file, srgb);
 	}
 
@@ -51,6 +53,23 @@ namespace uicore
 		return JPEGLoader::load(file, srgb);
 	}
 
+	std::shared_ptr<PixelBuffer> JPEGFormat::load_scaled(const std::string &filename, int scale_denominator, bool srgb)
+	{
+		auto file = MemoryDevice::open(File::open_mapped(filename));
+		return JPEGLoader::load(file, srgb, scale_denominator);
+	}
+
+	std::shared_ptr<PixelBuffer> JPEGFormat::load_scaled(const std::shared_ptr<IODevice> &file, int scale_denominator, bool srgb)
+	{
+		return JPEGLoader::load(file, srgb, scale_denominator);
+	}
+
+	std::shared_ptr<PixelBuffer> JPEGFormat::load_reduced(const std::string &filename, const Size &max_size, bool srgb)
+	{
+		auto file = MemoryDevice::open(File::open_mapped(filename));
+		return JPEGLoader::load(file, srgb, 1, max_size);
+	}
+
 	void JPEGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename, int quality)
 	{
 		auto file = File::create_always(filename);
@@ -66,12 +85,14 @@ namespace uicore
 			buffer = newbuf;
 		}
 
-		auto output = DataBuffer::create(buffer->width() * buffer->height() * 5);
+		auto output = DataBuffer::create(std::max(buffer->width() * buffer->height() * 5, 1024)); // Room for the headers of tiny images
 		int size = output->size();
 
+		// One restart interval per MCU row lets JPEGLoader decode the rows in parallel
 		uicore_jpge::params desc;
 		desc.m_quality = quality;
-		bool result = uicore_jpge::compress_image_to_jpeg_file_in_memory(output->data(), size, buffer->width(), buffer->height(), 3, output->data<uicore_jpge::uint8>(), desc);
+		desc.m_restart_interval = std::min((buffer->width() + 15) / 16, 0xFFFF);
+		bool result = uicore_jpge::compress_image_to_jpeg_file_in_memory(output->data(), size, buffer->width(), buffer->height(), 3, buffer->data<uicore_jpge::uint8>(), desc);
 		if (!result)
 			throw Exception("Unable to compress JPEG image");
 
@@ -30,6 +30,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
+#include "UICore/Core/IOData/buffered_iodevice.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/Text/text.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -43,7 +45,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBuffer> PNGFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(File::open_mapped(filename));
 		return PNGLoader::load(file, srgb);
 	}
 
@@ -54,8 +56,9 @@ namespace uicore
 
 	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::string &filename)
 	{
-		auto file = File::create_always(filename);
+		auto file = BufferedIODevice::create(File::create_always(filename));
 		save(buffer, file);
+		file->flush();
 	}
 
 	void PNGFormat::save(std::shared_ptr<PixelBuffer> buffer, const std::shared_ptr<IODevice> &iodev)
@@ -29,6 +29,7 @@
 #include "UICore/precomp.h"
 #include "UICore/Core/System/exception.h"
 #include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/memory_device.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Display/ImageFormats/targa_format.h"
 #include "UICore/Display/Image/pixel_buffer.h"
@@ -38,7 +39,7 @@ namespace uicore
 {
 	std::shared_ptr<PixelBuffer> TargaFormat::load(const std::string &filename, bool srgb)
 	{
-		auto file = File::open_existing(filename);
+		auto file = MemoryDevice::open(File::open_mapped(filename));
 		return TargaLoader::load(file, srgb);
 	}
 
@@ -0,0 +1,121 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Display/ImageFormats/thumbnail_cache.h"
+#include "UICore/Display/ImageFormats/image_file.h"
+#include "UICore/Display/ImageFormats/png_format.h"
+#include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Core/IOData/file.h"
+#include "UICore/Core/IOData/directory.h"
+#include "UICore/Core/IOData/path_help.h"
+#include "UICore/Core/Crypto/sha1.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/Text/text.h"
+#include <atomic>
+#include <chrono>
+
+namespace uicore
+{
+	class ThumbnailCacheImpl : public ThumbnailCache
+	{
+	public:
+		ThumbnailCacheImpl(const std::string &cache_path) : cache_path(cache_path)
+		{
+			Directory::create(cache_path, true);
+		}
+
+		std::shared_ptr<PixelBuffer> load(const std::string &filename, const Size &max_size, bool srgb) override
+		{
+			std::string absolute_filename = FilePath::absolute_path(filename);
+			std::string key = absolute_filename + "|" + Text::to_string(File::last_write_time(absolute_filename)) + "|" + Text::to_string(max_size.width) + "x" + Text::to_string(max_size.height);
+
+			auto sha1 = SHA1::create();
+			sha1->add(key.data(), (int)key.size());
+			sha1->calculate();
+			std::string cache_filename = FilePath::combine(cache_path, sha1->hash() + ".png");
+
+			if (File::exists(cache_filename))
+			{
+				try
+				{
+					return PNGFormat::load(cache_filename, srgb);
+				}
+				catch (const Exception &)
+				{
+					// A damaged or partially written entry is created again below
+				}
+			}
+
+			auto image = ImageFile::load_scaled(filename, max_size, std::string(), srgb);
+
+			// Written to a temporary file and renamed into place, so another process never loads a partially written entry.
+			// create_new fails if the name is taken, which then only skips caching this time.
+			static std::atomic<unsigned int> temp_counter(0);
+			std::string temp_filename = FilePath::combine(cache_path, sha1->hash() + "-" + Text::to_string((long long)std::chrono::steady_clock::now().time_since_epoch().count()) + "-" + Text::to_string(temp_counter++) + ".tmp");
+			bool temp_created = false;
+			try
+			{
+				{
+					auto file = File::create_new(temp_filename, FileAccess::write);
+					temp_created = true;
+					PNGFormat::save(image, file);
+				}
+				if (!Directory::rename(temp_filename, cache_filename))
+					File::remove(temp_filename);
+			}
+			catch (const Exception &)
+			{
+				// The cache is only an optimization; a read-only or full disk must not fail the load
+				if (temp_created)
+				{
+					try { File::remove(temp_filename); } catch (const Exception &) { }
+				}
+			}
+
+			return image;
+		}
+
+		void clear() override
+		{
+			for (const auto &file : Directory::files(cache_path))
+			{
+				if (FilePath::has_extension(file, "png") || FilePath::has_extension(file, "tmp"))
+					File::remove(file);
+			}
+		}
+
+	private:
+		std::string cache_path;
+	};
+
+	std::shared_ptr<ThumbnailCache> ThumbnailCache::create(const std::string &cache_path)
+	{
+		return std::make_shared<ThumbnailCacheImpl>(cache_path);
+	}
+}
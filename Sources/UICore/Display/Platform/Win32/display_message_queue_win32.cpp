@@ -33,6 +33,7 @@
 #include "display_message_queue_win32.h"
 #include "win32_window.h"
 #include "../../setup_display.h"
+#include "../../../Network/Socket/tcp_socket.h"
 #include "UICore/Core/System/system.h"
 
 namespace uicore
@@ -61,12 +62,13 @@ namespace uicore
 		while (true)
 		{
 			MSG msg;
-			BOOL result = GetMessage(&msg, 0, 0, 0);
-			if (result < 0)
-				throw Exception("GetMessage failed!");
+			while (PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
+			{
+				if (!process_message(msg))
+					return;
+			}
 
-			if (!process_message(msg))
-				break;
+			wait_for_messages(process_timers(-1));
 		}
 	}
 
@@ -98,16 +100,48 @@ namespace uicore
 			auto time_now = System::time();
 			int64_t time_remaining_ms = timeout_ms - (time_now - time_start);
 
+			int wait_ms = process_timers((int)std::max(time_remaining_ms, (int64_t)0));
 			if (time_remaining_ms <= 0)
 				break;
 
-			if (MsgWaitForMultipleObjects(0, 0, FALSE, time_remaining_ms, QS_ALLEVENTS | QS_SENDMESSAGE | QS_RAWINPUT) == WAIT_TIMEOUT)
+			// A timeout caused by a timer continues the loop, as the timer is called at the start of the next round
+			if (wait_for_messages(wait_ms) == WAIT_TIMEOUT && wait_ms == time_remaining_ms)
 				break;
 		}
 
 		return true;
 	}
 
+	DWORD DisplayMessageQueue_Win32::wait_for_messages(int timeout_ms)
+	{
+		std::vector<std::weak_ptr<RunLoopWatch>> wait_watches;
+		std::vector<HANDLE> handles;
+		for (auto &weak_watch : watches)
+		{
+			auto watch = weak_watch.lock();
+			if (watch && watch->type == RunLoopWatch::type_network_event)
+			{
+				wait_watches.push_back(watch);
+				handles.push_back(socket_handle(watch->event)->wait_handle);
+			}
+		}
+
+		if (handles.size() >= MAXIMUM_WAIT_OBJECTS)
+			throw Exception("Too many network events connected to the RunLoop");
+
+		DWORD result = MsgWaitForMultipleObjectsEx((DWORD)handles.size(), handles.empty() ? nullptr : handles.data(), timeout_ms >= 0 ? timeout_ms : INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+		if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size())
+		{
+			auto watch = wait_watches[result - WAIT_OBJECT_0].lock();
+			if (watch)
+			{
+				socket_handle(watch->event)->reset_wait_handle();
+				watch->func();
+			}
+		}
+		return result;
+	}
+
 	void DisplayMessageQueue_Win32::post_async_work_needed()
 	{
 		PostMessage(async_message_window_handle, WM_ASYNC_WORK, 0, 0);
@@ -46,6 +46,7 @@ namespace uicore
 		void exit() override;
 		bool process(int timeout_ms) override;
 		void post_async_work_needed() override;
+		bool is_watch_supported(RunLoopWatch::Type type) const override { return type != RunLoopWatch::type_fd; }
 
 		static bool should_apply_vista_x64_workaround()
 		{
@@ -61,6 +62,7 @@ namespace uicore
 
 		static void allow_exceptions();
 		bool process_message(MSG &msg);
+		DWORD wait_for_messages(int timeout_ms);
 
 		bool exit_loop = false;
 		HWND async_message_window_handle;
@@ -33,6 +33,7 @@
 #include "x11_window.h"
 #include <dlfcn.h>
 #include "../../setup_display.h"
+#include "../../../Network/Socket/tcp_socket.h"
 #include "UICore/Core/System/system.h"
 
 namespace uicore
@@ -133,7 +134,7 @@ namespace uicore
 	bool DisplayMessageQueue_X11::process(int timeout_ms)
 	{
 		auto time_start = System::time();
-		int x11_handle = ConnectionNumber(display);
+		int x11_handle = ConnectionNumber(get_display());
 
 		while (true)
 		{
@@ -141,44 +142,71 @@ namespace uicore
 
 			auto time_now = System::time();
 			int time_remaining_ms = timeout_ms - (time_now - time_start);
+			int wait_ms = process_timers(timeout_ms != -1 ? std::max(time_remaining_ms, 0) : -1);
 
-			struct timeval tv;
-			if (time_remaining_ms > 0)
-			{
-				tv.tv_sec = time_remaining_ms / 1000;
-				tv.tv_usec = (time_remaining_ms % 1000) * 1000;
-			}
-			else
-			{
-				tv.tv_sec = 0;
-				tv.tv_usec = 0;
-			}
+			poll_fds.clear();
+			poll_watches.clear();
+			poll_fds.push_back({ x11_handle, POLLIN, 0 });
+			poll_fds.push_back({ async_work_event.read_fd(), POLLIN, 0 });
+			poll_fds.push_back({ exit_event.read_fd(), POLLIN, 0 });
 
-			fd_set rfds;
-			FD_ZERO(&rfds);
+			for (auto &weak_watch : watches)
+			{
+				auto watch = weak_watch.lock();
+				if (!watch || watch->type == RunLoopWatch::type_timer)
+					continue;
 
-			FD_SET(x11_handle, &rfds);
-			FD_SET(async_work_event.read_fd(), &rfds);
-			FD_SET(exit_event.read_fd(), &rfds);
+				pollfd fd = {};
+				if (watch->type == RunLoopWatch::type_network_event)
+				{
+					socket_handle(watch->event)->begin_poll(fd);
+				}
+				else
+				{
+					fd.fd = watch->fd;
+					fd.events = watch->fd_write ? POLLIN | POLLOUT : POLLIN;
+				}
+				poll_fds.push_back(fd);
+				poll_watches.push_back(watch);
+			}
 
-			int result = select(std::max(std::max(async_work_event.read_fd(), x11_handle), exit_event.read_fd()) + 1, &rfds, nullptr, nullptr, timeout_ms != -1 ? &tv : nullptr);
+			int result = poll(poll_fds.data(), poll_fds.size(), wait_ms);
 			if (result > 0)
 			{
-				if (FD_ISSET(async_work_event.read_fd(), &rfds))
+				if (poll_fds[1].revents)
 				{
 					async_work_event.reset();
 					process_async_work();
 				}
-				if (FD_ISSET(exit_event.read_fd(), &rfds))
+				if (poll_fds[2].revents)
 				{
 					exit_event.reset();
 					return false;
 				}
+
+				// A callback may destroy the slots of the watches after it
+				for (size_t i = 0; i < poll_watches.size(); i++)
+				{
+					const pollfd &fd = poll_fds[i + 3];
+					auto watch = poll_watches[i].lock();
+					if (!watch || fd.revents == 0)
+						continue;
+
+					bool ready = watch->type == RunLoopWatch::type_network_event ? socket_handle(watch->event)->end_poll(fd) : true;
+					if (ready)
+						watch->func();
+				}
+			}
+			else if (result == -1)
+			{
+				if (errno != EINTR)
+					break;
 			}
-			else
+			else if (timeout_ms != -1 && System::time() - time_start >= timeout_ms)
 			{
 				break;
 			}
+			// Otherwise the wait was cut short by a timer, which is called at the start of the next round
 		}
 		return true;
 	}
@@ -34,6 +34,7 @@
 #include <X11/Xlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 
 namespace uicore
 {
@@ -69,6 +70,7 @@ namespace uicore
 		void exit() override;
 		bool process(int timeout_ms) override;
 		void post_async_work_needed() override;
+		bool is_watch_supported(RunLoopWatch::Type) const override { return true; }
 
 	private:
 		void process_message();
@@ -79,6 +81,9 @@ namespace uicore
 		void *dlopen_lib_handle = nullptr;
 		bool client_modified = false;
 
+		std::vector<pollfd> poll_fds;
+		std::vector<std::weak_ptr<RunLoopWatch>> poll_watches;
+
 		class NotifyEvent
 		{
 		public:
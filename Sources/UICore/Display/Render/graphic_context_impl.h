@@ -38,6 +38,7 @@
 #include "UICore/Core/Math/mat4.h"
 #include "UICore/Core/Signals/signal.h"
 #include "UICore/Display/Render/staging_texture.h"
+#include "UICore/Display/2D/texture_group.h"
 
 namespace uicore
 {
@@ -168,6 +169,17 @@ namespace uicore
 			return _default_depth_stencil_state;
 		}
 
+		/// \brief Atlas pages shared by all small images created on this context
+		const std::shared_ptr<TextureGroup> &image_atlas()
+		{
+			if (!_image_atlas)
+			{
+				_image_atlas = TextureGroup::create(Size(1024, 1024));
+				_image_atlas->set_allocation_policy(TextureGroupAllocationPolicy::search_previous_textures);
+			}
+			return _image_atlas;
+		}
+
 		void set_default_state()
 		{
 			set_rasterizer_state(default_rasterizer_state());
@@ -181,6 +193,7 @@ namespace uicore
 		std::shared_ptr<RasterizerState> _default_rasterizer_state;
 		std::shared_ptr<BlendState> _default_blend_state;
 		std::shared_ptr<DepthStencilState> _default_depth_stencil_state;
+		std::shared_ptr<TextureGroup> _image_atlas;
 
 		Slot resize_slot;
 	};
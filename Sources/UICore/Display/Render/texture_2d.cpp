@@ -31,10 +31,12 @@
 #include "UICore/Display/Render/texture_impl.h"
 #include "UICore/Display/Render/graphic_context_impl.h"
 #include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/Image/texture_compressor_impl.h"
 #include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Core/Math/color.h"
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/Text/string_format.h"
+#include "UICore/Core/System/system.h"
 
 namespace uicore
 {
@@ -52,20 +54,14 @@ namespace uicore
 	{
 		std::shared_ptr<PixelBuffer> pb = ImageFile::load(filename, std::string());
 		pb = import_desc.process(pb);
-
-		auto texture = create(context, pb->width(), pb->height(), import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8);
-		texture->set_subimage(context, Point(0, 0), pb, Rect(pb->size()), 0);
-		return texture;
+		return TextureCompressorImpl::create_texture(context, pb, import_desc);
 	}
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::shared_ptr<IODevice> &file, const std::string &image_type, const ImageImportDescription &import_desc)
 	{
 		std::shared_ptr<PixelBuffer> pb = ImageFile::load(file, image_type);
 		pb = import_desc.process(pb);
-
-		auto texture = create(context, pb->width(), pb->height(), import_desc.is_srgb() ? tf_srgb8_alpha8 : tf_rgba8);
-		texture->set_subimage(context, Point(0, 0), pb, Rect(pb->size()), 0);
-		return texture;
+		return TextureCompressorImpl::create_texture(context, pb, import_desc);
 	}
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::shared_ptr<PixelBuffer> &image, bool is_srgb)
@@ -75,8 +71,15 @@ namespace uicore
 
 	std::shared_ptr<Texture2D> Texture2D::create(const std::shared_ptr<GraphicContext> &context, const std::shared_ptr<PixelBuffer> &image, const Rect &src_rect, bool is_srgb)
 	{
-		auto texture = create(context, src_rect.width(), src_rect.height(), is_srgb ? tf_srgb8_alpha8 : tf_rgba8);
+		// Compressed images, such as those loaded by DDSFormat, are uploaded as blocks
+		TextureFormat format = is_srgb ? tf_srgb8_alpha8 : tf_rgba8;
+		if (image->is_compressed())
+			format = is_srgb && TextureCompressor::is_supported(image->format()) ? TextureCompressor::srgb_format(image->format()) : image->format();
+
+		int64_t start_time = System::microseconds();
+		auto texture = create(context, src_rect.width(), src_rect.height(), format);
 		texture->set_subimage(context, Point(0, 0), image, src_rect, 0);
+		TextureCompressorImpl::add_upload(image->is_compressed(), image->is_compressed() ? image->data_size() : PixelBuffer::data_size(src_rect.size(), image->format()), System::microseconds() - start_time);
 		return texture;
 	}
 }
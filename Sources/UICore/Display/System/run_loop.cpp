@@ -29,6 +29,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Display/System/run_loop.h"
 #include "run_loop_impl.h"
+#include "UICore/Network/Socket/network_condition_variable.h"
+#include <algorithm>
 
 namespace uicore
 {
@@ -60,6 +62,45 @@ namespace uicore
 			impl->post_async_work_needed();
 	}
 
+	Slot RunLoop::connect_network_event(NetworkEvent *event, std::function<void()> func)
+	{
+		auto watch = std::make_shared<RunLoopWatch>();
+		watch->type = RunLoopWatch::type_network_event;
+		watch->event = event;
+		watch->func = std::move(func);
+		return RunLoopImpl::get_instance()->add_watch(watch);
+	}
+
+	Slot RunLoop::connect_fd(int fd, bool write, std::function<void()> func)
+	{
+		auto watch = std::make_shared<RunLoopWatch>();
+		watch->type = RunLoopWatch::type_fd;
+		watch->fd = fd;
+		watch->fd_write = write;
+		watch->func = std::move(func);
+		return RunLoopImpl::get_instance()->add_watch(watch);
+	}
+
+	Slot RunLoop::connect_timer(int timeout_ms, bool repeat, std::function<void()> func)
+	{
+		auto watch = std::make_shared<RunLoopWatch>();
+		watch->type = RunLoopWatch::type_timer;
+		watch->repeat = repeat;
+		watch->interval = std::chrono::milliseconds(std::max(timeout_ms, 0));
+		watch->next_time = std::chrono::steady_clock::now() + watch->interval;
+		watch->func = std::move(func);
+		return RunLoopImpl::get_instance()->add_watch(watch);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	RunLoopWatch::~RunLoopWatch()
+	{
+		RunLoopImpl *impl = RunLoopImpl::get_instance_if_exists();
+		if (impl)
+			impl->remove_expired_watches();
+	}
+
 	/////////////////////////////////////////////////////////////////////////
 
 	RunLoopImpl *RunLoopImpl::get_instance()
@@ -93,5 +134,74 @@ namespace uicore
 		}
 	}
 
+	Slot RunLoopImpl::add_watch(std::shared_ptr<RunLoopWatch> watch)
+	{
+		if (!is_watch_supported(watch->type))
+			throw Exception("RunLoop does not support this kind of watch on this platform");
+
+		watches.push_back(watch);
+		return Slot(watch);
+	}
+
+	void RunLoopImpl::remove_expired_watches()
+	{
+		watches.erase(std::remove_if(watches.begin(), watches.end(), [](const std::weak_ptr<RunLoopWatch> &watch) { return watch.expired(); }), watches.end());
+	}
+
+	int RunLoopImpl::process_timers(int timeout_ms)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		// Callbacks may add or remove watches, so work on a copy. Weak references, as a callback may destroy
+		// the slot of another timer due in the same round.
+		std::vector<std::weak_ptr<RunLoopWatch>> expired;
+		for (auto &weak_watch : watches)
+		{
+			auto watch = weak_watch.lock();
+			if (watch && watch->type == RunLoopWatch::type_timer && watch->func && watch->next_time <= now)
+				expired.push_back(watch);
+		}
+
+		for (auto &weak_watch : expired)
+		{
+			auto watch = weak_watch.lock();
+			if (!watch || !watch->func)
+				continue;
+
+			if (watch->repeat)
+			{
+				// Skip intervals missed while the main thread was busy rather than calling the function repeatedly
+				watch->next_time += watch->interval;
+				if (watch->next_time <= now)
+					watch->next_time = now + watch->interval;
+			}
+
+			std::function<void()> func = watch->func;
+			if (!watch->repeat)
+				watch->func = nullptr;
+			func();
+		}
+
+		now = std::chrono::steady_clock::now();
+		for (auto &weak_watch : watches)
+		{
+			auto watch = weak_watch.lock();
+			if (watch && watch->type == RunLoopWatch::type_timer && watch->func)
+			{
+				// Round up so the wait does not return just before the timer expires
+				auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(watch->next_time - now).count();
+				int wait_ms = (int)std::max((remaining + 999) / 1000, (decltype(remaining))0);
+				if (timeout_ms == -1 || wait_ms < timeout_ms)
+					timeout_ms = wait_ms;
+			}
+		}
+		return timeout_ms;
+	}
+
+	SocketHandle *RunLoopImpl::socket_handle(NetworkEvent *event)
+	{
+		return event->socket_handle();
+	}
+
 	RunLoopImpl *RunLoopImpl::instance = 0;
 }
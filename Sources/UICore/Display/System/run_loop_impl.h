@@ -28,12 +28,40 @@
 
 #pragma once
 
+#include "UICore/Core/Signals/signal.h"
 #include <mutex>
 #include <vector>
 #include <functional>
+#include <chrono>
 
 namespace uicore
 {
+	class NetworkEvent;
+	class SocketHandle;
+
+	/// \brief Network event, file descriptor or timer serviced by the run loop
+	class RunLoopWatch : public SlotImpl
+	{
+	public:
+		enum Type
+		{
+			type_network_event,
+			type_fd,
+			type_timer
+		};
+
+		~RunLoopWatch();
+
+		Type type = type_timer;
+		NetworkEvent *event = nullptr;
+		int fd = -1;
+		bool fd_write = false;
+		bool repeat = false;
+		std::chrono::milliseconds interval;
+		std::chrono::steady_clock::time_point next_time;
+		std::function<void()> func;
+	};
+
 	class RunLoopImpl
 	{
 	public:
@@ -47,7 +75,25 @@ namespace uicore
 		virtual bool process(int timeout_ms) = 0;
 		virtual void post_async_work_needed() = 0;
 
+		/// \brief Returns true if the message queue waits for watches of this type
+		virtual bool is_watch_supported(RunLoopWatch::Type) const { return false; }
+
+		Slot add_watch(std::shared_ptr<RunLoopWatch> watch);
+		void remove_expired_watches();
+
+		/// \brief Calls expired timers and returns how long the message queue may wait before the next one expires
+		///
+		/// A timeout of -1 waits forever.
+		int process_timers(int timeout_ms);
+
 		static RunLoopImpl *get_instance();
+		static RunLoopImpl *get_instance_if_exists() { return instance; }
+
+	protected:
+		static SocketHandle *socket_handle(NetworkEvent *event);
+
+		/// \brief Watches in the order they were added. Only accessed on the main thread.
+		std::vector<std::weak_ptr<RunLoopWatch>> watches;
 
 	private:
 		std::mutex mutex;
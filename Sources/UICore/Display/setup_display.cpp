@@ -61,8 +61,8 @@ namespace uicore
 		/// \brief Map of the class factories for each provider type.
 		std::map<std::string, ImageFileType *> image_provider_factory_types;
 
-		ImageFileType_Register<JPEGFormat> *jpeg_provider = nullptr;
-		ImageFileType_Register<JPEGFormat> *jpg_provider = nullptr;
+		ImageFileTypeReduced_Register<JPEGFormat> *jpeg_provider = nullptr;
+		ImageFileTypeReduced_Register<JPEGFormat> *jpg_provider = nullptr;
 		ImageFileType_Register<PNGFormat> *png_provider = nullptr;
 		ImageFileType_Register<TargaFormat> *targa_provider = nullptr;
 		ImageFileType_Register<TargaFormat> *tga_provider = nullptr;
@@ -100,8 +100,8 @@ namespace uicore
 		// This function must be the first Xlib function a multi-threaded program calls, and it must complete before any other Xlib call is made.
 		XInitThreads();
 #endif
-		jpeg_provider = new ImageFileType_Register<JPEGFormat>("jpeg");
-		jpg_provider = new ImageFileType_Register<JPEGFormat>("jpg");
+		jpeg_provider = new ImageFileTypeReduced_Register<JPEGFormat>("jpeg");
+		jpg_provider = new ImageFileTypeReduced_Register<JPEGFormat>("jpg");
 		png_provider = new ImageFileType_Register<PNGFormat>("png");
 		targa_provider = new ImageFileType_Register<TargaFormat>("targa");
 		tga_provider = new ImageFileType_Register<TargaFormat>("tga");
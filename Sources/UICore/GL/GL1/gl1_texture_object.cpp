@@ -1017,6 +1017,8 @@ namespace uicore
 			//case tf_compressed_srgb_alpha_s3tc_dxt1: gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; gl_pixel_format = GL_RGBA; break;
 			//case tf_compressed_srgb_alpha_s3tc_dxt3: gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; gl_pixel_format = GL_RGBA; break;
 			//case tf_compressed_srgb_alpha_s3tc_dxt5: gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; gl_pixel_format = GL_RGBA; break;
+			//case tf_compressed_rgba_bptc_unorm: gl_internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; gl_pixel_format = GL_RGBA; break;
+			//case tf_compressed_srgb_alpha_bptc_unorm: gl_internal_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; gl_pixel_format = GL_RGBA; break;
 
 			default:
 				throw Exception(string_format("Unsupported TextureFormat (%1)", format));
@@ -1291,6 +1293,8 @@ namespace uicore
 			case tf_compressed_srgb_alpha_s3tc_dxt1: break;
 			case tf_compressed_srgb_alpha_s3tc_dxt3: break;
 			case tf_compressed_srgb_alpha_s3tc_dxt5: break;
+			case tf_compressed_rgba_bptc_unorm: break;
+			case tf_compressed_srgb_alpha_bptc_unorm: break;
 		}
 
 		return valid;
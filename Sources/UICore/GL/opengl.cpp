@@ -262,6 +262,8 @@ namespace uicore
 			case tf_compressed_srgb_alpha_s3tc_dxt1: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
 			case tf_compressed_srgb_alpha_s3tc_dxt3: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
 			case tf_compressed_srgb_alpha_s3tc_dxt5: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+			case tf_compressed_rgba_bptc_unorm: tf.internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; break;
+			case tf_compressed_srgb_alpha_bptc_unorm: tf.internal_format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; tf.pixel_format = GL_RGBA; tf.pixel_datatype = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; break;
 	#endif
 			default:
 				tf.valid = false;
@@ -0,0 +1,287 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#include "UICore/precomp.h"
+#include "async_tcp_connection_impl.h"
+#include "tcp_socket.h"
+#include "UICore/Core/System/databuffer.h"
+#include "UICore/Core/System/exception.h"
+#include <climits>
+
+namespace uicore
+{
+	std::shared_ptr<AsyncTCPConnection> AsyncTCPConnection::create(std::shared_ptr<TCPConnection> connection, std::shared_ptr<NetworkReactor> reactor)
+	{
+		auto impl = std::make_shared<AsyncTCPConnectionImpl>(std::move(connection), NetworkReactorImpl::get(std::move(reactor)));
+		impl->start();
+		return impl;
+	}
+
+	AsyncTCPConnectionImpl::AsyncTCPConnectionImpl(std::shared_ptr<TCPConnection> connection, std::shared_ptr<NetworkReactorImpl> reactor)
+		: _connection(std::move(connection)), _reactor(reactor), reactor_impl(reactor.get())
+	{
+		if (!_connection)
+			throw Exception("No connection specified");
+	}
+
+	AsyncTCPConnectionImpl::~AsyncTCPConnectionImpl()
+	{
+		reactor_impl->remove(_connection.get());
+	}
+
+	void AsyncTCPConnectionImpl::start()
+	{
+		reactor_impl->add(_connection.get(), shared_from_this());
+	}
+
+	void AsyncTCPConnectionImpl::async_read(void *data, int size, AsyncNetworkCallback<int> func)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		reads.push_back({ data, size, std::move(func) });
+		lock.unlock();
+
+		// Operations are only attempted on the reactor thread, so callbacks never run on the calling thread
+		reactor_impl->schedule(shared_from_this());
+	}
+
+	void AsyncTCPConnectionImpl::async_write(const void *data, int size, AsyncNetworkCallback<int> func)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		writes.push_back({ static_cast<const char *>(data), size, size, std::shared_ptr<DataBuffer>(), std::move(func) });
+		lock.unlock();
+
+		reactor_impl->schedule(shared_from_this());
+	}
+
+	void AsyncTCPConnectionImpl::async_write(std::vector<std::shared_ptr<DataBuffer>> buffers, AsyncNetworkCallback<int> func)
+	{
+		// The completion reports the total as an int
+		size_t total_size = 0;
+		for (auto &buffer : buffers)
+		{
+			if (buffer->size() > (size_t)INT_MAX - total_size)
+				throw Exception("Total size of the buffers passed to AsyncTCPConnection::async_write exceeds INT_MAX");
+			total_size += buffer->size();
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		if (buffers.empty())
+		{
+			writes.push_back({ nullptr, 0, 0, std::shared_ptr<DataBuffer>(), std::move(func) });
+		}
+		else
+		{
+			for (size_t i = 0; i + 1 < buffers.size(); i++)
+				writes.push_back({ buffers[i]->data(), (int)buffers[i]->size(), (int)total_size, buffers[i], AsyncNetworkCallback<int>() });
+			writes.push_back({ buffers.back()->data(), (int)buffers.back()->size(), (int)total_size, buffers.back(), std::move(func) });
+		}
+		lock.unlock();
+
+		reactor_impl->schedule(shared_from_this());
+	}
+
+	void AsyncTCPConnectionImpl::close()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		closed = true;
+		lock.unlock();
+
+		reactor_impl->schedule(shared_from_this());
+	}
+
+	void AsyncTCPConnectionImpl::process(bool event_ready)
+	{
+		if (event_ready)
+		{
+			readable = true;
+			writable = true;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		std::exception_ptr current_error = error;
+		bool close_requested = closed && !error;
+		lock.unlock();
+
+		if (close_requested)
+		{
+			reactor_impl->remove(_connection.get());
+			_connection->close();
+			fail(std::make_exception_ptr(Exception("Connection closed")));
+			return;
+		}
+
+		// Operations started after a failure complete with the same error
+		if (current_error)
+		{
+			fail(current_error);
+			return;
+		}
+
+		try
+		{
+			if (writable)
+				process_writes();
+			if (readable)
+				process_reads();
+		}
+		catch (...)
+		{
+			fail(std::current_exception());
+		}
+	}
+
+	bool AsyncTCPConnectionImpl::wants_event()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return !reads.empty() || !writes.empty();
+	}
+
+	void AsyncTCPConnectionImpl::process_reads()
+	{
+		// Only the reactor thread removes operations, so the front stays valid while the lock is released
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!reads.empty() && !error && readable)
+		{
+			ReadOperation &operation = reads.front();
+			lock.unlock();
+
+			int result = _connection->read(operation.data, operation.size);
+			if (result == -1)
+			{
+				readable = false;
+				return;
+			}
+
+			// A short read emptied the receive buffer
+			if (result > 0 && result < operation.size)
+				readable = false;
+
+			lock.lock();
+			AsyncNetworkCallback<int> func = std::move(reads.front().func);
+			reads.pop_front();
+			lock.unlock();
+
+			if (func)
+				func(std::exception_ptr(), result);
+
+			lock.lock();
+		}
+	}
+
+	void AsyncTCPConnectionImpl::process_writes()
+	{
+		TCPConnectionImpl *gather_connection = dynamic_cast<TCPConnectionImpl *>(_connection.get());
+		std::vector<SocketBuffer> buffers;
+		std::vector<AsyncNetworkCallback<int>> completed;
+		std::vector<int> completed_sizes;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!writes.empty() && !error)
+		{
+			buffers.clear();
+			int size = 0;
+			int offset = write_offset;
+			for (auto &operation : writes)
+			{
+				if (buffers.size() == 64)
+					break;
+				buffers.push_back({ operation.data + offset, operation.size - offset });
+				size += operation.size - offset;
+				offset = 0;
+			}
+			lock.unlock();
+
+			int result;
+			if (size == 0)
+				result = 0;
+			else if (gather_connection && buffers.size() > 1)
+				result = gather_connection->write(buffers.data(), (int)buffers.size());
+			else
+				result = _connection->write(buffers[0].data, buffers[0].size);
+
+			if (result == -1)
+			{
+				writable = false;
+				return;
+			}
+
+			lock.lock();
+			write_offset += result;
+			while (!writes.empty() && write_offset >= writes.front().size)
+			{
+				write_offset -= writes.front().size;
+				if (writes.front().func)
+				{
+					completed.push_back(std::move(writes.front().func));
+					completed_sizes.push_back(writes.front().total_size);
+				}
+				writes.pop_front();
+			}
+			lock.unlock();
+
+			for (size_t i = 0; i < completed.size(); i++)
+				completed[i](std::exception_ptr(), completed_sizes[i]);
+			completed.clear();
+			completed_sizes.clear();
+
+			// A short write means the send buffer is full. The reactor calls again when it becomes writable.
+			if (result < size)
+			{
+				writable = false;
+				return;
+			}
+
+			lock.lock();
+		}
+	}
+
+	void AsyncTCPConnectionImpl::fail(const std::exception_ptr &operation_error)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!error)
+			error = operation_error;
+		std::exception_ptr current_error = error;
+		std::deque<ReadOperation> failed_reads;
+		std::deque<WriteOperation> failed_writes;
+		failed_reads.swap(reads);
+		failed_writes.swap(writes);
+		write_offset = 0;
+		lock.unlock();
+
+		for (auto &operation : failed_reads)
+		{
+			if (operation.func)
+				operation.func(current_error, 0);
+		}
+		for (auto &operation : failed_writes)
+		{
+			if (operation.func)
+				operation.func(current_error, 0);
+		}
+	}
+}
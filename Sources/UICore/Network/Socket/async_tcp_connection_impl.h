@@ -0,0 +1,95 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include "UICore/Network/Socket/async_tcp_connection.h"
+#include "UICore/Network/Socket/tcp_connection.h"
+#include "network_reactor_impl.h"
+#include <deque>
+
+namespace uicore
+{
+	class AsyncTCPConnectionImpl : public AsyncTCPConnection, public NetworkReactorHandler, public std::enable_shared_from_this<AsyncTCPConnectionImpl>
+	{
+	public:
+		AsyncTCPConnectionImpl(std::shared_ptr<TCPConnection> connection, std::shared_ptr<NetworkReactorImpl> reactor);
+		~AsyncTCPConnectionImpl();
+
+		void start();
+
+		const std::shared_ptr<TCPConnection> &connection() const override { return _connection; }
+		const std::shared_ptr<NetworkReactor> &reactor() const override { return _reactor; }
+
+		void async_read(void *data, int size, AsyncNetworkCallback<int> func) override;
+		void async_write(const void *data, int size, AsyncNetworkCallback<int> func) override;
+		void async_write(std::vector<std::shared_ptr<DataBuffer>> buffers, AsyncNetworkCallback<int> func) override;
+		void close() override;
+
+		void process(bool event_ready) override;
+		bool wants_event() override;
+
+	private:
+		struct ReadOperation
+		{
+			void *data;
+			int size;
+			AsyncNetworkCallback<int> func;
+		};
+
+		// A write of several buffers is queued as one entry per buffer, with the callback on the last one
+		struct WriteOperation
+		{
+			const char *data;
+			int size;
+			int total_size;
+			std::shared_ptr<DataBuffer> buffer;
+			AsyncNetworkCallback<int> func;
+		};
+
+		void process_reads();
+		void process_writes();
+		void fail(const std::exception_ptr &error);
+
+		std::shared_ptr<TCPConnection> _connection;
+		std::shared_ptr<NetworkReactor> _reactor;
+		NetworkReactorImpl *reactor_impl;
+
+		std::mutex mutex;
+		std::deque<ReadOperation> reads;
+		std::deque<WriteOperation> writes;
+		int write_offset = 0;
+
+		// Cleared when the socket was found empty or full, until the reactor reports the event again. Only accessed on the reactor thread.
+		bool readable = true;
+		bool writable = true;
+
+		std::exception_ptr error;
+		bool closed = false;
+	};
+}
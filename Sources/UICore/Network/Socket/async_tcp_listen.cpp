@@ -0,0 +1,173 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Network/Socket/async_tcp_listen.h"
+#include "UICore/Network/Socket/tcp_listen.h"
+#include "UICore/Network/Socket/socket_name.h"
+#include "UICore/Core/System/exception.h"
+#include "async_tcp_connection_impl.h"
+#include <deque>
+
+namespace uicore
+{
+	class AsyncTCPListenImpl : public AsyncTCPListen, public NetworkReactorHandler, public std::enable_shared_from_this<AsyncTCPListenImpl>
+	{
+	public:
+		AsyncTCPListenImpl(std::shared_ptr<TCPListen> listen, std::shared_ptr<NetworkReactorImpl> reactor) : _listen(std::move(listen)), reactor(std::move(reactor))
+		{
+			if (!_listen)
+				throw Exception("No listen socket specified");
+		}
+
+		~AsyncTCPListenImpl()
+		{
+			reactor->remove(_listen.get());
+		}
+
+		void start()
+		{
+			reactor->add(_listen.get(), shared_from_this());
+		}
+
+		const std::shared_ptr<TCPListen> &listen() const override { return _listen; }
+
+		void async_accept(AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>> func) override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			accepts.push_back(std::move(func));
+			lock.unlock();
+
+			reactor->schedule(shared_from_this());
+		}
+
+		void close() override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			closed = true;
+			lock.unlock();
+
+			reactor->schedule(shared_from_this());
+		}
+
+		void process(bool event_ready) override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			std::exception_ptr current_error = error;
+			bool close_requested = closed && !error;
+			lock.unlock();
+
+			if (close_requested)
+			{
+				reactor->remove(_listen.get());
+				_listen->close();
+				fail(std::make_exception_ptr(Exception("Listen socket closed")));
+				return;
+			}
+
+			if (current_error)
+			{
+				fail(current_error);
+				return;
+			}
+
+			lock.lock();
+			while (!accepts.empty())
+			{
+				lock.unlock();
+
+				std::shared_ptr<AsyncTCPConnection> connection;
+				try
+				{
+					SocketName end_point;
+					std::shared_ptr<TCPConnection> accepted = _listen->accept(end_point);
+					if (!accepted)
+						return;
+
+					auto impl = std::make_shared<AsyncTCPConnectionImpl>(accepted, reactor);
+					impl->start();
+					connection = impl;
+				}
+				catch (...)
+				{
+					fail(std::current_exception());
+					return;
+				}
+
+				lock.lock();
+				AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>> func = std::move(accepts.front());
+				accepts.pop_front();
+				lock.unlock();
+
+				if (func)
+					func(std::exception_ptr(), connection);
+
+				lock.lock();
+			}
+		}
+
+		bool wants_event() override
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return !accepts.empty();
+		}
+
+	private:
+		void fail(const std::exception_ptr &operation_error)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!error)
+				error = operation_error;
+			std::exception_ptr current_error = error;
+			std::deque<AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>>> failed_accepts;
+			failed_accepts.swap(accepts);
+			lock.unlock();
+
+			for (auto &func : failed_accepts)
+			{
+				if (func)
+					func(current_error, std::shared_ptr<AsyncTCPConnection>());
+			}
+		}
+
+		std::shared_ptr<TCPListen> _listen;
+		std::shared_ptr<NetworkReactorImpl> reactor;
+
+		std::mutex mutex;
+		std::deque<AsyncNetworkCallback<std::shared_ptr<AsyncTCPConnection>>> accepts;
+		std::exception_ptr error;
+		bool closed = false;
+	};
+
+	std::shared_ptr<AsyncTCPListen> AsyncTCPListen::create(std::shared_ptr<TCPListen> listen, std::shared_ptr<NetworkReactor> reactor)
+	{
+		auto impl = std::make_shared<AsyncTCPListenImpl>(std::move(listen), NetworkReactorImpl::get(std::move(reactor)));
+		impl->start();
+		return impl;
+	}
+}
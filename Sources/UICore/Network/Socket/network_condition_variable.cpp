@@ -30,12 +30,20 @@
 #include "UICore/precomp.h"
 #include "UICore/Network/Socket/network_condition_variable.h"
 #include "tcp_socket.h"
+#include <algorithm>
+#include <mutex>
 
 #ifndef WIN32
 #include <unistd.h>
 #include <fcntl.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <chrono>
+#endif
+
 namespace uicore
 {
 #if defined(WIN32)
@@ -55,14 +63,29 @@ namespace uicore
 		}
 
 		HANDLE notify_handle;
+
+		std::mutex mutex;
+		std::vector<NetworkEvent *> added;
 	};
 
 	NetworkConditionVariable::NetworkConditionVariable() : impl(std::make_shared<NetworkConditionVariableImpl>())
 	{
 	}
 
-	bool NetworkConditionVariable::wait_impl(int count, NetworkEvent **events, int timeout)
+	bool NetworkConditionVariable::wait_impl(int count, NetworkEvent **events, int timeout, std::vector<NetworkEvent *> *ready_events)
 	{
+		std::vector<NetworkEvent *> all_events;
+		{
+			std::unique_lock<std::mutex> lock(impl->mutex);
+			if (!impl->added.empty())
+			{
+				all_events = impl->added;
+				all_events.insert(all_events.end(), events, events + count);
+				count = (int)all_events.size();
+				events = all_events.data();
+			}
+		}
+
 		std::vector<HANDLE> handles;
 		handles.reserve(count + 1);
 		for (int i = 0; i < count; i++)
@@ -79,7 +102,11 @@ namespace uicore
 
 		int event_index = result - WAIT_OBJECT_0;
 		if (event_index < count)
+		{
 			events[event_index]->socket_handle()->reset_wait_handle();
+			if (ready_events)
+				ready_events->push_back(events[event_index]);
+		}
 		else
 			ResetEvent(impl->notify_handle);
 
@@ -91,6 +118,263 @@ namespace uicore
 		SetEvent(impl->notify_handle);
 	}
 
+	void NetworkConditionVariable::add(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		if (std::find(impl->added.begin(), impl->added.end(), event) == impl->added.end())
+			impl->added.push_back(event);
+	}
+
+	void NetworkConditionVariable::remove(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->added.erase(std::remove(impl->added.begin(), impl->added.end(), event), impl->added.end());
+	}
+
+#elif defined(__linux__)
+
+	/// \brief Edge-triggered epoll set that sockets stay registered with between waits
+	///
+	/// Events carry a pointer to the SocketPollState of the socket. The set holds a reference to every state it has been given,
+	/// so an event for a socket destroyed during the wait still points at valid memory.
+	class NetworkConditionVariableImpl
+	{
+	public:
+		NetworkConditionVariableImpl() : poll_id(++last_poll_id)
+		{
+			epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+			if (epoll_handle == -1)
+				throw Exception("Unable to create epoll handle");
+
+			notify_handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (notify_handle == -1)
+			{
+				::close(epoll_handle);
+				throw Exception("Unable to create eventfd handle");
+			}
+
+			epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.ptr = nullptr;
+			if (epoll_ctl(epoll_handle, EPOLL_CTL_ADD, notify_handle, &event) == -1)
+			{
+				::close(notify_handle);
+				::close(epoll_handle);
+				throw Exception("Unable to add eventfd handle to epoll set");
+			}
+		}
+
+		~NetworkConditionVariableImpl()
+		{
+			// Sockets closed later must not remove themselves from a closed (or reused) epoll handle
+			for (const auto &state : states)
+			{
+				int handle = epoll_handle;
+				state->epoll_handle.compare_exchange_strong(handle, -1);
+			}
+
+			::close(notify_handle);
+			::close(epoll_handle);
+		}
+
+		void add(SocketHandle *socket)
+		{
+			SocketPollState *state = socket->poll_state.get();
+			if (state->poll_id == poll_id || socket->handle == -1)
+				return;
+
+			epoll_event event = {};
+			event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+			if (socket->poll_write)
+				event.events |= EPOLLOUT;
+			event.data.ptr = state;
+			if (epoll_ctl(epoll_handle, EPOLL_CTL_ADD, socket->handle, &event) == -1 && errno != EEXIST)
+				throw Exception("Unable to add socket to epoll set");
+
+			state->poll_id = poll_id;
+			state->epoll_handle = epoll_handle;
+
+			// Release the states of destroyed sockets, but only while no thread can be holding an event for one
+			if (states.size() >= prune_size && waiting_threads == 0)
+			{
+				states.erase(std::remove_if(states.begin(), states.end(), [](const std::shared_ptr<SocketPollState> &s) { return s.use_count() == 1; }), states.end());
+				prune_size = std::max(states.size() * 2, (size_t)64);
+			}
+			states.push_back(socket->poll_state);
+		}
+
+		void reset_notify()
+		{
+			uint64_t value;
+			while (read(notify_handle, &value, sizeof(uint64_t)) == sizeof(uint64_t));
+		}
+
+		void set_notify()
+		{
+			uint64_t value = 1;
+			::write(notify_handle, &value, sizeof(uint64_t));
+		}
+
+		int epoll_handle = -1;
+		int notify_handle = -1;
+		uint64_t poll_id;
+
+		std::mutex mutex;
+		std::vector<std::shared_ptr<SocketPollState>> states;
+		std::vector<std::shared_ptr<SocketPollState>> pending_reads;
+		size_t prune_size = 64;
+		int waiting_threads = 0;
+		uint64_t wait_serial = 0;
+
+		static std::atomic<uint64_t> last_poll_id;
+	};
+
+	std::atomic<uint64_t> NetworkConditionVariableImpl::last_poll_id(0);
+
+	NetworkConditionVariable::NetworkConditionVariable() : impl(std::make_shared<NetworkConditionVariableImpl>())
+	{
+	}
+
+	bool NetworkConditionVariable::wait_impl(int count, NetworkEvent **events, int timeout_ms, std::vector<NetworkEvent *> *ready_events)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+
+		// States are only reported if they belong to an event passed to this wait or an added event, as those are known to be alive
+		uint64_t wait_serial = ++impl->wait_serial;
+		auto report = [&](SocketPollState *state)
+		{
+			NetworkEvent *event = state->wait_serial == wait_serial ? state->event : state->added_event;
+			if (ready_events && event && state->reported_serial != wait_serial)
+			{
+				state->reported_serial = wait_serial;
+				ready_events->push_back(event);
+			}
+		};
+
+		// Edge-triggered events only report changes, so a socket that was not read until empty is still ready.
+		// Added events that were readable are remembered in pending_reads, so they are found without visiting the idle ones.
+		bool ready = false;
+		auto &pending_reads = impl->pending_reads;
+		pending_reads.erase(std::remove_if(pending_reads.begin(), pending_reads.end(), [&](const std::shared_ptr<SocketPollState> &state)
+		{
+			state->pending_read = state->added_event && state->can_read;
+			if (state->pending_read)
+			{
+				ready = true;
+				report(state.get());
+			}
+			return !state->pending_read;
+		}), pending_reads.end());
+
+		for (int i = 0; i < count; i++)
+		{
+			SocketHandle *socket = events[i]->socket_handle();
+			SocketPollState *state = socket->poll_state.get();
+			impl->add(socket);
+			state->event = events[i];
+			state->wait_serial = wait_serial;
+			if (state->can_read)
+			{
+				ready = true;
+				report(state);
+			}
+		}
+		if (ready)
+			return true;
+
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+		while (true)
+		{
+			int wait_time = -1;
+			if (timeout_ms >= 0)
+			{
+				auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+				wait_time = (int)std::max(remaining, (decltype(remaining))0);
+			}
+
+			impl->waiting_threads++;
+			lock.unlock();
+			epoll_event ready_events[64];
+			int result = epoll_wait(impl->epoll_handle, ready_events, 64, wait_time);
+			int wait_error = errno;
+			lock.lock();
+			impl->waiting_threads--;
+
+			if (result == -1)
+			{
+				if (wait_error == EINTR)
+					continue;
+				throw Exception("epoll_wait failed");
+			}
+
+			bool woken = false;
+			for (int i = 0; i < result; i++)
+			{
+				SocketPollState *state = static_cast<SocketPollState*>(ready_events[i].data.ptr);
+				uint32_t flags = ready_events[i].events;
+				if (!state)
+				{
+					impl->reset_notify();
+					woken = true;
+					continue;
+				}
+
+				bool changed = false;
+				if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+				{
+					state->can_read = true;
+					changed = true;
+					if (state->added_event && !state->pending_read)
+					{
+						state->pending_read = true;
+						pending_reads.push_back(state->shared_from_this());
+					}
+				}
+
+				// Like select, only a socket that was full wakes up the waiting thread when it becomes writable
+				if ((flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && !state->can_write.exchange(true))
+					changed = true;
+
+				if (changed)
+				{
+					woken = true;
+					report(state);
+				}
+			}
+
+			if (woken)
+				return true;
+			if (result == 0 || (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline))
+				return false;
+		}
+	}
+
+	void NetworkConditionVariable::notify()
+	{
+		impl->set_notify();
+	}
+
+	void NetworkConditionVariable::add(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		SocketHandle *socket = event->socket_handle();
+		impl->add(socket);
+		socket->poll_state->added_event = event;
+
+		// A socket that already has data will not get another edge until more data arrives
+		if (!socket->poll_state->pending_read)
+		{
+			socket->poll_state->pending_read = true;
+			impl->pending_reads.push_back(socket->poll_state);
+		}
+	}
+
+	void NetworkConditionVariable::remove(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		event->socket_handle()->poll_state->added_event = nullptr;
+	}
+
 #else
 
 	class NetworkConditionVariableImpl
@@ -129,14 +413,29 @@ namespace uicore
 		}
 
 		int notify_handle[2];
+
+		std::mutex mutex;
+		std::vector<NetworkEvent *> added;
 	};
 
 	NetworkConditionVariable::NetworkConditionVariable() : impl(std::make_shared<NetworkConditionVariableImpl>())
 	{
 	}
 
-	bool NetworkConditionVariable::wait_impl(int count, NetworkEvent **events, int timeout_ms)
+	bool NetworkConditionVariable::wait_impl(int count, NetworkEvent **events, int timeout_ms, std::vector<NetworkEvent *> *ready_events)
 	{
+		std::vector<NetworkEvent *> all_events;
+		{
+			std::unique_lock<std::mutex> lock(impl->mutex);
+			if (!impl->added.empty())
+			{
+				all_events = impl->added;
+				all_events.insert(all_events.end(), events, events + count);
+				count = (int)all_events.size();
+				events = all_events.data();
+			}
+		}
+
 		int max_fd = impl->notify_handle[0];
 
 		fd_set rfds, wfds;
@@ -159,7 +458,8 @@ namespace uicore
 
 		for (int i = 0; i < count; i++)
 		{
-			events[i]->socket_handle()->end_wait(rfds, wfds);
+			if (events[i]->socket_handle()->end_wait(rfds, wfds) && ready_events)
+				ready_events->push_back(events[i]);
 		}
 
 		impl->reset_notify();
@@ -172,5 +472,18 @@ namespace uicore
 		impl->set_notify();
 	}
 
+	void NetworkConditionVariable::add(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		if (std::find(impl->added.begin(), impl->added.end(), event) == impl->added.end())
+			impl->added.push_back(event);
+	}
+
+	void NetworkConditionVariable::remove(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(impl->mutex);
+		impl->added.erase(std::remove(impl->added.begin(), impl->added.end(), event), impl->added.end());
+	}
+
 #endif
 }
@@ -0,0 +1,222 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#include "UICore/precomp.h"
+#include "network_reactor_impl.h"
+#include "UICore/Core/System/exception.h"
+#include "UICore/Core/System/singleton_bugfix.h"
+#include <future>
+
+namespace uicore
+{
+	NetworkReactorImpl::NetworkReactorImpl() : queue(std::make_shared<NetworkReactorQueue>())
+	{
+		// The thread sets its id before anything can run on it, so is_reactor_thread is correct for the first callback
+		std::promise<void> started;
+		std::future<void> started_future = started.get_future();
+		std::shared_ptr<NetworkReactorQueue> thread_queue = queue;
+		thread = std::thread([thread_queue, &started]()
+		{
+			thread_queue->thread_id = std::this_thread::get_id();
+			started.set_value();
+			worker_main(thread_queue);
+		});
+		started_future.wait();
+	}
+
+	NetworkReactorImpl::~NetworkReactorImpl()
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		queue->stop_flag = true;
+		lock.unlock();
+		queue->condition.notify();
+
+		if (is_reactor_thread())
+			thread.detach();
+		else
+			thread.join();
+	}
+
+	bool NetworkReactorImpl::is_reactor_thread() const
+	{
+		return std::this_thread::get_id() == queue->thread_id;
+	}
+
+	void NetworkReactorImpl::post(std::function<void()> func)
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		queue->posted.push_back(std::move(func));
+		lock.unlock();
+
+		if (!is_reactor_thread())
+			queue->condition.notify();
+	}
+
+	void NetworkReactorImpl::add(NetworkEvent *event, const std::weak_ptr<NetworkReactorHandler> &handler)
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		queue->handlers[event] = handler;
+
+		// The event is added to the wait once the handler has something queued
+		auto locked_handler = handler.lock();
+		if (locked_handler)
+		{
+			locked_handler->event = event;
+			locked_handler->event_added = false;
+		}
+	}
+
+	void NetworkReactorImpl::remove(NetworkEvent *event)
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		queue->handlers.erase(event);
+		queue->condition.remove(event);
+	}
+
+	void NetworkReactorImpl::schedule(const std::shared_ptr<NetworkReactorHandler> &handler)
+	{
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		if (handler->scheduled)
+			return;
+		handler->scheduled = true;
+		queue->scheduled.push_back(handler);
+		lock.unlock();
+
+		if (!is_reactor_thread())
+			queue->condition.notify();
+	}
+
+	void NetworkReactorImpl::worker_main(std::shared_ptr<NetworkReactorQueue> queue)
+	{
+		std::vector<std::function<void()>> current_posted;
+		std::vector<std::shared_ptr<NetworkReactorHandler>> current_scheduled;
+		std::vector<std::shared_ptr<NetworkReactorHandler>> current_ready;
+		std::vector<NetworkEvent *> ready_events;
+		std::vector<std::pair<std::shared_ptr<NetworkReactorHandler>, bool>> wanted_events;
+
+		// Work queued by callbacks is processed for a few rounds before polling again, as most of it does not need a new network event
+		const int max_rounds_without_poll = 16;
+		int rounds_without_poll = 0;
+
+		std::unique_lock<std::mutex> lock(queue->mutex);
+		while (!queue->stop_flag)
+		{
+			current_posted.swap(queue->posted);
+			current_scheduled.swap(queue->scheduled);
+			for (auto &handler : current_scheduled)
+				handler->scheduled = false;
+
+			bool has_work = !current_posted.empty() || !current_scheduled.empty();
+			if (!has_work || ++rounds_without_poll == max_rounds_without_poll)
+			{
+				rounds_without_poll = 0;
+				queue->condition.wait(lock, ready_events, has_work ? 0 : -1);
+				for (NetworkEvent *event : ready_events)
+				{
+					auto it = queue->handlers.find(event);
+					if (it != queue->handlers.end())
+					{
+						auto handler = it->second.lock();
+						if (handler)
+							current_ready.push_back(handler);
+					}
+				}
+			}
+			lock.unlock();
+
+			for (auto &func : current_posted)
+				func();
+			for (auto &handler : current_ready)
+				handler->process(true);
+			for (auto &handler : current_scheduled)
+				handler->process(false);
+
+			for (auto &handler : current_ready)
+				wanted_events.push_back({ handler, handler->wants_event() });
+			for (auto &handler : current_scheduled)
+				wanted_events.push_back({ handler, handler->wants_event() });
+
+			// An operation queued after wants_event returned also schedules the handler, which checks again in the next round
+			lock.lock();
+			for (auto &wanted : wanted_events)
+				update_event(queue.get(), wanted.first, wanted.second);
+			lock.unlock();
+			wanted_events.clear();
+
+			// Released before locking again, as destroying a handler removes it from the reactor
+			current_posted.clear();
+			current_scheduled.clear();
+			current_ready.clear();
+
+			lock.lock();
+		}
+	}
+
+	void NetworkReactorImpl::update_event(NetworkReactorQueue *queue, const std::shared_ptr<NetworkReactorHandler> &handler, bool wants_event)
+	{
+		if (!handler->event || wants_event == handler->event_added)
+			return;
+
+		// Handlers removed during process keep their event pointer, but must not be added again
+		auto it = queue->handlers.find(handler->event);
+		if (it == queue->handlers.end() || it->second.owner_before(handler) || handler.owner_before(it->second))
+			return;
+
+		if (wants_event)
+			queue->condition.add(handler->event);
+		else
+			queue->condition.remove(handler->event);
+		handler->event_added = wants_event;
+	}
+
+	std::shared_ptr<NetworkReactorImpl> NetworkReactorImpl::get(std::shared_ptr<NetworkReactor> reactor)
+	{
+		if (!reactor)
+			reactor = NetworkReactor::shared();
+		return std::static_pointer_cast<NetworkReactorImpl>(reactor);
+	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	class NetworkReactorShared
+	{
+	public:
+		std::shared_ptr<NetworkReactor> reactor = NetworkReactor::create();
+	};
+
+	std::shared_ptr<NetworkReactor> NetworkReactor::create()
+	{
+		return std::make_shared<NetworkReactorImpl>();
+	}
+
+	const std::shared_ptr<NetworkReactor> &NetworkReactor::shared()
+	{
+		static Singleton<NetworkReactorShared> shared_reactor;
+		return shared_reactor->reactor;
+	}
+}
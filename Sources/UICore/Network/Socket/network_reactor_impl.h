@@ -0,0 +1,105 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    agent
+*/
+
+#pragma once
+
+#include "UICore/Network/Socket/network_reactor.h"
+#include "UICore/Network/Socket/network_condition_variable.h"
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+namespace uicore
+{
+	/// \brief Object serviced by a NetworkReactor
+	class NetworkReactorHandler
+	{
+	public:
+		virtual ~NetworkReactorHandler() { }
+
+		/// \brief Called on the reactor thread when the event of the handler is ready, or after schedule
+		virtual void process(bool event_ready) = 0;
+
+		/// \brief Returns true if queued operations are waiting for the event. Called on the reactor thread after process.
+		virtual bool wants_event() = 0;
+
+	private:
+		bool scheduled = false;
+
+		// Event of the handler, and whether it is included in the wait. Only accessed with the queue mutex locked.
+		NetworkEvent *event = nullptr;
+		bool event_added = false;
+		friend class NetworkReactorImpl;
+	};
+
+	/// \brief State shared by a NetworkReactorImpl and its thread
+	class NetworkReactorQueue
+	{
+	public:
+		std::mutex mutex;
+		NetworkConditionVariable condition;
+
+		/// \brief Set by the thread before the reactor constructor returns
+		std::thread::id thread_id;
+		bool stop_flag = false;
+		std::vector<std::function<void()>> posted;
+		std::vector<std::shared_ptr<NetworkReactorHandler>> scheduled;
+		std::unordered_map<NetworkEvent *, std::weak_ptr<NetworkReactorHandler>> handlers;
+	};
+
+	class NetworkReactorImpl : public NetworkReactor
+	{
+	public:
+		NetworkReactorImpl();
+		~NetworkReactorImpl();
+
+		bool is_reactor_thread() const override;
+		void post(std::function<void()> func) override;
+
+		/// \brief Calls process on the handler whenever the event is ready and it wants the event, until remove is called
+		///
+		/// The event is only waited for while wants_event returns true, so a readable socket nobody reads from does not keep waking the thread.
+		/// Handlers must call schedule after queuing an operation for the reactor to check again.
+		void add(NetworkEvent *event, const std::weak_ptr<NetworkReactorHandler> &handler);
+		void remove(NetworkEvent *event);
+
+		/// \brief Calls process on the handler once, even if its event is not ready
+		void schedule(const std::shared_ptr<NetworkReactorHandler> &handler);
+
+		static std::shared_ptr<NetworkReactorImpl> get(std::shared_ptr<NetworkReactor> reactor);
+
+	private:
+		static void worker_main(std::shared_ptr<NetworkReactorQueue> queue);
+		static void update_event(NetworkReactorQueue *queue, const std::shared_ptr<NetworkReactorHandler> &handler, bool wants_event);
+
+		// The thread keeps the queue alive, so the reactor can be destroyed by a callback running on it
+		std::shared_ptr<NetworkReactorQueue> queue;
+		std::thread thread;
+	};
+}
@@ -4,6 +4,8 @@
 #include "UICore/Network/Socket/socket_name.h"
 #include "tcp_socket.h"
 #include "UICore/Core/System/exception.h"
+#include <algorithm>
+#include <vector>
 
 namespace uicore
 {
@@ -64,6 +66,27 @@ namespace uicore
 		return result;
 	}
 
+	int TCPConnectionImpl::write(const SocketBuffer *buffers, int count)
+	{
+		std::vector<WSABUF> wsa_buffers(count);
+		for (int i = 0; i < count; i++)
+		{
+			wsa_buffers[i].buf = static_cast<char *>(const_cast<void *>(buffers[i].data));
+			wsa_buffers[i].len = buffers[i].size;
+		}
+
+		DWORD bytes_sent = 0;
+		int result = WSASend(handle, wsa_buffers.data(), count, &bytes_sent, 0, nullptr, nullptr);
+		if (result == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+				return -1;
+			else
+				throw Exception("Error writing to server");
+		}
+		return bytes_sent;
+	}
+
 	int TCPConnectionImpl::read(void *data, int size)
 	{
 		int result = ::recv(handle, static_cast<char *>(data), size, 0);
@@ -146,24 +169,61 @@ namespace uicore
 
 	int TCPConnectionImpl::write(const void *data, int size)
 	{
+		// Cleared before the call so that a writable edge seen by a waiting thread meanwhile is kept
+		poll_state->can_write = false;
+
 		int result = ::send(handle, static_cast<const char *>(data), size, 0);
 		if (result == -1)
 		{
 			if (errno == EWOULDBLOCK)
-			{
-				can_write = false;
 				return -1;
-			}
 			else
-			{
 				throw Exception("Error writing to server");
-			}
 		}
+
+		// A partial write means the send buffer is full
+		if (result == size)
+			poll_state->can_write = true;
+		return result;
+	}
+
+	int TCPConnectionImpl::write(const SocketBuffer *buffers, int count)
+	{
+		iovec vectors[64];
+		count = std::min(count, 64);
+
+		int size = 0;
+		for (int i = 0; i < count; i++)
+		{
+			vectors[i].iov_base = const_cast<void *>(buffers[i].data);
+			vectors[i].iov_len = buffers[i].size;
+			size += buffers[i].size;
+		}
+
+		msghdr message = {};
+		message.msg_iov = vectors;
+		message.msg_iovlen = count;
+
+		poll_state->can_write = false;
+
+		int result = ::sendmsg(handle, &message, 0);
+		if (result == -1)
+		{
+			if (errno == EWOULDBLOCK)
+				return -1;
+			else
+				throw Exception("Error writing to server");
+		}
+
+		if (result == size)
+			poll_state->can_write = true;
 		return result;
 	}
 
 	int TCPConnectionImpl::read(void *data, int size)
 	{
+		poll_state->can_read = false;
+
 		int result = ::recv(handle, static_cast<char *>(data), size, 0);
 		if (result == -1)
 		{
@@ -172,6 +232,10 @@ namespace uicore
 			else
 				throw Exception("Error reading from server");
 		}
+
+		// A short read emptied the receive buffer. Data arriving later raises a new readable edge.
+		if (result == size || result == 0)
+			poll_state->can_read = true;
 		return result;
 	}
 
@@ -117,6 +117,8 @@ namespace uicore
 		sockaddr_in peer_address = { 0 };
 		socklen_t peer_address_length = sizeof(sockaddr_in);
 
+		poll_state->can_read = false;
+
 		int result = ::accept(handle, reinterpret_cast<sockaddr*>(&peer_address), &peer_address_length);
 		if (result == -1)
 		{
@@ -126,6 +128,9 @@ namespace uicore
 				throw Exception("Error accepting from socket");
 		}
 
+		// More connections may be waiting in the backlog
+		poll_state->can_read = true;
+
 		out_end_point.from_sockaddr(AF_INET, reinterpret_cast<sockaddr*>(&peer_address), peer_address_length);
 		return std::make_shared<TCPConnectionImpl>(result);
 	}
@@ -15,6 +15,14 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <errno.h>
+#include <poll.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#endif
+
+#if defined(__linux__)
+#include <sys/epoll.h>
 #endif
 
 #if defined(__APPLE__)
@@ -23,6 +31,12 @@
 
 namespace uicore
 {
+	/// \brief Buffer passed to a gather write
+	struct SocketBuffer
+	{
+		const void *data;
+		int size;
+	};
 
 #if defined(WIN32)
 
@@ -99,39 +113,48 @@ namespace uicore
 		int write(const void *data, int size) override;
 		int read(void *data, int size) override;
 		SocketHandle *socket_handle() override { return this; }
+
+		/// \brief Writes several buffers with one call
+		/// \return Bytes written, or -1 if buffer is full
+		int write(const SocketBuffer *buffers, int count);
 	};
 
 #else
 
-	class SocketHandle
+	/// \brief Readiness of a socket as last seen by a NetworkConditionVariable
+	///
+	/// The state is shared with the condition variables the socket is registered with, so it stays valid while they hold on to it.
+	class SocketPollState : public std::enable_shared_from_this<SocketPollState>
 	{
 	public:
-		virtual void begin_wait(fd_set &rfds, fd_set &wfds, int &max_fd) = 0;
-		virtual void end_wait(fd_set &rfds, fd_set &wfds) = 0;
+		/// \brief Set when the socket becomes readable and cleared when a read finds it empty
+		std::atomic<bool> can_read{ false };
+
+		/// \brief Set when the socket becomes writable and cleared when a write finds the buffer full
+		std::atomic<bool> can_write{ false };
+
+		/// \brief Identifies the epoll set the socket was last registered with
+		std::atomic<uint64_t> poll_id{ 0 };
+		std::atomic<int> epoll_handle{ -1 };
+
+		/// \brief Event passed to the wait identified by wait_serial. Only accessed by the waiting NetworkConditionVariable.
+		NetworkEvent *event = nullptr;
+		uint64_t wait_serial = 0;
+		uint64_t reported_serial = 0;
+
+		/// \brief Event added to the NetworkConditionVariable, and whether the state is in its list of readable sockets
+		NetworkEvent *added_event = nullptr;
+		bool pending_read = false;
 	};
 
-	class TCPSocket : public SocketHandle
+	class SocketHandle
 	{
 	public:
-		TCPSocket()
-			: handle(-1), can_write(false)
+		SocketHandle(int handle = -1, bool poll_write = true) : handle(handle), poll_write(poll_write), poll_state(std::make_shared<SocketPollState>())
 		{
-			handle = socket(AF_INET, SOCK_STREAM, 0);
-			if (handle == -1)
-				throw Exception("Unable to create socket handle");
-
-#if defined(SO_NOSIGPIPE)
-			int value = 1;
-			setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, (const char *) &value, sizeof(int));
-#endif
 		}
 
-		TCPSocket(int handle)
-			: handle(handle)
-		{
-		}
-
-		~TCPSocket()
+		virtual ~SocketHandle()
 		{
 			close();
 		}
@@ -140,29 +163,90 @@ namespace uicore
 		{
 			if (handle != -1)
 			{
+#if defined(__linux__)
+				// The registration outlives the handle if a child process inherited the socket
+				int epoll_handle = poll_state->epoll_handle;
+				if (epoll_handle != -1)
+					epoll_ctl(epoll_handle, EPOLL_CTL_DEL, handle, nullptr);
+#endif
 				::close(handle);
 				handle = -1;
 			}
 		}
 
-		void begin_wait(fd_set &rfds, fd_set &wfds, int &max_fd) override
+		void begin_wait(fd_set &rfds, fd_set &wfds, int &max_fd)
 		{
+			if (handle >= FD_SETSIZE)
+				throw Exception("Socket handle too large for select");
+
 			FD_SET(handle, &rfds);
-			if (!can_write)
+			if (poll_write && !poll_state->can_write)
 				FD_SET(handle, &wfds);
 			max_fd = std::max(max_fd, handle);
 		}
 
-		void end_wait(fd_set &rfds, fd_set &wfds) override
+		bool end_wait(fd_set &rfds, fd_set &wfds)
 		{
-			if (FD_ISSET(handle, &wfds))
-			{
-				can_write = true;
-			}
+			bool readable = FD_ISSET(handle, &rfds) != 0;
+			if (readable)
+				poll_state->can_read = true;
+
+			bool writable = poll_write && FD_ISSET(handle, &wfds);
+			if (writable)
+				poll_state->can_write = true;
+
+			return readable || writable;
+		}
+
+		void begin_poll(pollfd &fd)
+		{
+			fd.fd = handle;
+			fd.events = POLLIN;
+			if (poll_write && !poll_state->can_write)
+				fd.events |= POLLOUT;
+			fd.revents = 0;
+		}
+
+		bool end_poll(const pollfd &fd)
+		{
+			bool readable = (fd.revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+			if (readable)
+				poll_state->can_read = true;
+
+			bool writable = poll_write && (fd.revents & (POLLOUT | POLLHUP | POLLERR)) != 0;
+			if (writable)
+				poll_state->can_write = true;
+
+			return readable || writable;
 		}
 
 		int handle;
-		bool can_write;
+
+		/// \brief Wake up waiting threads when the socket becomes writable
+		bool poll_write;
+
+		std::shared_ptr<SocketPollState> poll_state;
+	};
+
+	class TCPSocket : public SocketHandle
+	{
+	public:
+		TCPSocket()
+		{
+			handle = socket(AF_INET, SOCK_STREAM, 0);
+			if (handle == -1)
+				throw Exception("Unable to create socket handle");
+
+#if defined(SO_NOSIGPIPE)
+			int value = 1;
+			setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, (const char *) &value, sizeof(int));
+#endif
+		}
+
+		TCPSocket(int handle)
+			: SocketHandle(handle)
+		{
+		}
 	};
 
 	class TCPConnectionImpl : public TCPConnection, TCPSocket
@@ -177,6 +261,10 @@ namespace uicore
 		int write(const void *data, int size) override;
 		int read(void *data, int size) override;
 		SocketHandle *socket_handle() override { return this; }
+
+		/// \brief Writes several buffers with one call
+		/// \return Bytes written, or -1 if buffer is full
+		int write(const SocketBuffer *buffers, int count);
 	};
 
 #endif
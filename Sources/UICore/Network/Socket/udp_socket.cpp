@@ -16,12 +16,120 @@
 #include <netinet/tcp.h>
 #include <errno.h>
 #endif
+#if defined(__linux__)
+#include <netinet/udp.h>
+#endif
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 #if defined(__APPLE__)
 #define SOL_TCP IPPROTO_TCP
 #endif
 
 namespace uicore
 {
+	class UDPDatagramBatchImpl : public UDPDatagramBatch
+	{
+	public:
+		UDPDatagramBatchImpl(int capacity, int max_datagram_size) : _capacity(capacity), _max_datagram_size(max_datagram_size)
+		{
+			if (capacity <= 0 || max_datagram_size <= 0)
+				throw Exception("Invalid UDP datagram batch size");
+
+			storage.resize((size_t)capacity * max_datagram_size);
+			sizes.resize(capacity);
+			addresses.resize(capacity);
+			has_address.resize(capacity);
+#if defined(__linux__)
+			messages.resize(capacity);
+			vectors.resize(capacity);
+#endif
+		}
+
+		int capacity() const override { return _capacity; }
+		int max_datagram_size() const override { return _max_datagram_size; }
+		int count() const override { return _count; }
+		void clear() override { _count = 0; }
+
+		bool add(const void *data, int size) override
+		{
+			if (_count == _capacity || size < 0 || size > _max_datagram_size)
+				return false;
+
+			memcpy(slot(_count), data, size);
+			sizes[_count] = size;
+			has_address[_count] = false;
+			_count++;
+			return true;
+		}
+
+		bool add(const void *data, int size, const SocketName &endpoint) override
+		{
+			if (!add(data, size))
+				return false;
+
+			// Converting a SocketName involves parsing strings, so consecutive datagrams to the same end point reuse the last address
+			if (!has_last_endpoint || last_endpoint.address() != endpoint.address() || last_endpoint.port() != endpoint.port())
+			{
+				endpoint.to_sockaddr(AF_INET, (sockaddr *)&last_address, sizeof(sockaddr_in));
+				last_endpoint = endpoint;
+				has_last_endpoint = true;
+			}
+			addresses[_count - 1] = last_address;
+			has_address[_count - 1] = true;
+			return true;
+		}
+
+		const void *data(int index) const override { return storage.data() + (size_t)index * _max_datagram_size; }
+		int size(int index) const override { return sizes[index]; }
+
+		SocketName endpoint(int index) const override
+		{
+			SocketName name;
+			if (has_address[index])
+			{
+				sockaddr_in address = addresses[index];
+				name.from_sockaddr(AF_INET, (sockaddr *)&address, sizeof(sockaddr_in));
+			}
+			return name;
+		}
+
+		unsigned char *slot(int index) { return storage.data() + (size_t)index * _max_datagram_size; }
+
+		int _capacity;
+		int _max_datagram_size;
+		int _count = 0;
+		std::vector<unsigned char> storage;
+		std::vector<int> sizes;
+		std::vector<sockaddr_in> addresses;
+		std::vector<char> has_address;
+
+		SocketName last_endpoint;
+		sockaddr_in last_address;
+		bool has_last_endpoint = false;
+
+#if defined(__linux__)
+		// Scratch space for the system calls, so a batch can be sent repeatedly without allocating
+		mutable std::vector<mmsghdr> messages;
+		mutable std::vector<iovec> vectors;
+#endif
+	};
+
+	std::shared_ptr<UDPDatagramBatch> UDPDatagramBatch::create(int capacity, int max_datagram_size)
+	{
+		return std::make_shared<UDPDatagramBatchImpl>(capacity, max_datagram_size);
+	}
+
+	static sockaddr_in to_sockaddr_in(const SocketName &endpoint)
+	{
+		sockaddr_in addr;
+		endpoint.to_sockaddr(AF_INET, (sockaddr *)&addr, sizeof(sockaddr_in));
+		return addr;
+	}
 
 #if defined(WIN32)
 
@@ -51,7 +159,13 @@ namespace uicore
 		void bind(const SocketName &endpoint) override;
 		void send(const void *data, int size, const SocketName &endpoint) override;
 		int read(void *data, int size, SocketName &endpoint) override;
+		int send(const UDPDatagramBatch &batch, int start) override;
+		int send(const UDPDatagramBatch &batch, const SocketName &endpoint, int start) override;
+		int read(UDPDatagramBatch &batch) override;
 		void close() override { SocketHandle::close(); }
+
+	private:
+		bool send_datagram(const void *data, int size, const sockaddr_in &addr);
 	};
 
 	std::shared_ptr<UDPSocket> UDPSocket::create()
@@ -110,12 +224,79 @@ namespace uicore
 		return result;
 	}
 
+
+	bool UDPSocketImpl::send_datagram(const void *data, int size, const sockaddr_in &addr)
+	{
+		int result = sendto(handle, static_cast<const char*>(data), size, 0, (const sockaddr *)&addr, sizeof(sockaddr_in));
+		if (result == SOCKET_ERROR)
+		{
+			int last_error = WSAGetLastError();
+			if (last_error == WSAEWOULDBLOCK || last_error == WSAENOBUFS)
+				return false;
+			throw Exception("Error writing to udp socket");
+		}
+		return true;
+	}
+
+	int UDPSocketImpl::send(const UDPDatagramBatch &batch, int start)
+	{
+		auto &impl = static_cast<const UDPDatagramBatchImpl &>(batch);
+		int sent = start;
+		for (; sent < impl.count(); sent++)
+		{
+			if (!impl.has_address[sent])
+				throw Exception("No end point specified for UDP datagram");
+			if (!send_datagram(impl.data(sent), impl.size(sent), impl.addresses[sent]))
+				break;
+		}
+		return sent - start;
+	}
+
+	int UDPSocketImpl::send(const UDPDatagramBatch &batch, const SocketName &endpoint, int start)
+	{
+		sockaddr_in addr = to_sockaddr_in(endpoint);
+		int sent = start;
+		for (; sent < batch.count(); sent++)
+		{
+			if (!send_datagram(batch.data(sent), batch.size(sent), addr))
+				break;
+		}
+		return sent - start;
+	}
+
+	int UDPSocketImpl::read(UDPDatagramBatch &batch)
+	{
+		auto &impl = static_cast<UDPDatagramBatchImpl &>(batch);
+		impl.clear();
+		while (impl._count < impl._capacity)
+		{
+			int index = impl._count;
+			int addr_len = sizeof(sockaddr_in);
+			int result = recvfrom(handle, reinterpret_cast<char*>(impl.slot(index)), impl._max_datagram_size, 0, (sockaddr *)&impl.addresses[index], &addr_len);
+			if (result == SOCKET_ERROR)
+			{
+				int last_error = WSAGetLastError();
+				if (last_error == WSAEMSGSIZE)
+					result = impl._max_datagram_size;
+				else if (last_error == WSAEWOULDBLOCK || last_error == WSAECONNRESET || last_error == WSAENETRESET)
+					break;
+				else
+					throw Exception("Error reading from udp socket");
+			}
+
+			impl.sizes[index] = result;
+			impl.has_address[index] = true;
+			impl._count++;
+		}
+		return impl._count;
+	}
+
 #else
 
 	class UDPSocketImpl : public UDPSocket, SocketHandle
 	{
 	public:
-		UDPSocketImpl()
+		UDPSocketImpl() : SocketHandle(-1, false)
 		{
 			SetupNetwork::start();
 
@@ -127,41 +308,32 @@ namespace uicore
 			ioctl(handle, FIONBIO, &nonblocking);
 		}
 
-		UDPSocketImpl(int handle) : handle(handle)
+		UDPSocketImpl(int handle) : SocketHandle(handle, false)
 		{
 		}
 
-		~UDPSocketImpl()
-		{
-			close();
-		}
-
 		SocketHandle *socket_handle() override { return this; }
 
 		void bind(const SocketName &endpoint) override;
 		void send(const void *data, int size, const SocketName &endpoint) override;
 		int read(void *data, int size, SocketName &endpoint) override;
+		int send(const UDPDatagramBatch &batch, int start) override;
+		int send(const UDPDatagramBatch &batch, const SocketName &endpoint, int start) override;
+		int read(UDPDatagramBatch &batch) override;
 
-		void close() override
-		{
-			if (handle != -1)
-			{
-				::close(handle);
-				handle = -1;
-			}
-		}
+		void close() override { SocketHandle::close(); }
 
-		void begin_wait(fd_set &rfds, fd_set &wfds, int &max_fd) override
-		{
-			FD_SET(handle, &rfds);
-			max_fd = std::max(max_fd, handle);
-		}
+	private:
+		int send_messages(const UDPDatagramBatchImpl &batch, int start, const sockaddr_in *addr);
+#if defined(__linux__)
+		int send_segmented(const UDPDatagramBatchImpl &batch, int start, const sockaddr_in &addr);
 
-		void end_wait(fd_set &rfds, fd_set &wfds) override
-		{
-		}
+		/// \brief Cleared when the kernel rejects UDP_SEGMENT
+		bool segmentation_offload = true;
 
-		int handle = -1;
+		/// \brief Set once a segmented send succeeded, after which EINVAL and EIO point at the datagrams instead
+		bool segmentation_offload_confirmed = false;
+#endif
 	};
 
 	std::shared_ptr<UDPSocket> UDPSocket::create()
@@ -191,11 +363,15 @@ namespace uicore
 		sockaddr_in addr;
 		socklen_t addr_len = sizeof(sockaddr_in);
 
+		poll_state->can_read = false;
+
 		int result = recvfrom(handle, static_cast<char*>(data), size, 0, (sockaddr *)&addr, &addr_len);
 		if (result == -1)
 		{
 			if (errno == EWOULDBLOCK || errno == EMSGSIZE || errno == ECONNRESET || errno == ENETRESET)
 			{
+				if (errno != EWOULDBLOCK)
+					poll_state->can_read = true;
 				endpoint = SocketName();
 				return -1;
 			}
@@ -205,9 +381,218 @@ namespace uicore
 			}
 		}
 
+		// More datagrams may be queued
+		poll_state->can_read = true;
+
 		endpoint.from_sockaddr(AF_INET, (sockaddr *)&addr, addr_len);
 		return result;
 	}
 
+	int UDPSocketImpl::send(const UDPDatagramBatch &batch, int start)
+	{
+		return send_messages(static_cast<const UDPDatagramBatchImpl &>(batch), start, nullptr);
+	}
+
+	int UDPSocketImpl::send(const UDPDatagramBatch &batch, const SocketName &endpoint, int start)
+	{
+		auto &impl = static_cast<const UDPDatagramBatchImpl &>(batch);
+		sockaddr_in addr = to_sockaddr_in(endpoint);
+#if defined(__linux__)
+		if (segmentation_offload)
+			return send_segmented(impl, start, addr);
+#endif
+		return send_messages(impl, start, &addr);
+	}
+
+	int UDPSocketImpl::send_messages(const UDPDatagramBatchImpl &batch, int start, const sockaddr_in *addr)
+	{
+		int count = batch._count - start;
+		if (count <= 0)
+			return 0;
+
+		for (int i = start; i < batch._count; i++)
+		{
+			if (!addr && !batch.has_address[i])
+				throw Exception("No end point specified for UDP datagram");
+		}
+
+#if defined(__linux__)
+		for (int i = 0; i < count; i++)
+		{
+			int index = start + i;
+			batch.vectors[i].iov_base = const_cast<void *>(batch.data(index));
+			batch.vectors[i].iov_len = batch.sizes[index];
+
+			msghdr &header = batch.messages[i].msg_hdr;
+			memset(&header, 0, sizeof(msghdr));
+			header.msg_name = const_cast<sockaddr_in *>(addr ? addr : &batch.addresses[index]);
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = &batch.vectors[i];
+			header.msg_iovlen = 1;
+		}
+
+		int result = sendmmsg(handle, batch.messages.data(), count, 0);
+		if (result == -1)
+		{
+			if (errno == EWOULDBLOCK || errno == ENOBUFS)
+				return 0;
+			throw Exception("Error writing to udp socket");
+		}
+		return result;
+#else
+		int sent = 0;
+		for (; sent < count; sent++)
+		{
+			int index = start + sent;
+			const sockaddr_in *target = addr ? addr : &batch.addresses[index];
+			int result = sendto(handle, batch.data(index), batch.sizes[index], 0, (const sockaddr *)target, sizeof(sockaddr_in));
+			if (result == -1)
+			{
+				if (errno == EWOULDBLOCK || errno == ENOBUFS)
+					break;
+				throw Exception("Error writing to udp socket");
+			}
+		}
+		return sent;
+#endif
+	}
+
+#if defined(__linux__)
+	int UDPSocketImpl::send_segmented(const UDPDatagramBatchImpl &batch, int start, const sockaddr_in &addr)
+	{
+		// The kernel splits a segmented send into datagrams of segment_size bytes, where only the last may be shorter
+		const int max_segments = 64;
+		const int max_payload = 65000;
+
+		int sent = start;
+		while (sent < batch._count)
+		{
+			int segment_size = batch.sizes[sent];
+			int segments = 1;
+			int payload = segment_size;
+			while (segment_size > 0 && sent + segments < batch._count && segments < max_segments)
+			{
+				int next_size = batch.sizes[sent + segments];
+				if (next_size > segment_size || next_size == 0 || payload + next_size > max_payload)
+					break;
+				payload += next_size;
+				segments++;
+				if (next_size < segment_size)
+					break;
+			}
+
+			for (int i = 0; i < segments; i++)
+			{
+				batch.vectors[i].iov_base = const_cast<void *>(batch.data(sent + i));
+				batch.vectors[i].iov_len = batch.sizes[sent + i];
+			}
+
+			char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+			msghdr header = {};
+			header.msg_name = const_cast<sockaddr_in *>(&addr);
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = batch.vectors.data();
+			header.msg_iovlen = segments;
+			if (segments > 1)
+			{
+				header.msg_control = control;
+				header.msg_controllen = sizeof(control);
+				cmsghdr *message = CMSG_FIRSTHDR(&header);
+				message->cmsg_level = SOL_UDP;
+				message->cmsg_type = UDP_SEGMENT;
+				message->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+				uint16_t gso_size = segment_size;
+				memcpy(CMSG_DATA(message), &gso_size, sizeof(uint16_t));
+			}
+
+			int result = sendmsg(handle, &header, 0);
+			if (result == -1)
+			{
+				if (errno == EWOULDBLOCK || errno == ENOBUFS)
+					break;
+
+				// Kernels older than 4.18, or network devices without checksum offload, do not support segmentation
+				if (segments > 1 && (errno == EINVAL || errno == ENOPROTOOPT || errno == EIO || errno == EOPNOTSUPP))
+				{
+					// EINVAL and EIO are also returned for invalid datagrams, so they only disable offload before it has worked once
+					if (errno == ENOPROTOOPT || errno == EOPNOTSUPP || !segmentation_offload_confirmed)
+						segmentation_offload = false;
+					return sent - start + send_messages(batch, sent, &addr);
+				}
+				throw Exception("Error writing to udp socket");
+			}
+			if (segments > 1)
+				segmentation_offload_confirmed = true;
+			sent += segments;
+		}
+		return sent - start;
+	}
+#endif
+
+	int UDPSocketImpl::read(UDPDatagramBatch &batch)
+	{
+		auto &impl = static_cast<UDPDatagramBatchImpl &>(batch);
+		impl.clear();
+
+		poll_state->can_read = false;
+
+#if defined(__linux__)
+		for (int i = 0; i < impl._capacity; i++)
+		{
+			impl.vectors[i].iov_base = impl.slot(i);
+			impl.vectors[i].iov_len = impl._max_datagram_size;
+
+			msghdr &header = impl.messages[i].msg_hdr;
+			memset(&header, 0, sizeof(msghdr));
+			header.msg_name = &impl.addresses[i];
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = &impl.vectors[i];
+			header.msg_iovlen = 1;
+		}
+
+		int result = recvmmsg(handle, impl.messages.data(), impl._capacity, 0, nullptr);
+		if (result == -1)
+		{
+			if (errno == EWOULDBLOCK)
+				return 0;
+			if (errno == ECONNRESET || errno == ENETRESET)
+			{
+				poll_state->can_read = true;
+				return 0;
+			}
+			throw Exception("Error reading from udp socket");
+		}
+
+		for (int i = 0; i < result; i++)
+		{
+			impl.sizes[i] = std::min((int)impl.messages[i].msg_len, impl._max_datagram_size);
+			impl.has_address[i] = true;
+		}
+		impl._count = result;
+#else
+		while (impl._count < impl._capacity)
+		{
+			int index = impl._count;
+			socklen_t addr_len = sizeof(sockaddr_in);
+			int result = recvfrom(handle, impl.slot(index), impl._max_datagram_size, 0, (sockaddr *)&impl.addresses[index], &addr_len);
+			if (result == -1)
+			{
+				if (errno == EWOULDBLOCK || errno == ECONNRESET || errno == ENETRESET)
+					break;
+				throw Exception("Error reading from udp socket");
+			}
+
+			impl.sizes[index] = std::min(result, impl._max_datagram_size);
+			impl.has_address[index] = true;
+			impl._count++;
+		}
+#endif
+
+		// A full batch may have left more datagrams queued
+		if (impl._count == impl._capacity)
+			poll_state->can_read = true;
+		return impl._count;
+	}
+
 #endif
 }
@@ -48,10 +48,13 @@ namespace uicore
 
 		void get_images(const std::shared_ptr<Canvas> &canvas)
 		{
-			if (!canvas_image && image)
+			// Images still loading are asked for again until something else than the placeholder is returned
+			auto placeholder = UIThread::placeholder_image();
+
+			if ((!canvas_image || canvas_image == placeholder) && image)
 				canvas_image = image->image(canvas);
 
-			if (!canvas_highlighted_image && highlighted_image)
+			if ((!canvas_highlighted_image || canvas_highlighted_image == placeholder) && highlighted_image)
 				canvas_highlighted_image = highlighted_image->image(canvas);
 		}
 	};
@@ -40,6 +40,8 @@
 #include "Properties/outline.h"
 #include "Properties/padding.h"
 #include "Properties/text_and_font.h"
+#include <unordered_map>
+#include <algorithm>
 
 namespace uicore
 {
@@ -62,6 +64,29 @@ namespace uicore
 		}
 	} style_force_link;
 
+	class StyleSharedCache
+	{
+	public:
+		std::unordered_map<std::string, std::weak_ptr<Style>> by_text;
+		std::unordered_multimap<std::size_t, std::weak_ptr<Style>> by_content;
+		std::size_t next_sweep = 64;
+
+		void sweep()
+		{
+			for (auto it = by_text.begin(); it != by_text.end();)
+				it = it->second.expired() ? by_text.erase(it) : ++it;
+			for (auto it = by_content.begin(); it != by_content.end();)
+				it = it->second.expired() ? by_content.erase(it) : ++it;
+			next_sweep = std::max((std::size_t)64, by_content.size() * 2);
+		}
+
+		static StyleSharedCache *instance()
+		{
+			static StyleSharedCache cache;
+			return &cache;
+		}
+	};
+
 	Style::Style() : impl(new StyleImpl())
 	{
 	}
@@ -72,9 +97,98 @@ namespace uicore
 
 	void Style::set(const std::string &properties)
 	{
+		if (impl->shared)
+			throw Exception("Shared styles cannot be modified");
 		StyleProperty::parse(impl.get(), properties);
 	}
 
+	void Style::set_value(const std::string &property_name, const StyleSetValue &value)
+	{
+		if (impl->shared)
+			throw Exception("Shared styles cannot be modified");
+		impl->set_value(property_name, value);
+	}
+
+	void Style::set_value_array(const std::string &property_name, const std::vector<StyleSetValue> &value_array)
+	{
+		if (impl->shared)
+			throw Exception("Shared styles cannot be modified");
+		impl->set_value_array(property_name, value_array);
+	}
+
+	bool Style::is_shared() const
+	{
+		return impl->shared;
+	}
+
+	std::shared_ptr<Style> Style::clone() const
+	{
+		auto style = std::make_shared<Style>();
+		style->impl->prop_type = impl->prop_type;
+		style->impl->prop_text = impl->prop_text;
+		style->impl->prop_number = impl->prop_number;
+		style->impl->prop_dimension = impl->prop_dimension;
+		style->impl->prop_color = impl->prop_color;
+		return style;
+	}
+
+	std::shared_ptr<Style> Style::shared(const std::string &properties)
+	{
+		auto cache = StyleSharedCache::instance();
+
+		auto it = cache->by_text.find(properties);
+		if (it != cache->by_text.end())
+		{
+			auto style = it->second.lock();
+			if (style)
+				return style;
+		}
+
+		auto style = std::make_shared<Style>();
+		style->set(properties);
+		style = shared(style);
+		cache->by_text[properties] = style;
+		return style;
+	}
+
+	std::shared_ptr<Style> Style::shared(const std::shared_ptr<Style> &style)
+	{
+		if (style->impl->shared)
+			return style;
+
+		auto cache = StyleSharedCache::instance();
+
+		std::size_t hash = style->impl->content_hash();
+		auto range = cache->by_content.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			auto existing = it->second.lock();
+			if (existing && existing->impl->content_equals(*style->impl))
+				return existing;
+		}
+
+		auto shared_style = style->clone();
+		shared_style->impl->shared = true;
+		cache->by_content.insert({ hash, shared_style });
+
+		if (cache->by_content.size() + cache->by_text.size() > cache->next_sweep)
+			cache->sweep();
+
+		return shared_style;
+	}
+
+	size_t Style::shared_count()
+	{
+		auto cache = StyleSharedCache::instance();
+		size_t count = 0;
+		for (const auto &it : cache->by_content)
+		{
+			if (!it.second.expired())
+				count++;
+		}
+		return count;
+	}
+
 	StyleGetValue Style::declared_value(const char *property_name_str) const
 	{
 		StyleString property_name = property_name_str;
@@ -115,4 +115,30 @@ namespace uicore
 			set_value(index_name, StyleSetValue());
 		}
 	}
+
+	std::size_t StyleImpl::content_hash() const
+	{
+		// Combined by addition so the result does not depend on the hash table iteration order
+		StyleString::hash hash_name;
+		std::hash<std::string> hash_text;
+		std::hash<float> hash_float;
+
+		std::size_t hash = prop_type.size();
+		for (const auto &it : prop_type)
+			hash += hash_name(it.first) * 31 + static_cast<std::size_t>(it.second);
+		for (const auto &it : prop_text)
+			hash += hash_text(it.second);
+		for (const auto &it : prop_number)
+			hash += hash_float(it.second);
+		for (const auto &it : prop_dimension)
+			hash += static_cast<std::size_t>(it.second);
+		for (const auto &it : prop_color)
+			hash += hash_float(it.second.x) ^ (hash_float(it.second.y) << 1) ^ (hash_float(it.second.z) << 2) ^ (hash_float(it.second.w) << 3);
+		return hash;
+	}
+
+	bool StyleImpl::content_equals(const StyleImpl &other) const
+	{
+		return prop_type == other.prop_type && prop_text == other.prop_text && prop_number == other.prop_number && prop_dimension == other.prop_dimension && prop_color == other.prop_color;
+	}
 }
@@ -144,6 +144,11 @@ namespace uicore
 		void set_value(const std::string &name, const StyleSetValue &value) override;
 		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override;
 
+		std::size_t content_hash() const;
+		bool content_equals(const StyleImpl &other) const;
+
+		bool shared = false;
+
 		std::unordered_map<StyleString, StyleValueType, StyleString::hash> prop_type;
 		std::unordered_map<StyleString, std::string, StyleString::hash> prop_text;
 		std::unordered_map<StyleString, float, StyleString::hash> prop_number;
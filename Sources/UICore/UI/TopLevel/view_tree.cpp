@@ -30,6 +30,7 @@
 #include "UICore/UI/TopLevel/view_tree.h"
 #include "UICore/UI/Events/event.h"
 #include "UICore/UI/Events/focus_change_event.h"
+#include "UICore/UI/UIThread/ui_thread.h"
 #include "../View/view_impl.h"
 #include "../View/positioned_layout.h"
 #include <algorithm>
@@ -51,11 +52,18 @@ namespace uicore
 
 		View *focus_view = nullptr;
 		std::shared_ptr<View> root;
+		SlotContainer slots;
 	};
 
 	ViewTree::ViewTree() : impl(new ViewTreeImpl)
 	{
 		set_root_view(std::make_shared<View>());
+
+		// UIThread already invalidated the views that measured or rendered a placeholder while the images were loading
+		impl->slots.connect(UIThread::sig_images_loaded(), [this]()
+		{
+			set_needs_render();
+		});
 	}
 
 	ViewTree::~ViewTree()
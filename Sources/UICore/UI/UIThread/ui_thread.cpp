@@ -29,6 +29,8 @@
 #include "UICore/precomp.h"
 #include "UICore/Display/2D/canvas.h"
 #include "UICore/Display/2D/image.h"
+#include "UICore/Display/Image/pixel_buffer.h"
+#include "UICore/Display/ImageFormats/image_file.h"
 #include "UICore/Display/Font/font.h"
 #include "UICore/Display/Font/font_family.h"
 #include "UICore/Display/System/run_loop.h"
@@ -37,10 +39,31 @@
 #include "UICore/Core/IOData/path_help.h"
 #include "UICore/Core/IOData/directory.h"
 #include "UICore/UI/Style/style.h"
+#include "UICore/Core/System/work_queue.h"
+#include "UICore/Display/2D/texture_group.h"
+#include "UICore/UI/View/view.h"
+#include "../View/view_impl.h"
+#include <chrono>
 #include <map>
+#include <list>
+#include <unordered_map>
 
 namespace uicore
 {
+	class UIThreadImage
+	{
+	public:
+		std::string name;
+		std::shared_ptr<Image> image;
+		std::exception_ptr exception;
+		std::chrono::steady_clock::time_point retry_time;
+		bool loading = false;
+		size_t bytes = 0;
+
+		// Views that measured or rendered the placeholder while the image was loading
+		std::vector<std::weak_ptr<View>> requesters;
+	};
+
 	class UIThreadImpl
 	{
 	public:
@@ -60,7 +83,153 @@ namespace uicore
 		std::function<void(const std::exception_ptr &)> exception_handler;
 
 		std::map<std::string, std::shared_ptr<FontFamily>> font_families;
-		std::map<std::string, std::shared_ptr<Image>> images;
+
+		// Most recently used image first
+		std::list<UIThreadImage> images;
+		std::unordered_map<std::string, std::list<UIThreadImage>::iterator> image_lookup;
+		size_t image_cache_bytes = 0;
+		size_t image_cache_budget = 128 * 1024 * 1024;
+		std::shared_ptr<Image> placeholder_image;
+		Signal<void()> sig_images_loaded;
+		bool images_loaded_pending = false;
+
+		std::list<UIThreadImage>::iterator find_image(const std::string &name)
+		{
+			auto it = image_lookup.find(name);
+			if (it == image_lookup.end())
+			{
+				images.push_front(UIThreadImage());
+				images.front().name = name;
+				image_lookup[name] = images.begin();
+				return images.begin();
+			}
+			else
+			{
+				images.splice(images.begin(), images, it->second);
+				return it->second;
+			}
+		}
+
+		void set_image_loaded(std::list<UIThreadImage>::iterator entry, const std::shared_ptr<Image> &image, size_t bytes)
+		{
+			entry->image = image;
+			entry->loading = false;
+			entry->bytes = bytes;
+			image_cache_bytes += bytes;
+			invalidate_requesters(entry);
+			evict_images();
+		}
+
+		void set_image_failed(std::list<UIThreadImage>::iterator entry, const std::exception_ptr &exception)
+		{
+			entry->exception = exception;
+			entry->loading = false;
+			entry->retry_time = std::chrono::steady_clock::now() + failed_image_retry_delay;
+
+			// Charge the entry itself, so failures are evicted like loaded images instead of piling up outside the budget
+			entry->bytes = sizeof(UIThreadImage) + entry->name.size();
+			image_cache_bytes += entry->bytes;
+			invalidate_requesters(entry);
+			evict_images();
+		}
+
+		void clear_image_failure(std::list<UIThreadImage>::iterator entry)
+		{
+			image_cache_bytes -= entry->bytes;
+			entry->bytes = 0;
+			entry->exception = nullptr;
+		}
+
+		void add_requester(std::list<UIThreadImage>::iterator entry, View *view)
+		{
+			for (const auto &requester : entry->requesters)
+			{
+				if (requester.lock().get() == view)
+					return;
+			}
+			entry->requesters.push_back(view->shared_from_this());
+		}
+
+		void invalidate_requesters(std::list<UIThreadImage>::iterator entry)
+		{
+			for (const auto &requester : entry->requesters)
+			{
+				auto view = requester.lock();
+				if (view)
+					view->set_needs_layout();
+			}
+			entry->requesters.clear();
+		}
+
+		// Time a failed load is reported before the image is loaded again
+		const std::chrono::seconds failed_image_retry_delay = std::chrono::seconds(5);
+
+		void evict_images()
+		{
+			// Images still in use by views stay alive through their shared_ptr, they just have to be loaded again if requested
+			auto it = images.end();
+			while (image_cache_bytes > image_cache_budget && it != images.begin())
+			{
+				--it;
+				if (!it->loading && it->bytes > 0)
+				{
+					image_cache_bytes -= it->bytes;
+					image_lookup.erase(it->name);
+					it = images.erase(it);
+				}
+			}
+		}
+
+		void load_image_async(std::list<UIThreadImage>::iterator entry, const std::shared_ptr<Canvas> &canvas)
+		{
+			entry->loading = true;
+
+			std::string name = entry->name;
+			std::string filename = FilePath::combine(resource_path, name);
+			WorkQueue::shared()->queue([=]()
+			{
+				std::shared_ptr<PixelBuffer> pixelbuffer;
+				std::exception_ptr exception;
+				try
+				{
+					pixelbuffer = ImageFile::load(filename);
+					if (pixelbuffer->format() != tf_rgba8)
+						pixelbuffer = pixelbuffer->to_format(tf_rgba8);
+				}
+				catch (...)
+				{
+					exception = std::current_exception();
+				}
+
+				RunLoop::main_thread_async([=]()
+				{
+					auto impl = instance();
+					auto it = impl->image_lookup.find(name);
+					if (it == impl->image_lookup.end() || !it->second->loading)
+						return;
+
+					if (exception)
+					{
+						impl->set_image_failed(it->second, exception);
+					}
+					else
+					{
+						impl->set_image_loaded(it->second, Image::create(canvas, pixelbuffer, pixelbuffer->size()), pixelbuffer->data_size());
+					}
+
+					if (!impl->images_loaded_pending)
+					{
+						// Completions queued at the same time only cause one relayout
+						impl->images_loaded_pending = true;
+						RunLoop::main_thread_async([=]()
+						{
+							instance()->images_loaded_pending = false;
+							instance()->sig_images_loaded();
+						});
+					}
+				});
+			});
+		}
 
 		static UIThreadImpl *instance()
 		{
@@ -122,12 +291,77 @@ namespace uicore
 		UIThreadImpl::instance()->resource_path = path;
 	}
 
-	std::shared_ptr<Image> UIThread::image(const std::shared_ptr<Canvas> &canvas, const std::string &name)
+	std::shared_ptr<Image> UIThread::image(const std::shared_ptr<Canvas> &canvas, const std::string &name, bool wait)
+	{
+		auto impl = UIThreadImpl::instance();
+		auto entry = impl->find_image(name);
+
+		if (entry->image)
+			return entry->image;
+
+		if (entry->exception)
+		{
+			if (std::chrono::steady_clock::now() < entry->retry_time)
+				std::rethrow_exception(entry->exception);
+
+			// The failure has expired, so a transient error does not stick
+			impl->clear_image_failure(entry);
+		}
+
+		if (wait)
+		{
+			// A pending asynchronous load is ignored when it completes
+			entry->loading = false;
+			std::shared_ptr<Image> image;
+			try
+			{
+				image = Image::create(canvas, FilePath::combine(impl->resource_path, name));
+			}
+			catch (...)
+			{
+				impl->set_image_failed(entry, std::current_exception());
+				throw;
+			}
+
+			// Width and height are in dips, the texture rectangle is in pixels
+			Size pixel_size = image->texture().geometry().size();
+			impl->set_image_loaded(entry, image, (size_t)pixel_size.width * pixel_size.height * 4);
+			return image;
+		}
+
+		if (ViewImageRequesterScope::current)
+			impl->add_requester(entry, ViewImageRequesterScope::current);
+
+		if (!entry->loading)
+			impl->load_image_async(entry, canvas);
+
+		return impl->placeholder_image;
+	}
+
+	std::shared_ptr<Image> UIThread::placeholder_image()
+	{
+		return UIThreadImpl::instance()->placeholder_image;
+	}
+
+	void UIThread::set_placeholder_image(const std::shared_ptr<Image> &image)
+	{
+		UIThreadImpl::instance()->placeholder_image = image;
+	}
+
+	size_t UIThread::image_cache_budget()
+	{
+		return UIThreadImpl::instance()->image_cache_budget;
+	}
+
+	void UIThread::set_image_cache_budget(size_t bytes)
+	{
+		UIThreadImpl::instance()->image_cache_budget = bytes;
+		UIThreadImpl::instance()->evict_images();
+	}
+
+	Signal<void()> &UIThread::sig_images_loaded()
 	{
-		auto &images = UIThreadImpl::instance()->images;
-		if (images.find(name) == images.end())
-			images[name] = Image::create(canvas, FilePath::combine(UIThreadImpl::instance()->resource_path, name));
-		return images[name];
+		return UIThreadImpl::instance()->sig_images_loaded;
 	}
 
 	std::shared_ptr<Font> UIThread::font(const std::string &family, const FontDescription &desc)
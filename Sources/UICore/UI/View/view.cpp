@@ -80,7 +80,15 @@ namespace uicore
 	{
 		const auto it = impl->styles.find(state);
 		if (it != impl->styles.end())
+		{
+			if (it->second->is_shared())
+			{
+				// Copy on write
+				it->second = it->second->clone();
+				impl->update_style_cascade();
+			}
 			return it->second;
+		}
 
 		auto &style = impl->styles[state];
 		style = std::make_shared<Style>();
@@ -88,6 +96,16 @@ namespace uicore
 		return style;
 	}
 
+	void View::set_style(const std::shared_ptr<Style> &style, const std::string &state)
+	{
+		if (style)
+			impl->styles[state] = style;
+		else
+			impl->styles.erase(state);
+		impl->update_style_cascade();
+		set_needs_layout();
+	}
+
 	bool View::state(const std::string &name) const
 	{
 		const auto it = impl->states.find(name);
@@ -310,6 +328,7 @@ namespace uicore
 	{
 		impl->needs_layout = true;
 		impl->layout_cache.clear();
+		impl->layer.dirty = true;
 
 		View *super = parent();
 		if (super)
@@ -329,6 +348,8 @@ namespace uicore
 
 	void View::set_needs_render()
 	{
+		ViewImpl::set_layers_dirty(this);
+
 		ViewTree *tree = view_tree();
 		if (tree)
 			tree->set_needs_render();
@@ -375,7 +396,12 @@ namespace uicore
 	void View::set_view_transform(const Mat4f &transform)
 	{
 		impl->view_transform = transform;
-		set_needs_render();
+
+		// A cached layer is composited with the view transform and does not have to be rendered again
+		ViewImpl::set_layers_dirty(parent());
+		ViewTree *tree = view_tree();
+		if (tree)
+			tree->set_needs_render();
 	}
 
 	bool View::content_clipped() const
@@ -392,6 +418,52 @@ namespace uicore
 		}
 	}
 
+	bool View::layer_cached() const
+	{
+		return impl->layer.enabled;
+	}
+
+	void View::set_layer_cached(bool enable)
+	{
+		if (impl->layer.enabled != enable)
+		{
+			impl->layer.enabled = enable;
+			if (!enable)
+				impl->layer.release();
+			set_needs_render();
+		}
+	}
+
+	float View::layer_opacity() const
+	{
+		return impl->layer.opacity;
+	}
+
+	void View::set_layer_opacity(float opacity)
+	{
+		impl->layer.opacity = opacity;
+
+		ViewImpl::set_layers_dirty(parent());
+		ViewTree *tree = view_tree();
+		if (tree)
+			tree->set_needs_render();
+	}
+
+	size_t View::layer_memory_budget()
+	{
+		return ViewLayer::memory_budget;
+	}
+
+	void View::set_layer_memory_budget(size_t bytes)
+	{
+		ViewLayer::memory_budget = bytes;
+	}
+
+	size_t View::layer_memory_usage()
+	{
+		return ViewLayer::memory_usage;
+	}
+
 	float View::preferred_margin_width(const std::shared_ptr<Canvas> &canvas)
 	{
 		float margin_left = style_cascade().computed_value("margin-left").number();
@@ -464,6 +536,7 @@ namespace uicore
 	{
 		if (!impl->layout_cache.preferred_width_calculated)
 		{
+			ViewImageRequesterScope requester(this);
 			impl->layout_cache.preferred_width = calculate_preferred_width(canvas);
 			impl->layout_cache.preferred_width_calculated = true;
 		}
@@ -476,6 +549,7 @@ namespace uicore
 		if (it != impl->layout_cache.preferred_height.end())
 			return it->second;
 
+		ViewImageRequesterScope requester(this);
 		float height = calculate_preferred_height(canvas, width);
 		impl->layout_cache.preferred_height[width] = height;
 		return height;
@@ -487,6 +561,7 @@ namespace uicore
 		if (it != impl->layout_cache.first_baseline_offset.end())
 			return it->second;
 
+		ViewImageRequesterScope requester(this);
 		float baseline_offset = calculate_first_baseline_offset(canvas, width);
 		impl->layout_cache.first_baseline_offset[width] = baseline_offset;
 		return baseline_offset;
@@ -498,6 +573,7 @@ namespace uicore
 		if (it != impl->layout_cache.last_baseline_offset.end())
 			return it->second;
 
+		ViewImageRequesterScope requester(this);
 		float baseline_offset = calculate_last_baseline_offset(canvas, width);
 		impl->layout_cache.last_baseline_offset[width] = baseline_offset;
 		return baseline_offset;
@@ -1044,13 +1120,30 @@ namespace uicore
 
 	void ViewImpl::render(View *self, const std::shared_ptr<Canvas> &canvas)
 	{
+		ViewImageRequesterScope requester(self);
+
 		style_cascade.render_background(canvas, _geometry);
 		style_cascade.render_border(canvas, _geometry);
 
 		Mat4f old_transform = canvas->transform();
 		Pointf translate = _geometry.content_pos();
+		Sizef content_size(_geometry.content_width, _geometry.content_height);
+
+		if (layer.enabled && layer.update(canvas, content_size, [&](const std::shared_ptr<Canvas> &layer_canvas) { render_contents(self, layer_canvas, Mat4f::identity()); }))
+		{
+			canvas->set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform);
+			layer.draw(canvas, content_size);
+			canvas->set_transform(old_transform);
+			return;
+		}
+
 		canvas->set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0) * view_transform);
+		render_contents(self, canvas, old_transform * Mat4f::translate(translate.x, translate.y, 0));
+		canvas->set_transform(old_transform);
+	}
 
+	void ViewImpl::render_contents(View *self, const std::shared_ptr<Canvas> &canvas, const Mat4f &untransformed)
+	{
 		bool clipped = content_clipped;
 		if (clipped)
 		{
@@ -1076,7 +1169,7 @@ namespace uicore
 
 		if (self->render_exception_encountered())
 		{
-			canvas->set_transform(old_transform * Mat4f::translate(translate.x, translate.y, 0));
+			canvas->set_transform(untransformed);
 			Path::rect(0.0f, 0.0f, _geometry.content_width, _geometry.content_height)->fill(canvas, Colorf(1.0f, 0.2f, 0.2f, 0.5f));
 			Path::line(0.0f, 0.0f, _geometry.content_width, _geometry.content_height)->stroke(canvas, StandardColorf::black());
 			Path::line(_geometry.content_width, 0.0f, 0.0f, _geometry.content_height)->stroke(canvas, StandardColorf::black());
@@ -1101,8 +1194,14 @@ namespace uicore
 
 		if (clipped)
 			canvas->pop_clip();
+	}
 
-		canvas->set_transform(old_transform);
+	View *ViewImageRequesterScope::current = nullptr;
+
+	void ViewImpl::set_layers_dirty(View *view)
+	{
+		for (; view != nullptr; view = view->parent())
+			view->impl->layer.dirty = true;
 	}
 
 	void ViewImpl::update_style_cascade() const
@@ -35,6 +35,7 @@
 #include "../Animation/animation_group.h"
 #include "view_layout.h"
 #include "flex_layout.h"
+#include "view_layer.h"
 #include <map>
 
 namespace uicore
@@ -74,12 +75,28 @@ namespace uicore
 		}
 	};
 
+	/// \brief Makes a view the image requester while it measures or renders itself
+	///
+	/// UIThread::image remembers the requester of an image that is still loading, so only that view is laid out again when it arrives.
+	class ViewImageRequesterScope
+	{
+	public:
+		ViewImageRequesterScope(View *view) : previous(current) { current = view; }
+		~ViewImageRequesterScope() { current = previous; }
+
+		static View *current;
+
+	private:
+		View *previous;
+	};
+
 	class ViewImpl
 	{
 	public:
 		ViewLayout *active_layout(View *self);
 
 		void render(View *self, const std::shared_ptr<Canvas> &canvas);
+		void render_contents(View *self, const std::shared_ptr<Canvas> &canvas, const Mat4f &untransformed);
 		void process_event(View *self, EventUI *e, bool use_capture);
 		void process_event_handler(ViewEventHandler *handler, EventUI *e);
 		void update_style_cascade() const;
@@ -94,6 +111,8 @@ namespace uicore
 
 		void inverse_bubble(EventUI *e, const View *until_parent_view);
 
+		static void set_layers_dirty(View *view);
+
 		View *_parent = nullptr;
 		std::shared_ptr<View> _first_child, _last_child;
 		std::shared_ptr<View> _next_sibling;
@@ -139,6 +158,8 @@ namespace uicore
 		Mat4f view_transform = Mat4f::identity();
 		bool content_clipped = false;
 
+		ViewLayer layer;
+
 		bool exception_encountered = false;
 
 		bool needs_layout = true;
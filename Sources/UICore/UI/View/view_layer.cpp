@@ -0,0 +1,123 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "UICore/precomp.h"
+#include "UICore/Display/2D/canvas.h"
+#include "UICore/Display/2D/image.h"
+#include "UICore/Display/Render/graphic_context.h"
+#include "UICore/Display/Render/texture_2d.h"
+#include "UICore/Display/Render/frame_buffer.h"
+#include "UICore/Display/Render/blend_state_description.h"
+#include "UICore/Display/2D/canvas_impl.h"
+#include "view_layer.h"
+#include <cmath>
+
+namespace uicore
+{
+	size_t ViewLayer::memory_budget = 64 * 1024 * 1024;
+	size_t ViewLayer::memory_usage = 0;
+
+	ViewLayer::~ViewLayer()
+	{
+		release();
+	}
+
+	bool ViewLayer::update(const std::shared_ptr<Canvas> &canvas, const Sizef &content_size, const std::function<void(const std::shared_ptr<Canvas> &)> &render_contents)
+	{
+		float pixel_ratio = canvas->pixel_ratio();
+		Size size((int)std::ceil(content_size.width * pixel_ratio), (int)std::ceil(content_size.height * pixel_ratio));
+		if (size.width <= 0 || size.height <= 0)
+		{
+			release();
+			return false;
+		}
+
+		if (!texture || texture->size() != size || gc != canvas->gc())
+		{
+			release();
+
+			Size max_size = canvas->gc()->max_texture_size();
+			size_t bytes = (size_t)size.width * size.height * 4;
+			if (size.width > max_size.width || size.height > max_size.height || memory_usage + bytes > memory_budget)
+				return false;
+
+			gc = canvas->gc();
+			texture = Texture2D::create(gc, size, tf_rgba8);
+			frame_buffer = FrameBuffer::create(gc);
+			frame_buffer->attach_color(0, texture);
+			layer_canvas = Canvas::create(canvas, frame_buffer);
+			image = Image::create(texture, Rect(Point(), size), pixel_ratio);
+			premultiplied_blend = gc->create_blend_state(BlendStateDescription::blend(true));
+
+			texture_bytes = bytes;
+			memory_usage += texture_bytes;
+			dirty = true;
+		}
+
+		if (dirty)
+		{
+			// Cleared first so that anything invalidating the view during rendering is picked up in the next frame
+			dirty = false;
+
+			canvas->end();
+			layer_canvas->begin();
+			layer_canvas->clear(StandardColorf::transparent());
+			layer_canvas->set_transform(Mat4f::identity());
+			render_contents(layer_canvas);
+			layer_canvas->end();
+			canvas->begin();
+		}
+
+		return true;
+	}
+
+	void ViewLayer::draw(const std::shared_ptr<Canvas> &canvas, const Sizef &content_size)
+	{
+		// The layer was rendered onto a transparent texture, which leaves its colors premultiplied by alpha
+		CanvasImpl *canvas_impl = static_cast<CanvasImpl*>(canvas.get());
+		canvas_impl->batcher.flush();
+		gc->set_blend_state(premultiplied_blend);
+		image->set_color(Colorf(opacity, opacity, opacity, opacity));
+		image->draw(canvas, Rectf(Pointf(), content_size));
+		canvas_impl->batcher.flush();
+		gc->set_blend_state(nullptr);
+	}
+
+	void ViewLayer::release()
+	{
+		memory_usage -= texture_bytes;
+		texture_bytes = 0;
+
+		image.reset();
+		layer_canvas.reset();
+		frame_buffer.reset();
+		texture.reset();
+		premultiplied_blend.reset();
+		gc.reset();
+	}
+}
@@ -0,0 +1,77 @@
+/*
+**  UICore
+**  Copyright (c) 1997-2015 The UICore Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries UICore may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "UICore/Core/Math/size.h"
+#include <memory>
+#include <functional>
+
+namespace uicore
+{
+	class Canvas;
+	class GraphicContext;
+	class Texture2D;
+	class FrameBuffer;
+	class Image;
+	class BlendState;
+
+	/// Offscreen texture caching the rendered content and children of a view
+	class ViewLayer
+	{
+	public:
+		~ViewLayer();
+
+		/// Renders the layer contents again if they are dirty
+		///
+		/// Returns false if the layer could not be allocated within the layer memory budget. The view must then render its contents directly.
+		bool update(const std::shared_ptr<Canvas> &canvas, const Sizef &content_size, const std::function<void(const std::shared_ptr<Canvas> &)> &render_contents);
+
+		/// Composites the layer texture into the content box at the current canvas transform
+		void draw(const std::shared_ptr<Canvas> &canvas, const Sizef &content_size);
+
+		/// Frees the layer texture and returns its memory to the budget
+		void release();
+
+		bool enabled = false;
+		bool dirty = true;
+		float opacity = 1.0f;
+
+		static size_t memory_budget;
+		static size_t memory_usage;
+
+	private:
+		std::shared_ptr<GraphicContext> gc;
+		std::shared_ptr<Texture2D> texture;
+		std::shared_ptr<FrameBuffer> frame_buffer;
+		std::shared_ptr<Canvas> layer_canvas;
+		std::shared_ptr<Image> image;
+		std::shared_ptr<BlendState> premultiplied_blend;
+		size_t texture_bytes = 0;
+	};
+}
@@ -31,6 +31,8 @@
 #include "UICore/UI/Style/style_token.h"
 #include "UICore/UI/ViewCompiler/view_compiler.h"
 #include "view_compiler_impl.h"
+#include <cstdio>
+#include <cmath>
 
 namespace uicore
 {
@@ -166,7 +168,31 @@ namespace uicore
 	void ViewCompilerImpl::codegen_constructor_set_style(const std::string &name, const ViewClassMembers &members)
 	{
 		if (!members.style.empty())
-			add_line("\t\t%1style()->set(\"%2\");", name, string_escape(members.style));
+		{
+			// Parse the style at compile time so the generated view does not have to tokenize it during construction
+			ViewStyleRecorder recorder;
+			StyleProperty::parse(&recorder, members.style);
+			recorder.remove_overridden();
+
+			for (const auto &entry : recorder.values)
+			{
+				if (entry.is_array)
+				{
+					std::string array_code;
+					for (const auto &value : entry.values)
+					{
+						if (!array_code.empty())
+							array_code += ", ";
+						array_code += codegen_style_value(value);
+					}
+					add_line("\t\t%1style()->set_value_array(\"%2\", { %3 });", name, string_escape(entry.name), array_code);
+				}
+				else
+				{
+					add_line("\t\t%1style()->set_value(\"%2\", %3);", name, string_escape(entry.name), codegen_style_value(entry.values.front()));
+				}
+			}
+		}
 
 		for (const auto &child : members.children)
 		{
@@ -174,6 +200,86 @@ namespace uicore
 		}
 	}
 
+	std::string ViewCompilerImpl::codegen_style_value(const StyleSetValue &value)
+	{
+		switch (value.type)
+		{
+		default:
+		case StyleValueType::undefined:
+			return "StyleSetValue()";
+		case StyleValueType::keyword:
+			return string_format("StyleSetValue::from_keyword(\"%1\")", string_escape(value.text));
+		case StyleValueType::string:
+			return string_format("StyleSetValue::from_string(\"%1\")", string_escape(value.text));
+		case StyleValueType::url:
+			return string_format("StyleSetValue::from_url(\"%1\")", string_escape(value.text));
+		case StyleValueType::length:
+			return string_format("StyleSetValue::from_length(%1, %2)", codegen_float(value.number), codegen_dimension(value.dimension));
+		case StyleValueType::angle:
+			return string_format("StyleSetValue::from_angle(%1, %2)", codegen_float(value.number), codegen_dimension(value.dimension));
+		case StyleValueType::time:
+			return string_format("StyleSetValue::from_time(%1, %2)", codegen_float(value.number), codegen_dimension(value.dimension));
+		case StyleValueType::frequency:
+			return string_format("StyleSetValue::from_frequency(%1, %2)", codegen_float(value.number), codegen_dimension(value.dimension));
+		case StyleValueType::resolution:
+			return string_format("StyleSetValue::from_resolution(%1, %2)", codegen_float(value.number), codegen_dimension(value.dimension));
+		case StyleValueType::percentage:
+			return string_format("StyleSetValue::from_percentage(%1)", codegen_float(value.number));
+		case StyleValueType::number:
+			return string_format("StyleSetValue::from_number(%1)", codegen_float(value.number));
+		case StyleValueType::color:
+			return string_format("StyleSetValue::from_color(Colorf(%1, %2, %3, %4))", codegen_float(value.color.x), codegen_float(value.color.y), codegen_float(value.color.z), codegen_float(value.color.w));
+		}
+	}
+
+	std::string ViewCompilerImpl::codegen_float(float value)
+	{
+		// inf and nan have no float literal form
+		if (!std::isfinite(value))
+			throw Exception(string_format("Style value %1 is not a finite number", value));
+
+		// 9 significant digits are enough to restore the exact same float
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "%.9g", value);
+		std::string text = buffer;
+		if (text.find_first_of(".en") == std::string::npos)
+			text += ".0";
+		return text + "f";
+	}
+
+	std::string ViewCompilerImpl::codegen_dimension(StyleDimension dimension)
+	{
+		switch (dimension)
+		{
+		default:
+		case StyleDimension::px: return "StyleDimension::px";
+		case StyleDimension::em: return "StyleDimension::em";
+		case StyleDimension::pt: return "StyleDimension::pt";
+		case StyleDimension::mm: return "StyleDimension::mm";
+		case StyleDimension::cm: return "StyleDimension::cm";
+		case StyleDimension::in: return "StyleDimension::in";
+		case StyleDimension::pc: return "StyleDimension::pc";
+		case StyleDimension::ex: return "StyleDimension::ex";
+		case StyleDimension::ch: return "StyleDimension::ch";
+		case StyleDimension::rem: return "StyleDimension::rem";
+		case StyleDimension::vw: return "StyleDimension::vw";
+		case StyleDimension::vh: return "StyleDimension::vh";
+		case StyleDimension::vmin: return "StyleDimension::vmin";
+		case StyleDimension::vmax: return "StyleDimension::vmax";
+		case StyleDimension::deg: return "StyleDimension::deg";
+		case StyleDimension::grad: return "StyleDimension::grad";
+		case StyleDimension::rad: return "StyleDimension::rad";
+		case StyleDimension::turn: return "StyleDimension::turn";
+		case StyleDimension::s: return "StyleDimension::s";
+		case StyleDimension::ms: return "StyleDimension::ms";
+		case StyleDimension::hz: return "StyleDimension::hz";
+		case StyleDimension::khz: return "StyleDimension::khz";
+		case StyleDimension::dpi: return "StyleDimension::dpi";
+		case StyleDimension::dpcm: return "StyleDimension::dpcm";
+		case StyleDimension::dppx: return "StyleDimension::dppx";
+		}
+	}
+
 	void ViewCompilerImpl::codegen_constructor_set_value(const std::string &name, const ViewClassMembers &members)
 	{
 		if (!members.values.empty())
@@ -210,7 +316,21 @@ namespace uicore
 
 	std::string ViewCompilerImpl::string_escape(const std::string &text)
 	{
-		return text; // To do: escape string
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (char c : text)
+		{
+			switch (c)
+			{
+			case '\\': escaped += "\\\\"; break;
+			case '"': escaped += "\\\""; break;
+			case '\n': escaped += "\\n"; break;
+			case '\r': escaped += "\\r"; break;
+			case '\t': escaped += "\\t"; break;
+			default: escaped += c; break;
+			}
+		}
+		return escaped;
 	}
 
 	void ViewCompilerImpl::parse_view_declaration(StyleToken &token, StyleTokenizer &tokenizer)
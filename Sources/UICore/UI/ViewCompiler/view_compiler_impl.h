@@ -4,6 +4,7 @@
 #include <map>
 #include <set>
 #include "UICore/Core/Text/string_format.h"
+#include "UICore/UI/Style/style_property_parser.h"
 
 namespace uicore
 {
@@ -32,6 +33,57 @@ namespace uicore
 		std::string native_type;
 	};
 
+	class ViewStyleValue
+	{
+	public:
+		std::string name;
+		std::vector<StyleSetValue> values;
+		bool is_array = false;
+	};
+
+	/// Records the values set by the style property parsers so they can be emitted as code
+	class ViewStyleRecorder : public StylePropertySetter
+	{
+	public:
+		void set_value(const std::string &name, const StyleSetValue &value) override
+		{
+			ViewStyleValue entry;
+			entry.name = name;
+			entry.values.push_back(value);
+			values.push_back(entry);
+		}
+
+		void set_value_array(const std::string &name, const std::vector<StyleSetValue> &value_array) override
+		{
+			ViewStyleValue entry;
+			entry.name = name;
+			entry.values = value_array;
+			entry.is_array = true;
+			values.push_back(entry);
+		}
+
+		/// Removes values that a later declaration in the same style sets again
+		void remove_overridden()
+		{
+			std::vector<ViewStyleValue> result;
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				bool overridden = false;
+				for (size_t j = i + 1; j < values.size() && !overridden; j++)
+				{
+					// A shorter array only clears the element following it, so earlier elements beyond that stay set
+					overridden = values[j].name == values[i].name && values[j].is_array == values[i].is_array &&
+						(!values[i].is_array || values[j].values.size() + 1 >= values[i].values.size());
+				}
+				if (!overridden)
+					result.push_back(values[i]);
+			}
+			values.swap(result);
+		}
+
+		std::vector<ViewStyleValue> values;
+	};
+
 	class ViewCompilerImpl
 	{
 	public:
@@ -53,6 +105,9 @@ namespace uicore
 		void codegen_constructor_add_child(const std::vector<ViewClassChild> &children, const std::string &parent_prefix);
 		void codegen_constructor_set_style(const std::string &name, const ViewClassMembers &members);
 		void codegen_constructor_set_value(const std::string &name, const ViewClassMembers &members);
+		std::string codegen_style_value(const StyleSetValue &value);
+		std::string codegen_float(float value);
+		std::string codegen_dimension(StyleDimension dimension);
 
 		void add_line(const std::string &text);
 		std::string string_escape(const std::string &text);
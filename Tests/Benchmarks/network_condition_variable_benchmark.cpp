@@ -0,0 +1,217 @@
+// Wake latency and CPU cost of NetworkConditionVariable with many idle sockets.
+//
+// One server thread serves 100 active loopback connections plus N idle ones. A forked client process
+// sends 64-byte ping-pongs on the active connections and reports p50/p99 latency and the rate of a
+// 100-way burst. The server reports its CPU time per wake.
+//
+// Build (Linux): g++ -std=c++11 -O2 -I../../Sources/Include network_condition_variable_benchmark.cpp -L<build dir> -luicore -pthread
+// Usage: network_condition_variable_benchmark <idle sockets> [scan|ready|added]
+//   scan   wait(lock, count, events) and then try every connection (the only option before the epoll backend)
+//   ready  wait(lock, count, events, ready_events) and serve the returned events
+//   added  add() every connection once, then wait(lock, ready_events)
+// Above about 500 idle sockets, raise the open file limit first (ulimit -n 65536).
+
+#include <uicore.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace uicore;
+
+static double now_us()
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double cpu_us()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void transfer(int fd, char *buffer, int size, bool send_data)
+{
+	int done = 0;
+	while (done < size)
+	{
+		int result = send_data ? send(fd, buffer + done, size - done, 0) : recv(fd, buffer + done, size - done, 0);
+		if (result <= 0)
+		{
+			perror("client");
+			exit(1);
+		}
+		done += result;
+	}
+}
+
+static void run_client(int port, int idle, int active, int start_pipe)
+{
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	std::vector<int> sockets(idle + active);
+	for (int &fd : sockets)
+	{
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		int one = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (connect(fd, (sockaddr *)&address, sizeof(address)) != 0)
+		{
+			perror("connect");
+			exit(1);
+		}
+	}
+
+	char start;
+	if (read(start_pipe, &start, 1) != 1)
+		exit(1);
+
+	char buffer[64] = { 1 };
+	const int messages = 20000;
+	std::vector<double> latency;
+	for (int i = 0; i < messages; i++)
+	{
+		int fd = sockets[idle + i % active];
+		double start_time = now_us();
+		transfer(fd, buffer, 64, true);
+		transfer(fd, buffer, 64, false);
+		latency.push_back(now_us() - start_time);
+	}
+	std::sort(latency.begin(), latency.end());
+
+	const int rounds = 200;
+	double start_time = now_us();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (int i = 0; i < active; i++)
+			transfer(sockets[idle + i], buffer, 64, true);
+		for (int i = 0; i < active; i++)
+			transfer(sockets[idle + i], buffer, 64, false);
+	}
+	double burst_rate = rounds * active / ((now_us() - start_time) / 1e6);
+
+	printf("latency p50 %.1f us, p99 %.1f us, %d-way burst %.0f msg/s\n", latency[messages / 2], latency[messages * 99 / 100], active, burst_rate);
+	fflush(stdout);
+
+	buffer[0] = 'q';
+	transfer(sockets[idle], buffer, 64, true);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		printf("Usage: %s <idle sockets> [scan|ready|added]\n", argv[0]);
+		return 1;
+	}
+
+	int idle = atoi(argv[1]);
+	const int active = 100;
+	std::string mode = argc > 2 ? argv[2] : "added";
+	int total = idle + active;
+
+	int port = 20000 + getpid() % 10000;
+	auto listen = TCPListen::listen(SocketName("127.0.0.1", std::to_string(port)), 1024);
+
+	int start_pipe[2];
+	if (pipe(start_pipe) != 0)
+		return 1;
+
+	pid_t client = fork();
+	if (client == 0)
+	{
+		run_client(port, idle, active, start_pipe[0]);
+		_exit(0);
+	}
+
+	NetworkConditionVariable condition;
+	std::mutex mutex;
+	std::unique_lock<std::mutex> lock(mutex);
+
+	std::vector<std::shared_ptr<TCPConnection>> connections;
+	while ((int)connections.size() < total)
+	{
+		NetworkEvent *event = listen.get();
+		condition.wait(lock, 1, &event, 1000);
+		SocketName name;
+		while (auto connection = listen->accept(name))
+			connections.push_back(connection);
+	}
+
+	std::vector<NetworkEvent *> events;
+	for (auto &connection : connections)
+		events.push_back(connection.get());
+	if (mode == "added")
+	{
+		for (auto event : events)
+			condition.add(event);
+	}
+
+	if (write(start_pipe[1], "x", 1) != 1)
+		return 1;
+
+	bool quit = false;
+	char buffer[4096];
+	auto serve = [&](TCPConnection *connection)
+	{
+		while (true)
+		{
+			int received = connection->read(buffer, sizeof(buffer));
+			if (received <= 0)
+				break;
+			if (buffer[0] == 'q')
+				quit = true;
+			for (int sent = 0; sent < received;)
+			{
+				int result = connection->write(buffer + sent, received - sent);
+				if (result > 0)
+					sent += result;
+			}
+		}
+	};
+
+	std::vector<NetworkEvent *> ready_events;
+	double start_cpu = cpu_us();
+	long wakes = 0;
+	while (!quit)
+	{
+		if (mode == "added")
+		{
+			condition.wait(lock, ready_events);
+			for (auto event : ready_events)
+				serve(static_cast<TCPConnection *>(event));
+		}
+		else if (mode == "ready")
+		{
+			condition.wait(lock, total, events.data(), ready_events);
+			for (auto event : ready_events)
+				serve(static_cast<TCPConnection *>(event));
+		}
+		else
+		{
+			condition.wait(lock, total, events.data());
+			for (auto &connection : connections)
+				serve(connection.get());
+		}
+		wakes++;
+	}
+	double cpu = cpu_us() - start_cpu;
+
+	waitpid(client, nullptr, 0);
+	printf("%s, %d idle: %ld wakes, %.1f us server CPU per wake\n", mode.c_str(), idle, wakes, cpu / wakes);
+	return 0;
+}
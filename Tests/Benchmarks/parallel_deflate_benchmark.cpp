@@ -0,0 +1,65 @@
+// Scaling of ZLibCompression::compress_parallel across worker counts.
+//
+// Compresses a synthetic 3840x2160 RGBA screenshot, laid out as PNG IDAT data with a filter byte per row,
+// serially and on work queues of 1 to 16 threads. Every parallel result is decompressed again and compared
+// with the input and with the other thread counts, and its adler32 is compared with the serial stream.
+//
+// Build: g++ -std=c++11 -O2 -I../../Sources/Include parallel_deflate_benchmark.cpp -L<build dir> -luicore -pthread
+
+#include <uicore.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+using namespace uicore;
+
+static bool same_data(const std::shared_ptr<DataBuffer> &a, const std::shared_ptr<DataBuffer> &b)
+{
+	return a->size() == b->size() && memcmp(a->data(), b->data(), a->size()) == 0;
+}
+
+int main()
+{
+	const int width = 3840;
+	const int height = 2160;
+	const size_t pitch = width * 4 + 1;
+
+	// Gradients with some noise, so the data compresses like a screenshot rather than like a solid color
+	auto data = DataBuffer::create((int)(pitch * height));
+	std::mt19937 random(1);
+	unsigned char *pixels = data->data<unsigned char>();
+	for (int y = 0; y < height; y++)
+	{
+		pixels[y * pitch] = 1;
+		for (int x = 0; x < width * 4; x++)
+			pixels[y * pitch + 1 + x] = ((x / 4 + y) & 0xff) ^ ((random() % 8 == 0) ? random() & 7 : 0);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto serial = ZLibCompression::compress(data, false);
+	double serial_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("serial compress:   %.3f s, %d bytes\n", serial_time, (int)serial->size());
+
+	bool passed = true;
+	std::shared_ptr<DataBuffer> first;
+	for (int threads : { 1, 2, 4, 8, 16 })
+	{
+		auto queue = WorkQueue::create(threads);
+		start = std::chrono::steady_clock::now();
+		auto output = ZLibCompression::compress_parallel(data, false, 6, ZLibCompression::default_strategy, queue);
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		bool round_trip = same_data(ZLibCompression::decompress(output, false), data);
+		bool deterministic = !first || same_data(first, output);
+		bool adler32 = memcmp(serial->data() + serial->size() - 4, output->data() + output->size() - 4, 4) == 0;
+		if (!first)
+			first = output;
+		passed = passed && round_trip && deterministic && adler32;
+
+		printf("%2d threads:        %.3f s, %d bytes, %.2fx, round trip %s, deterministic %s, adler32 %s\n", queue->thread_count(), time, (int)output->size(), serial_time / time,
+			round_trip ? "ok" : "FAILED", deterministic ? "ok" : "FAILED", adler32 ? "ok" : "FAILED");
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+// Heap used by a form of 10,000 views with the same declaration block, with and without shared styles.
+//
+// Build (Linux, glibc 2.33 or newer): g++ -std=c++11 -O2 -I../../Sources/Include shared_style_memory_report.cpp -L<build dir> -luicore -pthread
+// Usage: shared_style_memory_report [per-view|shared]
+
+#include <uicore.h>
+#include <malloc.h>
+#include <cstdio>
+#include <string>
+
+using namespace uicore;
+
+static size_t heap_in_use()
+{
+	return mallinfo2().uordblks;
+}
+
+int main(int argc, char **argv)
+{
+	bool shared = argc > 1 && std::string(argv[1]) == "shared";
+	const int view_count = 10000;
+	const char *declarations = "width: 120px; height: 24px; margin: 2px 4px; padding: 3px; border: 1px solid #ccc; border-radius: 3px; background: rgb(240,240,240); font: 12px/16px 'Segoe UI'; color: black;";
+
+	auto form = std::make_shared<View>();
+	size_t before = heap_in_use();
+	for (int i = 0; i < view_count; i++)
+	{
+		auto view = form->add_child<View>();
+		if (shared)
+			view->set_style(Style::shared(declarations));
+		else
+			view->style()->set(declarations);
+	}
+	size_t used = heap_in_use() - before;
+
+	printf("%s: %d KB, %d bytes per view, %d shared styles\n", shared ? "set_style(Style::shared)" : "style()->set per view",
+		(int)(used / 1024), (int)(used / view_count), (int)Style::shared_count());
+	return 0;
+}
@@ -0,0 +1,83 @@
+// Frame time of a sliding panel with a static subtree, rendered directly or through a cached layer.
+//
+// The panel holds a grid of styled views with text. Every frame only changes the view transform of the panel,
+// which is the case cached layers are meant for: the cached run renders the subtree once and then only
+// composites the layer texture.
+//
+// Build (Linux): g++ -std=c++11 -O2 -I../../Sources/Include view_layer_benchmark.cpp -L<build dir> -luicore -pthread
+// Usage: view_layer_benchmark [direct|cached] [frames]
+// Needs a display with OpenGL. Frames are presented without waiting for vsync.
+
+#include <uicore.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace uicore;
+
+static double cpu_seconds()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	bool cached = argc > 1 && std::string(argv[1]) == "cached";
+	int frames = argc > 2 ? atoi(argv[2]) : 500;
+
+	DisplayWindowDescription description;
+	description.set_title("View layer benchmark");
+	description.set_size(Sizef(1024.0f, 768.0f), true);
+	description.set_allow_resize(false);
+	auto window = DisplayWindow::create(description);
+	auto canvas = Canvas::create(window);
+
+	auto tree = std::make_shared<TextureWindow>(canvas);
+	tree->set_viewport(Rectf(Pointf(), canvas->size()));
+	tree->set_background_color(Colorf(0.9f, 0.9f, 0.9f));
+	tree->set_always_render(true);
+
+	auto panel = std::make_shared<View>();
+	panel->style()->set("flex-direction: row; flex-wrap: wrap; width: 600px; padding: 5px; background: white; border: 1px solid #888");
+	for (int i = 0; i < 600; i++)
+	{
+		auto cell = panel->add_child<View>();
+		cell->style()->set("width: 88px; height: 20px; margin: 2px; border: 1px solid #ccc; border-radius: 3px; background: rgb(240,240,240)");
+		auto label = cell->add_child<LabelBaseView>();
+		label->style()->set("font: 11px/14px 'Sans'; color: black; margin: 3px");
+		label->set_text("Item " + std::to_string(i));
+	}
+	panel->set_layer_cached(cached);
+	tree->set_root_view(panel);
+
+	auto render_frame = [&](int frame)
+	{
+		panel->set_view_transform(Mat4f::translate((float)(frame % 400), 0.0f, 0.0f));
+		canvas->begin();
+		tree->update();
+		canvas->end();
+		window->flip(0);
+		RunLoop::process(0);
+	};
+
+	// The first frames lay out the views and, in the cached run, fill the layer
+	for (int i = 0; i < 10; i++)
+		render_frame(i);
+
+	canvas->reset_draw_call_count();
+	double start_cpu = cpu_seconds();
+	auto start_time = std::chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++)
+		render_frame(i);
+	window->gc()->flush();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	double cpu = cpu_seconds() - start_cpu;
+
+	printf("%s: %.3f ms per frame, %.3f ms CPU per frame, %.1f draw calls per frame, layer memory %d KB\n", cached ? "cached" : "direct",
+		elapsed * 1000.0 / frames, cpu * 1000.0 / frames, canvas->draw_call_count() / (double)frames, (int)(View::layer_memory_usage() / 1024));
+	return 0;
+}
@@ -0,0 +1,64 @@
+// Checks that the NetworkReactor thread sleeps while its sockets are readable but nothing is queued on them.
+//
+// Build (Linux): g++ -std=c++20 -O2 -I../../Sources/Include reactor_idle_test.cpp -L<build dir> -luicore -pthread
+// Exits with 0 if the reactor stays idle in both states.
+
+#include <uicore.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <thread>
+
+using namespace uicore;
+
+// CPU time used by the process, in seconds. The main thread only sleeps while it is measured, so it is the reactor thread.
+static double process_cpu_time()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static bool check_idle(const char *state)
+{
+	double start = process_cpu_time();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	double used = process_cpu_time() - start;
+
+	bool idle = used < 0.1;
+	printf("%-50s %.3f s CPU per second  %s\n", state, used, idle ? "OK" : "FAILED");
+	return idle;
+}
+
+int main()
+{
+	auto reactor = NetworkReactor::create();
+	SocketName endpoint("127.0.0.1", "27183");
+	auto listen = AsyncTCPListen::create(TCPListen::listen(endpoint), reactor);
+
+	// Accept one connection and leave no accept queued while a second client is waiting to be accepted
+	std::promise<std::shared_ptr<AsyncTCPConnection>> accepted;
+	listen->async_accept([&](const std::exception_ptr &error, std::shared_ptr<AsyncTCPConnection> connection) { accepted.set_value(connection); });
+
+	auto client = TCPConnection::connect(endpoint);
+	auto server_connection = accepted.get_future().get();
+	auto second_client = TCPConnection::connect(endpoint);
+
+	bool passed = check_idle("Listen socket readable, no accept queued:");
+
+	// Data arrives before anything reads it
+	client->write("hello", 5);
+	passed = check_idle("Connection readable, no read queued:") && passed;
+
+	// The data is still delivered once a read is queued
+	char buffer[16];
+	std::promise<int> read_result;
+	server_connection->async_read(buffer, sizeof(buffer), [&](const std::exception_ptr &error, int bytes) { read_result.set_value(error ? -1 : bytes); });
+	int bytes = read_result.get_future().get();
+	bool delivered = bytes == 5 && std::string(buffer, 5) == "hello";
+	printf("%-50s %d bytes  %s\n", "Queued read after the data arrived:", bytes, delivered ? "OK" : "FAILED");
+
+	return passed && delivered ? 0 : 1;
+}